@@ -0,0 +1,84 @@
+/******************************************************************\
+ * Copyright 2015, DigiPen Institute of Technology
+\******************************************************************/
+
+#include "AstArena.hpp"
+#include <cstdint>
+
+// Blocks start small so that tiny trees stay cheap, and double up to the largest size
+static const size_t FirstBlockSize = 1024;
+static const size_t MaxBlockSize = 64 * 1024;
+
+static thread_local bool Destroying = false;
+
+AstArena::AstArena() :
+  mCursor(nullptr),
+  mEnd(nullptr),
+  mReservedBytes(0),
+  mNodeCount(0),
+  mRoot(nullptr)
+{
+}
+
+AstArena::~AstArena()
+{
+  bool wasDestroying = Destroying;
+  Destroying = true;
+  for (size_t i = 0; i < mDestroyedNodes.size(); ++i)
+    mDestroyedNodes[i]->~AbstractNode();
+  Destroying = wasDestroying;
+
+  for (size_t i = 0; i < mBlocks.size(); ++i)
+    ::operator delete(mBlocks[i]);
+}
+
+void AstArena::SetRoot(AbstractNode* root)
+{
+  mRoot = root;
+}
+
+AbstractNode* AstArena::GetRoot() const
+{
+  return mRoot;
+}
+
+size_t AstArena::GetNodeCount() const
+{
+  return mNodeCount;
+}
+
+size_t AstArena::GetReservedBytes() const
+{
+  return mReservedBytes;
+}
+
+bool AstArena::IsDestroying()
+{
+  return Destroying;
+}
+
+void* AstArena::Allocate(size_t size, size_t alignment)
+{
+  uintptr_t address = (reinterpret_cast<uintptr_t>(mCursor) + alignment - 1) & ~(uintptr_t)(alignment - 1);
+  char* memory = reinterpret_cast<char*>(address);
+
+  if (mCursor == nullptr || memory + size > mEnd)
+  {
+    // Each block is as large as all of the blocks before it, which doubles the arena
+    // New blocks are aligned for any node type, so they never need padding
+    size_t blockSize = mBlocks.empty() ? FirstBlockSize : mReservedBytes;
+    if (blockSize > MaxBlockSize)
+      blockSize = MaxBlockSize;
+    if (blockSize < size)
+      blockSize = size;
+    char* block = static_cast<char*>(::operator new(blockSize));
+
+    mBlocks.push_back(block);
+    mReservedBytes += blockSize;
+    mEnd = block + blockSize;
+    memory = block;
+  }
+
+  mCursor = memory + size;
+  return memory;
+}
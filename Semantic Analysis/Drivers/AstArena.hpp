@@ -0,0 +1,79 @@
+/******************************************************************\
+ * Copyright 2015, DigiPen Institute of Technology
+\******************************************************************/
+
+#pragma once
+#ifndef COMPILER_CLASS_AST_ARENA
+#define COMPILER_CLASS_AST_ARENA
+
+#include "AstNodes.hpp"
+#include <new>
+
+// Whether the arena has to run a node type's destructor
+// Nodes that only hold tokens, raw pointers and AstPtr children have nothing to clean up once their arena goes away,
+// so only node types that own memory elsewhere (vectors and strings) are destroyed one by one
+template <typename T>
+struct AstNeedsDestructor
+{
+  static const bool value = false;
+};
+
+template <> struct AstNeedsDestructor<BlockNode>    { static const bool value = true; };
+template <> struct AstNeedsDestructor<ClassNode>    { static const bool value = true; };
+template <> struct AstNeedsDestructor<ScopeNode>    { static const bool value = true; };
+template <> struct AstNeedsDestructor<FunctionNode> { static const bool value = true; };
+template <> struct AstNeedsDestructor<CallNode>     { static const bool value = true; };
+template <> struct AstNeedsDestructor<ErrorNode>    { static const bool value = true; };
+
+// Owns every node of one parse
+// Nodes are constructed into large blocks of memory, and are all destroyed and freed together when the arena is
+// Children never delete each other (see AstDeleter), so a tree of any shape is torn down without recursion
+// A tree built in an arena should only hold nodes from that same arena
+class AstArena
+{
+public:
+  AstArena();
+  ~AstArena();
+
+  // Constructs a node in the arena
+  template <typename T>
+  AstPtr<T> Create()
+  {
+    T* node = new (Allocate(sizeof(T), alignof(T))) T();
+    node->mArena = this;
+    ++mNodeCount;
+    if (AstNeedsDestructor<T>::value)
+      mDestroyedNodes.push_back(node);
+    return AstPtr<T>(node);
+  }
+
+  // Once a tree is handed out, deleting its root through an AstPtr deletes the arena
+  void SetRoot(AbstractNode* root);
+  AbstractNode* GetRoot() const;
+
+  size_t GetNodeCount() const;
+  // How much memory the arena has taken from the heap for nodes (used or not)
+  size_t GetReservedBytes() const;
+
+  // True while any arena on this thread is destroying its nodes
+  static bool IsDestroying();
+
+private:
+  AstArena(const AstArena&) = delete;
+  AstArena& operator=(const AstArena&) = delete;
+
+  void* Allocate(size_t size, size_t alignment);
+
+  // Bump allocation within the current block
+  char* mCursor;
+  char* mEnd;
+  std::vector<char*> mBlocks;
+  size_t mReservedBytes;
+
+  size_t mNodeCount;
+  // The nodes whose destructors must be run, in the order they were created
+  std::vector<AbstractNode*> mDestroyedNodes;
+  AbstractNode* mRoot;
+};
+
+#endif
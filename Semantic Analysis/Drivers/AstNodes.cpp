@@ -4,9 +4,53 @@
 \******************************************************************/
 
 #include "AstNodes.hpp"
+#include "AstArena.hpp"
+
+void AstDeleter::operator()(AbstractNode* node) const
+{
+  // While an arena is being destroyed every pointer it reaches is one of its own nodes
+  if (AstArena::IsDestroying())
+    return;
+
+  // Children are taken out of each node before it is deleted, so a deep tree (such as a long
+  // chain of else ifs) is deleted from this worklist rather than by recursing through destructors
+  std::vector<AbstractNode*> pending(1, node);
+  while (!pending.empty())
+  {
+    AbstractNode* current = pending.back();
+    pending.pop_back();
+
+    if (current->mArena == nullptr)
+    {
+      current->ReleaseChildren(pending);
+      delete current;
+    }
+    else if (current->mArena->GetRoot() == current)
+    {
+      delete current->mArena;
+    }
+  }
+}
+
+template <typename T>
+static void Release(AstPtr<T>& child, std::vector<AbstractNode*>& children)
+{
+  if (child)
+    children.push_back(child.release());
+}
+
+template <typename T>
+static void Release(AstVector<T>& list, std::vector<AbstractNode*>& children)
+{
+  for (size_t i = 0; i < list.size(); ++i)
+    Release(list[i], children);
+  list.clear();
+}
 
 AbstractNode::AbstractNode() :
-  mParent(nullptr)
+  mKind(NodeKind::Count),
+  mParent(nullptr),
+  mArena(nullptr)
 {
 }
 
@@ -18,30 +62,129 @@ void AbstractNode::Walk(Visitor* visitor, bool visit)
 {
 }
 
+void AbstractNode::ReleaseChildren(std::vector<AbstractNode*>& children)
+{
+}
+
+void BlockNode::ReleaseChildren(std::vector<AbstractNode*>& children)
+{
+  Release(mGlobals, children);
+}
+
+void ClassNode::ReleaseChildren(std::vector<AbstractNode*>& children)
+{
+  Release(mMembers, children);
+}
+
+void VariableNode::ReleaseChildren(std::vector<AbstractNode*>& children)
+{
+  Release(mType, children);
+  Release(mInitialValue, children);
+}
+
+void ScopeNode::ReleaseChildren(std::vector<AbstractNode*>& children)
+{
+  Release(mStatements, children);
+}
+
+void FunctionNode::ReleaseChildren(std::vector<AbstractNode*>& children)
+{
+  Release(mParameters, children);
+  Release(mReturnType, children);
+  Release(mScope, children);
+}
+
+void ReturnNode::ReleaseChildren(std::vector<AbstractNode*>& children)
+{
+  Release(mReturnValue, children);
+}
+
+void IfNode::ReleaseChildren(std::vector<AbstractNode*>& children)
+{
+  Release(mCondition, children);
+  Release(mScope, children);
+  Release(mElse, children);
+}
+
+void WhileNode::ReleaseChildren(std::vector<AbstractNode*>& children)
+{
+  Release(mCondition, children);
+  Release(mScope, children);
+}
+
+void ForNode::ReleaseChildren(std::vector<AbstractNode*>& children)
+{
+  Release(mInitialVariable, children);
+  Release(mInitialExpression, children);
+  Release(mCondition, children);
+  Release(mIterator, children);
+  Release(mScope, children);
+}
+
+void BinaryOperatorNode::ReleaseChildren(std::vector<AbstractNode*>& children)
+{
+  Release(mLeft, children);
+  Release(mRight, children);
+}
+
+void UnaryOperatorNode::ReleaseChildren(std::vector<AbstractNode*>& children)
+{
+  Release(mRight, children);
+}
+
+void PostExpressionNode::ReleaseChildren(std::vector<AbstractNode*>& children)
+{
+  Release(mLeft, children);
+}
+
+void CallNode::ReleaseChildren(std::vector<AbstractNode*>& children)
+{
+  PostExpressionNode::ReleaseChildren(children);
+  Release(mArguments, children);
+}
+
+void CastNode::ReleaseChildren(std::vector<AbstractNode*>& children)
+{
+  PostExpressionNode::ReleaseChildren(children);
+  Release(mType, children);
+}
+
+void IndexNode::ReleaseChildren(std::vector<AbstractNode*>& children)
+{
+  PostExpressionNode::ReleaseChildren(children);
+  Release(mIndex, children);
+}
+
 ClassNode::ClassNode() :
   mSymbol(nullptr)
 {
+  mKind = NodeKind::Class;
 }
 
 TypeNode::TypeNode() :
+  mPointerCount(0),
   mSymbol(nullptr)
 {
+  mKind = NodeKind::Type;
 }
 
 VariableNode::VariableNode() :
   mSymbol(nullptr)
 {
+  mKind = NodeKind::Variable;
 }
 
 FunctionNode::FunctionNode() :
   mSymbol(nullptr),
   mSignatureType(nullptr)
 {
+  mKind = NodeKind::Function;
 }
 
 GotoNode::GotoNode() :
   mResolvedLabel(nullptr)
 {
+  mKind = NodeKind::Goto;
 }
 
 ExpressionNode::ExpressionNode() :
@@ -52,4 +195,92 @@ ExpressionNode::ExpressionNode() :
 MemberAccessNode::MemberAccessNode() :
   mResolvedMember(nullptr)
 {
-}
\ No newline at end of file
+  mKind = NodeKind::MemberAccess;
+}
+
+BlockNode::BlockNode()
+{
+  mKind = NodeKind::Block;
+}
+
+ParameterNode::ParameterNode()
+{
+  mKind = NodeKind::Parameter;
+}
+
+ScopeNode::ScopeNode()
+{
+  mKind = NodeKind::Scope;
+}
+
+LabelNode::LabelNode() :
+  mSymbol(nullptr)
+{
+  mKind = NodeKind::Label;
+}
+
+ReturnNode::ReturnNode()
+{
+  mKind = NodeKind::Return;
+}
+
+BreakNode::BreakNode()
+{
+  mKind = NodeKind::Break;
+}
+
+ContinueNode::ContinueNode()
+{
+  mKind = NodeKind::Continue;
+}
+
+ErrorNode::ErrorNode()
+{
+  mKind = NodeKind::Error;
+}
+
+IfNode::IfNode()
+{
+  mKind = NodeKind::If;
+}
+
+WhileNode::WhileNode()
+{
+  mKind = NodeKind::While;
+}
+
+ForNode::ForNode()
+{
+  mKind = NodeKind::For;
+}
+
+ValueNode::ValueNode() :
+  mResolvedSymbol(nullptr)
+{
+  mKind = NodeKind::Value;
+}
+
+BinaryOperatorNode::BinaryOperatorNode()
+{
+  mKind = NodeKind::BinaryOperator;
+}
+
+UnaryOperatorNode::UnaryOperatorNode()
+{
+  mKind = NodeKind::UnaryOperator;
+}
+
+CallNode::CallNode()
+{
+  mKind = NodeKind::Call;
+}
+
+CastNode::CastNode()
+{
+  mKind = NodeKind::Cast;
+}
+
+IndexNode::IndexNode()
+{
+  mKind = NodeKind::Index;
+}
@@ -42,6 +42,7 @@ class MemberAccessNode;
 class CallNode;
 class CastNode;
 class IndexNode;
+class ErrorNode;
 
 // Forward declarations for the symbols
 class Symbol;
@@ -51,6 +52,55 @@ class Function;
 class Label;
 class Library;
 
+class AstArena;
+
+// Every kind of node that the parser creates
+namespace NodeKind
+{
+  enum Enum
+  {
+    Block,
+    Class,
+    Variable,
+    Parameter,
+    Scope,
+    Function,
+    Type,
+    Label,
+    Goto,
+    Return,
+    Break,
+    Continue,
+    Error,
+    If,
+    While,
+    For,
+    Value,
+    BinaryOperator,
+    UnaryOperator,
+    MemberAccess,
+    Call,
+    Cast,
+    Index,
+    // Also used by the abstract node types, which are never created on their own
+    Count
+  };
+}
+
+// Deletes a node that was allocated on its own
+// Nodes created by an AstArena are left alone, except for the root of the tree which deletes the whole arena
+class AstDeleter
+{
+public:
+  void operator()(AbstractNode* node) const;
+};
+
+// How nodes own their children
+template <typename T>
+using AstPtr = std::unique_ptr<T, AstDeleter>;
+template <typename T>
+using AstVector = unique_vector<T, AstDeleter>;
+
 // All of our node types inherit from this node and implement the Walk function
 class AbstractNode
 {
@@ -60,17 +110,28 @@ public:
   
   virtual void Walk(Visitor* visitor, bool visit = true);
 
+  // Moves ownership of every child out of this node and into 'children' (used to delete trees without recursion)
+  virtual void ReleaseChildren(std::vector<AbstractNode*>& children);
+
+  // Which node type this is, so that code can switch on it instead of making virtual calls
+  NodeKind::Enum mKind;
+
   //* Semantic Analysis *//
   AbstractNode* mParent;
+
+  // The arena that created this node (null if it was allocated on its own)
+  AstArena* mArena;
 };
 
 class BlockNode : public AbstractNode
 {
 public:
+  BlockNode();
   // ClassNode / VariableNode / FunctionNode
-  unique_vector<AbstractNode> mGlobals;
+  AstVector<AbstractNode> mGlobals;
 
   void Walk(Visitor* visitor, bool visit = true) override;
+  void ReleaseChildren(std::vector<AbstractNode*>& children) override;
 };
 
 class ClassNode : public AbstractNode
@@ -80,9 +141,10 @@ public:
   Token mName;
   
   // VariableNode / FunctionNode
-  unique_vector<AbstractNode> mMembers;
+  AstVector<AbstractNode> mMembers;
   
   void Walk(Visitor* visitor, bool visit = true) override;
+  void ReleaseChildren(std::vector<AbstractNode*>& children) override;
 
   //* Semantic Analysis *//
   // The class node should create the following symbol
@@ -117,12 +179,13 @@ class VariableNode : public StatementNode
 public:
   VariableNode();
   Token mName;
-  std::unique_ptr<TypeNode> mType;
+  AstPtr<TypeNode> mType;
 
   // Can be null
-  std::unique_ptr<ExpressionNode> mInitialValue;
+  AstPtr<ExpressionNode> mInitialValue;
 
   void Walk(Visitor* visitor, bool visit = true) override;
+  void ReleaseChildren(std::vector<AbstractNode*>& children) override;
 
   //* Semantic Analysis *//
   // The variable node should create the following symbol
@@ -132,15 +195,18 @@ public:
 class ParameterNode : public VariableNode
 {
 public:
+  ParameterNode();
   void Walk(Visitor* visitor, bool visit = true) override;
 };
 
 class ScopeNode : public StatementNode
 {
 public:
-  unique_vector<StatementNode> mStatements;
+  ScopeNode();
+  AstVector<StatementNode> mStatements;
   
   void Walk(Visitor* visitor, bool visit = true) override;
+  void ReleaseChildren(std::vector<AbstractNode*>& children) override;
 };
 
 class FunctionNode : public AbstractNode
@@ -148,14 +214,15 @@ class FunctionNode : public AbstractNode
 public:
   FunctionNode();
   Token mName;
-  unique_vector<ParameterNode> mParameters;
+  AstVector<ParameterNode> mParameters;
 
   // Can be null
-  std::unique_ptr<TypeNode> mReturnType;
+  AstPtr<TypeNode> mReturnType;
 
-  std::unique_ptr<ScopeNode> mScope;
+  AstPtr<ScopeNode> mScope;
 
   void Walk(Visitor* visitor, bool visit = true) override;
+  void ReleaseChildren(std::vector<AbstractNode*>& children) override;
 
   //* Semantic Analysis *//
   // The signature type is filled out first and is used later when we create the Function symbol
@@ -167,6 +234,7 @@ public:
 class LabelNode : public StatementNode
 {
 public:
+  LabelNode();
   Token mName;
 
   void Walk(Visitor* visitor, bool visit = true) override;
@@ -192,21 +260,36 @@ public:
 class ReturnNode : public StatementNode
 {
 public:
+  ReturnNode();
   // Can be null
-  std::unique_ptr<ExpressionNode> mReturnValue;
+  AstPtr<ExpressionNode> mReturnValue;
 
   void Walk(Visitor* visitor, bool visit = true) override;
+  void ReleaseChildren(std::vector<AbstractNode*>& children) override;
 };
 
 class BreakNode : public StatementNode
 {
 public:
+  BreakNode();
   void Walk(Visitor* visitor, bool visit = true) override;
 };
 
 class ContinueNode : public StatementNode
 {
 public:
+  ContinueNode();
+  void Walk(Visitor* visitor, bool visit = true) override;
+};
+
+// Stands in for a global, member or statement that was skipped while recovering from a syntax error
+class ErrorNode : public StatementNode
+{
+public:
+  ErrorNode();
+  // The error that caused the tokens to be skipped
+  std::string mMessage;
+
   void Walk(Visitor* visitor, bool visit = true) override;
 };
 
@@ -224,79 +307,95 @@ public:
 class IfNode : public StatementNode
 {
 public:
+  IfNode();
 
   // Can be null
-  std::unique_ptr<ExpressionNode> mCondition;
+  AstPtr<ExpressionNode> mCondition;
 
-  std::unique_ptr<ScopeNode> mScope;
+  AstPtr<ScopeNode> mScope;
 
   // Can be null
-  std::unique_ptr<IfNode> mElse;
+  AstPtr<IfNode> mElse;
 
   void Walk(Visitor* visitor, bool visit = true) override;
+  void ReleaseChildren(std::vector<AbstractNode*>& children) override;
 };
 
 class WhileNode : public StatementNode
 {
 public:
-  std::unique_ptr<ExpressionNode> mCondition;
-  std::unique_ptr<ScopeNode> mScope;
+  WhileNode();
+  AstPtr<ExpressionNode> mCondition;
+  AstPtr<ScopeNode> mScope;
 
   void Walk(Visitor* visitor, bool visit = true) override;
+  void ReleaseChildren(std::vector<AbstractNode*>& children) override;
 };
 
 class ForNode : public StatementNode
 {
 public:
+  ForNode();
   // Can be null
-  std::unique_ptr<VariableNode> mInitialVariable;
+  AstPtr<VariableNode> mInitialVariable;
   // Can be null
-  std::unique_ptr<ExpressionNode> mInitialExpression;
+  AstPtr<ExpressionNode> mInitialExpression;
 
   // Can be null
-  std::unique_ptr<ExpressionNode> mCondition;
+  AstPtr<ExpressionNode> mCondition;
   // Can be null
-  std::unique_ptr<ExpressionNode> mIterator;
+  AstPtr<ExpressionNode> mIterator;
 
-  std::unique_ptr<ScopeNode> mScope;
+  AstPtr<ScopeNode> mScope;
 
   void Walk(Visitor* visitor, bool visit = true) override;
+  void ReleaseChildren(std::vector<AbstractNode*>& children) override;
 };
 
 class ValueNode : public ExpressionNode
 {
 public:
+  ValueNode();
   // Includes name references
   Token mToken;
 
   void Walk(Visitor* visitor, bool visit = true) override;
+
+  //* Semantic Analysis *//
+  // The variable or function that a name resolved to (null for literals)
+  Symbol* mResolvedSymbol;
 };
 
 class BinaryOperatorNode : public ExpressionNode
 {
 public:
+  BinaryOperatorNode();
   Token mOperator;
-  std::unique_ptr<ExpressionNode> mLeft;
-  std::unique_ptr<ExpressionNode> mRight;
+  AstPtr<ExpressionNode> mLeft;
+  AstPtr<ExpressionNode> mRight;
 
   void Walk(Visitor* visitor, bool visit = true) override;
+  void ReleaseChildren(std::vector<AbstractNode*>& children) override;
 };
 
 class UnaryOperatorNode : public ExpressionNode
 {
 public:
+  UnaryOperatorNode();
   Token mOperator;
-  std::unique_ptr<ExpressionNode> mRight;
+  AstPtr<ExpressionNode> mRight;
 
   void Walk(Visitor* visitor, bool visit = true) override;
+  void ReleaseChildren(std::vector<AbstractNode*>& children) override;
 };
 
 class PostExpressionNode : public ExpressionNode
 {
 public:
-  std::unique_ptr<ExpressionNode> mLeft;
+  AstPtr<ExpressionNode> mLeft;
 
   void Walk(Visitor* visitor, bool visit = true) override;
+  void ReleaseChildren(std::vector<AbstractNode*>& children) override;
 };
 
 class MemberAccessNode : public PostExpressionNode
@@ -316,25 +415,31 @@ public:
 class CallNode : public PostExpressionNode
 {
 public:
-  unique_vector<ExpressionNode> mArguments;
+  CallNode();
+  AstVector<ExpressionNode> mArguments;
 
   void Walk(Visitor* visitor, bool visit = true) override;
+  void ReleaseChildren(std::vector<AbstractNode*>& children) override;
 };
 
 class CastNode : public PostExpressionNode
 {
 public:
-  std::unique_ptr<TypeNode> mType;
+  CastNode();
+  AstPtr<TypeNode> mType;
 
   void Walk(Visitor* visitor, bool visit = true) override;
+  void ReleaseChildren(std::vector<AbstractNode*>& children) override;
 };
 
 class IndexNode : public PostExpressionNode
 {
 public:
-  std::unique_ptr<ExpressionNode> mIndex;
+  IndexNode();
+  AstPtr<ExpressionNode> mIndex;
 
   void Walk(Visitor* visitor, bool visit = true) override;
+  void ReleaseChildren(std::vector<AbstractNode*>& children) override;
 };
 
 #endif
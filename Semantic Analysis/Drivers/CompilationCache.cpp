@@ -0,0 +1,376 @@
+/******************************************************************\
+ * Copyright 2015, DigiPen Institute of Technology
+\******************************************************************/
+
+#include "CompilationCache.hpp"
+#include "Driver4.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <sys/types.h>
+#include <sys/utime.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#include <utime.h>
+#endif
+
+const char* const CompilerVersion = "Semantic Analysis 1";
+
+namespace
+{
+  // 'SCCH'
+  const uint32_t EntryMagic = 0x48434353;
+  const uint32_t EntryVersion = 1;
+  const char* const EntryExtension = ".slc";
+
+  // 64 bit FNV-1a
+  const uint64_t HashSeed = 14695981039346656037ULL;
+
+  uint64_t Hash(uint64_t hash, const void* data, size_t size)
+  {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i)
+    {
+      hash ^= bytes[i];
+      hash *= 1099511628211ULL;
+    }
+    return hash;
+  }
+
+  uint64_t Hash(uint64_t hash, const std::string& text)
+  {
+    // The length goes in too, so that neighbouring strings can't trade characters
+    uint64_t length = text.size();
+    hash = Hash(hash, &length, sizeof(length));
+    return Hash(hash, text.data(), text.size());
+  }
+
+  uint32_t Align(size_t offset)
+  {
+    return (uint32_t)((offset + 3) & ~(size_t)3);
+  }
+
+  // An entry found in the cache's directory when it was opened
+  class FoundFile
+  {
+  public:
+    uint64_t mKey;
+    size_t mSize;
+    uint64_t mLastUsed;
+  };
+
+  // Every file in the directory named as an entry
+  void FindEntries(const std::string& directory, std::vector<FoundFile>& found)
+  {
+#ifdef _WIN32
+    WIN32_FIND_DATAA data;
+    HANDLE find = FindFirstFileA((directory + "/*" + EntryExtension).c_str(), &data);
+    if (find == INVALID_HANDLE_VALUE)
+      return;
+
+    do
+    {
+      FoundFile file;
+      file.mKey = strtoull(data.cFileName, nullptr, 16);
+      file.mSize = (size_t)(((uint64_t)data.nFileSizeHigh << 32) | data.nFileSizeLow);
+      file.mLastUsed = ((uint64_t)data.ftLastWriteTime.dwHighDateTime << 32) | data.ftLastWriteTime.dwLowDateTime;
+      found.push_back(file);
+    } while (FindNextFileA(find, &data));
+
+    FindClose(find);
+#else
+    DIR* dir = opendir(directory.c_str());
+    if (dir == nullptr)
+      return;
+
+    size_t extensionLength = strlen(EntryExtension);
+    while (dirent* entry = readdir(dir))
+    {
+      size_t length = strlen(entry->d_name);
+      if (length <= extensionLength || strcmp(entry->d_name + length - extensionLength, EntryExtension) != 0)
+        continue;
+
+      struct stat info;
+      if (stat((directory + "/" + entry->d_name).c_str(), &info) != 0)
+        continue;
+
+      FoundFile file;
+      file.mKey = strtoull(entry->d_name, nullptr, 16);
+      file.mSize = (size_t)info.st_size;
+      file.mLastUsed = (uint64_t)info.st_mtime;
+      found.push_back(file);
+    }
+
+    closedir(dir);
+#endif
+  }
+
+  void MakeDirectory(const std::string& directory)
+  {
+#ifdef _WIN32
+    CreateDirectoryA(directory.c_str(), nullptr);
+#else
+    mkdir(directory.c_str(), 0755);
+#endif
+  }
+
+  // Sets the file's modified time to now, which is what orders the entries between runs
+  void TouchFile(const std::string& path)
+  {
+#ifdef _WIN32
+    _utime(path.c_str(), nullptr);
+#else
+    utime(path.c_str(), nullptr);
+#endif
+  }
+
+  // The tokens of a source, without whitespace and comments (the same as RunSemanticTest, but without printing them)
+  void Lex(const std::string& source, std::vector<Token>& tokens)
+  {
+    DfaState* root = CreateLanguageDfa();
+    const char* stream = source.c_str();
+    while (*stream != '\0')
+    {
+      Token token;
+      ReadLanguageToken(root, stream, token);
+      if (token.mLength == 0)
+      {
+        ++stream;
+        continue;
+      }
+
+      tokens.push_back(token);
+      stream += token.mLength;
+    }
+
+    DeleteStateAndChildren(root);
+    RemoveWhitespaceAndComments(tokens);
+  }
+}
+
+uint64_t HashLibrary(Library* library)
+{
+  uint64_t hash = HashSeed;
+  for (size_t i = 0; i < library->mAllSymbols.size(); ++i)
+  {
+    Symbol* symbol = library->mAllSymbols[i].get();
+    hash = Hash(hash, symbol->Dump());
+    hash = Hash(hash, symbol->mParentType ? symbol->mParentType->mName : std::string());
+    hash = Hash(hash, symbol->mParentFunction ? symbol->mParentFunction->mName : std::string());
+  }
+  return hash;
+}
+
+CompilationCache::CompilationCache(const std::string& directory, size_t maxBytes) :
+  mDirectory(directory),
+  mMaxBytes(maxBytes),
+  mTotalBytes(0)
+{
+  MakeDirectory(directory);
+
+  std::vector<FoundFile> found;
+  FindEntries(directory, found);
+  std::sort(found.begin(), found.end(), [](const FoundFile& a, const FoundFile& b) { return a.mLastUsed < b.mLastUsed; });
+
+  for (size_t i = 0; i < found.size(); ++i)
+  {
+    CacheFile file;
+    file.mKey = found[i].mKey;
+    file.mSize = found[i].mSize;
+    mFilesByKey[file.mKey] = mFiles.insert(mFiles.end(), file);
+    mTotalBytes += file.mSize;
+  }
+}
+
+uint64_t CompilationCache::MakeKey(const std::string& source, const std::vector<Library*>& dependencies)
+{
+  uint64_t hash = Hash(HashSeed, source);
+  hash = Hash(hash, CompilerVersion);
+  hash = Hash(hash, &LibraryImage::Version, sizeof(LibraryImage::Version));
+  for (size_t i = 0; i < dependencies.size(); ++i)
+  {
+    uint64_t dependency = HashLibrary(dependencies[i]);
+    hash = Hash(hash, &dependency, sizeof(dependency));
+  }
+  return hash;
+}
+
+bool CompilationCache::Load(uint64_t key, const std::string& source, const std::vector<Library*>& dependencies, Library* library, bool& analyzed, std::string& diagnostic)
+{
+  if (mFilesByKey.find(key) == mFilesByKey.end())
+    return false;
+
+  std::ifstream file(GetPath(key).c_str(), std::ios::binary | std::ios::ate);
+  if (!file)
+  {
+    Remove(key);
+    return false;
+  }
+
+  std::vector<char> entry((size_t)file.tellg());
+  file.seekg(0);
+  file.read(entry.data(), entry.size());
+
+  CacheEntryHeader header;
+  bool valid = file.good() && entry.size() >= sizeof(header);
+  if (valid)
+  {
+    memcpy(&header, entry.data(), sizeof(header));
+    size_t imageOffset = Align(sizeof(header) + (size_t)header.mSourceSize + header.mDiagnosticSize);
+    valid = header.mMagic == EntryMagic && header.mVersion == EntryVersion &&
+      imageOffset + header.mImageSize == entry.size() &&
+      header.mChecksum == Hash(HashSeed, entry.data() + sizeof(header), entry.size() - sizeof(header)) &&
+      header.mSourceSize == source.size() &&
+      memcmp(entry.data() + sizeof(header), source.data(), source.size()) == 0;
+
+    if (valid && header.mAnalyzed)
+      valid = ReadLibraryImage(entry.data() + imageOffset, header.mImageSize, dependencies, library);
+  }
+
+  // A damaged entry (or one for another source with the same hash) is thrown away, and analysis runs as if it was never there
+  // (the key covers the dependencies, so once the checksum matches the image only fails to read if they were changed since)
+  if (!valid)
+  {
+    Remove(key);
+    return false;
+  }
+
+  analyzed = header.mAnalyzed != 0;
+  diagnostic.assign(entry.data() + sizeof(header) + header.mSourceSize, header.mDiagnosticSize);
+  Touch(key);
+  return true;
+}
+
+void CompilationCache::Store(uint64_t key, const std::string& source, const std::vector<Library*>& dependencies, Library* library, const std::string& diagnostic)
+{
+  std::vector<char> image;
+  if (library && !WriteLibraryImage(library, dependencies, image))
+    return;
+
+  CacheEntryHeader header;
+  header.mMagic = EntryMagic;
+  header.mVersion = EntryVersion;
+  header.mAnalyzed = library != nullptr;
+  header.mSourceSize = (uint32_t)source.size();
+  header.mDiagnosticSize = (uint32_t)diagnostic.size();
+  header.mImageSize = (uint32_t)image.size();
+
+  std::vector<char> entry(Align(sizeof(header) + source.size() + diagnostic.size()) + image.size());
+  memcpy(entry.data() + sizeof(header), source.data(), source.size());
+  memcpy(entry.data() + sizeof(header) + source.size(), diagnostic.data(), diagnostic.size());
+  if (!image.empty())
+    memcpy(entry.data() + entry.size() - image.size(), image.data(), image.size());
+
+  header.mChecksum = Hash(HashSeed, entry.data() + sizeof(header), entry.size() - sizeof(header));
+  memcpy(entry.data(), &header, sizeof(header));
+
+  // Written beside the entry and then moved over it, so a reader never sees half an entry
+  std::string path = GetPath(key);
+  std::string temporary = path + ".tmp";
+  {
+    std::ofstream file(temporary.c_str(), std::ios::binary | std::ios::trunc);
+    file.write(entry.data(), entry.size());
+    if (!file.good())
+    {
+      file.close();
+      remove(temporary.c_str());
+      return;
+    }
+  }
+
+  if (mFilesByKey.find(key) != mFilesByKey.end())
+    Remove(key);
+  if (rename(temporary.c_str(), path.c_str()) != 0)
+  {
+    remove(temporary.c_str());
+    return;
+  }
+
+  CacheFile file;
+  file.mKey = key;
+  file.mSize = entry.size();
+  mFilesByKey[key] = mFiles.insert(mFiles.end(), file);
+  mTotalBytes += file.mSize;
+
+  // The entry just stored is kept even when it is bigger than the whole cache
+  while (mTotalBytes > mMaxBytes && mFiles.front().mKey != key)
+    Remove(mFiles.front().mKey);
+}
+
+size_t CompilationCache::GetSize() const
+{
+  return mTotalBytes;
+}
+
+std::string CompilationCache::GetPath(uint64_t key) const
+{
+  char name[32];
+  snprintf(name, sizeof(name), "/%016llx", (unsigned long long)key);
+  return mDirectory + name + EntryExtension;
+}
+
+void CompilationCache::Touch(uint64_t key)
+{
+  std::list<CacheFile>::iterator file = mFilesByKey[key];
+  mFiles.splice(mFiles.end(), mFiles, file);
+  TouchFile(GetPath(key));
+}
+
+void CompilationCache::Remove(uint64_t key)
+{
+  std::unordered_map<uint64_t, std::list<CacheFile>::iterator>::iterator it = mFilesByKey.find(key);
+  if (it == mFilesByKey.end())
+    return;
+
+  mTotalBytes -= it->second->mSize;
+  mFiles.erase(it->second);
+  mFilesByKey.erase(it);
+  remove(GetPath(key).c_str());
+}
+
+bool CompileCached(CompilationCache& cache, const std::string& source, std::vector<Library*>& dependencies, Library* library, std::string& diagnostic)
+{
+  uint64_t key = cache.MakeKey(source, dependencies);
+  bool analyzed = false;
+  if (cache.Load(key, source, dependencies, library, analyzed, diagnostic))
+    return analyzed;
+
+  diagnostic.clear();
+  std::vector<Token> tokens;
+  Lex(source, tokens);
+
+  // The trace is only for the driver tests, so it's turned off for the parse and then put back
+  bool tracing = IsParseTracing();
+  SetParseTracing(false);
+  std::string error;
+  AstPtr<BlockNode> block = TryParseBlock(tokens, &error);
+  SetParseTracing(tracing);
+  if (block == nullptr)
+  {
+    diagnostic = error.empty() ? "Parsing Failed" : "Parsing Failed: " + error;
+    cache.Store(key, source, dependencies, nullptr, diagnostic);
+    return false;
+  }
+
+  try
+  {
+    SemanticAnalyize(block.get(), dependencies, library);
+  }
+  catch (SemanticException& e)
+  {
+    diagnostic = e.what();
+    cache.Store(key, source, dependencies, nullptr, diagnostic);
+    return false;
+  }
+
+  cache.Store(key, source, dependencies, library, diagnostic);
+  return true;
+}
@@ -0,0 +1,97 @@
+/******************************************************************\
+ * Copyright 2015, DigiPen Institute of Technology
+\******************************************************************/
+
+#pragma once
+#ifndef COMPILER_CLASS_COMPILATION_CACHE
+#define COMPILER_CLASS_COMPILATION_CACHE
+
+#include "LibraryFile.hpp"
+#include <list>
+
+// A cache on disk of analyzed sources, so that a source that was analyzed before is not lexed, parsed or analyzed again
+// An entry is keyed by a hash of the source, CompilerVersion and every dependency (see HashLibrary), and holds the
+// library as an image (see WriteLibraryImage) along with the diagnostic that analysis ended with
+// Each entry is one file in the cache's directory, and once the files grow past the size limit the least recently
+// used ones are deleted (a hit marks its file as used, so the order carries over between runs)
+//
+// Entry layout (the image starts on a 4 byte boundary):
+//   CacheEntryHeader
+//   The source, so that a hash collision is caught instead of returning another source's library
+//   The diagnostic
+//   The library image (missing when analysis failed)
+
+// Changes whenever analysis could give a different library or diagnostic for the same source
+extern const char* const CompilerVersion;
+
+class CacheEntryHeader
+{
+public:
+  uint32_t mMagic;
+  uint32_t mVersion;
+  // Whether analysis succeeded (only then is there an image)
+  uint32_t mAnalyzed;
+  uint32_t mSourceSize;
+  uint32_t mDiagnosticSize;
+  uint32_t mImageSize;
+  // A hash of everything after the header, so a damaged entry is found before any of it is read into a library
+  uint64_t mChecksum;
+};
+
+// A hash of every symbol of a library (names, types and parents) for keying the sources that depend on it
+uint64_t HashLibrary(Library* library);
+
+class CompilationCache
+{
+public:
+  // Creates the directory if it doesn't exist, and picks up the entries already in it
+  CompilationCache(const std::string& directory, size_t maxBytes);
+
+  // The key of a source analyzed against the given dependencies
+  uint64_t MakeKey(const std::string& source, const std::vector<Library*>& dependencies);
+
+  // Returns true on a hit, filling in the empty library (only when analysis had succeeded), whether it had, and the diagnostic
+  // On a miss the library is still empty, so it can be analyzed into
+  bool Load(uint64_t key, const std::string& source, const std::vector<Library*>& dependencies, Library* library, bool& analyzed, std::string& diagnostic);
+
+  // Saves what analysis ended with (the library is null when it failed), then deletes entries until the cache fits
+  void Store(uint64_t key, const std::string& source, const std::vector<Library*>& dependencies, Library* library, const std::string& diagnostic);
+
+  // The bytes all the entries take up
+  size_t GetSize() const;
+
+private:
+  CompilationCache(const CompilationCache&) = delete;
+  CompilationCache& operator=(const CompilationCache&) = delete;
+
+  class CacheFile
+  {
+  public:
+    uint64_t mKey;
+    size_t mSize;
+  };
+
+  std::string GetPath(uint64_t key) const;
+
+  // Moves an entry to the most recently used end, on disk as well
+  void Touch(uint64_t key);
+
+  // Forgets an entry and deletes its file
+  void Remove(uint64_t key);
+
+  std::string mDirectory;
+  size_t mMaxBytes;
+  size_t mTotalBytes;
+
+  // The least recently used entry comes first
+  std::list<CacheFile> mFiles;
+  std::unordered_map<uint64_t, std::list<CacheFile>::iterator> mFilesByKey;
+};
+
+// Analyzes a source against the dependencies the way RunSemanticTest does, unless the cache already has it,
+// in which case the library is read from the cache and nothing is lexed, parsed or analyzed
+// Returns whether analysis succeeded; when it didn't, the diagnostic holds the parsing or semantic error
+// and the library should not be used
+bool CompileCached(CompilationCache& cache, const std::string& source, std::vector<Library*>& dependencies, Library* library, std::string& diagnostic);
+
+#endif
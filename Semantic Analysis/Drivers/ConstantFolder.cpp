@@ -0,0 +1,551 @@
+/******************************************************************\
+ * Copyright 2015, DigiPen Institute of Technology
+\******************************************************************/
+
+#include "ConstantFolder.hpp"
+#include "AstArena.hpp"
+#include "StaticVisitor.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unordered_set>
+
+namespace
+{
+  // The same conversions the Interpreter makes between primitives
+  double ToDouble(const RuntimeValue& value)
+  {
+    if (value.mType == FloatType)
+      return value.mFloat;
+    if (value.mType == IntegerType)
+      return value.mInteger;
+    if (value.mType == ByteType)
+      return value.mByte;
+    return value.mBoolean ? 1.0 : 0.0;
+  }
+
+  int64_t ToInteger(const RuntimeValue& value)
+  {
+    if (value.mType == IntegerType)
+      return value.mInteger;
+    if (value.mType == ByteType)
+      return value.mByte;
+    return value.mBoolean ? 1 : 0;
+  }
+
+  bool IsExpression(AbstractNode* node)
+  {
+    return node->mKind >= NodeKind::Value && node->mKind <= NodeKind::Index;
+  }
+
+  // The nodes of a subtree that is about to be folded (which only holds literals, operators and casts)
+  size_t CountNodes(ExpressionNode* node)
+  {
+    switch (node->mKind)
+    {
+      case NodeKind::BinaryOperator:
+      {
+        BinaryOperatorNode* binary = static_cast<BinaryOperatorNode*>(node);
+        return 1 + CountNodes(binary->mLeft.get()) + CountNodes(binary->mRight.get());
+      }
+
+      case NodeKind::UnaryOperator:
+        return 1 + CountNodes(static_cast<UnaryOperatorNode*>(node)->mRight.get());
+
+      // The cast and its TypeNode
+      case NodeKind::Cast:
+        return 2 + CountNodes(static_cast<CastNode*>(node)->mLeft.get());
+
+      default:
+        return 1;
+    }
+  }
+
+  // The locals that may change after they're declared, and the functions that have labels
+  class WrittenLocalFinder : public StaticVisitor<WrittenLocalFinder>
+  {
+  public:
+    using StaticVisitor<WrittenLocalFinder>::Visit;
+
+    WrittenLocalFinder() :
+      mFunction(nullptr)
+    {
+    }
+
+    // Functions don't nest, so the last one visited is the one a label is in
+    VisitResult Visit(FunctionNode* node)
+    {
+      mFunction = node->mSymbol;
+      return Continue;
+    }
+
+    VisitResult Visit(LabelNode* node)
+    {
+      mLabeledFunctions.insert(mFunction);
+      return Continue;
+    }
+
+    VisitResult Visit(BinaryOperatorNode* node)
+    {
+      // The parser hangs the left hand side off of mRight
+      if (node->mOperator.mEnumTokenType == TokenType::Assignment)
+        Mark(node->mRight.get());
+      return Continue;
+    }
+
+    VisitResult Visit(UnaryOperatorNode* node)
+    {
+      TokenType::Enum op = node->mOperator.mEnumTokenType;
+      if (op == TokenType::Increment || op == TokenType::Decrement || op == TokenType::BitwiseAndAddressOf)
+        Mark(node->mRight.get());
+      return Continue;
+    }
+
+    std::unordered_set<Symbol*> mLocals;
+    std::unordered_set<Function*> mLabeledFunctions;
+
+  private:
+    void Mark(ExpressionNode* node)
+    {
+      if (node->mKind != NodeKind::Value)
+        return;
+
+      Symbol* symbol = static_cast<ValueNode*>(node)->mResolvedSymbol;
+      if (symbol != nullptr && symbol->mParentFunction != nullptr)
+        mLocals.insert(symbol);
+    }
+
+    Function* mFunction;
+  };
+
+  class ConstantFolder : public StaticVisitor<ConstantFolder>
+  {
+  public:
+    using StaticVisitor<ConstantFolder>::Visit;
+
+    ConstantFolder(const WrittenLocalFinder& written) :
+      mRemovedNodes(0),
+      mWritten(written)
+    {
+    }
+
+    // Statements are folded in order, so that a local's constant is known before the statements that use it
+    VisitResult Visit(ScopeNode* node)
+    {
+      for (size_t i = 0; i < node->mStatements.size(); ++i)
+      {
+        if (IsExpression(node->mStatements[i].get()))
+          Fold(node->mStatements[i]);
+        else
+          Walk(node->mStatements[i]);
+      }
+      return Stop;
+    }
+
+    // A parameter is visited again as a VariableNode
+    VisitResult Visit(ParameterNode* node)
+    {
+      return Continue;
+    }
+
+    VisitResult Visit(VariableNode* node)
+    {
+      Fold(node->mInitialValue);
+
+      Variable* variable = node->mSymbol;
+      RuntimeValue value;
+      if (variable != nullptr && variable->mParentFunction != nullptr && !variable->mIsParameter &&
+          IsPrimitive(variable->mType) && mWritten.mLocals.count(variable) == 0 &&
+          mWritten.mLabeledFunctions.count(variable->mParentFunction) == 0 &&
+          GetLiteral(node->mInitialValue.get(), value))
+      {
+        // Analysis gives an initial value the declared type, but the literal has the type it was written with
+        mConstants[variable] = ConvertValue(value, variable->mType);
+      }
+      return Stop;
+    }
+
+    VisitResult Visit(IfNode* node)
+    {
+      Fold(node->mCondition);
+      Walk(node->mScope);
+      Walk(node->mElse);
+      return Stop;
+    }
+
+    VisitResult Visit(WhileNode* node)
+    {
+      Fold(node->mCondition);
+      Walk(node->mScope);
+      return Stop;
+    }
+
+    VisitResult Visit(ForNode* node)
+    {
+      Walk(node->mInitialVariable);
+      Fold(node->mInitialExpression);
+      Fold(node->mCondition);
+      Fold(node->mIterator);
+      Walk(node->mScope);
+      return Stop;
+    }
+
+    VisitResult Visit(ReturnNode* node)
+    {
+      Fold(node->mReturnValue);
+      return Stop;
+    }
+
+    size_t mRemovedNodes;
+
+  private:
+    // Folds the expression in a slot from the bottom up, and replaces it with a literal if it comes to one
+    template <typename T>
+    void Fold(AstPtr<T>& slot)
+    {
+      if (!slot)
+        return;
+
+      ExpressionNode* node = static_cast<ExpressionNode*>(slot.get());
+      RuntimeValue value;
+      if (node->mKind == NodeKind::Value)
+      {
+        Symbol* symbol = static_cast<ValueNode*>(node)->mResolvedSymbol;
+        std::unordered_map<Symbol*, RuntimeValue>::iterator it = mConstants.find(symbol);
+        if (it == mConstants.end())
+          return;
+        value = it->second;
+      }
+      else
+      {
+        FoldChildren(node);
+        if (!Evaluate(node, value))
+          return;
+      }
+
+      AstPtr<ValueNode> literal = MakeLiteral(value, node);
+      if (!literal)
+        return;
+
+      mRemovedNodes += CountNodes(node) - 1;
+      slot = std::move(literal);
+    }
+
+    void FoldChildren(ExpressionNode* node)
+    {
+      switch (node->mKind)
+      {
+        case NodeKind::BinaryOperator:
+        {
+          BinaryOperatorNode* binary = static_cast<BinaryOperatorNode*>(node);
+          Fold(binary->mRight);
+          Fold(binary->mLeft);
+          break;
+        }
+
+        case NodeKind::UnaryOperator:
+          Fold(static_cast<UnaryOperatorNode*>(node)->mRight);
+          break;
+
+        case NodeKind::MemberAccess:
+        case NodeKind::Cast:
+          Fold(static_cast<PostExpressionNode*>(node)->mLeft);
+          break;
+
+        case NodeKind::Call:
+        {
+          CallNode* call = static_cast<CallNode*>(node);
+          Fold(call->mLeft);
+          for (size_t i = 0; i < call->mArguments.size(); ++i)
+            Fold(call->mArguments[i]);
+          break;
+        }
+
+        case NodeKind::Index:
+        {
+          IndexNode* index = static_cast<IndexNode*>(node);
+          Fold(index->mLeft);
+          Fold(index->mIndex);
+          break;
+        }
+
+        default:
+          break;
+      }
+    }
+
+    // The value of a literal (but not null or a string, which aren't constants a literal can be folded into)
+    bool GetLiteral(ExpressionNode* node, RuntimeValue& value)
+    {
+      if (node == nullptr || node->mKind != NodeKind::Value)
+        return false;
+
+      const Token& token = static_cast<ValueNode*>(node)->mToken;
+      switch (token.mEnumTokenType)
+      {
+        case TokenType::IntegerLiteral:
+          value = RuntimeValue::MakeInteger((int32_t)strtoll(token.mText, nullptr, 10));
+          return true;
+
+        case TokenType::FloatLiteral:
+          value = RuntimeValue::MakeFloat((float)strtod(token.mText, nullptr));
+          return true;
+
+        case TokenType::True:
+        case TokenType::False:
+          value = RuntimeValue::MakeBoolean(token.mEnumTokenType == TokenType::True);
+          return true;
+
+        case TokenType::CharacterLiteral:
+        {
+          std::string text = Unescape(token.mText + 1, token.mLength - 2);
+          value = RuntimeValue::MakeByte(text.empty() ? 0 : (uint8_t)text[0]);
+          return true;
+        }
+
+        default:
+          return false;
+      }
+    }
+
+    // What an operator or cast of literals comes to, the same way Interpreter::Evaluate would compute it
+    // Returns false if it isn't a constant, or if running it would fail
+    bool Evaluate(ExpressionNode* node, RuntimeValue& result)
+    {
+      switch (node->mKind)
+      {
+        case NodeKind::BinaryOperator:
+        {
+          // The parser hangs the left hand side off of mRight and the right hand side off of mLeft
+          BinaryOperatorNode* binary = static_cast<BinaryOperatorNode*>(node);
+          RuntimeValue left;
+          RuntimeValue right;
+          if (!GetLiteral(binary->mRight.get(), left) || !GetLiteral(binary->mLeft.get(), right))
+            return false;
+          return EvaluateBinary(binary->mOperator.mEnumTokenType, left, right, result);
+        }
+
+        case NodeKind::UnaryOperator:
+        {
+          UnaryOperatorNode* unary = static_cast<UnaryOperatorNode*>(node);
+          RuntimeValue value;
+          if (!GetLiteral(unary->mRight.get(), value))
+            return false;
+
+          switch (unary->mOperator.mEnumTokenType)
+          {
+            case TokenType::Plus:
+              result = value;
+              return IsArithmetic(value.mType);
+
+            case TokenType::Minus:
+              if (value.mType == IntegerType)
+                result = RuntimeValue::MakeInteger((int32_t)(0u - (uint32_t)value.mInteger));
+              else if (value.mType == FloatType)
+                result = RuntimeValue::MakeFloat(-value.mFloat);
+              else if (value.mType == ByteType)
+                result = RuntimeValue::MakeByte((uint8_t)-value.mByte);
+              else
+                return false;
+              return true;
+
+            case TokenType::LogicalNot:
+              result = RuntimeValue::MakeBoolean(!value.mBoolean);
+              return value.mType == BooleanType;
+
+            default:
+              return false;
+          }
+        }
+
+        case NodeKind::Cast:
+        {
+          CastNode* cast = static_cast<CastNode*>(node);
+          RuntimeValue value;
+          Type* type = cast->mType->mSymbol;
+          if (type == nullptr || !IsPrimitive(type) || !GetLiteral(cast->mLeft.get(), value))
+            return false;
+          result = ConvertValue(value, type);
+          return true;
+        }
+
+        default:
+          return false;
+      }
+    }
+
+    bool EvaluateBinary(TokenType::Enum op, const RuntimeValue& left, const RuntimeValue& right, RuntimeValue& result)
+    {
+      switch (op)
+      {
+        case TokenType::LogicalAnd:
+        case TokenType::LogicalOr:
+          if (left.mType != BooleanType || right.mType != BooleanType)
+            return false;
+          result = RuntimeValue::MakeBoolean(op == TokenType::LogicalAnd ? left.mBoolean && right.mBoolean : left.mBoolean || right.mBoolean);
+          return true;
+
+        case TokenType::LessThan:
+        case TokenType::GreaterThan:
+        case TokenType::LessThanOrEqualTo:
+        case TokenType::GreaterThanOrEqualTo:
+        case TokenType::Equality:
+        case TokenType::Inequality:
+        {
+          int comparison = 0;
+          if (left.mType == FloatType || right.mType == FloatType)
+          {
+            double a = ToDouble(left);
+            double b = ToDouble(right);
+            // Any comparison with NaN is false, except that it isn't equal
+            if (a != a || b != b)
+            {
+              result = RuntimeValue::MakeBoolean(op == TokenType::Inequality);
+              return true;
+            }
+            comparison = a < b ? -1 : a > b ? 1 : 0;
+          }
+          else
+          {
+            int64_t a = ToInteger(left);
+            int64_t b = ToInteger(right);
+            comparison = a < b ? -1 : a > b ? 1 : 0;
+          }
+
+          switch (op)
+          {
+            case TokenType::LessThan:             result = RuntimeValue::MakeBoolean(comparison < 0);  break;
+            case TokenType::GreaterThan:          result = RuntimeValue::MakeBoolean(comparison > 0);  break;
+            case TokenType::LessThanOrEqualTo:    result = RuntimeValue::MakeBoolean(comparison <= 0); break;
+            case TokenType::GreaterThanOrEqualTo: result = RuntimeValue::MakeBoolean(comparison >= 0); break;
+            case TokenType::Equality:             result = RuntimeValue::MakeBoolean(comparison == 0); break;
+            default:                              result = RuntimeValue::MakeBoolean(comparison != 0); break;
+          }
+          return true;
+        }
+
+        default:
+          break;
+      }
+
+      if (!IsArithmetic(left.mType) || !IsArithmetic(right.mType))
+        return false;
+
+      // Mixed operands (which only initial values let through) work in the wider of the two
+      if (left.mType == FloatType || right.mType == FloatType)
+      {
+        float a = (float)ToDouble(left);
+        float b = (float)ToDouble(right);
+        switch (op)
+        {
+          case TokenType::Plus:     result = RuntimeValue::MakeFloat(a + b);       return true;
+          case TokenType::Minus:    result = RuntimeValue::MakeFloat(a - b);       return true;
+          case TokenType::Asterisk: result = RuntimeValue::MakeFloat(a * b);       return true;
+          case TokenType::Divide:   result = RuntimeValue::MakeFloat(a / b);       return true;
+          case TokenType::Modulo:   result = RuntimeValue::MakeFloat(fmodf(a, b)); return true;
+          default:                  return false;
+        }
+      }
+
+      // Integers wrap around instead of overflowing, the same as the machine does
+      bool bytes = left.mType == ByteType && right.mType == ByteType;
+      uint32_t a = (uint32_t)ToInteger(left);
+      uint32_t b = (uint32_t)ToInteger(right);
+      uint32_t value = 0;
+      switch (op)
+      {
+        case TokenType::Plus:     value = a + b; break;
+        case TokenType::Minus:    value = a - b; break;
+        case TokenType::Asterisk: value = a * b; break;
+        case TokenType::Divide:
+        case TokenType::Modulo:
+        {
+          int32_t dividend = bytes ? (int32_t)(uint8_t)a : (int32_t)a;
+          int32_t divisor = bytes ? (int32_t)(uint8_t)b : (int32_t)b;
+
+          // Dividing by zero is an error for the program to report when it runs
+          if (divisor == 0)
+            return false;
+
+          if (divisor == -1)
+            value = op == TokenType::Divide ? 0u - a : 0u;
+          else
+            value = (uint32_t)(op == TokenType::Divide ? dividend / divisor : dividend % divisor);
+          break;
+        }
+        default:
+          return false;
+      }
+
+      result = bytes ? RuntimeValue::MakeByte((uint8_t)value) : RuntimeValue::MakeInteger((int32_t)value);
+      return true;
+    }
+
+    // A literal with the value, to take the place of 'node' (or null if no literal can spell the value)
+    AstPtr<ValueNode> MakeLiteral(const RuntimeValue& value, ExpressionNode* node)
+    {
+      char text[64];
+      TokenType::Enum type;
+      if (value.mType == IntegerType)
+      {
+        type = TokenType::IntegerLiteral;
+        snprintf(text, sizeof(text), "%d", value.mInteger);
+      }
+      else if (value.mType == FloatType)
+      {
+        if (!std::isfinite(value.mFloat))
+          return AstPtr<ValueNode>();
+
+        // Nine digits are enough for strtod to give back the same float, and the point keeps it looking like a Float
+        type = TokenType::FloatLiteral;
+        snprintf(text, sizeof(text), "%.9g", value.mFloat);
+        if (strpbrk(text, ".e") == nullptr)
+          strcat(text, ".0");
+      }
+      else if (value.mType == BooleanType)
+      {
+        type = value.mBoolean ? TokenType::True : TokenType::False;
+        strcpy(text, value.mBoolean ? "true" : "false");
+      }
+      else if (value.mType == ByteType)
+      {
+        // Only the escapes that the language can spell (so there's no literal for a backslash)
+        type = TokenType::CharacterLiteral;
+        uint8_t byte = value.mByte;
+        if (byte == '\n' || byte == '\r' || byte == '\t' || byte == '\'')
+          snprintf(text, sizeof(text), "'\\%c'", byte == '\n' ? 'n' : byte == '\r' ? 'r' : byte == '\t' ? 't' : '\'');
+        else if (byte >= ' ' && byte <= '~' && byte != '\\')
+          snprintf(text, sizeof(text), "'%c'", byte);
+        else
+          return AstPtr<ValueNode>();
+      }
+      else
+      {
+        return AstPtr<ValueNode>();
+      }
+
+      AstPtr<ValueNode> literal = node->mArena != nullptr ? node->mArena->Create<ValueNode>() : AstPtr<ValueNode>(new ValueNode());
+      const std::string& interned = GetAtomString(InternString(text, strlen(text)));
+      literal->mToken = Token(interned.c_str(), interned.size(), type);
+      literal->mResolvedType = node->mResolvedType;
+      literal->mParent = node->mParent;
+      return literal;
+    }
+
+    const WrittenLocalFinder& mWritten;
+
+    // The value of each local that was found to be a constant
+    std::unordered_map<Symbol*, RuntimeValue> mConstants;
+  };
+}
+
+size_t FoldConstants(AbstractNode* tree)
+{
+  WrittenLocalFinder written;
+  written.Walk(tree);
+
+  ConstantFolder folder(written);
+  folder.Walk(tree);
+  return folder.mRemovedNodes;
+}
@@ -0,0 +1,28 @@
+/******************************************************************\
+ * Copyright 2015, DigiPen Institute of Technology
+\******************************************************************/
+
+#pragma once
+#ifndef COMPILER_CLASS_CONSTANT_FOLDER
+#define COMPILER_CLASS_CONSTANT_FOLDER
+
+#include "Interpreter.hpp"
+
+// An optimization pass over a tree that SemanticAnalyize has analyzed (analysis never runs it on its own)
+//
+// Every BinaryOperator, UnaryOperator and Cast whose operands are all literals is replaced by one literal ValueNode,
+// with the value the Interpreter would have computed: Integers wrap around, Byte arithmetic wraps to 0 to 255 (only
+// when both operands are Bytes), Float arithmetic is single precision and conversions are the ones ConvertValue makes
+// Anything that would fail when run (such as dividing by zero) is left for the program to fail on, and so is a result
+// that no literal can spell (a Float that isn't finite, or a Byte with no character literal)
+//
+// Constants are also propagated through locals that are never assigned, incremented, decremented or have their
+// address taken: each use of one whose initial value folds to a literal becomes that literal (converted to its type)
+// The locals of a function with labels are left alone, since a goto can jump over a declaration
+//
+// A literal that replaces a node keeps the type analysis resolved the node to, and its text is interned
+// It comes from the same arena as the nodes it replaced (see AstArena), which stay there until the arena is deleted
+// Returns how many nodes were removed from the tree
+size_t FoldConstants(AbstractNode* tree);
+
+#endif
@@ -32,6 +32,7 @@ int main(int argc, char* argv[])
 Token::Token() :
   mText(""),
   mLength(0),
+  mAtom(EmptyAtom),
   mTokenType(0)
 {
 }
@@ -39,6 +40,7 @@ Token::Token() :
 Token::Token(const char* text, size_t length, int type) :
   mText(text),
   mLength(length),
+  mAtom(type == TokenType::Identifier ? InternString(text, length) : EmptyAtom),
   mTokenType(type)
 {
 }
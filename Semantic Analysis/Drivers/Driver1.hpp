@@ -9,6 +9,7 @@
 
 #include <string>
 #include <vector>
+#include "StringAtom.hpp"
 
 /***************************** PART 1 *****************************/
 
@@ -38,6 +39,9 @@ public:
   const char* mText;
   size_t mLength;
 
+  // The interned text of an Identifier (EmptyAtom for every other token type)
+  Atom mAtom;
+
   // Allow streams to output our token
   friend std::ostream& operator<<(std::ostream& out, const Token& token);
 
@@ -50,6 +50,7 @@ const char* ParsingException::what() const
 }
 
 std::vector<PrintRule*> PrintRule::ActiveRules;
+bool PrintRule::Failing = false;
 
 void PrintRule::PrintTabs()
 {
@@ -70,11 +71,12 @@ PrintRule::~PrintRule()
 {
   ActiveRules.pop_back();
 
-  if (this->mAccepted || std::uncaught_exception())
+  bool failed = Failing || std::uncaught_exception();
+  if (this->mAccepted || failed)
   {
     this->PrintTabs();
 
-    if (std::uncaught_exception())
+    if (failed)
       this->mStream << "End" << this->mName << "*\n";
     else
       this->mStream << "End" << this->mName << "\n";
@@ -111,6 +113,11 @@ void PrintRule::DebugPrintLine(const char* text)
   this->mStream << text << "\n";
 }
 
+void PrintRule::SetFailing(bool failing)
+{
+  Failing = failing;
+}
+
 PrintRule* PrintRule::GetLatestRule()
 {
   if (ActiveRules.empty())
@@ -69,10 +69,15 @@ public:
   // Gets the latest print rule, or returns null if none are active (generally used for debugging)
   static PrintRule* GetLatestRule();
 
+  // While set, every rule that is destroyed prints as failed, just like when an exception unwinds through it
+  // This lets a parser report an error by returning instead of throwing
+  static void SetFailing(bool failing);
+
 private:
   bool mAccepted;
   void PrintTabs();
   static std::vector<PrintRule*> ActiveRules;
+  static bool Failing;
   std::stringstream mStream;
   std::string mName;
 };
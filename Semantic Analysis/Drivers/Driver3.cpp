@@ -5,6 +5,7 @@
 
 #include "Driver3.hpp"
 #include "DriverShared.hpp"
+#include "FlatAst.hpp"
 #include <stdio.h>
 
 #if DRIVER3
@@ -33,7 +34,12 @@ int main(int argc, char* argv[])
     Driver3Part2Test17,
     Driver3Part3Test18,
     Driver3Part3Test19,
-    Driver3Part3Test20
+    Driver3Part3Test20,
+    Driver3Part3Test21,
+    Driver3Part3Test22,
+    Driver3Part3Test23,
+    Driver3Part3Test24,
+    Driver3Part3Test25
   };
 
   return DriverMain(argc, argv, tests, DriverArraySize(tests));
@@ -101,6 +107,123 @@ void RunAstTest(int part, int test, T (*parser)(std::vector<Token>& tokens), con
   printf("*******************************************\n\n");
 }
 
+// Whether a block has a global class, function or variable with the given name
+static bool HasGlobal(BlockNode* block, const char* name)
+{
+  for (size_t i = 0; i < block->mGlobals.size(); ++i)
+  {
+    AbstractNode* global = block->mGlobals[i].get();
+    Token* globalName = nullptr;
+    if (global->mKind == NodeKind::Class)
+      globalName = &static_cast<ClassNode*>(global)->mName;
+    else if (global->mKind == NodeKind::Function)
+      globalName = &static_cast<FunctionNode*>(global)->mName;
+    else if (global->mKind == NodeKind::Variable)
+      globalName = &static_cast<VariableNode*>(global)->mName;
+
+    if (globalName && globalName->str() == name)
+      return true;
+  }
+
+  return false;
+}
+
+// If skippedGlobal is given, recovery must drop that global along with its error, but keep the ones that follow it
+void RunRecoveryTest(int part, int test, const char* stream, const char* skippedGlobal = nullptr, const char* keptGlobal = nullptr)
+{
+  printf("************** PART %d TEST %d **************\n", part, test);
+  DfaState* root = CreateLanguageDfa();
+  std::vector<Token> tokens;
+  TokenizeAndDeleteRoot(root, stream, TokenNames, &tokens, ReadLanguageToken);
+  printf("\n");
+
+  RemoveWhitespaceAndComments(tokens);
+  std::vector<ParseDiagnostic> diagnostics;
+  auto rootNode = ParseBlockWithRecovery(tokens, diagnostics);
+
+  printf("Parsing Finished with %d Error(s)\n", (int)diagnostics.size());
+  for (size_t i = 0; i < diagnostics.size(); ++i)
+    printf("Error at token %d: %s\n", (int)diagnostics[i].mTokenIndex, diagnostics[i].mMessage.c_str());
+  printf("\n");
+
+  if (rootNode && skippedGlobal)
+  {
+    if (HasGlobal(rootNode.get(), skippedGlobal))
+      printf("Test Failed: Expected '%s' to be skipped along with its error\n\n", skippedGlobal);
+    else if (keptGlobal && !HasGlobal(rootNode.get(), keptGlobal))
+      printf("Test Failed: Expected '%s' to be parsed after '%s' was skipped\n\n", keptGlobal, skippedGlobal);
+    else
+      printf("Skipped '%s' along with its error\n\n", skippedGlobal);
+  }
+
+  if (rootNode)
+    PrintTree(rootNode.get());
+
+  printf("*******************************************\n\n");
+}
+
+// Like RunAstTest, but through the entry points that report failure instead of throwing
+template <typename T>
+void RunTryParseTest(int part, int test, T (*parser)(std::vector<Token>& tokens, std::string* error), const char* stream)
+{
+  printf("************** PART %d TEST %d **************\n", part, test);
+  DfaState* root = CreateLanguageDfa();
+  std::vector<Token> tokens;
+  TokenizeAndDeleteRoot(root, stream, TokenNames, &tokens, ReadLanguageToken);
+  printf("\n");
+
+  RemoveWhitespaceAndComments(tokens);
+  std::string error;
+  auto rootNode = parser(tokens, &error);
+  if (rootNode)
+  {
+    printf("Parsing Successful\n\n");
+    PrintTree(rootNode.get());
+  }
+  else
+  {
+    printf("Parsing Failed (%s)\n", error.empty() ? "Null Node" : error.c_str());
+  }
+
+  printf("*******************************************\n\n");
+}
+
+// Parses a block and prints its flat form, without inflating it back into a tree
+void RunFlatPrintTest(int part, int test, const char* stream)
+{
+  printf("************** PART %d TEST %d **************\n", part, test);
+  DfaState* root = CreateLanguageDfa();
+  std::vector<Token> tokens;
+  TokenizeAndDeleteRoot(root, stream, TokenNames, &tokens, ReadLanguageToken);
+  printf("\n");
+
+  RemoveWhitespaceAndComments(tokens);
+  std::string error;
+  auto rootNode = TryParseBlock(tokens, &error);
+  if (rootNode)
+  {
+    printf("Parsing Successful\n\n");
+    FlatAst flat;
+    Flatten(rootNode.get(), flat);
+    PrintTree(flat);
+  }
+  else
+  {
+    printf("Parsing Failed (%s)\n", error.empty() ? "Null Node" : error.c_str());
+  }
+
+  printf("*******************************************\n\n");
+}
+
+// Parses a block, then sends it through the flat AST and back before it gets printed
+AstPtr<AbstractNode> ParseBlockThroughFlatAst(std::vector<Token>& tokens)
+{
+  AstPtr<BlockNode> block = ParseBlock(tokens);
+  FlatAst flat;
+  Flatten(block.get(), flat);
+  return Inflate(flat);
+}
+
 void Driver3Part1Test0()
 {
   RunAstTest(1, 0, ParseExpression, STRINGIZE("hello world"));
@@ -268,3 +391,48 @@ void Driver3Part3Test20()
 {
   RunAstTest(3, 20, ParseBlock, "function Explode() { if (a > 5) { } else }");
 }
+
+void Driver3Part3Test21()
+{
+  RunRecoveryTest(3, 21,
+    "function Main() { var a : Integer = ; a = 5 + ; return a; }"
+    "class Player { var Health : = 100; function Die() { Health = 0; } }"
+    "function Broken( { while (true) { } }"
+    "var gCount : Integer;",
+    "Broken", "gCount");
+}
+
+// A class with most kinds of statements, for the flat AST tests
+static const char* FlatAstTestCode =
+  "class Player\n"
+  "{\n"
+  "  var Lives : Integer = 9 * 1 + 0;\n"
+  "  function Hit(amount : Float, source : Player**) : Boolean\n"
+  "  {\n"
+  "    for (var i : Integer = 0; i < this.Lives; ++i) { this.Lives -= source[i]->Damage(amount as Integer, 2); }\n"
+  "    while (false) { break; }\n"
+  "    if (this.Lives > 0) { return true; } else if (!this.Dead) { continue; } else { goto End; }\n"
+  "    label End;\n"
+  "    return false;\n"
+  "  }\n"
+  "}\n";
+
+void Driver3Part3Test22()
+{
+  RunAstTest(3, 22, ParseBlockThroughFlatAst, FlatAstTestCode);
+}
+
+void Driver3Part3Test23()
+{
+  RunTryParseTest(3, 23, TryParseExpression, "+ !");
+}
+
+void Driver3Part3Test24()
+{
+  RunTryParseTest(3, 24, TryParseBlock, "var a : Integer = 5 +");
+}
+
+void Driver3Part3Test25()
+{
+  RunFlatPrintTest(3, 25, FlatAstTestCode);
+}
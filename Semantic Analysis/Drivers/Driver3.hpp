@@ -28,7 +28,7 @@ private:
 // Parse the following stream of tokens into an Expression Tree (starting from the Expression rule)
 // This function should return a root node (which holds all of the parsed operators, literals, etc)
 // If we fail parsing, we should throw ParsingException (otherwise success is assumed)
-std::unique_ptr<ExpressionNode> ParseExpression(std::vector<Token>& tokens);
+AstPtr<ExpressionNode> ParseExpression(std::vector<Token>& tokens);
 
 // Print the tree out starting from the given node
 // The printed tree must match the tree from the driver
@@ -39,7 +39,33 @@ void PrintTree(AbstractNode* node);
 // Parse the following stream of tokens into an Abstract Syntax Tree (starting from the Block rule)
 // This function should return a root node (which holds all of the parsed classes and functions)
 // If we fail parsing, we should throw ParsingException (otherwise success is assumed)
-std::unique_ptr<BlockNode> ParseBlock(std::vector<Token>& tokens);
+AstPtr<BlockNode> ParseBlock(std::vector<Token>& tokens);
+
+// The same as ParseExpression and ParseBlock, except that a failed parse returns null instead of throwing
+// If error is given it receives the message the ParsingException would have carried
+AstPtr<ExpressionNode> TryParseExpression(std::vector<Token>& tokens, std::string* error = nullptr);
+AstPtr<BlockNode> TryParseBlock(std::vector<Token>& tokens, std::string* error = nullptr);
+
+// A syntax error that ParseBlockWithRecovery reported and skipped over
+class ParseDiagnostic
+{
+public:
+  std::string mMessage;
+  // Index into the token stream (after whitespace and comments are removed) where the error was found
+  size_t mTokenIndex;
+};
+
+// Parses like ParseBlock, but instead of throwing on the first error it records every error in diagnostics
+// Each error skips to the next ';', '}', 'class' or 'function' and leaves an ErrorNode in the returned tree
+AstPtr<BlockNode> ParseBlockWithRecovery(std::vector<Token>& tokens, std::vector<ParseDiagnostic>& diagnostics);
+
+// Limits how many rules the parser may be inside of at once (each level of parentheses uses about ten)
+// Input nested deeper than this throws ParsingException instead of exhausting memory; 0 restores the default
+void SetParseDepthLimit(size_t maxDepth);
+
+// Turns the PrintRule trace of the parser on or off (it is on by default, which the driver tests rely on)
+void SetParseTracing(bool tracing);
+bool IsParseTracing();
 
 /***************************** TESTS  *****************************/
 
@@ -106,4 +132,20 @@ void Driver3Part3Test19();
 // Failure test where we try and parse a global function and a nested if with an else that is missing a scope
 void Driver3Part3Test20();
 
+// Recovery test where a block with several mistakes reports all of them and still returns a tree
+// The function with the broken parameter list is dropped whole (recovery resumes at the next global)
+void Driver3Part3Test21();
+
+// Round trip test where a class with most kinds of statements is parsed, flattened, and inflated again before printing
+void Driver3Part3Test22();
+
+// Failure test where an expression ends after its unary operators, parsed without exceptions (it must return, not loop)
+void Driver3Part3Test23();
+
+// Failure test where a variable's initial value ends after a binary operator, parsed without exceptions
+void Driver3Part3Test24();
+
+// Flat AST test where the class from test 22 is flattened and printed straight from the flat form (the output matches test 22)
+void Driver3Part3Test25();
+
 #endif
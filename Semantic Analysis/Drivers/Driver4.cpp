@@ -5,6 +5,9 @@
 
 #include "Driver4.hpp"
 #include "DriverShared.hpp"
+#include "ConstantFolder.hpp"
+#include "FlatAst.hpp"
+#include "Interpreter.hpp"
 #include <stdio.h>
 
 #if DRIVER4
@@ -42,7 +45,12 @@ int main(int argc, char* argv[])
     Driver4Part4Test26,
     Driver4Part4Test27,
     Driver4Part4Test28,
-    Driver4Part4Test29
+    Driver4Part4Test29,
+    Driver4Part5Test30,
+    Driver4Part5Test31,
+    Driver4Part5Test32,
+    Driver4Part5Test33,
+    Driver4Part5Test34
   };
 
   return DriverMain(argc, argv, tests, DriverArraySize(tests));
@@ -130,7 +138,7 @@ void ErrorInvalidCall(CallNode* node)
   stream << "Expected call arguments (";
   
   bool emitComma = false;
-  for (Type* parameterType : functionType->mParameterTypes)
+  for (Type* parameterType : functionType->mFunction->mParameterTypes)
   {
     if (emitComma)
       stream << ", ";
@@ -273,6 +281,109 @@ void RunSemanticTest(int part, int test, const char* stream)
   printf("*******************************************\n\n");
 }
 
+// Analyzes the stream, folds its constants and prints the folded tree
+// The number of nodes folding removed is checked against what the test expects
+void RunFoldTest(int part, int test, size_t expectedRemoved, const char* stream)
+{
+  printf("************** PART %d TEST %d **************\n", part, test);
+  DfaState* root = CreateLanguageDfa();
+  std::vector<Token> tokens;
+  TokenizeAndDeleteRoot(root, stream, TokenNames, &tokens, ReadLanguageToken);
+  printf("\n");
+
+  Library* core = InitializeCoreLibrary();
+
+  try
+  {
+    RemoveWhitespaceAndComments(tokens);
+    auto rootNode = ParseBlock(tokens);
+    std::vector<Library*> dependencies;
+    dependencies.push_back(core);
+
+    auto library = std::make_unique<Library>();
+    try
+    {
+      SemanticAnalyize(rootNode.get(), dependencies, library.get());
+
+      size_t removed = FoldConstants(rootNode.get());
+      printf("Folding Removed %d Node(s)\n", (int)removed);
+      if (removed != expectedRemoved)
+        printf("Test Failed: Expected %d Removed Node(s)\n", (int)expectedRemoved);
+      printf("\n");
+
+      PrintTreeWithSymbols(rootNode.get());
+    }
+    catch (SemanticException& e)
+    {
+      printf("%s\n", e.what());
+    }
+  }
+  catch (ParsingException&)
+  {
+    printf("Parsing Failed (Exception)\n");
+  }
+
+  printf("*******************************************\n\n");
+}
+
+// Analyzes a tree inflated from the flat form, stores what analysis resolved back into the flat form,
+// then inflates a second tree from it and runs its Main function (which only works if every name is still bound)
+void RunFlatExecutionTest(int part, int test, const char* stream)
+{
+  printf("************** PART %d TEST %d **************\n", part, test);
+  DfaState* root = CreateLanguageDfa();
+  std::vector<Token> tokens;
+  TokenizeAndDeleteRoot(root, stream, TokenNames, &tokens, ReadLanguageToken);
+  printf("\n");
+
+  Library* core = InitializeCoreLibrary();
+
+  try
+  {
+    RemoveWhitespaceAndComments(tokens);
+    FlatAst flat;
+    {
+      auto parsed = ParseBlock(tokens);
+      Flatten(parsed.get(), flat);
+    }
+
+    std::vector<AbstractNode*> nodes;
+    auto analyzed = Inflate(flat, &nodes);
+    std::vector<Library*> dependencies;
+    dependencies.push_back(core);
+
+    auto library = std::make_unique<Library>();
+    try
+    {
+      SemanticAnalyize(analyzed.get(), dependencies, library.get());
+      StoreSymbols(flat, nodes);
+
+      auto rootNode = Inflate(flat);
+      PrintTreeWithSymbols(rootNode.get());
+      printf("\n");
+
+      Interpreter interpreter;
+      interpreter.Load(static_cast<BlockNode*>(rootNode.get()));
+      RuntimeValue result = interpreter.Call(interpreter.FindFunction("Main"), std::vector<RuntimeValue>());
+      printf("Main Returned %d\n", (int)result.mInteger);
+    }
+    catch (SemanticException& e)
+    {
+      printf("%s\n", e.what());
+    }
+    catch (ExecutionException& e)
+    {
+      printf("Execution Failed: %s\n", e.what());
+    }
+  }
+  catch (ParsingException&)
+  {
+    printf("Parsing Failed (Exception)\n");
+  }
+
+  printf("*******************************************\n\n");
+}
+
 void Driver4Part1Test0()
 {
   RunSemanticTest(1, 0, STRINGIZE(class Player { }));
@@ -698,4 +809,100 @@ void Driver4Part4Test29()
       &i % &i;
     }
   ));
-}
\ No newline at end of file
+}
+
+void Driver4Part5Test30()
+{
+  RunFoldTest(5, 30, 39, STRINGIZE(
+    function Test(a : Integer, b : Integer, c : Integer) : Integer
+    {
+      var r : Boolean = 5 + 3 * 9 - 6 / (2 + 2) == 31 || a == b && a != -c;
+      var f : Float = 9.0f * 2.0f * 1.0f * 160.0f / 5.0f / 10.0f;
+      var n : Boolean = !(-(3 * -5) > 14);
+      return 5 + 3 * 9 - 6 / (2 + 2);
+    }
+  ));
+}
+
+void Driver4Part5Test31()
+{
+  RunFoldTest(5, 31, 8, STRINGIZE(
+    function Test() : Byte
+    {
+      var wrapped : Byte = 'z' * 'z';
+      var unspellable : Byte = 'a' - 'b';
+      var converted : Byte = 300 as Byte;
+      var widened : Integer = ('z' as Integer) * 2;
+      return wrapped;
+    }
+  ));
+}
+
+void Driver4Part5Test32()
+{
+  RunFoldTest(5, 32, 2, STRINGIZE(
+    function Test(a : Integer) : Integer
+    {
+      var i : Integer = 5 / 0;
+      var j : Integer = a % (3 - 3);
+      return i + j;
+    }
+  ));
+}
+
+void Driver4Part5Test33()
+{
+  RunFoldTest(5, 33, 4, STRINGIZE(
+    function Test() : Integer
+    {
+      var kept : Integer = 2 + 3;
+      var assigned : Integer = 4;
+      assigned = 5;
+      var incremented : Integer = 6;
+      ++incremented;
+      var addressed : Integer = 7;
+      var p : Integer* = &addressed;
+      return kept * 2 + assigned + incremented + addressed;
+    }
+
+    function Labeled() : Integer
+    {
+      var d : Integer = 8;
+      label Top;
+      return d + 1;
+    }
+  ));
+}
+
+void Driver4Part5Test34()
+{
+  RunFlatExecutionTest(5, 34, STRINGIZE(
+    class Counter
+    {
+      var Count : Integer;
+    }
+
+    var gStep : Integer = 3;
+
+    function Add(counter : Counter*, amount : Integer)
+    {
+      counter->Count = counter->Count + amount;
+    }
+
+    function Twice(n : Integer) : Integer
+    {
+      return n * 2;
+    }
+
+    function Main() : Integer
+    {
+      var counter : Counter;
+      counter.Count = 0;
+      for (var i : Integer = 0; i < 4; ++i)
+      {
+        Add(&counter, gStep);
+      }
+      return counter.Count + Twice(5);
+    }
+  ));
+}
@@ -12,6 +12,7 @@
 #include "Driver3.hpp"
 #include "AstNodes.hpp"
 #include "SymbolTable.hpp"
+#include <unordered_set>
 
 /***************************** DRIVER *****************************/
 
@@ -86,10 +87,91 @@ void ErrorInvalidBinaryOperator(BinaryOperatorNode* node);
 // A partial library may be used to print out a tree after an error occurs (for your own debugging)
 void SemanticAnalyize(AbstractNode* node, std::vector<Library*>& dependencies, Library* library);
 
+// How long one pass of semantic analysis took
+class SemanticPassTime
+{
+public:
+  const char* mName;
+  double mSeconds;
+};
+
+// The passes that the last call to SemanticAnalyize on this thread ran, in order, with the time each one took
+// A pass that threw a SemanticException is not included
+const std::vector<SemanticPassTime>& GetSemanticPassTimes();
+
+// Chooses between the classic passes (each one walks the whole tree) and fused passes that do the same work in fewer walks
+// The fused passes are on by default. Both produce the same symbols and errors.
+void SetFusedSemanticPasses(bool fused);
+
+// How many threads the fused passes may use to analyze function bodies (0 uses one per core, 1 stays on the calling thread)
+// Small trees are always analyzed on the calling thread
+void SetSemanticThreads(size_t threads);
+
+class AnalysisContext;
+
+// Keeps an analyzed tree and its library so that an edit to the body of one function can be checked on its own
+// Nothing outside of a body depends on it, only on the function's signature. So while the signature stays the same,
+// the library, the other bodies and every resolved type are reused as they are.
+class IncrementalAnalyzer
+{
+public:
+  IncrementalAnalyzer();
+  ~IncrementalAnalyzer();
+
+  // Takes the tree and runs SemanticAnalyize over it, keeping what it needs to check bodies again
+  void Analyze(AstPtr<BlockNode> block, std::vector<Library*>& dependencies, Library* library);
+
+  // The analyzed tree, with the edited bodies in it
+  BlockNode* GetTree() const;
+
+  // Gives 'function' (from the analyzed tree) the body of the only function in 'edit', a parse of the edited function,
+  // and analyzes just that body again. The analyzer keeps 'edit' alive for as long as the body is in use.
+  // Returns false (changing nothing) if 'edit' isn't a function with the same name, parameters and return type,
+  // in which case the whole tree has to be analyzed again
+  // Throws a SemanticException if the new body has an error (editing the function again can still fix it)
+  bool ReplaceBody(FunctionNode* function, AstPtr<BlockNode> edit);
+
+private:
+  IncrementalAnalyzer(const IncrementalAnalyzer&) = delete;
+  IncrementalAnalyzer& operator=(const IncrementalAnalyzer&) = delete;
+
+  // Analyzes one function body as the Bodies pass would have
+  void CheckBody(FunctionNode* function);
+
+  // Swaps every edited body back into the tree and lets go of the edits
+  void RestoreBodies();
+
+  // Forgets the locals and labels that a function's current body declared, before the body is replaced
+  void ForgetLocals(FunctionNode* function);
+
+  // Removes the stale symbols from the library
+  void RemoveStaleSymbols();
+
+  Library* mLibrary;
+  AstPtr<BlockNode> mTree;
+
+  // The globals the tree was analyzed with
+  std::unique_ptr<AnalysisContext> mContext;
+
+  // The edit that each function's body currently comes from (holding the body it replaced)
+  std::unordered_map<FunctionNode*, AstPtr<BlockNode>> mEdits;
+
+  // What a body declared before it failed to analyze (which may not all be in its function's mLocals)
+  std::unordered_map<FunctionNode*, std::vector<Symbol*>> mFailedLocals;
+
+  // The locals and labels of replaced bodies
+  // They stay in the library until they make up a large enough part of it to be worth removing in one pass
+  std::unordered_set<Symbol*> mStaleSymbols;
+};
+
 // Print the tree out with semantic symbols starting from the given node
 // The printed tree must match the tree from the driver
 void PrintTreeWithSymbols(AbstractNode* node);
 
+// Creates the core library on the first call and returns it
+// Every test analyzes against it as their only dependency
+Library* InitializeCoreLibrary();
+
 // Symbols that we guarantee exist (within the core library)
 extern Type* VoidType;
 extern Type* NullType;
@@ -192,4 +274,19 @@ void Driver4Part4Test28();
 // Tests an invalid binary operator
 void Driver4Part4Test29();
 
+// Folds the Driver3 expressions made of literals (and leaves the parts that use variables)
+void Driver4Part5Test30();
+
+// Folds Byte arithmetic that wraps around, and leaves a Byte that no character literal can spell
+void Driver4Part5Test31();
+
+// Leaves a division and a modulo by zero for the program to fail on
+void Driver4Part5Test32();
+
+// Propagates a constant local, but not one that is assigned, incremented, has its address taken or is in a function with a label
+void Driver4Part5Test33();
+
+// Analyzes a tree inflated from the flat AST, stores the symbols back into the flat form and runs a second inflated tree
+void Driver4Part5Test34();
+
 #endif
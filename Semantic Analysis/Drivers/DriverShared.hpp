@@ -14,15 +14,16 @@
 // This is a helper template class that we use to simplify pushing unique pointers into a vector
 // The push_back function returns a bool so that it can be used in conditions (such as a while loop)
 // It also will only push when the unique_ptr is not null
-template <typename T>
-class unique_vector : public std::vector<std::unique_ptr<T>>
+// The deleter can be replaced, which the AST uses so that nodes living in an AstArena are not deleted one by one
+template <typename T, typename Deleter = std::default_delete<T>>
+class unique_vector : public std::vector<std::unique_ptr<T, Deleter>>
 {
 public:
-  bool push_back(std::unique_ptr<T> ptr)
+  bool push_back(std::unique_ptr<T, Deleter> ptr)
   {
     if (ptr)
     {
-      vector::push_back(std::move(ptr));
+      std::vector<std::unique_ptr<T, Deleter>>::push_back(std::move(ptr));
       return true;
     }
     return false;
@@ -0,0 +1,417 @@
+/******************************************************************\
+ * Copyright 2015, DigiPen Institute of Technology
+\******************************************************************/
+
+#include "FlatAst.hpp"
+#include "AstArena.hpp"
+#include "SymbolTable.hpp"
+
+const uint32_t FlatAst::None;
+
+uint32_t FlatAst::GetChild(uint32_t node, uint32_t slot) const
+{
+  const FlatNode& flatNode = mNodes[node];
+  if (slot >= flatNode.mChildCount)
+    return None;
+
+  return mChildren[flatNode.mFirstChild + slot];
+}
+
+// Creates the node for one flat node, with everything except its children
+static AbstractNode* CreateNode(AstArena& arena, const FlatAst& flat, uint32_t index)
+{
+  const FlatNode& flatNode = flat.mNodes[index];
+  const Token* tokens = flatNode.mToken == FlatAst::None ? nullptr : &flat.mTokens[flatNode.mToken];
+  Symbol* symbol = flat.mSymbols[index];
+  Type* type = flat.mTypes[index];
+
+  switch (flatNode.mKind)
+  {
+    case NodeKind::Block:
+      return arena.Create<BlockNode>().release();
+
+    case NodeKind::Class:
+    {
+      ClassNode* node = arena.Create<ClassNode>().release();
+      node->mName = tokens[0];
+      node->mSymbol = static_cast<Type*>(symbol);
+      return node;
+    }
+
+    case NodeKind::Variable:
+    case NodeKind::Parameter:
+    {
+      VariableNode* node = flatNode.mKind == NodeKind::Variable ?
+        arena.Create<VariableNode>().release() :
+        arena.Create<ParameterNode>().release();
+      node->mName = tokens[0];
+      node->mSymbol = static_cast<Variable*>(symbol);
+      return node;
+    }
+
+    case NodeKind::Scope:
+      return arena.Create<ScopeNode>().release();
+
+    case NodeKind::Function:
+    {
+      FunctionNode* node = arena.Create<FunctionNode>().release();
+      node->mName = tokens[0];
+      node->mSymbol = static_cast<Function*>(symbol);
+      node->mSignatureType = type;
+      return node;
+    }
+
+    case NodeKind::Type:
+    {
+      TypeNode* node = arena.Create<TypeNode>().release();
+      node->mName = tokens[0];
+      node->mPointerCount = flatNode.mExtra;
+      node->mSymbol = static_cast<Type*>(symbol);
+      return node;
+    }
+
+    case NodeKind::Label:
+    {
+      LabelNode* node = arena.Create<LabelNode>().release();
+      node->mName = tokens[0];
+      node->mSymbol = static_cast<Label*>(symbol);
+      return node;
+    }
+
+    case NodeKind::Goto:
+    {
+      GotoNode* node = arena.Create<GotoNode>().release();
+      node->mName = tokens[0];
+      node->mResolvedLabel = static_cast<Label*>(symbol);
+      return node;
+    }
+
+    case NodeKind::Return:
+      return arena.Create<ReturnNode>().release();
+
+    case NodeKind::Break:
+      return arena.Create<BreakNode>().release();
+
+    case NodeKind::Continue:
+      return arena.Create<ContinueNode>().release();
+
+    case NodeKind::Error:
+    {
+      ErrorNode* node = arena.Create<ErrorNode>().release();
+      node->mMessage = flat.mMessages[flatNode.mExtra];
+      return node;
+    }
+
+    case NodeKind::If:
+      return arena.Create<IfNode>().release();
+
+    case NodeKind::While:
+      return arena.Create<WhileNode>().release();
+
+    case NodeKind::For:
+      return arena.Create<ForNode>().release();
+
+    case NodeKind::Value:
+    {
+      ValueNode* node = arena.Create<ValueNode>().release();
+      node->mToken = tokens[0];
+      node->mResolvedSymbol = symbol;
+      node->mResolvedType = type;
+      return node;
+    }
+
+    case NodeKind::BinaryOperator:
+    {
+      BinaryOperatorNode* node = arena.Create<BinaryOperatorNode>().release();
+      node->mOperator = tokens[0];
+      node->mResolvedType = type;
+      return node;
+    }
+
+    case NodeKind::UnaryOperator:
+    {
+      UnaryOperatorNode* node = arena.Create<UnaryOperatorNode>().release();
+      node->mOperator = tokens[0];
+      node->mResolvedType = type;
+      return node;
+    }
+
+    case NodeKind::MemberAccess:
+    {
+      MemberAccessNode* node = arena.Create<MemberAccessNode>().release();
+      node->mOperator = tokens[0];
+      node->mName = tokens[1];
+      node->mResolvedMember = symbol;
+      node->mResolvedType = type;
+      return node;
+    }
+
+    case NodeKind::Call:
+    {
+      CallNode* node = arena.Create<CallNode>().release();
+      node->mResolvedType = type;
+      return node;
+    }
+
+    case NodeKind::Cast:
+    {
+      CastNode* node = arena.Create<CastNode>().release();
+      node->mResolvedType = type;
+      return node;
+    }
+
+    case NodeKind::Index:
+    {
+      IndexNode* node = arena.Create<IndexNode>().release();
+      node->mResolvedType = type;
+      return node;
+    }
+  }
+
+  return nullptr;
+}
+
+// Hands out the children of one flat node as the owning pointers that nodes hold
+class ChildReader
+{
+public:
+  ChildReader(const FlatAst& flat, const std::vector<AbstractNode*>& nodes, uint32_t index) :
+    mFlat(flat),
+    mNodes(nodes),
+    mNode(flat.mNodes[index])
+  {
+  }
+
+  uint32_t Count() const
+  {
+    return mNode.mChildCount;
+  }
+
+  template <typename T>
+  AstPtr<T> Get(uint32_t slot) const
+  {
+    uint32_t child = mFlat.mChildren[mNode.mFirstChild + slot];
+    if (child == FlatAst::None)
+      return nullptr;
+
+    return AstPtr<T>(static_cast<T*>(mNodes[child]));
+  }
+
+  template <typename T>
+  void GetAll(uint32_t firstSlot, uint32_t endSlot, AstVector<T>& children) const
+  {
+    children.reserve(endSlot - firstSlot);
+    for (uint32_t slot = firstSlot; slot < endSlot; ++slot)
+      children.push_back(Get<T>(slot));
+  }
+
+private:
+  const FlatAst& mFlat;
+  const std::vector<AbstractNode*>& mNodes;
+  const FlatNode& mNode;
+};
+
+// Gives a created node its children
+static void LinkNode(const FlatAst& flat, const std::vector<AbstractNode*>& nodes, uint32_t index)
+{
+  AbstractNode* abstractNode = nodes[index];
+  ChildReader children(flat, nodes, index);
+
+  uint32_t parent = flat.mNodes[index].mParent;
+  if (parent != FlatAst::None)
+    abstractNode->mParent = nodes[parent];
+
+  switch (flat.mNodes[index].mKind)
+  {
+    case NodeKind::Block:
+      children.GetAll(0, children.Count(), static_cast<BlockNode*>(abstractNode)->mGlobals);
+      break;
+
+    case NodeKind::Class:
+      children.GetAll(0, children.Count(), static_cast<ClassNode*>(abstractNode)->mMembers);
+      break;
+
+    case NodeKind::Variable:
+    case NodeKind::Parameter:
+    {
+      VariableNode* node = static_cast<VariableNode*>(abstractNode);
+      node->mType = children.Get<TypeNode>(0);
+      node->mInitialValue = children.Get<ExpressionNode>(1);
+      break;
+    }
+
+    case NodeKind::Scope:
+      children.GetAll(0, children.Count(), static_cast<ScopeNode*>(abstractNode)->mStatements);
+      break;
+
+    case NodeKind::Function:
+    {
+      FunctionNode* node = static_cast<FunctionNode*>(abstractNode);
+      uint32_t parameterCount = children.Count() - 2;
+      children.GetAll(0, parameterCount, node->mParameters);
+      node->mReturnType = children.Get<TypeNode>(parameterCount);
+      node->mScope = children.Get<ScopeNode>(parameterCount + 1);
+      break;
+    }
+
+    case NodeKind::Return:
+      static_cast<ReturnNode*>(abstractNode)->mReturnValue = children.Get<ExpressionNode>(0);
+      break;
+
+    case NodeKind::If:
+    {
+      IfNode* node = static_cast<IfNode*>(abstractNode);
+      node->mCondition = children.Get<ExpressionNode>(0);
+      node->mScope = children.Get<ScopeNode>(1);
+      node->mElse = children.Get<IfNode>(2);
+      break;
+    }
+
+    case NodeKind::While:
+    {
+      WhileNode* node = static_cast<WhileNode*>(abstractNode);
+      node->mCondition = children.Get<ExpressionNode>(0);
+      node->mScope = children.Get<ScopeNode>(1);
+      break;
+    }
+
+    case NodeKind::For:
+    {
+      ForNode* node = static_cast<ForNode*>(abstractNode);
+      node->mInitialVariable = children.Get<VariableNode>(0);
+      node->mInitialExpression = children.Get<ExpressionNode>(1);
+      node->mCondition = children.Get<ExpressionNode>(2);
+      node->mIterator = children.Get<ExpressionNode>(3);
+      node->mScope = children.Get<ScopeNode>(4);
+      break;
+    }
+
+    case NodeKind::BinaryOperator:
+    {
+      BinaryOperatorNode* node = static_cast<BinaryOperatorNode*>(abstractNode);
+      node->mLeft = children.Get<ExpressionNode>(0);
+      node->mRight = children.Get<ExpressionNode>(1);
+      break;
+    }
+
+    case NodeKind::UnaryOperator:
+      static_cast<UnaryOperatorNode*>(abstractNode)->mRight = children.Get<ExpressionNode>(0);
+      break;
+
+    case NodeKind::MemberAccess:
+      static_cast<MemberAccessNode*>(abstractNode)->mLeft = children.Get<ExpressionNode>(0);
+      break;
+
+    case NodeKind::Call:
+    {
+      CallNode* node = static_cast<CallNode*>(abstractNode);
+      node->mLeft = children.Get<ExpressionNode>(0);
+      children.GetAll(1, children.Count(), node->mArguments);
+      break;
+    }
+
+    case NodeKind::Cast:
+    {
+      CastNode* node = static_cast<CastNode*>(abstractNode);
+      node->mLeft = children.Get<ExpressionNode>(0);
+      node->mType = children.Get<TypeNode>(1);
+      break;
+    }
+
+    case NodeKind::Index:
+    {
+      IndexNode* node = static_cast<IndexNode*>(abstractNode);
+      node->mLeft = children.Get<ExpressionNode>(0);
+      node->mIndex = children.Get<ExpressionNode>(1);
+      break;
+    }
+
+    default:
+      break;
+  }
+}
+
+AstPtr<AbstractNode> Inflate(const FlatAst& flat, std::vector<AbstractNode*>* nodesOut)
+{
+  if (flat.mNodes.empty())
+    return nullptr;
+
+  std::unique_ptr<AstArena> arena(new AstArena());
+  std::vector<AbstractNode*> nodes(flat.mNodes.size());
+
+  // Every node is created before any are linked, so a child never has to exist before its parent
+  for (uint32_t i = 0; i < nodes.size(); ++i)
+    nodes[i] = CreateNode(*arena, flat, i);
+
+  for (uint32_t i = 0; i < nodes.size(); ++i)
+    LinkNode(flat, nodes, i);
+
+  // The root owns the arena from here on
+  arena->SetRoot(nodes[0]);
+  AstPtr<AbstractNode> root(nodes[0]);
+  arena.release();
+
+  if (nodesOut)
+    nodesOut->swap(nodes);
+
+  return root;
+}
+
+void StoreSymbols(FlatAst& flat, const std::vector<AbstractNode*>& nodes)
+{
+  for (uint32_t i = 0; i < nodes.size(); ++i)
+  {
+    Symbol*& symbol = flat.mSymbols[i];
+    Type*& type = flat.mTypes[i];
+
+    switch (flat.mNodes[i].mKind)
+    {
+      case NodeKind::Class:
+        symbol = static_cast<ClassNode*>(nodes[i])->mSymbol;
+        break;
+
+      case NodeKind::Variable:
+      case NodeKind::Parameter:
+        symbol = static_cast<VariableNode*>(nodes[i])->mSymbol;
+        break;
+
+      case NodeKind::Function:
+        symbol = static_cast<FunctionNode*>(nodes[i])->mSymbol;
+        type = static_cast<FunctionNode*>(nodes[i])->mSignatureType;
+        break;
+
+      case NodeKind::Type:
+        symbol = static_cast<TypeNode*>(nodes[i])->mSymbol;
+        break;
+
+      case NodeKind::Label:
+        symbol = static_cast<LabelNode*>(nodes[i])->mSymbol;
+        break;
+
+      case NodeKind::Goto:
+        symbol = static_cast<GotoNode*>(nodes[i])->mResolvedLabel;
+        break;
+
+      case NodeKind::MemberAccess:
+        symbol = static_cast<MemberAccessNode*>(nodes[i])->mResolvedMember;
+        type = static_cast<ExpressionNode*>(nodes[i])->mResolvedType;
+        break;
+
+      case NodeKind::Value:
+        symbol = static_cast<ValueNode*>(nodes[i])->mResolvedSymbol;
+        type = static_cast<ExpressionNode*>(nodes[i])->mResolvedType;
+        break;
+
+      case NodeKind::BinaryOperator:
+      case NodeKind::UnaryOperator:
+      case NodeKind::Call:
+      case NodeKind::Cast:
+      case NodeKind::Index:
+        type = static_cast<ExpressionNode*>(nodes[i])->mResolvedType;
+        break;
+
+      default:
+        break;
+    }
+  }
+}
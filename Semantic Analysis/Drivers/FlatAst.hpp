@@ -0,0 +1,82 @@
+/******************************************************************\
+ * Copyright 2015, DigiPen Institute of Technology
+\******************************************************************/
+
+#pragma once
+#ifndef COMPILER_CLASS_FLAT_AST
+#define COMPILER_CLASS_FLAT_AST
+
+#include "AstNodes.hpp"
+#include <cstdint>
+
+// One node of a FlatAst
+class FlatNode
+{
+public:
+  // A NodeKind::Enum
+  uint8_t mKind;
+
+  // Index of the parent node (FlatAst::None for the root)
+  uint32_t mParent;
+
+  // The node's child slots are mChildren[mFirstChild] to mChildren[mFirstChild + mChildCount - 1]
+  uint32_t mFirstChild;
+  uint32_t mChildCount;
+
+  // Index of the node's first token in mTokens (FlatAst::None when it has none)
+  // A MemberAccess has two tokens, the operator then the name
+  uint32_t mToken;
+
+  // The pointer count of a Type, or the index of an Error's message in mMessages
+  uint32_t mExtra;
+};
+
+// An AST stored as one contiguous array of nodes that refer to each other with 32-bit indices
+// Node 0 is the root, and the nodes are in the order that Walk visits them
+// Child slots hold node indices (FlatAst::None for a missing optional child), in this order by kind:
+//   Block: the globals                    Class: the members
+//   Variable, Parameter: type, initial value
+//   Scope: the statements                 Function: the parameters, return type, scope
+//   Return: return value                  If: condition, scope, else
+//   While: condition, scope               For: initial variable, initial expression, condition, iterator, scope
+//   BinaryOperator: left, right           UnaryOperator: right
+//   MemberAccess: left                    Call: left, the arguments
+//   Cast: left, type                      Index: left, index
+class FlatAst
+{
+public:
+  static const uint32_t None = 0xFFFFFFFF;
+
+  // The index of the node in one of a node's child slots (None if the slot is empty)
+  uint32_t GetChild(uint32_t node, uint32_t slot) const;
+
+  std::vector<FlatNode> mNodes;
+  std::vector<uint32_t> mChildren;
+  std::vector<Token> mTokens;
+  std::vector<std::string> mMessages;
+
+  //* Semantic Analysis *//
+  // Side tables indexed like mNodes (null where a node has nothing resolved)
+  // The symbol a node created (Class, Type, Variable, Parameter, Function, Label) or resolved to (Goto, MemberAccess, Value)
+  std::vector<Symbol*> mSymbols;
+  // The resolved type of an expression, or the signature type of a Function
+  std::vector<Type*> mTypes;
+};
+
+// Builds the flat form of a tree, including anything semantic analysis has already resolved on it
+// Walks the tree with a worklist, so trees of any depth can be flattened
+void Flatten(AbstractNode* root, FlatAst& flat);
+
+// Rebuilds a tree of regular nodes from the flat form, so that the existing Visitor passes can run on it
+// The nodes are created in a single arena in the order Walk visits them, which keeps a walk moving forward in memory
+// If nodes is given it receives the node that was created for each flat node (by index)
+AstPtr<AbstractNode> Inflate(const FlatAst& flat, std::vector<AbstractNode*>* nodes = nullptr);
+
+// Copies what passes resolved on an inflated tree back into the side tables of the flat form
+void StoreSymbols(FlatAst& flat, const std::vector<AbstractNode*>& nodes);
+
+// Prints the same text that PrintTree prints for the tree the flat form was made from
+// Reads the node arrays directly (with a worklist), so no tree has to be inflated first
+void PrintTree(const FlatAst& flat);
+
+#endif
@@ -0,0 +1,1164 @@
+/******************************************************************\
+ * Copyright 2015, DigiPen Institute of Technology
+\******************************************************************/
+
+#include "Interpreter.hpp"
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+  // The interpreter's stack, which every frame (and any class value a call returns) comes out of
+  const size_t StackSize = 1024 * 1024;
+
+  // Every interpreted call also nests several calls on the host's stack, so recursion is stopped well before that runs out
+  const size_t MaxCallDepth = 512;
+
+  void ErrorExecution(const std::string& error)
+  {
+    throw ExecutionException(error);
+  }
+
+  double ToDouble(const RuntimeValue& value)
+  {
+    if (value.mType == FloatType)
+      return value.mFloat;
+    if (value.mType == IntegerType)
+      return value.mInteger;
+    if (value.mType == ByteType)
+      return value.mByte;
+    return value.mBoolean ? 1.0 : 0.0;
+  }
+
+  int64_t ToInteger(const RuntimeValue& value)
+  {
+    if (value.mType == IntegerType)
+      return value.mInteger;
+    if (value.mType == ByteType)
+      return value.mByte;
+    if (value.mType == BooleanType)
+      return value.mBoolean ? 1 : 0;
+    return (int64_t)(intptr_t)value.mPointer;
+  }
+
+  size_t AlignUp(size_t offset, size_t alignment)
+  {
+    return (offset + alignment - 1) & ~(alignment - 1);
+  }
+}
+
+bool IsPointer(Type* type)
+{
+  return type->mMode == TypeMode::Pointer || type == NullType;
+}
+
+bool IsArithmetic(Type* type)
+{
+  return type == IntegerType || type == FloatType || type == ByteType;
+}
+
+bool IsPrimitive(Type* type)
+{
+  return IsArithmetic(type) || type == BooleanType;
+}
+
+bool IsClass(Type* type)
+{
+  return type->mMode == TypeMode::Class && !IsPrimitive(type) && type != VoidType && type != NullType;
+}
+
+int32_t FloatToInteger(float value)
+{
+  if (value != value)
+    return 0;
+  if (value >= 2147483647.0f)
+    return INT_MAX;
+  if (value <= -2147483648.0f)
+    return INT_MIN;
+  return (int32_t)value;
+}
+
+std::string Unescape(const char* text, size_t length)
+{
+  std::string result;
+  for (size_t i = 0; i < length; ++i)
+  {
+    char c = text[i];
+    if (c == '\\' && i + 1 < length)
+    {
+      c = text[++i];
+      switch (c)
+      {
+        case 'n': c = '\n'; break;
+        case 'r': c = '\r'; break;
+        case 't': c = '\t'; break;
+        case '0': c = '\0'; break;
+      }
+    }
+    result += c;
+  }
+  return result;
+}
+
+ExecutionException::ExecutionException(const std::string& error) :
+  mError(error)
+{
+}
+
+const char* ExecutionException::what() const
+{
+  return mError.c_str();
+}
+
+RuntimeValue::RuntimeValue() :
+  mType(VoidType),
+  mPointer(nullptr)
+{
+}
+
+RuntimeValue RuntimeValue::MakeInteger(int32_t value)
+{
+  RuntimeValue result;
+  result.mType = IntegerType;
+  result.mInteger = value;
+  return result;
+}
+
+RuntimeValue RuntimeValue::MakeFloat(float value)
+{
+  RuntimeValue result;
+  result.mType = FloatType;
+  result.mFloat = value;
+  return result;
+}
+
+RuntimeValue RuntimeValue::MakeBoolean(bool value)
+{
+  RuntimeValue result;
+  result.mType = BooleanType;
+  result.mBoolean = value;
+  return result;
+}
+
+RuntimeValue RuntimeValue::MakeByte(uint8_t value)
+{
+  RuntimeValue result;
+  result.mType = ByteType;
+  result.mByte = value;
+  return result;
+}
+
+Interpreter::Interpreter() :
+  mStack(new char[StackSize]),
+  mStackTop(0),
+  mGotoLabel(nullptr)
+{
+}
+
+Interpreter::~Interpreter()
+{
+}
+
+void Interpreter::Load(BlockNode* block)
+{
+  size_t top = mStackTop;
+  try
+  {
+    for (size_t i = 0; i < block->mGlobals.size(); ++i)
+    {
+      AbstractNode* global = block->mGlobals[i].get();
+      if (global->mKind == NodeKind::Function)
+      {
+        FunctionNode* node = static_cast<FunctionNode*>(global);
+        mFunctions[node->mSymbol->mAtom] = node->mSymbol;
+        mFunctionNodes[node->mSymbol] = node;
+      }
+      else if (global->mKind == NodeKind::Class)
+      {
+        ClassNode* node = static_cast<ClassNode*>(global);
+        for (size_t j = 0; j < node->mMembers.size(); ++j)
+        {
+          if (node->mMembers[j]->mKind == NodeKind::Function)
+          {
+            FunctionNode* member = static_cast<FunctionNode*>(node->mMembers[j].get());
+            mFunctionNodes[member->mSymbol] = member;
+          }
+        }
+      }
+      else if (global->mKind == NodeKind::Variable)
+      {
+        ExecuteVariable(static_cast<VariableNode*>(global));
+        mStackTop = top;
+      }
+    }
+  }
+  catch (...)
+  {
+    mFrames.clear();
+    mStackTop = top;
+    throw;
+  }
+}
+
+Function* Interpreter::FindFunction(const std::string& name) const
+{
+  std::unordered_map<Atom, Function*>::const_iterator it = mFunctions.find(InternString(name));
+  if (it == mFunctions.end())
+    return nullptr;
+  return it->second;
+}
+
+RuntimeValue Interpreter::Call(Function* function, const std::vector<RuntimeValue>& arguments)
+{
+  size_t frames = mFrames.size();
+  size_t top = mStackTop;
+  try
+  {
+    std::vector<RuntimeValue> copy(arguments);
+    return Invoke(function, copy.data(), copy.size());
+  }
+  catch (...)
+  {
+    mFrames.resize(frames);
+    mStackTop = top;
+    throw;
+  }
+}
+
+#pragma region Layout
+const MemoryLayout::TypeLayout& MemoryLayout::GetTypeLayout(Type* type)
+{
+  std::unordered_map<Type*, TypeLayout>::iterator found = mTypeLayouts.find(type);
+  if (found != mTypeLayouts.end())
+  {
+    if (found->second.mInProgress)
+      ErrorExecution("The class '" + type->mName + "' contains itself");
+    return found->second;
+  }
+
+  TypeLayout& layout = mTypeLayouts[type];
+  layout.mInProgress = true;
+  layout.mSize = 0;
+  layout.mAlignment = 1;
+
+  if (type == IntegerType || type == FloatType)
+  {
+    layout.mSize = layout.mAlignment = 4;
+  }
+  else if (type == BooleanType || type == ByteType)
+  {
+    layout.mSize = layout.mAlignment = 1;
+  }
+  else if (IsPointer(type))
+  {
+    layout.mSize = layout.mAlignment = sizeof(char*);
+  }
+  else if (type->mMode == TypeMode::Function)
+  {
+    layout.mSize = layout.mAlignment = sizeof(Function*);
+  }
+  else if (type->mClass != nullptr)
+  {
+    // Member variables in order, each on its own alignment (member functions take no room)
+    size_t size = 0;
+    size_t alignment = 1;
+    for (size_t i = 0; i < type->mClass->mMembers.size(); ++i)
+    {
+      Variable* member = dynamic_cast<Variable*>(type->mClass->mMembers[i]);
+      if (member == nullptr)
+        continue;
+
+      const TypeLayout& memberLayout = GetTypeLayout(member->mType);
+      size = AlignUp(size, memberLayout.mAlignment);
+      mMemberOffsets[member] = size;
+      size += memberLayout.mSize;
+      if (memberLayout.mAlignment > alignment)
+        alignment = memberLayout.mAlignment;
+    }
+
+    layout.mSize = AlignUp(size, alignment);
+    layout.mAlignment = alignment;
+  }
+
+  layout.mInProgress = false;
+  return layout;
+}
+
+size_t MemoryLayout::GetSize(Type* type)
+{
+  return GetTypeLayout(type).mSize;
+}
+
+size_t MemoryLayout::GetAlignment(Type* type)
+{
+  return GetTypeLayout(type).mAlignment;
+}
+
+size_t MemoryLayout::GetMemberOffset(Variable* member)
+{
+  std::unordered_map<Variable*, size_t>::iterator it = mMemberOffsets.find(member);
+  if (it != mMemberOffsets.end())
+    return it->second;
+
+  // Laying out the class finds the offsets of all of its members
+  GetTypeLayout(member->mParentType);
+  return mMemberOffsets[member];
+}
+
+Interpreter::FunctionLayout& Interpreter::GetFunctionLayout(Function* function)
+{
+  std::unordered_map<Function*, FunctionLayout>::iterator found = mFunctionLayouts.find(function);
+  if (found != mFunctionLayouts.end())
+    return found->second;
+
+  std::unordered_map<Function*, FunctionNode*>::iterator body = mFunctionNodes.find(function);
+  if (body == mFunctionNodes.end())
+    ErrorExecution("The function '" + function->mName + "' has no body to run");
+  FunctionNode* node = body->second;
+
+  // Every local gets its own place in the frame (locals of scopes that don't overlap could share, but frames are small)
+  FunctionLayout& layout = mFunctionLayouts[function];
+  layout.mNode = node;
+  size_t size = 0;
+  for (size_t i = 0; i < function->mLocals.size(); ++i)
+  {
+    Variable* local = dynamic_cast<Variable*>(function->mLocals[i]);
+    if (local == nullptr)
+      continue;
+
+    size = AlignUp(size, mMemory.GetAlignment(local->mType));
+    layout.mOffsets[local] = size;
+    size += mMemory.GetSize(local->mType);
+  }
+
+  layout.mSize = AlignUp(size, sizeof(char*));
+  return layout;
+}
+
+char* Interpreter::AllocateStack(size_t size)
+{
+  size_t base = AlignUp(mStackTop, sizeof(char*));
+  if (base + size > StackSize)
+    ErrorExecution("The stack overflowed");
+
+  mStackTop = base + size;
+  return mStack.get() + base;
+}
+#pragma endregion
+
+#pragma region Statements
+Interpreter::ExecutionResult Interpreter::Execute(StatementNode* statement)
+{
+  switch (statement->mKind)
+  {
+    case NodeKind::Variable:
+      ExecuteVariable(static_cast<VariableNode*>(statement));
+      return Normal;
+
+    case NodeKind::Scope:
+      return ExecuteScope(static_cast<ScopeNode*>(statement));
+
+    case NodeKind::If:
+    {
+      // An else is an IfNode without a condition, and an else if is one with
+      for (IfNode* node = static_cast<IfNode*>(statement); node != nullptr; node = node->mElse.get())
+      {
+        if (node->mCondition == nullptr || IsTrue(Evaluate(node->mCondition.get())))
+          return ExecuteScope(node->mScope.get());
+      }
+      return Normal;
+    }
+
+    case NodeKind::While:
+    {
+      WhileNode* node = static_cast<WhileNode*>(statement);
+      for (;;)
+      {
+        size_t top = mStackTop;
+        bool condition = IsTrue(Evaluate(node->mCondition.get()));
+        mStackTop = top;
+        if (!condition)
+          return Normal;
+
+        ExecutionResult result = ExecuteScope(node->mScope.get());
+        if (result == Break)
+          return Normal;
+        if (result == Return || result == Goto)
+          return result;
+      }
+    }
+
+    case NodeKind::For:
+    {
+      ForNode* node = static_cast<ForNode*>(statement);
+      if (node->mInitialVariable)
+        ExecuteVariable(node->mInitialVariable.get());
+      else if (node->mInitialExpression)
+        Evaluate(node->mInitialExpression.get());
+
+      for (;;)
+      {
+        size_t top = mStackTop;
+        if (node->mCondition && !IsTrue(Evaluate(node->mCondition.get())))
+        {
+          mStackTop = top;
+          return Normal;
+        }
+        mStackTop = top;
+
+        ExecutionResult result = ExecuteScope(node->mScope.get());
+        if (result == Break)
+          return Normal;
+        if (result == Return || result == Goto)
+          return result;
+
+        if (node->mIterator)
+          Evaluate(node->mIterator.get());
+        mStackTop = top;
+      }
+    }
+
+    case NodeKind::Label:
+      return Normal;
+
+    case NodeKind::Goto:
+    {
+      GotoNode* node = static_cast<GotoNode*>(statement);
+      if (node->mResolvedLabel == nullptr)
+        ErrorExecution("A goto was unable to find the label " + node->mName.str());
+      mGotoLabel = node->mResolvedLabel;
+      return Goto;
+    }
+
+    case NodeKind::Return:
+    {
+      ReturnNode* node = static_cast<ReturnNode*>(statement);
+      if (node->mReturnValue)
+        mReturnValue = Evaluate(node->mReturnValue.get());
+      else
+        mReturnValue = RuntimeValue();
+      return Return;
+    }
+
+    case NodeKind::Break:
+      return Break;
+
+    case NodeKind::Continue:
+      return Continue;
+
+    case NodeKind::Error:
+      ErrorExecution("Unable to run a statement that failed to parse: " + static_cast<ErrorNode*>(statement)->mMessage);
+      return Normal;
+
+    default:
+      Evaluate(static_cast<ExpressionNode*>(statement));
+      return Normal;
+  }
+}
+
+Interpreter::ExecutionResult Interpreter::ExecuteScope(ScopeNode* scope)
+{
+  size_t count = scope->mStatements.size();
+  for (size_t i = 0; i < count; ++i)
+  {
+    // Anything a statement left on the stack (the class values calls return) is done with once the statement is
+    size_t top = mStackTop;
+    ExecutionResult result = Execute(scope->mStatements[i].get());
+    mStackTop = top;
+    if (result == Normal)
+      continue;
+
+    // A goto can jump to a label in its own scope or any scope around it (but not into a nested one)
+    if (result == Goto)
+    {
+      size_t label = 0;
+      while (label < count && !(scope->mStatements[label]->mKind == NodeKind::Label &&
+        static_cast<LabelNode*>(scope->mStatements[label].get())->mSymbol == mGotoLabel))
+        ++label;
+
+      if (label < count)
+      {
+        i = label;
+        continue;
+      }
+    }
+
+    return result;
+  }
+
+  return Normal;
+}
+
+void Interpreter::ExecuteVariable(VariableNode* variable)
+{
+  Variable* symbol = variable->mSymbol;
+  char* address = GetVariableAddress(symbol);
+  if (variable->mInitialValue)
+    StoreValue(address, symbol->mType, Evaluate(variable->mInitialValue.get()));
+  else
+    memset(address, 0, mMemory.GetSize(symbol->mType));
+}
+
+RuntimeValue Interpreter::Invoke(Function* function, RuntimeValue* arguments, size_t count)
+{
+  FunctionLayout& layout = GetFunctionLayout(function);
+  FunctionNode* node = layout.mNode;
+  if (count != node->mParameters.size())
+    ErrorExecution("The function '" + function->mName + "' was called with the wrong number of arguments");
+  if (mFrames.size() >= MaxCallDepth)
+    ErrorExecution("The call stack overflowed");
+
+  size_t top = mStackTop;
+  char* base = AllocateStack(layout.mSize);
+  memset(base, 0, layout.mSize);
+
+  // The arguments are all evaluated by now, so the new frame can't change them
+  for (size_t i = 0; i < count; ++i)
+  {
+    Variable* parameter = node->mParameters[i]->mSymbol;
+    StoreValue(base + layout.mOffsets[parameter], parameter->mType, arguments[i]);
+  }
+
+  Frame frame;
+  frame.mLayout = &layout;
+  frame.mBase = base;
+  mFrames.push_back(frame);
+
+  ExecutionResult result = ExecuteScope(node->mScope.get());
+  if (result == Goto)
+    ErrorExecution("A goto can only jump to a label in its own scope or a scope around it");
+
+  Type* returnType = function->mType->mFunction->mReturnType;
+  RuntimeValue value;
+  if (returnType != nullptr && returnType != VoidType)
+  {
+    if (result != Return || mReturnValue.mType == VoidType)
+      ErrorExecution("The function '" + function->mName + "' ended without returning a value");
+    value = ConvertValue(mReturnValue, returnType);
+  }
+
+  mFrames.pop_back();
+  mStackTop = top;
+
+  // A class value still lives in the frame we just gave back, so it moves down to where the frame started
+  if (IsClass(value.mType))
+  {
+    size_t size = mMemory.GetSize(value.mType);
+    char* copy = AllocateStack(size);
+    memmove(copy, value.mPointer, size);
+    value.mPointer = copy;
+  }
+
+  return value;
+}
+#pragma endregion
+
+#pragma region Expressions
+RuntimeValue Interpreter::Evaluate(ExpressionNode* expression)
+{
+  switch (expression->mKind)
+  {
+    case NodeKind::Value:
+      return EvaluateValue(static_cast<ValueNode*>(expression));
+
+    case NodeKind::BinaryOperator:
+      return EvaluateBinary(static_cast<BinaryOperatorNode*>(expression));
+
+    case NodeKind::UnaryOperator:
+      return EvaluateUnary(static_cast<UnaryOperatorNode*>(expression));
+
+    case NodeKind::Call:
+      return EvaluateCall(static_cast<CallNode*>(expression));
+
+    case NodeKind::Cast:
+      return EvaluateCast(static_cast<CastNode*>(expression));
+
+    case NodeKind::MemberAccess:
+    {
+      MemberAccessNode* node = static_cast<MemberAccessNode*>(expression);
+      Symbol* member = node->mResolvedMember;
+
+      // Member functions don't take the object, but whatever it came from still runs
+      if (member->mType->mMode == TypeMode::Function)
+      {
+        Evaluate(node->mLeft.get());
+        RuntimeValue result;
+        result.mType = member->mType;
+        result.mFunction = static_cast<Function*>(member);
+        return result;
+      }
+
+      Type* type = nullptr;
+      char* address = EvaluateAddress(node, type);
+      return LoadValue(address, type);
+    }
+
+    case NodeKind::Index:
+    {
+      Type* type = nullptr;
+      char* address = EvaluateAddress(expression, type);
+      return LoadValue(address, type);
+    }
+
+    default:
+      ErrorExecution("Unable to run an expression of this kind");
+      return RuntimeValue();
+  }
+}
+
+RuntimeValue Interpreter::EvaluateValue(ValueNode* node)
+{
+  const Token& token = node->mToken;
+  switch (token.mEnumTokenType)
+  {
+    // A literal always ends before the end of the source, so parsing it stops at its last character
+    case TokenType::IntegerLiteral:
+      return RuntimeValue::MakeInteger((int32_t)strtoll(token.mText, nullptr, 10));
+
+    case TokenType::FloatLiteral:
+      return RuntimeValue::MakeFloat((float)strtod(token.mText, nullptr));
+
+    case TokenType::True:
+      return RuntimeValue::MakeBoolean(true);
+
+    case TokenType::False:
+      return RuntimeValue::MakeBoolean(false);
+
+    case TokenType::Null:
+    {
+      RuntimeValue result;
+      result.mType = NullType;
+      return result;
+    }
+
+    case TokenType::CharacterLiteral:
+    {
+      std::string text = Unescape(token.mText + 1, token.mLength - 2);
+      return RuntimeValue::MakeByte(text.empty() ? 0 : (uint8_t)text[0]);
+    }
+
+    case TokenType::StringLiteral:
+    {
+      std::unordered_map<ValueNode*, std::string>::iterator it = mStrings.find(node);
+      if (it == mStrings.end())
+        it = mStrings.insert(std::make_pair(node, Unescape(token.mText + 1, token.mLength - 2))).first;
+
+      RuntimeValue result;
+      result.mType = node->mResolvedType;
+      result.mPointer = &it->second[0];
+      return result;
+    }
+
+    case TokenType::Identifier:
+    {
+      Symbol* symbol = node->mResolvedSymbol;
+      if (symbol == nullptr)
+        ErrorExecution("The symbol '" + token.str() + "' was not found");
+
+      if (symbol->mType->mMode == TypeMode::Function)
+      {
+        RuntimeValue result;
+        result.mType = symbol->mType;
+        result.mFunction = static_cast<Function*>(symbol);
+        return result;
+      }
+
+      Variable* variable = static_cast<Variable*>(symbol);
+      return LoadValue(GetVariableAddress(variable), variable->mType);
+    }
+
+    default:
+      ErrorExecution("Unable to run the value '" + token.str() + "'");
+      return RuntimeValue();
+  }
+}
+
+RuntimeValue Interpreter::EvaluateBinary(BinaryOperatorNode* node)
+{
+  // The parser hangs the left hand side off of mRight and the right hand side off of mLeft
+  ExpressionNode* leftNode = node->mRight.get();
+  ExpressionNode* rightNode = node->mLeft.get();
+
+  TokenType::Enum op = node->mOperator.mEnumTokenType;
+  switch (op)
+  {
+    case TokenType::Assignment:
+    {
+      Type* type = nullptr;
+      char* address = EvaluateAddress(leftNode, type);
+      StoreValue(address, type, Evaluate(rightNode));
+      return LoadValue(address, type);
+    }
+
+    case TokenType::LogicalAnd:
+      return RuntimeValue::MakeBoolean(IsTrue(Evaluate(leftNode)) && IsTrue(Evaluate(rightNode)));
+
+    case TokenType::LogicalOr:
+      return RuntimeValue::MakeBoolean(IsTrue(Evaluate(leftNode)) || IsTrue(Evaluate(rightNode)));
+
+    default:
+      break;
+  }
+
+  RuntimeValue left = Evaluate(leftNode);
+  RuntimeValue right = Evaluate(rightNode);
+
+  switch (op)
+  {
+    case TokenType::LessThan:
+    case TokenType::GreaterThan:
+    case TokenType::LessThanOrEqualTo:
+    case TokenType::GreaterThanOrEqualTo:
+    case TokenType::Equality:
+    case TokenType::Inequality:
+    {
+      int comparison = 0;
+      if (IsPointer(left.mType) || IsPointer(right.mType))
+      {
+        int64_t a = ToInteger(left);
+        int64_t b = ToInteger(right);
+        comparison = a < b ? -1 : a > b ? 1 : 0;
+      }
+      else if (IsPrimitive(left.mType) && IsPrimitive(right.mType))
+      {
+        if (left.mType == FloatType || right.mType == FloatType)
+        {
+          double a = ToDouble(left);
+          double b = ToDouble(right);
+          // Any comparison with NaN is false, except that it isn't equal
+          if (a != a || b != b)
+            return RuntimeValue::MakeBoolean(op == TokenType::Inequality);
+          comparison = a < b ? -1 : a > b ? 1 : 0;
+        }
+        else
+        {
+          int64_t a = ToInteger(left);
+          int64_t b = ToInteger(right);
+          comparison = a < b ? -1 : a > b ? 1 : 0;
+        }
+      }
+      else if (IsClass(left.mType) && left.mType == right.mType && (op == TokenType::Equality || op == TokenType::Inequality))
+      {
+        comparison = memcmp(left.mPointer, right.mPointer, mMemory.GetSize(left.mType)) != 0;
+      }
+      else
+      {
+        ErrorExecution("Unable to compare '" + left.mType->mName + "' with '" + right.mType->mName + "'");
+      }
+
+      switch (op)
+      {
+        case TokenType::LessThan:             return RuntimeValue::MakeBoolean(comparison < 0);
+        case TokenType::GreaterThan:          return RuntimeValue::MakeBoolean(comparison > 0);
+        case TokenType::LessThanOrEqualTo:    return RuntimeValue::MakeBoolean(comparison <= 0);
+        case TokenType::GreaterThanOrEqualTo: return RuntimeValue::MakeBoolean(comparison >= 0);
+        case TokenType::Equality:             return RuntimeValue::MakeBoolean(comparison == 0);
+        default:                              return RuntimeValue::MakeBoolean(comparison != 0);
+      }
+    }
+
+    case TokenType::Plus:
+    case TokenType::Minus:
+    {
+      // Pointers move a whole element at a time, and two pointers are apart by some number of elements
+      if (IsPointer(left.mType) && IsPointer(right.mType) && op == TokenType::Minus)
+      {
+        size_t size = mMemory.GetSize(left.mType->mPointerToType);
+        ptrdiff_t difference = left.mPointer - right.mPointer;
+        return RuntimeValue::MakeInteger((int32_t)(size ? difference / (ptrdiff_t)size : difference));
+      }
+
+      if (IsPointer(left.mType) != IsPointer(right.mType))
+      {
+        RuntimeValue pointer = IsPointer(left.mType) ? left : right;
+        RuntimeValue offset = IsPointer(left.mType) ? right : left;
+        if (!IsPrimitive(offset.mType) || pointer.mType == NullType || (op == TokenType::Minus && !IsPointer(left.mType)))
+          ErrorExecution("The binary operator '" + node->mOperator.str() + "' is not valid between '" + left.mType->mName + "' and '" + right.mType->mName + "'");
+
+        ptrdiff_t elements = (ptrdiff_t)ToInteger(offset);
+        ptrdiff_t bytes = elements * (ptrdiff_t)mMemory.GetSize(pointer.mType->mPointerToType);
+        pointer.mPointer += op == TokenType::Plus ? bytes : -bytes;
+        return pointer;
+      }
+      break;
+    }
+
+    default:
+      break;
+  }
+
+  if (!IsArithmetic(left.mType) || !IsArithmetic(right.mType))
+    ErrorExecution("The binary operator '" + node->mOperator.str() + "' is not valid between '" + left.mType->mName + "' and '" + right.mType->mName + "'");
+
+  // Mixed operands (which only initial values let through) work in the wider of the two
+  if (left.mType == FloatType || right.mType == FloatType)
+  {
+    float a = (float)ToDouble(left);
+    float b = (float)ToDouble(right);
+    switch (op)
+    {
+      case TokenType::Plus:     return RuntimeValue::MakeFloat(a + b);
+      case TokenType::Minus:    return RuntimeValue::MakeFloat(a - b);
+      case TokenType::Asterisk: return RuntimeValue::MakeFloat(a * b);
+      case TokenType::Divide:   return RuntimeValue::MakeFloat(a / b);
+      case TokenType::Modulo:   return RuntimeValue::MakeFloat(fmodf(a, b));
+      default: break;
+    }
+  }
+  else
+  {
+    // Integers wrap around instead of overflowing, the same as the machine does
+    uint32_t a = (uint32_t)ToInteger(left);
+    uint32_t b = (uint32_t)ToInteger(right);
+    uint32_t result = 0;
+    switch (op)
+    {
+      case TokenType::Plus:     result = a + b; break;
+      case TokenType::Minus:    result = a - b; break;
+      case TokenType::Asterisk: result = a * b; break;
+      case TokenType::Divide:
+      case TokenType::Modulo:
+      {
+        int32_t dividend = (int32_t)a;
+        int32_t divisor = (int32_t)b;
+        if (left.mType == ByteType && right.mType == ByteType)
+        {
+          dividend = (uint8_t)a;
+          divisor = (uint8_t)b;
+        }
+
+        if (divisor == 0)
+          ErrorExecution("Division by zero");
+
+        if (divisor == -1)
+          result = op == TokenType::Divide ? 0u - a : 0u;
+        else
+          result = (uint32_t)(op == TokenType::Divide ? dividend / divisor : dividend % divisor);
+        break;
+      }
+      default:
+        ErrorExecution("The binary operator '" + node->mOperator.str() + "' is not valid between '" + left.mType->mName + "' and '" + right.mType->mName + "'");
+    }
+
+    if (left.mType == ByteType && right.mType == ByteType)
+      return RuntimeValue::MakeByte((uint8_t)result);
+    return RuntimeValue::MakeInteger((int32_t)result);
+  }
+
+  ErrorExecution("The binary operator '" + node->mOperator.str() + "' is not valid between '" + left.mType->mName + "' and '" + right.mType->mName + "'");
+  return RuntimeValue();
+}
+
+RuntimeValue Interpreter::EvaluateUnary(UnaryOperatorNode* node)
+{
+  switch (node->mOperator.mEnumTokenType)
+  {
+    case TokenType::Asterisk:
+    {
+      Type* type = nullptr;
+      char* address = EvaluateAddress(node, type);
+      return LoadValue(address, type);
+    }
+
+    case TokenType::BitwiseAndAddressOf:
+    {
+      Type* type = nullptr;
+      RuntimeValue result;
+      result.mPointer = EvaluateAddress(node->mRight.get(), type);
+      result.mType = node->mResolvedType;
+      return result;
+    }
+
+    case TokenType::Increment:
+    case TokenType::Decrement:
+    {
+      Type* type = nullptr;
+      char* address = EvaluateAddress(node->mRight.get(), type);
+      RuntimeValue value = LoadValue(address, type);
+      int step = node->mOperator.mEnumTokenType == TokenType::Increment ? 1 : -1;
+
+      if (type == IntegerType)
+        value.mInteger = (int32_t)((uint32_t)value.mInteger + (uint32_t)step);
+      else if (type == FloatType)
+        value.mFloat += step;
+      else if (type == ByteType)
+        value.mByte = (uint8_t)(value.mByte + step);
+      else if (type->mMode == TypeMode::Pointer)
+        value.mPointer += step * (ptrdiff_t)mMemory.GetSize(type->mPointerToType);
+      else
+        ErrorExecution("The unary operator '" + node->mOperator.str() + "' is not valid with the type '" + type->mName + "'");
+
+      StoreValue(address, type, value);
+      return value;
+    }
+
+    default:
+      break;
+  }
+
+  RuntimeValue value = Evaluate(node->mRight.get());
+  switch (node->mOperator.mEnumTokenType)
+  {
+    case TokenType::Plus:
+      if (IsArithmetic(value.mType))
+        return value;
+      break;
+
+    case TokenType::Minus:
+      if (value.mType == IntegerType)
+        return RuntimeValue::MakeInteger((int32_t)(0u - (uint32_t)value.mInteger));
+      if (value.mType == FloatType)
+        return RuntimeValue::MakeFloat(-value.mFloat);
+      if (value.mType == ByteType)
+        return RuntimeValue::MakeByte((uint8_t)-value.mByte);
+      break;
+
+    case TokenType::LogicalNot:
+      return RuntimeValue::MakeBoolean(!IsTrue(value));
+
+    default:
+      break;
+  }
+
+  ErrorExecution("The unary operator '" + node->mOperator.str() + "' is not valid with the type '" + value.mType->mName + "'");
+  return RuntimeValue();
+}
+
+RuntimeValue Interpreter::EvaluateCall(CallNode* node)
+{
+  RuntimeValue callee = Evaluate(node->mLeft.get());
+  if (callee.mType->mMode != TypeMode::Function)
+    ErrorExecution("Attempting to perform a call on a type '" + callee.mType->mName + "' that is non-callable");
+
+  // Most calls have a handful of arguments, which don't need the heap
+  const size_t InlineArguments = 8;
+  RuntimeValue inlineArguments[InlineArguments];
+  std::vector<RuntimeValue> moreArguments;
+
+  size_t count = node->mArguments.size();
+  RuntimeValue* arguments = inlineArguments;
+  if (count > InlineArguments)
+  {
+    moreArguments.resize(count);
+    arguments = moreArguments.data();
+  }
+
+  for (size_t i = 0; i < count; ++i)
+    arguments[i] = Evaluate(node->mArguments[i].get());
+
+  return Invoke(callee.mFunction, arguments, count);
+}
+
+RuntimeValue Interpreter::EvaluateCast(CastNode* node)
+{
+  return ConvertValue(Evaluate(node->mLeft.get()), node->mType->mSymbol);
+}
+
+char* Interpreter::EvaluateAddress(ExpressionNode* expression, Type*& type)
+{
+  switch (expression->mKind)
+  {
+    case NodeKind::Value:
+    {
+      ValueNode* node = static_cast<ValueNode*>(expression);
+      Symbol* symbol = node->mResolvedSymbol;
+      if (node->mToken.mEnumTokenType != TokenType::Identifier || symbol == nullptr || symbol->mType->mMode == TypeMode::Function)
+        break;
+
+      Variable* variable = static_cast<Variable*>(symbol);
+      type = variable->mType;
+      return GetVariableAddress(variable);
+    }
+
+    case NodeKind::MemberAccess:
+    {
+      MemberAccessNode* node = static_cast<MemberAccessNode*>(expression);
+      Symbol* member = node->mResolvedMember;
+      if (member->mType->mMode == TypeMode::Function)
+        break;
+
+      char* object = nullptr;
+      if (node->mOperator.mEnumTokenType == TokenType::Arrow)
+      {
+        object = Evaluate(node->mLeft.get()).mPointer;
+        if (object == nullptr)
+          ErrorExecution("Accessed the member '" + node->mName.str() + "' through a null pointer");
+      }
+      else
+      {
+        Type* objectType = nullptr;
+        object = EvaluateAddress(node->mLeft.get(), objectType);
+      }
+
+      type = member->mType;
+      return object + mMemory.GetMemberOffset(static_cast<Variable*>(member));
+    }
+
+    case NodeKind::UnaryOperator:
+    {
+      UnaryOperatorNode* node = static_cast<UnaryOperatorNode*>(expression);
+      if (node->mOperator.mEnumTokenType != TokenType::Asterisk)
+        break;
+
+      RuntimeValue pointer = Evaluate(node->mRight.get());
+      if (pointer.mPointer == nullptr)
+        ErrorExecution("Dereferenced a null pointer");
+
+      type = pointer.mType->mPointerToType;
+      return pointer.mPointer;
+    }
+
+    case NodeKind::Index:
+    {
+      IndexNode* node = static_cast<IndexNode*>(expression);
+      RuntimeValue pointer = Evaluate(node->mLeft.get());
+      RuntimeValue index = Evaluate(node->mIndex.get());
+      if (pointer.mPointer == nullptr)
+        ErrorExecution("Indexed a null pointer");
+
+      type = pointer.mType->mPointerToType;
+      return pointer.mPointer + (ptrdiff_t)ToInteger(index) * (ptrdiff_t)mMemory.GetSize(type);
+    }
+
+    default:
+      break;
+  }
+
+  // A class value that a call returned can still have its members read
+  RuntimeValue value = Evaluate(expression);
+  if (IsClass(value.mType))
+  {
+    type = value.mType;
+    return value.mPointer;
+  }
+
+  ErrorExecution("The expression does not refer to anything that can be assigned to or have its address taken");
+  return nullptr;
+}
+
+char* Interpreter::GetVariableAddress(Variable* variable)
+{
+  if (variable->mParentFunction != nullptr)
+  {
+    if (mFrames.empty())
+      ErrorExecution("The local '" + variable->mName + "' was used outside of its function");
+
+    FunctionLayout* layout = mFrames.back().mLayout;
+    std::unordered_map<Variable*, size_t>::iterator it = layout->mOffsets.find(variable);
+    if (it == layout->mOffsets.end())
+      ErrorExecution("The local '" + variable->mName + "' was used outside of its function");
+    return mFrames.back().mBase + it->second;
+  }
+
+  // Globals get their storage the first time they're used (the globals of libraries that weren't loaded start zeroed)
+  std::unique_ptr<char[]>& storage = mGlobals[variable];
+  if (storage == nullptr)
+  {
+    size_t size = mMemory.GetSize(variable->mType);
+    storage.reset(new char[size ? size : 1]());
+  }
+  return storage.get();
+}
+#pragma endregion
+
+#pragma region Values
+bool Interpreter::IsTrue(const RuntimeValue& value)
+{
+  if (value.mType == BooleanType)
+    return value.mBoolean;
+  if (IsPointer(value.mType))
+    return value.mPointer != nullptr;
+  return ConvertValue(value, BooleanType).mBoolean;
+}
+
+RuntimeValue Interpreter::LoadValue(const char* address, Type* type)
+{
+  RuntimeValue result;
+  result.mType = type;
+  if (type == IntegerType)
+    memcpy(&result.mInteger, address, sizeof(result.mInteger));
+  else if (type == FloatType)
+    memcpy(&result.mFloat, address, sizeof(result.mFloat));
+  else if (type == BooleanType)
+    result.mBoolean = *address != 0;
+  else if (type == ByteType)
+    result.mByte = (uint8_t)*address;
+  else if (IsPointer(type))
+    memcpy(&result.mPointer, address, sizeof(result.mPointer));
+  else if (IsClass(type))
+    result.mPointer = const_cast<char*>(address);
+  else
+    ErrorExecution("Unable to read a value of the type '" + type->mName + "'");
+  return result;
+}
+
+void Interpreter::StoreValue(char* address, Type* type, const RuntimeValue& value)
+{
+  RuntimeValue converted = ConvertValue(value, type);
+  if (type == IntegerType)
+    memcpy(address, &converted.mInteger, sizeof(converted.mInteger));
+  else if (type == FloatType)
+    memcpy(address, &converted.mFloat, sizeof(converted.mFloat));
+  else if (type == BooleanType)
+    *address = converted.mBoolean ? 1 : 0;
+  else if (type == ByteType)
+    *address = (char)converted.mByte;
+  else if (IsPointer(type))
+    memcpy(address, &converted.mPointer, sizeof(converted.mPointer));
+  else if (IsClass(type))
+    memmove(address, converted.mPointer, mMemory.GetSize(type));
+  else
+    ErrorExecution("Unable to store a value of the type '" + type->mName + "'");
+}
+
+RuntimeValue ConvertValue(const RuntimeValue& value, Type* type)
+{
+  if (value.mType == type)
+    return value;
+
+  RuntimeValue result;
+  result.mType = type;
+
+  if (IsPrimitive(type) && IsPrimitive(value.mType))
+  {
+    if (type == IntegerType)
+      result.mInteger = value.mType == FloatType ? FloatToInteger(value.mFloat) : (int32_t)ToInteger(value);
+    else if (type == FloatType)
+      result.mFloat = (float)ToDouble(value);
+    else if (type == ByteType)
+      result.mByte = (uint8_t)(value.mType == FloatType ? FloatToInteger(value.mFloat) : ToInteger(value));
+    else
+      result.mBoolean = ToDouble(value) != 0.0;
+    return result;
+  }
+
+  if (IsPointer(type) && IsPointer(value.mType))
+  {
+    result.mPointer = value.mPointer;
+    return result;
+  }
+
+  if (IsPointer(type) && value.mType == IntegerType)
+  {
+    result.mPointer = (char*)(intptr_t)value.mInteger;
+    return result;
+  }
+
+  if (type == IntegerType && IsPointer(value.mType))
+  {
+    result.mInteger = (int32_t)(intptr_t)value.mPointer;
+    return result;
+  }
+
+  if (type == BooleanType && IsPointer(value.mType))
+  {
+    result.mBoolean = value.mPointer != nullptr;
+    return result;
+  }
+
+  ErrorExecution("Unable to convert from '" + value.mType->mName + "' to '" + type->mName + "'");
+  return result;
+}
+#pragma endregion
@@ -0,0 +1,196 @@
+/******************************************************************\
+ * Copyright 2015, DigiPen Institute of Technology
+\******************************************************************/
+
+#pragma once
+#ifndef COMPILER_CLASS_INTERPRETER
+#define COMPILER_CLASS_INTERPRETER
+
+#include "Driver4.hpp"
+#include <cstdint>
+
+// Runs analyzed trees by walking them
+// A function's body is found through the FunctionNodes of the loaded trees (not Function::mExecutableFunction,
+// which a VirtualMachine points at its bytecode) and names through ValueNode::mResolvedSymbol and MemberAccessNode::mResolvedMember
+//
+// Memory is laid out the way C would lay it out: Integer and Float take 4 bytes, Boolean and Byte take 1,
+// a pointer is a real address (the size of a host pointer) and a class is its member variables in order, each aligned
+// Locals live in frames on the interpreter's own stack, globals each get their own storage, and a string literal
+// is a null terminated copy of its text, so a pointer can point at any of them
+// Like C, only null pointers are caught; walking a pointer off the end of what it points at is not
+
+// Thrown when a program does something that can't be run (such as dividing by zero or dereferencing null)
+class ExecutionException : public std::exception
+{
+public:
+  ExecutionException(const std::string& error);
+  const char* what() const override;
+  std::string mError;
+};
+
+// A value the interpreter computes
+// A class value refers to its storage instead of holding it (mPointer), and is copied when it is stored
+class RuntimeValue
+{
+public:
+  RuntimeValue();
+
+  static RuntimeValue MakeInteger(int32_t value);
+  static RuntimeValue MakeFloat(float value);
+  static RuntimeValue MakeBoolean(bool value);
+  static RuntimeValue MakeByte(uint8_t value);
+
+  // VoidType for nothing (a function that returns nothing)
+  Type* mType;
+
+  union
+  {
+    int32_t mInteger;
+    float mFloat;
+    bool mBoolean;
+    uint8_t mByte;
+    char* mPointer;
+    Function* mFunction;
+  };
+};
+
+// Integer, Float and Byte, which arithmetic works on
+bool IsArithmetic(Type* type);
+// The primitives that convert to each other (the arithmetic ones and Boolean)
+bool IsPrimitive(Type* type);
+// A pointer, or the type of null
+bool IsPointer(Type* type);
+// A class value (a class that isn't one of the primitives)
+bool IsClass(Type* type);
+
+// C's conversion, except that a Float too big for an Integer stops at the largest one instead of being undefined
+int32_t FloatToInteger(float value);
+
+// The text of a string or character literal without its quotes, with its escapes replaced
+std::string Unescape(const char* text, size_t length);
+
+// Converts a value to a type the way a cast or an assignment would
+RuntimeValue ConvertValue(const RuntimeValue& value, Type* type);
+
+// Sizes and alignments of types, and the offsets of the members of classes, the way C would lay them out
+class MemoryLayout
+{
+public:
+  size_t GetSize(Type* type);
+  size_t GetAlignment(Type* type);
+  size_t GetMemberOffset(Variable* member);
+
+private:
+  class TypeLayout
+  {
+  public:
+    size_t mSize;
+    size_t mAlignment;
+    // Set while a class's members are being laid out, to catch a class that contains itself
+    bool mInProgress;
+  };
+
+  const TypeLayout& GetTypeLayout(Type* type);
+
+  std::unordered_map<Type*, TypeLayout> mTypeLayouts;
+  std::unordered_map<Variable*, size_t> mMemberOffsets;
+};
+
+class Interpreter
+{
+public:
+  Interpreter();
+  ~Interpreter();
+
+  // Gives the globals of an analyzed tree storage and runs their initial values (in order)
+  // Several trees can be loaded, as long as the ones they depend on are loaded first
+  // The trees (and the text their tokens point into) must outlive the interpreter
+  void Load(BlockNode* block);
+
+  // The global function with the name, from the loaded trees (or null)
+  Function* FindFunction(const std::string& name) const;
+
+  // Runs a function with the arguments (converted to its parameter types) and returns what it returned
+  // Throws an ExecutionException if the program can't go on, which leaves the interpreter ready for another call
+  // A class value that is returned is left on the interpreter's stack, where it lasts until the next call
+  RuntimeValue Call(Function* function, const std::vector<RuntimeValue>& arguments);
+
+private:
+  Interpreter(const Interpreter&) = delete;
+  Interpreter& operator=(const Interpreter&) = delete;
+
+  // How a statement finished
+  enum ExecutionResult
+  {
+    Normal,
+    Break,
+    Continue,
+    Return,
+    Goto
+  };
+
+  class FunctionLayout
+  {
+  public:
+    FunctionNode* mNode;
+    size_t mSize;
+    std::unordered_map<Variable*, size_t> mOffsets;
+  };
+
+  // One call of a function
+  class Frame
+  {
+  public:
+    FunctionLayout* mLayout;
+    char* mBase;
+  };
+
+  FunctionLayout& GetFunctionLayout(Function* function);
+
+  // Memory on the interpreter's stack, which is given back when the stack is reset to an earlier top
+  char* AllocateStack(size_t size);
+
+  ExecutionResult Execute(StatementNode* statement);
+  ExecutionResult ExecuteScope(ScopeNode* scope);
+  void ExecuteVariable(VariableNode* variable);
+
+  RuntimeValue Evaluate(ExpressionNode* expression);
+  RuntimeValue EvaluateValue(ValueNode* node);
+  RuntimeValue EvaluateBinary(BinaryOperatorNode* node);
+  RuntimeValue EvaluateUnary(UnaryOperatorNode* node);
+  RuntimeValue EvaluateCall(CallNode* node);
+  RuntimeValue EvaluateCast(CastNode* node);
+
+  // The storage an expression refers to, and its type
+  char* EvaluateAddress(ExpressionNode* expression, Type*& type);
+  char* GetVariableAddress(Variable* variable);
+
+  // Whether a condition holds (a Boolean, or a pointer that isn't null)
+  bool IsTrue(const RuntimeValue& value);
+
+  RuntimeValue LoadValue(const char* address, Type* type);
+  void StoreValue(char* address, Type* type, const RuntimeValue& value);
+
+  RuntimeValue Invoke(Function* function, RuntimeValue* arguments, size_t count);
+
+  MemoryLayout mMemory;
+  std::unordered_map<Function*, FunctionLayout> mFunctionLayouts;
+
+  std::unordered_map<Variable*, std::unique_ptr<char[]>> mGlobals;
+  std::unordered_map<Atom, Function*> mFunctions;
+  // The body of every function (members included) of the loaded trees
+  std::unordered_map<Function*, FunctionNode*> mFunctionNodes;
+
+  // The text of each string literal, null terminated
+  std::unordered_map<ValueNode*, std::string> mStrings;
+
+  std::unique_ptr<char[]> mStack;
+  size_t mStackTop;
+  std::vector<Frame> mFrames;
+
+  // What the last return returned, and the label the last goto is looking for
+  RuntimeValue mReturnValue;
+  Label* mGotoLabel;
+};
+
+#endif
@@ -0,0 +1,993 @@
+/******************************************************************\
+ * Copyright 2015, DigiPen Institute of Technology
+\******************************************************************/
+
+#include "Jit.hpp"
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define JIT_X64 1
+#else
+#define JIT_X64 0
+#endif
+
+#if JIT_X64
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+#endif
+
+namespace
+{
+  // The errors machine code finds itself, worded the same as the VirtualMachine words them
+  const std::string DivisionByZero = "Division by zero";
+  const std::string NullPointer = "Accessed memory through a null pointer";
+  const std::string NullIndex = "Indexed a null pointer";
+  const std::string CallStackOverflow = "The call stack overflowed";
+  const std::string StackOverflow = "The stack overflowed";
+
+  // Host stack that machine code leaves for the bytecode, JIT helpers and exception handling it calls into
+  const size_t StackReserve = 64 * 1024;
+  // How much of the host's stack machine code may use when the thread's stack can't be asked for its bounds
+  const size_t FallbackStackBudget = 256 * 1024;
+
+  // The registers of the machine, numbered the way instructions encode them
+  namespace NativeRegister
+  {
+    enum Enum
+    {
+      Rax, Rcx, Rdx, Rbx, Rsp, Rbp, Rsi, Rdi,
+      R8, R9, R10, R11, R12, R13, R14, R15
+    };
+  }
+
+  namespace Condition
+  {
+    enum Enum
+    {
+      Below = 0x2, AboveOrEqual = 0x3, Equal = 0x4, NotEqual = 0x5, Above = 0x7,
+      Parity = 0xA, NoParity = 0xB, Less = 0xC, LessOrEqual = 0xE
+    };
+  }
+
+  using namespace NativeRegister;
+
+  // Where arguments go and how much room a callee may use above its return address
+#if defined(_WIN32)
+  const NativeRegister::Enum Arguments[] = { Rcx, Rdx, R8 };
+  const int32_t ShadowSpace = 32;
+#else
+  const NativeRegister::Enum Arguments[] = { Rdi, Rsi, Rdx };
+  const int32_t ShadowSpace = 0;
+#endif
+
+  // The machine code keeps these for the whole call (all of them are preserved across calls on both ABIs)
+  const NativeRegister::Enum Registers = Rbx;
+  const NativeRegister::Enum Context = R12;
+  const NativeRegister::Enum Frame = R13;
+  const NativeRegister::Enum StackTop = R14;
+
+  // Where a function that returns a class keeps the caller's storage for it
+  const int32_t ResultSlot = ShadowSpace;
+  const int32_t LocalSpace = 16;
+
+  int32_t RegisterOffset(size_t reg)
+  {
+    return (int32_t)(reg * sizeof(Register));
+  }
+
+  float FloatModulo(float left, float right)
+  {
+    return fmodf(left, right);
+  }
+
+  int32_t SameBytes(const char* left, const char* right, size_t size)
+  {
+    return memcmp(left, right, size) == 0;
+  }
+
+  // Writes x86-64 instructions (only the forms the JIT uses)
+  class Assembler
+  {
+  public:
+    std::vector<uint8_t> mCode;
+
+    size_t Here() const
+    {
+      return mCode.size();
+    }
+
+    void Byte(uint8_t value)
+    {
+      mCode.push_back(value);
+    }
+
+    void Int32(int32_t value)
+    {
+      uint8_t bytes[4];
+      memcpy(bytes, &value, sizeof(bytes));
+      mCode.insert(mCode.end(), bytes, bytes + sizeof(bytes));
+    }
+
+    void Int64(uint64_t value)
+    {
+      uint8_t bytes[8];
+      memcpy(bytes, &value, sizeof(bytes));
+      mCode.insert(mCode.end(), bytes, bytes + sizeof(bytes));
+    }
+
+    void Rex(bool wide, int reg, int base)
+    {
+      uint8_t rex = 0x40 | (wide ? 0x08 : 0) | ((reg & 8) ? 0x04 : 0) | ((base & 8) ? 0x01 : 0);
+      if (rex != 0x40)
+        Byte(rex);
+    }
+
+    // An instruction with a register and [base + displacement] operand
+    // A prefix (like F3 for scalar floats) has to come before the REX byte
+    void Memory(const char* opcode, size_t length, bool wide, int reg, int base, int32_t displacement, uint8_t prefix = 0)
+    {
+      if (prefix != 0)
+        Byte(prefix);
+      Rex(wide, reg, base);
+      for (size_t i = 0; i < length; ++i)
+        Byte((uint8_t)opcode[i]);
+
+      // Always a 32 bit displacement, which also avoids the special cases of rbp and r13
+      Byte((uint8_t)(0x80 | ((reg & 7) << 3) | (base & 7)));
+      if ((base & 7) == Rsp)
+        Byte(0x24);
+      Int32(displacement);
+    }
+
+    // An instruction with two register operands
+    void Direct(const char* opcode, size_t length, bool wide, int reg, int rm)
+    {
+      Rex(wide, reg, rm);
+      for (size_t i = 0; i < length; ++i)
+        Byte((uint8_t)opcode[i]);
+      Byte((uint8_t)(0xC0 | ((reg & 7) << 3) | (rm & 7)));
+    }
+
+    // mov reg, [base + displacement] (32 or 64 bits)
+    void Load(int reg, int base, int32_t displacement, bool wide)
+    {
+      Memory("\x8B", 1, wide, reg, base, displacement);
+    }
+
+    // mov [base + displacement], reg
+    void Store(int base, int32_t displacement, int reg, bool wide)
+    {
+      Memory("\x89", 1, wide, reg, base, displacement);
+    }
+
+    // mov reg, imm64
+    void Immediate(int reg, uint64_t value)
+    {
+      Rex(true, 0, reg);
+      Byte((uint8_t)(0xB8 + (reg & 7)));
+      Int64(value);
+    }
+
+    // mov to, from (64 bits)
+    void Move(int to, int from)
+    {
+      Direct("\x89", 1, true, from, to);
+    }
+
+    void Push(int reg)
+    {
+      Rex(false, 0, reg);
+      Byte((uint8_t)(0x50 + (reg & 7)));
+    }
+
+    void Pop(int reg)
+    {
+      Rex(false, 0, reg);
+      Byte((uint8_t)(0x58 + (reg & 7)));
+    }
+
+    // Calls the function at an address, through rax
+    void Call(const void* function)
+    {
+      Immediate(Rax, (uint64_t)(uintptr_t)function);
+      Byte(0xFF);
+      Byte(0xD0);
+    }
+
+    // A jump (or a jump if the condition holds) whose target is patched later
+    size_t Jump()
+    {
+      Byte(0xE9);
+      Int32(0);
+      return Here() - 4;
+    }
+
+    size_t JumpIf(Condition::Enum condition)
+    {
+      Byte(0x0F);
+      Byte((uint8_t)(0x80 + condition));
+      Int32(0);
+      return Here() - 4;
+    }
+
+    void Patch(size_t jump, size_t target)
+    {
+      int32_t relative = (int32_t)((int64_t)target - (int64_t)(jump + 4));
+      memcpy(&mCode[jump], &relative, sizeof(relative));
+    }
+
+    // The low byte of reg = condition
+    void Set(Condition::Enum condition, int reg = Rax)
+    {
+      Byte(0x0F);
+      Byte((uint8_t)(0x90 + condition));
+      Byte((uint8_t)(0xC0 | (reg & 7)));
+    }
+
+    // eax = al
+    void ZeroExtendAl()
+    {
+      Byte(0x0F);
+      Byte(0xB6);
+      Byte(0xC0);
+    }
+
+    // test reg, reg
+    void Test(int reg, bool wide)
+    {
+      Direct("\x85", 1, wide, reg, reg);
+    }
+  };
+
+  // Turns one BytecodeFunction into machine code
+  class NativeCompiler
+  {
+  public:
+    NativeCompiler(BytecodeFunction* function, const void* callBytecode, const void* allocateFrame) :
+      mFunction(function),
+      mCallBytecode(callBytecode),
+      mAllocateFrame(allocateFrame),
+      mExit(0)
+    {
+    }
+
+    bool Compile();
+
+    Assembler mAssembler;
+
+  private:
+    int32_t R(size_t reg) const
+    {
+      return RegisterOffset(reg);
+    }
+
+    void Prologue();
+    void Epilogue();
+    bool CompileInstruction(const Instruction* instruction);
+    void ErrorIf(Condition::Enum condition, const std::string* message);
+    void Finish(Condition::Enum condition);
+    // Loads the address in register 'base' into rcx, stopping with an error if it is null
+    void CheckedAddress(uint16_t base, const std::string* message);
+    void Return(bool setValue, uint16_t reg);
+    void Divide(const Instruction* instruction, bool modulo);
+
+    BytecodeFunction* mFunction;
+    const void* mCallBytecode;
+    const void* mAllocateFrame;
+    bool mReturnsClass;
+
+    // The machine code of each instruction, and the jumps to patch once they're all known
+    std::vector<size_t> mOffsets;
+    std::vector<std::pair<size_t, size_t>> mJumps;
+    std::vector<size_t> mExits;
+    std::vector<std::pair<size_t, const std::string*>> mErrors;
+    size_t mExit;
+  };
+
+  bool NativeCompiler::Compile()
+  {
+    Type* returnType = mFunction->mSymbol->mType->mFunction->mReturnType;
+    mReturnsClass = returnType != nullptr && IsClass(returnType);
+
+    Prologue();
+
+    const std::vector<Instruction>& code = mFunction->mCode;
+    mOffsets.resize(code.size(), 0);
+    for (size_t i = 0; i < code.size(); ++i)
+    {
+      mOffsets[i] = mAssembler.Here();
+      if (code[i].mOpcode == Opcode::Extra)
+        continue;
+      if (!CompileInstruction(&code[i]))
+        return false;
+    }
+
+    Epilogue();
+
+    for (size_t i = 0; i < mJumps.size(); ++i)
+      mAssembler.Patch(mJumps[i].first, mOffsets[mJumps[i].second]);
+    for (size_t i = 0; i < mExits.size(); ++i)
+      mAssembler.Patch(mExits[i], mExit);
+
+    // Each error sets its message and leaves through the exit with eax = 1
+    std::unordered_map<const std::string*, size_t> stubs;
+    for (size_t i = 0; i < mErrors.size(); ++i)
+    {
+      const std::string* message = mErrors[i].second;
+      std::unordered_map<const std::string*, size_t>::iterator found = stubs.find(message);
+      if (found == stubs.end())
+      {
+        found = stubs.insert(std::make_pair(message, mAssembler.Here())).first;
+        mAssembler.Immediate(Rax, (uint64_t)(uintptr_t)message);
+        mAssembler.Store(Context, offsetof(NativeContext, mMessage), Rax, true);
+        mAssembler.Byte(0xB8);
+        mAssembler.Int32(1);
+        mAssembler.Patch(mAssembler.Jump(), mExit);
+      }
+      mAssembler.Patch(mErrors[i].first, found->second);
+    }
+    return true;
+  }
+
+  void NativeCompiler::Prologue()
+  {
+    Assembler& a = mAssembler;
+    a.Push(Rbp);
+    a.Push(Registers);
+    a.Push(Context);
+    a.Push(Frame);
+    a.Push(StackTop);
+    // Five pushes and the return address leave the stack aligned, and this keeps it that way
+    a.Direct("\x81", 1, true, 5, Rsp);
+    a.Int32(ShadowSpace + LocalSpace);
+
+    a.Move(Registers, Arguments[0]);
+    a.Move(Context, Arguments[1]);
+
+    // The exit puts the stack top back, so it's read before anything can fail
+    a.Load(Rax, Context, offsetof(NativeContext, mStackTop), true);
+    a.Load(StackTop, Rax, 0, true);
+
+    if (mReturnsClass)
+    {
+      a.Load(Rax, Context, offsetof(NativeContext, mResult), true);
+      a.Store(Rsp, ResultSlot, Rax, true);
+    }
+
+    // ++depth, and the exit takes it back off
+    a.Load(Rax, Context, offsetof(NativeContext, mDepth), true);
+    a.Direct("\x83", 1, true, 0, Rax);
+    a.Byte(1);
+    a.Store(Context, offsetof(NativeContext, mDepth), Rax, true);
+    a.Memory("\x3B", 1, true, Rax, Context, offsetof(NativeContext, mMaxDepth));
+    ErrorIf(Condition::Above, &CallStackOverflow);
+    // A small host stack runs out long before the depth does
+    a.Memory("\x3B", 1, true, Rsp, Context, offsetof(NativeContext, mStackLimit));
+    ErrorIf(Condition::Below, &CallStackOverflow);
+
+    a.Memory("\x8D", 1, true, Rax, Registers, R(mFunction->mRegisterCount));
+    a.Memory("\x3B", 1, true, Rax, Context, offsetof(NativeContext, mRegisterEnd));
+    ErrorIf(Condition::Above, &CallStackOverflow);
+
+    if (mFunction->mFrameSize != 0)
+    {
+      a.Move(Arguments[0], Context);
+      a.Immediate(Arguments[1], mFunction->mFrameSize);
+      a.Call(mAllocateFrame);
+      a.Test(Rax, true);
+      ErrorIf(Condition::Equal, &StackOverflow);
+      a.Move(Frame, Rax);
+    }
+  }
+
+  void NativeCompiler::Epilogue()
+  {
+    Assembler& a = mAssembler;
+    mExit = a.Here();
+
+    // eax holds what the function returns (0, or 1 for an error)
+    a.Load(Rcx, Context, offsetof(NativeContext, mStackTop), true);
+    a.Store(Rcx, 0, StackTop, true);
+    a.Memory("\xFF", 1, true, 1, Context, offsetof(NativeContext, mDepth));
+
+    a.Direct("\x81", 1, true, 0, Rsp);
+    a.Int32(ShadowSpace + LocalSpace);
+    a.Pop(StackTop);
+    a.Pop(Frame);
+    a.Pop(Context);
+    a.Pop(Registers);
+    a.Pop(Rbp);
+    a.Byte(0xC3);
+  }
+
+  void NativeCompiler::ErrorIf(Condition::Enum condition, const std::string* message)
+  {
+    mErrors.push_back(std::make_pair(mAssembler.JumpIf(condition), message));
+  }
+
+  void NativeCompiler::Finish(Condition::Enum condition)
+  {
+    // Booleans are 0 or 1 in all 32 bits of the register's Integer
+    mAssembler.Set(condition);
+    mAssembler.ZeroExtendAl();
+  }
+
+  void NativeCompiler::CheckedAddress(uint16_t base, const std::string* message)
+  {
+    mAssembler.Load(Rcx, Registers, R(base), true);
+    mAssembler.Test(Rcx, true);
+    ErrorIf(Condition::Equal, message);
+  }
+
+  void NativeCompiler::Return(bool setValue, uint16_t reg)
+  {
+    Assembler& a = mAssembler;
+    if (setValue)
+      a.Load(Rax, Registers, R(reg), true);
+    else
+      a.Direct("\x31", 1, false, Rax, Rax);
+    a.Store(Context, offsetof(NativeContext, mResult), Rax, true);
+    a.Direct("\x31", 1, false, Rax, Rax);
+    mExits.push_back(a.Jump());
+  }
+
+  void NativeCompiler::Divide(const Instruction* instruction, bool modulo)
+  {
+    Assembler& a = mAssembler;
+    a.Load(Rcx, Registers, R(instruction->mC), false);
+    a.Test(Rcx, false);
+    ErrorIf(Condition::Equal, &DivisionByZero);
+    a.Load(Rax, Registers, R(instruction->mB), false);
+
+    // Dividing the smallest Integer by -1 overflows (and traps), so -1 is done without idiv
+    a.Byte(0x83);
+    a.Byte(0xF9);
+    a.Byte(0xFF);
+    size_t notMinusOne = a.JumpIf(Condition::NotEqual);
+    if (modulo)
+      a.Direct("\x31", 1, false, Rax, Rax);
+    else
+      a.Direct("\xF7", 1, false, 3, Rax);
+    size_t done = a.Jump();
+
+    a.Patch(notMinusOne, a.Here());
+    a.Byte(0x99);
+    a.Direct("\xF7", 1, false, 7, Rcx);
+    if (modulo)
+      a.Direct("\x89", 1, false, Rdx, Rax);
+
+    a.Patch(done, a.Here());
+    a.Store(Registers, R(instruction->mA), Rax, false);
+  }
+
+  bool NativeCompiler::CompileInstruction(const Instruction* instruction)
+  {
+    Assembler& a = mAssembler;
+    uint16_t A = instruction->mA;
+    uint16_t B = instruction->mB;
+    uint16_t C = instruction->mC;
+    uint32_t extra = 0;
+    if (instruction + 1 < mFunction->mCode.data() + mFunction->mCode.size() && instruction[1].mOpcode == Opcode::Extra)
+      extra = instruction[1].mA | ((uint32_t)instruction[1].mB << 16);
+
+    switch (instruction->mOpcode)
+    {
+      case Opcode::Move:
+        a.Load(Rax, Registers, R(B), true);
+        a.Store(Registers, R(A), Rax, true);
+        break;
+
+      case Opcode::LoadConstant:
+      {
+        uint64_t bits = 0;
+        memcpy(&bits, &mFunction->mConstants[B], sizeof(Register));
+        a.Immediate(Rax, bits);
+        a.Store(Registers, R(A), Rax, true);
+        break;
+      }
+
+      case Opcode::Clear:
+        a.Direct("\x31", 1, false, Rax, Rax);
+        a.Store(Registers, R(A), Rax, true);
+        break;
+
+      case Opcode::FrameAddress:
+        a.Memory("\x8D", 1, true, Rax, Frame, (int32_t)(B | ((uint32_t)C << 16)));
+        a.Store(Registers, R(A), Rax, true);
+        break;
+
+      // Integer arithmetic wraps, which is what the machine does anyway
+      case Opcode::IntegerAdd:
+      case Opcode::IntegerSubtract:
+      case Opcode::IntegerMultiply:
+      {
+        const char* opcode = instruction->mOpcode == Opcode::IntegerAdd ? "\x03" : instruction->mOpcode == Opcode::IntegerSubtract ? "\x2B" : "\x0F\xAF";
+        a.Load(Rax, Registers, R(B), false);
+        a.Memory(opcode, strlen(opcode), false, Rax, Registers, R(C));
+        a.Store(Registers, R(A), Rax, false);
+        break;
+      }
+
+      case Opcode::IntegerAddImmediate:
+        a.Load(Rax, Registers, R(B), false);
+        a.Byte(0x05);
+        a.Int32((int16_t)C);
+        a.Store(Registers, R(A), Rax, false);
+        break;
+
+      case Opcode::IntegerDivide:
+        Divide(instruction, false);
+        break;
+
+      case Opcode::IntegerModulo:
+        Divide(instruction, true);
+        break;
+
+      case Opcode::IntegerNegate:
+        a.Load(Rax, Registers, R(B), false);
+        a.Direct("\xF7", 1, false, 3, Rax);
+        a.Store(Registers, R(A), Rax, false);
+        break;
+
+      case Opcode::FloatAdd:
+      case Opcode::FloatSubtract:
+      case Opcode::FloatMultiply:
+      case Opcode::FloatDivide:
+      {
+        const char* opcode = instruction->mOpcode == Opcode::FloatAdd ? "\x0F\x58" : instruction->mOpcode == Opcode::FloatSubtract ? "\x0F\x5C" :
+          instruction->mOpcode == Opcode::FloatMultiply ? "\x0F\x59" : "\x0F\x5E";
+        a.Memory("\x0F\x10", 2, false, 0, Registers, R(B), 0xF3);
+        a.Memory(opcode, 2, false, 0, Registers, R(C), 0xF3);
+        a.Memory("\x0F\x11", 2, false, 0, Registers, R(A), 0xF3);
+        break;
+      }
+
+      case Opcode::FloatModulo:
+        a.Memory("\x0F\x10", 2, false, 0, Registers, R(B), 0xF3);
+        a.Memory("\x0F\x10", 2, false, 1, Registers, R(C), 0xF3);
+        a.Call((const void*)&FloatModulo);
+        a.Memory("\x0F\x11", 2, false, 0, Registers, R(A), 0xF3);
+        break;
+
+      case Opcode::FloatNegate:
+        a.Load(Rax, Registers, R(B), false);
+        a.Byte(0x35);
+        a.Int32(INT32_MIN);
+        a.Store(Registers, R(A), Rax, false);
+        break;
+
+      case Opcode::IntegerLess:
+      case Opcode::IntegerLessOrEqual:
+      case Opcode::IntegerEqual:
+      case Opcode::IntegerNotEqual:
+      case Opcode::PointerLess:
+      case Opcode::PointerLessOrEqual:
+      case Opcode::PointerEqual:
+      case Opcode::PointerNotEqual:
+      {
+        bool wide = instruction->mOpcode >= Opcode::PointerLess;
+        int kind = (instruction->mOpcode - (wide ? Opcode::PointerLess : Opcode::IntegerLess));
+        static const Condition::Enum Conditions[] = { Condition::Less, Condition::LessOrEqual, Condition::Equal, Condition::NotEqual };
+        a.Load(Rax, Registers, R(B), wide);
+        a.Memory("\x3B", 1, wide, Rax, Registers, R(C));
+        Finish(Conditions[kind]);
+        a.Store(Registers, R(A), Rax, false);
+        break;
+      }
+
+      // ucomiss is unordered for NaN, which makes every comparison but != false, the same as in C++
+      case Opcode::FloatLess:
+      case Opcode::FloatLessOrEqual:
+        a.Memory("\x0F\x10", 2, false, 0, Registers, R(C), 0xF3);
+        a.Memory("\x0F\x2E", 2, false, 0, Registers, R(B));
+        Finish(instruction->mOpcode == Opcode::FloatLess ? Condition::Above : Condition::AboveOrEqual);
+        a.Store(Registers, R(A), Rax, false);
+        break;
+
+      case Opcode::FloatEqual:
+      case Opcode::FloatNotEqual:
+      {
+        bool equal = instruction->mOpcode == Opcode::FloatEqual;
+        a.Memory("\x0F\x10", 2, false, 0, Registers, R(B), 0xF3);
+        a.Memory("\x0F\x2E", 2, false, 0, Registers, R(C));
+        a.Set(equal ? Condition::Equal : Condition::NotEqual);
+        a.Set(equal ? Condition::NoParity : Condition::Parity, Rcx);
+        a.Byte(equal ? 0x20 : 0x08);
+        a.Byte(0xC8);
+        a.ZeroExtendAl();
+        a.Store(Registers, R(A), Rax, false);
+        break;
+      }
+
+      case Opcode::ClassEqual:
+        a.Load(Arguments[0], Registers, R(B), true);
+        a.Load(Arguments[1], Registers, R(C), true);
+        a.Immediate(Arguments[2], extra);
+        a.Call((const void*)&SameBytes);
+        a.Store(Registers, R(A), Rax, false);
+        break;
+
+      case Opcode::Not:
+      case Opcode::IntegerToBoolean:
+      case Opcode::PointerToBoolean:
+      {
+        bool wide = instruction->mOpcode == Opcode::PointerToBoolean;
+        a.Memory("\x83", 1, wide, 7, Registers, R(B));
+        a.Byte(0);
+        Finish(instruction->mOpcode == Opcode::Not ? Condition::Equal : Condition::NotEqual);
+        a.Store(Registers, R(A), Rax, false);
+        break;
+      }
+
+      case Opcode::FloatToBoolean:
+        a.Direct("\x0F\x57", 2, false, 1, 1);
+        a.Memory("\x0F\x10", 2, false, 0, Registers, R(B), 0xF3);
+        a.Direct("\x0F\x2E", 2, false, 0, 1);
+        a.Set(Condition::NotEqual);
+        a.Set(Condition::Parity, Rcx);
+        a.Byte(0x08);
+        a.Byte(0xC8);
+        a.ZeroExtendAl();
+        a.Store(Registers, R(A), Rax, false);
+        break;
+
+      case Opcode::IntegerToFloat:
+        a.Memory("\x0F\x2A", 2, false, 0, Registers, R(B), 0xF3);
+        a.Memory("\x0F\x11", 2, false, 0, Registers, R(A), 0xF3);
+        break;
+
+      // Out of range Floats convert the way the Interpreter converts them
+      case Opcode::FloatToInteger:
+      case Opcode::FloatToByte:
+        a.Memory("\x0F\x10", 2, false, 0, Registers, R(B), 0xF3);
+        a.Call((const void*)&FloatToInteger);
+        if (instruction->mOpcode == Opcode::FloatToByte)
+          a.ZeroExtendAl();
+        a.Store(Registers, R(A), Rax, false);
+        break;
+
+      case Opcode::IntegerToByte:
+        a.Memory("\x0F\xB6", 2, false, Rax, Registers, R(B));
+        a.Store(Registers, R(A), Rax, false);
+        break;
+
+      case Opcode::IntegerToPointer:
+        a.Memory("\x63", 1, true, Rax, Registers, R(B));
+        a.Store(Registers, R(A), Rax, true);
+        break;
+
+      case Opcode::PointerToInteger:
+        a.Load(Rax, Registers, R(B), false);
+        a.Store(Registers, R(A), Rax, false);
+        break;
+
+      case Opcode::PointerAdd:
+        a.Memory("\x63", 1, true, Rax, Registers, R(C));
+        a.Memory("\x03", 1, true, Rax, Registers, R(B));
+        a.Store(Registers, R(A), Rax, true);
+        break;
+
+      case Opcode::PointerAddImmediate:
+      case Opcode::MemberAddress:
+      {
+        bool member = instruction->mOpcode == Opcode::MemberAddress;
+        if (member)
+          CheckedAddress(B, &NullPointer);
+        else
+          a.Load(Rcx, Registers, R(B), true);
+        a.Memory("\x8D", 1, true, Rax, Rcx, member ? (int32_t)C : (int32_t)(int16_t)C);
+        a.Store(Registers, R(A), Rax, true);
+        break;
+      }
+
+      case Opcode::PointerAddScaled:
+      case Opcode::IndexAddress:
+      {
+        if (extra > INT32_MAX)
+          return false;
+        if (instruction->mOpcode == Opcode::IndexAddress)
+          CheckedAddress(B, &NullIndex);
+        else
+          a.Load(Rcx, Registers, R(B), true);
+        a.Memory("\x63", 1, true, Rax, Registers, R(C));
+        a.Direct("\x69", 1, true, Rax, Rax);
+        a.Int32((int32_t)extra);
+        a.Direct("\x01", 1, true, Rcx, Rax);
+        a.Store(Registers, R(A), Rax, true);
+        break;
+      }
+
+      case Opcode::PointerDifference:
+        a.Load(Rax, Registers, R(B), true);
+        a.Memory("\x2B", 1, true, Rax, Registers, R(C));
+        a.Store(Registers, R(A), Rax, false);
+        break;
+
+      case Opcode::LoadInteger:
+        CheckedAddress(B, &NullPointer);
+        a.Load(Rax, Rcx, C, false);
+        a.Store(Registers, R(A), Rax, false);
+        break;
+
+      case Opcode::LoadByte:
+        CheckedAddress(B, &NullPointer);
+        a.Memory("\x0F\xB6", 2, false, Rax, Rcx, C);
+        a.Store(Registers, R(A), Rax, false);
+        break;
+
+      case Opcode::LoadBoolean:
+        CheckedAddress(B, &NullPointer);
+        a.Memory("\x80", 1, false, 7, Rcx, C);
+        a.Byte(0);
+        Finish(Condition::NotEqual);
+        a.Store(Registers, R(A), Rax, false);
+        break;
+
+      case Opcode::LoadPointer:
+        CheckedAddress(B, &NullPointer);
+        a.Load(Rax, Rcx, C, true);
+        a.Store(Registers, R(A), Rax, true);
+        break;
+
+      case Opcode::StoreInteger:
+      case Opcode::StorePointer:
+      {
+        bool wide = instruction->mOpcode == Opcode::StorePointer;
+        CheckedAddress(B, &NullPointer);
+        a.Load(Rax, Registers, R(A), wide);
+        a.Store(Rcx, C, Rax, wide);
+        break;
+      }
+
+      case Opcode::StoreByte:
+        CheckedAddress(B, &NullPointer);
+        a.Load(Rax, Registers, R(A), false);
+        a.Memory("\x88", 1, false, Rax, Rcx, C);
+        break;
+
+      case Opcode::Copy:
+        CheckedAddress(A, &NullPointer);
+        CheckedAddress(B, &NullPointer);
+        a.Load(Arguments[0], Registers, R(A), true);
+        a.Load(Arguments[1], Registers, R(B), true);
+        a.Immediate(Arguments[2], extra);
+        a.Call((const void*)&memmove);
+        break;
+
+      case Opcode::Zero:
+        a.Load(Arguments[0], Registers, R(A), true);
+        a.Immediate(Arguments[1], 0);
+        a.Immediate(Arguments[2], extra);
+        a.Call((const void*)&memset);
+        break;
+
+      case Opcode::Jump:
+        mJumps.push_back(std::make_pair(a.Jump(), (size_t)(B | ((uint32_t)C << 16))));
+        break;
+
+      case Opcode::JumpIfTrue:
+      case Opcode::JumpIfFalse:
+        a.Memory("\x83", 1, false, 7, Registers, R(A));
+        a.Byte(0);
+        mJumps.push_back(std::make_pair(a.JumpIf(instruction->mOpcode == Opcode::JumpIfTrue ? Condition::NotEqual : Condition::Equal),
+          (size_t)(B | ((uint32_t)C << 16))));
+        break;
+
+      case Opcode::Call:
+      {
+        // The callee's registers start right after this function's, the same as in the VirtualMachine
+        BytecodeFunction* callee = mFunction->mConstants[C].mBytecode;
+        int32_t calleeRegisters = R(mFunction->mRegisterCount);
+        for (size_t i = 0; i < callee->mParameterCount; ++i)
+        {
+          a.Load(Rax, Registers, R(B + i), true);
+          a.Store(Registers, calleeRegisters + R(i), Rax, true);
+        }
+
+        Type* returnType = callee->mSymbol->mType->mFunction->mReturnType;
+        if (returnType != nullptr && IsClass(returnType))
+        {
+          a.Load(Rax, Registers, R(A), true);
+          a.Store(Context, offsetof(NativeContext, mResult), Rax, true);
+        }
+
+        // The callee may only be compiled later, so whether it is gets checked on each call
+        a.Immediate(Rax, (uint64_t)(uintptr_t)&callee->mNative);
+        a.Load(Rax, Rax, 0, true);
+        a.Test(Rax, true);
+        size_t bytecode = a.JumpIf(Condition::Equal);
+        a.Memory("\x8D", 1, true, Arguments[0], Registers, calleeRegisters);
+        a.Move(Arguments[1], Context);
+        a.Byte(0xFF);
+        a.Byte(0xD0);
+        size_t done = a.Jump();
+
+        a.Patch(bytecode, a.Here());
+        a.Move(Arguments[0], Context);
+        a.Immediate(Arguments[1], (uint64_t)(uintptr_t)callee);
+        a.Memory("\x8D", 1, true, Arguments[2], Registers, calleeRegisters);
+        a.Call(mCallBytecode);
+
+        // An error in the callee goes straight on up (eax is already 1)
+        a.Patch(done, a.Here());
+        a.Test(Rax, false);
+        mExits.push_back(a.JumpIf(Condition::NotEqual));
+        a.Load(Rax, Context, offsetof(NativeContext, mResult), true);
+        a.Store(Registers, R(A), Rax, true);
+        break;
+      }
+
+      case Opcode::Return:
+        Return(true, A);
+        break;
+
+      case Opcode::ReturnVoid:
+        Return(false, 0);
+        break;
+
+      case Opcode::ReturnClass:
+        a.Load(Arguments[0], Rsp, ResultSlot, true);
+        a.Load(Arguments[1], Registers, R(A), true);
+        a.Immediate(Arguments[2], extra);
+        a.Call((const void*)&memmove);
+        a.Load(Rax, Rsp, ResultSlot, true);
+        a.Store(Context, offsetof(NativeContext, mResult), Rax, true);
+        a.Direct("\x31", 1, false, Rax, Rax);
+        mExits.push_back(a.Jump());
+        break;
+
+      case Opcode::Error:
+        mErrors.push_back(std::make_pair(a.Jump(), &mFunction->mMessages[A]));
+        break;
+
+      // Indirect calls (and anything new) stay in bytecode
+      default:
+        return false;
+    }
+    return true;
+  }
+}
+
+BaselineJit::BaselineJit()
+{
+}
+
+BaselineJit::~BaselineJit()
+{
+#if JIT_X64
+  for (size_t i = 0; i < mBlocks.size(); ++i)
+  {
+#if defined(_WIN32)
+    VirtualFree(mBlocks[i].first, 0, MEM_RELEASE);
+#else
+    munmap(mBlocks[i].first, mBlocks[i].second);
+#endif
+  }
+#endif
+}
+
+NativeFunction BaselineJit::Compile(BytecodeFunction* function)
+{
+#if JIT_X64
+  if (function->mSymbol == nullptr)
+    return nullptr;
+
+  NativeCompiler compiler(function, (const void*)&BaselineJit::CallBytecode, (const void*)&BaselineJit::AllocateFrame);
+  if (!compiler.Compile())
+    return nullptr;
+
+  // Written while it's only writable, then made only executable
+  const std::vector<uint8_t>& code = compiler.mAssembler.mCode;
+#if defined(_WIN32)
+  void* memory = VirtualAlloc(nullptr, code.size(), MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+  if (memory == nullptr)
+    return nullptr;
+  memcpy(memory, code.data(), code.size());
+  DWORD previous;
+  VirtualProtect(memory, code.size(), PAGE_EXECUTE_READ, &previous);
+  FlushInstructionCache(GetCurrentProcess(), memory, code.size());
+  size_t size = code.size();
+#else
+  size_t page = (size_t)sysconf(_SC_PAGESIZE);
+  size_t size = (code.size() + page - 1) / page * page;
+  void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (memory == MAP_FAILED)
+    return nullptr;
+  memcpy(memory, code.data(), code.size());
+  if (mprotect(memory, size, PROT_READ | PROT_EXEC) != 0)
+  {
+    munmap(memory, size);
+    return nullptr;
+  }
+#endif
+
+  mBlocks.push_back(std::make_pair(memory, size));
+  return (NativeFunction)memory;
+#else
+  (void)function;
+  return nullptr;
+#endif
+}
+
+uintptr_t BaselineJit::StackLimit()
+{
+  // The bounds of a thread's stack don't change, so they're only looked up once per thread
+  static thread_local uintptr_t limit = 0;
+  if (limit != 0)
+    return limit;
+
+  uintptr_t low = 0;
+#if JIT_X64 && defined(_WIN32)
+  ULONG_PTR stackLow;
+  ULONG_PTR stackHigh;
+  GetCurrentThreadStackLimits(&stackLow, &stackHigh);
+  low = (uintptr_t)stackLow;
+#elif JIT_X64 && defined(__APPLE__)
+  pthread_t self = pthread_self();
+  low = (uintptr_t)pthread_get_stackaddr_np(self) - pthread_get_stacksize_np(self);
+#elif JIT_X64 && defined(__linux__)
+  pthread_attr_t attributes;
+  if (pthread_getattr_np(pthread_self(), &attributes) == 0)
+  {
+    void* address;
+    size_t size;
+    if (pthread_attr_getstack(&attributes, &address, &size) == 0)
+      low = (uintptr_t)address;
+    pthread_attr_destroy(&attributes);
+  }
+#endif
+
+  // Without the bounds, machine code gets a fixed amount below where it is first entered
+  char here;
+  if (low == 0)
+    low = (uintptr_t)&here - FallbackStackBudget;
+
+  limit = low + StackReserve;
+  return limit;
+}
+
+uint32_t BaselineJit::CallBytecode(NativeContext* context, BytecodeFunction* function, Register* registers)
+{
+  // Nothing can be thrown back into machine code, so an error is caught here and passed up as a 1
+  VirtualMachine* machine = context->mMachine;
+  size_t frames = machine->mFrames.size();
+  size_t top = machine->mStackTop;
+  size_t depth = context->mDepth;
+
+  Register result = context->mResult;
+  try
+  {
+    machine->Run(function, registers, result);
+  }
+  catch (std::exception& e)
+  {
+    machine->mFrames.erase(machine->mFrames.begin() + frames, machine->mFrames.end());
+    machine->mStackTop = top;
+    context->mDepth = depth;
+    machine->mNativeError = e.what();
+    context->mMessage = &machine->mNativeError;
+    return 1;
+  }
+
+  context->mResult = result;
+  return 0;
+}
+
+char* BaselineJit::AllocateFrame(NativeContext* context, size_t size)
+{
+  try
+  {
+    return context->mMachine->AllocateStack(size);
+  }
+  catch (ExecutionException&)
+  {
+    return nullptr;
+  }
+}
@@ -0,0 +1,45 @@
+/******************************************************************\
+ * Copyright 2015, DigiPen Institute of Technology
+\******************************************************************/
+
+#pragma once
+#ifndef COMPILER_CLASS_JIT
+#define COMPILER_CLASS_JIT
+
+#include "VirtualMachine.hpp"
+
+// Compiles hot BytecodeFunctions to x86-64 machine code, one instruction at a time (a baseline, not an optimizing, JIT)
+// The registers stay where the VirtualMachine keeps them and hold the same unboxed Integers, Floats, Bytes and Booleans,
+// so machine code and bytecode can call each other freely and a function can be compiled between any two calls
+//
+// Machine code never throws: an error sets NativeContext::mMessage and returns 1 up through its callers,
+// since C++ exceptions can't unwind through code the compiler didn't generate
+// Code lives in memory mapped writable, filled in, then made executable (never both at once)
+// On anything but x86-64, or for a function with an instruction it doesn't know, Compile returns null
+class BaselineJit
+{
+public:
+  BaselineJit();
+  ~BaselineJit();
+
+  // The function as machine code that lasts as long as the JIT, or null if it can't be compiled
+  NativeFunction Compile(BytecodeFunction* function);
+
+  // The lowest the calling thread's stack pointer may go in machine code, which leaves room below it
+  // for the C++ that machine code calls into (and for reporting the overflow)
+  static uintptr_t StackLimit();
+
+private:
+  BaselineJit(const BaselineJit&) = delete;
+  BaselineJit& operator=(const BaselineJit&) = delete;
+
+  // Called from machine code, to run a function that is still bytecode
+  static uint32_t CallBytecode(NativeContext* context, BytecodeFunction* function, Register* registers);
+  // Called from machine code, for the memory of its frame (null if the stack overflowed)
+  static char* AllocateFrame(NativeContext* context, size_t size);
+
+  // Executable memory and its size, given back when the JIT is destroyed
+  std::vector<std::pair<void*, size_t>> mBlocks;
+};
+
+#endif
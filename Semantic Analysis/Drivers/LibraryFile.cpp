@@ -0,0 +1,610 @@
+/******************************************************************\
+ * Copyright 2015, DigiPen Institute of Technology
+\******************************************************************/
+
+#include "LibraryFile.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+  // Rounds an offset up to the next 4 byte boundary, so every section can be read in place
+  uint32_t Align(size_t offset)
+  {
+    return (uint32_t)((offset + 3) & ~(size_t)3);
+  }
+
+  class ImageWriter
+  {
+  public:
+    ImageWriter(Library* library, const std::vector<Library*>& dependencies) :
+      mLibrary(library),
+      mFailed(false)
+    {
+      for (size_t i = 0; i < library->mAllSymbols.size(); ++i)
+        mIndices[library->mAllSymbols[i].get()] = (uint32_t)i;
+
+      // Anything we refer to that we don't own has to be found by name when the image is read
+      for (size_t i = 0; i < dependencies.size(); ++i)
+      {
+        Library* dependency = dependencies[i];
+        for (std::unordered_map<Atom, Symbol*>::iterator it = dependency->mGlobalsByName.begin(); it != dependency->mGlobalsByName.end(); ++it)
+          mExports.insert(std::make_pair(it->second, std::make_pair((uint32_t)i, it->first)));
+      }
+    }
+
+    bool Write(std::vector<char>& image)
+    {
+      image.clear();
+      for (size_t i = 0; i < mLibrary->mAllSymbols.size(); ++i)
+        AddSymbol(mLibrary->mAllSymbols[i].get());
+
+      for (size_t i = 0; i < mLibrary->mGlobals.size(); ++i)
+      {
+        std::unordered_map<Symbol*, uint32_t>::iterator it = mIndices.find(mLibrary->mGlobals[i]);
+        if (it == mIndices.end())
+          return false;
+        mGlobals.push_back(it->second);
+      }
+
+      if (mFailed)
+        return false;
+
+      LibraryImageHeader header;
+      memset(&header, 0, sizeof(header));
+      header.mMagic = LibraryImage::Magic;
+      header.mVersion = LibraryImage::Version;
+      header.mDependencyCount = GetDependencyCount();
+
+      size_t offset = sizeof(header);
+      header.mStrings = Align(offset);
+      header.mStringCount = (uint32_t)mStrings.size();
+      offset = header.mStrings + mStrings.size() * sizeof(LibraryImageString);
+      header.mStringData = Align(offset);
+      header.mStringDataSize = (uint32_t)mStringData.size();
+      offset = header.mStringData + mStringData.size();
+      header.mImports = Align(offset);
+      header.mImportCount = (uint32_t)mImports.size();
+      offset = header.mImports + mImports.size() * sizeof(LibraryImageImport);
+      header.mSymbols = Align(offset);
+      header.mSymbolCount = (uint32_t)mSymbols.size();
+      offset = header.mSymbols + mSymbols.size() * sizeof(LibraryImageSymbol);
+      header.mLists = Align(offset);
+      header.mListSize = (uint32_t)mLists.size();
+      offset = header.mLists + mLists.size() * sizeof(uint32_t);
+      header.mGlobals = Align(offset);
+      header.mGlobalCount = (uint32_t)mGlobals.size();
+      offset = header.mGlobals + mGlobals.size() * sizeof(uint32_t);
+      header.mSize = Align(offset);
+
+      image.resize(header.mSize, 0);
+      char* data = image.data();
+      memcpy(data, &header, sizeof(header));
+      Copy(data + header.mStrings, mStrings);
+      if (!mStringData.empty())
+        memcpy(data + header.mStringData, mStringData.data(), mStringData.size());
+      Copy(data + header.mImports, mImports);
+      Copy(data + header.mSymbols, mSymbols);
+      Copy(data + header.mLists, mLists);
+      Copy(data + header.mGlobals, mGlobals);
+      return true;
+    }
+
+  private:
+    template <typename T>
+    static void Copy(char* destination, const std::vector<T>& entries)
+    {
+      if (!entries.empty())
+        memcpy(destination, entries.data(), entries.size() * sizeof(T));
+    }
+
+    // The highest dependency an import uses (plus one), so that reading checks we're given at least that many
+    uint32_t GetDependencyCount() const
+    {
+      uint32_t count = 0;
+      for (size_t i = 0; i < mImports.size(); ++i)
+        count = std::max(count, mImports[i].mDependency + 1);
+      return count;
+    }
+
+    uint32_t AddString(Atom atom)
+    {
+      std::unordered_map<Atom, uint32_t>::iterator it = mStringIndices.find(atom);
+      if (it != mStringIndices.end())
+        return it->second;
+
+      const std::string& text = GetAtomString(atom);
+      LibraryImageString entry;
+      entry.mOffset = (uint32_t)mStringData.size();
+      entry.mLength = (uint32_t)text.size();
+      mStringData.append(text);
+
+      uint32_t index = (uint32_t)mStrings.size();
+      mStrings.push_back(entry);
+      mStringIndices[atom] = index;
+      return index;
+    }
+
+    uint32_t Reference(Symbol* symbol)
+    {
+      if (symbol == nullptr)
+        return LibraryImage::None;
+
+      std::unordered_map<Symbol*, uint32_t>::iterator local = mIndices.find(symbol);
+      if (local != mIndices.end())
+        return local->second;
+
+      std::unordered_map<Symbol*, uint32_t>::iterator imported = mImportIndices.find(symbol);
+      if (imported != mImportIndices.end())
+        return imported->second | LibraryImage::ImportBit;
+
+      std::unordered_map<Symbol*, std::pair<uint32_t, Atom>>::iterator exported = mExports.find(symbol);
+      if (exported == mExports.end())
+      {
+        mFailed = true;
+        return LibraryImage::None;
+      }
+
+      LibraryImageImport entry;
+      entry.mDependency = exported->second.first;
+      entry.mName = AddString(exported->second.second);
+
+      uint32_t index = (uint32_t)mImports.size();
+      mImports.push_back(entry);
+      mImportIndices[symbol] = index;
+      return index | LibraryImage::ImportBit;
+    }
+
+    template <typename T>
+    void AddList(LibraryImageSymbol& entry, const std::vector<T*>& symbols)
+    {
+      entry.mFirst = (uint32_t)mLists.size();
+      entry.mCount = (uint32_t)symbols.size();
+      for (size_t i = 0; i < symbols.size(); ++i)
+        mLists.push_back(Reference(symbols[i]));
+    }
+
+    void AddSymbol(Symbol* symbol)
+    {
+      LibraryImageSymbol entry;
+      memset(&entry, 0, sizeof(entry));
+      entry.mName = AddString(symbol->mAtom);
+      entry.mType = Reference(symbol->mType);
+      entry.mParentType = Reference(symbol->mParentType);
+      entry.mParentFunction = Reference(symbol->mParentFunction);
+      entry.mPointerToType = LibraryImage::None;
+      entry.mReturnType = LibraryImage::None;
+
+      if (Type* type = dynamic_cast<Type*>(symbol))
+      {
+        entry.mKind = LibraryImage::Kind::Type;
+        entry.mMode = (uint8_t)type->mMode;
+        entry.mPointerToType = Reference(type->mPointerToType);
+        if (type->mClass)
+          AddList(entry, type->mClass->mMembers);
+        if (type->mFunction)
+        {
+          entry.mReturnType = Reference(type->mFunction->mReturnType);
+          AddList(entry, type->mFunction->mParameterTypes);
+        }
+      }
+      else if (Variable* variable = dynamic_cast<Variable*>(symbol))
+      {
+        entry.mKind = LibraryImage::Kind::Variable;
+        entry.mIsParameter = variable->mIsParameter;
+      }
+      else if (Function* function = dynamic_cast<Function*>(symbol))
+      {
+        entry.mKind = LibraryImage::Kind::Function;
+        AddList(entry, function->mLocals);
+      }
+      else
+      {
+        entry.mKind = LibraryImage::Kind::Label;
+      }
+
+      mSymbols.push_back(entry);
+    }
+
+    Library* mLibrary;
+    bool mFailed;
+
+    std::unordered_map<Symbol*, uint32_t> mIndices;
+    std::unordered_map<Symbol*, uint32_t> mImportIndices;
+    // The globals of the dependencies, with the index of their library and their name
+    std::unordered_map<Symbol*, std::pair<uint32_t, Atom>> mExports;
+    std::unordered_map<Atom, uint32_t> mStringIndices;
+
+    std::vector<LibraryImageString> mStrings;
+    std::string mStringData;
+    std::vector<LibraryImageImport> mImports;
+    std::vector<LibraryImageSymbol> mSymbols;
+    std::vector<uint32_t> mLists;
+    std::vector<uint32_t> mGlobals;
+  };
+
+  class ImageReader
+  {
+  public:
+    ImageReader(const char* image, size_t size, const std::vector<Library*>& dependencies, Library* library) :
+      mImage(image),
+      mSize(size),
+      mDependencies(dependencies),
+      mLibrary(library),
+      mFailed(false)
+    {
+    }
+
+    bool Read()
+    {
+      if (mSize < sizeof(LibraryImageHeader) || (reinterpret_cast<uintptr_t>(mImage) & 3) != 0)
+        return false;
+
+      const LibraryImageHeader& header = *reinterpret_cast<const LibraryImageHeader*>(mImage);
+      if (header.mMagic != LibraryImage::Magic || header.mVersion != LibraryImage::Version || header.mSize > mSize)
+        return false;
+      if (header.mDependencyCount > mDependencies.size())
+        return false;
+
+      const LibraryImageString* strings = GetSection<LibraryImageString>(header.mStrings, header.mStringCount);
+      const char* stringData = GetSection<char>(header.mStringData, header.mStringDataSize);
+      const LibraryImageImport* imports = GetSection<LibraryImageImport>(header.mImports, header.mImportCount);
+      const LibraryImageSymbol* symbols = GetSection<LibraryImageSymbol>(header.mSymbols, header.mSymbolCount);
+      mLists = GetSection<uint32_t>(header.mLists, header.mListSize);
+      mListSize = header.mListSize;
+      const uint32_t* globals = GetSection<uint32_t>(header.mGlobals, header.mGlobalCount);
+      if (mFailed)
+        return false;
+
+      mAtoms.resize(header.mStringCount);
+      for (uint32_t i = 0; i < header.mStringCount; ++i)
+      {
+        if ((uint64_t)strings[i].mOffset + strings[i].mLength > header.mStringDataSize)
+          return false;
+        mAtoms[i] = InternString(stringData + strings[i].mOffset, strings[i].mLength);
+      }
+
+      // Relocation: each import becomes a pointer to the symbol of that name in its dependency
+      mImports.resize(header.mImportCount);
+      for (uint32_t i = 0; i < header.mImportCount; ++i)
+      {
+        if (imports[i].mDependency >= mDependencies.size() || imports[i].mName >= mAtoms.size())
+          return false;
+
+        Library* dependency = mDependencies[imports[i].mDependency];
+        std::unordered_map<Atom, Symbol*>::iterator it = dependency->mGlobalsByName.find(mAtoms[imports[i].mName]);
+        if (it == dependency->mGlobalsByName.end())
+          return false;
+        mImports[i] = it->second;
+      }
+
+      // Every symbol is created before any of them are filled in, since they refer to each other in any order
+      mSymbols.resize(header.mSymbolCount);
+      for (uint32_t i = 0; i < header.mSymbolCount; ++i)
+      {
+        mSymbols[i] = CreateSymbol(symbols[i]);
+        if (mSymbols[i] == nullptr)
+          return false;
+      }
+
+      for (uint32_t i = 0; i < header.mSymbolCount; ++i)
+        FillSymbol(symbols[i], mSymbols[i]);
+
+      for (uint32_t i = 0; i < header.mGlobalCount && !mFailed; ++i)
+        AddGlobal(Resolve(globals[i]));
+
+      return !mFailed;
+    }
+
+  private:
+    template <typename T>
+    const T* GetSection(uint32_t offset, uint32_t count)
+    {
+      if (offset % 4 != 0 || (uint64_t)offset + (uint64_t)count * sizeof(T) > mSize)
+      {
+        mFailed = true;
+        return nullptr;
+      }
+      return reinterpret_cast<const T*>(mImage + offset);
+    }
+
+    Symbol* CreateSymbol(const LibraryImageSymbol& entry)
+    {
+      if (entry.mName >= mAtoms.size())
+        return nullptr;
+
+      Symbol* symbol = nullptr;
+      switch (entry.mKind)
+      {
+        case LibraryImage::Kind::Type:
+        {
+          Type* type = mLibrary->Allocate<Type>();
+          type->mMode = (TypeMode::Enum)entry.mMode;
+          if (type->mMode == TypeMode::Class)
+            type->mClass = mLibrary->Construct<ClassTypeRecord>();
+          else if (type->mMode == TypeMode::Function)
+            type->mFunction = mLibrary->Construct<FunctionTypeRecord>();
+          else if (type->mMode != TypeMode::Pointer)
+            return nullptr;
+          symbol = type;
+          break;
+        }
+
+        case LibraryImage::Kind::Variable:
+        {
+          Variable* variable = mLibrary->Allocate<Variable>();
+          variable->mIsParameter = entry.mIsParameter != 0;
+          symbol = variable;
+          break;
+        }
+
+        case LibraryImage::Kind::Function:
+          symbol = mLibrary->Allocate<Function>();
+          break;
+
+        case LibraryImage::Kind::Label:
+          symbol = mLibrary->Allocate<Label>();
+          break;
+
+        default:
+          return nullptr;
+      }
+
+      symbol->mAtom = mAtoms[entry.mName];
+      symbol->mName = GetAtomString(symbol->mAtom);
+      return symbol;
+    }
+
+    Symbol* Resolve(uint32_t reference)
+    {
+      if (reference == LibraryImage::None)
+        return nullptr;
+
+      if (reference & LibraryImage::ImportBit)
+      {
+        uint32_t index = reference & ~LibraryImage::ImportBit;
+        if (index < mImports.size())
+          return mImports[index];
+      }
+      else if (reference < mSymbols.size())
+      {
+        return mSymbols[reference];
+      }
+
+      mFailed = true;
+      return nullptr;
+    }
+
+    // Resolves a reference that has to be a particular kind of symbol (or no symbol)
+    template <typename T>
+    T* ResolveAs(uint32_t reference)
+    {
+      Symbol* symbol = Resolve(reference);
+      T* result = dynamic_cast<T*>(symbol);
+      if (symbol && result == nullptr)
+        mFailed = true;
+      return result;
+    }
+
+    // The references of one symbol's range of the lists
+    bool GetList(const LibraryImageSymbol& entry, const uint32_t*& list)
+    {
+      if ((uint64_t)entry.mFirst + entry.mCount > mListSize)
+      {
+        mFailed = true;
+        return false;
+      }
+      list = mLists + entry.mFirst;
+      return true;
+    }
+
+    void FillSymbol(const LibraryImageSymbol& entry, Symbol* symbol)
+    {
+      symbol->mType = ResolveAs<Type>(entry.mType);
+      symbol->mParentType = ResolveAs<Type>(entry.mParentType);
+      symbol->mParentFunction = ResolveAs<Function>(entry.mParentFunction);
+
+      const uint32_t* list = nullptr;
+      if (entry.mKind == LibraryImage::Kind::Type)
+      {
+        Type* type = static_cast<Type*>(symbol);
+        type->mPointerToType = ResolveAs<Type>(entry.mPointerToType);
+        if (type->mMode == TypeMode::Pointer && type->mPointerToType == nullptr)
+          mFailed = true;
+
+        if (type->mClass && GetList(entry, list))
+        {
+          for (uint32_t i = 0; i < entry.mCount; ++i)
+          {
+            Symbol* member = Resolve(list[i]);
+            if (member == nullptr)
+            {
+              mFailed = true;
+              return;
+            }
+            type->mClass->mMembers.push_back(member);
+            type->mClass->mMembersByName[member->mAtom] = member;
+          }
+        }
+        else if (type->mFunction && GetList(entry, list))
+        {
+          type->mFunction->mReturnType = ResolveAs<Type>(entry.mReturnType);
+          for (uint32_t i = 0; i < entry.mCount; ++i)
+            type->mFunction->mParameterTypes.push_back(ResolveAs<Type>(list[i]));
+        }
+      }
+      else if (entry.mKind == LibraryImage::Kind::Function && GetList(entry, list))
+      {
+        Function* function = static_cast<Function*>(symbol);
+        for (uint32_t i = 0; i < entry.mCount; ++i)
+        {
+          Symbol* local = Resolve(list[i]);
+          if (local == nullptr)
+          {
+            mFailed = true;
+            return;
+          }
+          function->mLocals.push_back(local);
+          function->mLocalsByName.insert(std::make_pair(local->mAtom, local));
+          if (Label* label = dynamic_cast<Label*>(local))
+            function->mLabelsByName[label->mAtom] = label;
+        }
+      }
+    }
+
+    void AddGlobal(Symbol* symbol)
+    {
+      if (symbol == nullptr || symbol->mLibrary != mLibrary)
+      {
+        mFailed = true;
+        return;
+      }
+
+      mLibrary->mGlobals.push_back(symbol);
+      mLibrary->mGlobalsByName[symbol->mAtom] = symbol;
+
+      // The caches GetPointerType and GetFunctionType look in before creating a type
+      Type* type = dynamic_cast<Type*>(symbol);
+      if (type && type->mMode == TypeMode::Pointer)
+        mLibrary->mPointerTypes[type->mPointerToType] = type;
+      else if (type && type->mMode == TypeMode::Function)
+        mLibrary->mFunctionTypes.Add(type);
+    }
+
+    const char* mImage;
+    size_t mSize;
+    const std::vector<Library*>& mDependencies;
+    Library* mLibrary;
+    bool mFailed;
+
+    const uint32_t* mLists;
+    uint32_t mListSize;
+    std::vector<Atom> mAtoms;
+    std::vector<Symbol*> mImports;
+    std::vector<Symbol*> mSymbols;
+  };
+
+  // A read only view of a whole file, mapped into memory
+  class MappedFile
+  {
+  public:
+    MappedFile(const char* path) :
+      mData(nullptr),
+      mSize(0)
+    {
+#ifdef _WIN32
+      mFile = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+      mMapping = nullptr;
+      LARGE_INTEGER size;
+      if (mFile == INVALID_HANDLE_VALUE || !GetFileSizeEx(mFile, &size) || size.QuadPart == 0)
+        return;
+
+      mMapping = CreateFileMappingA(mFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+      if (mMapping == nullptr)
+        return;
+
+      mData = static_cast<const char*>(MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0));
+      if (mData)
+        mSize = (size_t)size.QuadPart;
+#else
+      int file = open(path, O_RDONLY);
+      if (file < 0)
+        return;
+
+      struct stat info;
+      if (fstat(file, &info) == 0 && info.st_size > 0)
+      {
+        void* data = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+        if (data != MAP_FAILED)
+        {
+          mData = static_cast<const char*>(data);
+          mSize = (size_t)info.st_size;
+        }
+      }
+
+      // The mapping keeps the file open on its own
+      close(file);
+#endif
+    }
+
+    ~MappedFile()
+    {
+#ifdef _WIN32
+      if (mData)
+        UnmapViewOfFile(mData);
+      if (mMapping)
+        CloseHandle(mMapping);
+      if (mFile != INVALID_HANDLE_VALUE)
+        CloseHandle(mFile);
+#else
+      if (mData)
+        munmap(const_cast<char*>(mData), mSize);
+#endif
+    }
+
+    const char* mData;
+    size_t mSize;
+
+  private:
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+#ifdef _WIN32
+    HANDLE mFile;
+    HANDLE mMapping;
+#endif
+  };
+}
+
+bool WriteLibraryImage(Library* library, const std::vector<Library*>& dependencies, std::vector<char>& image)
+{
+  ImageWriter writer(library, dependencies);
+  if (writer.Write(image))
+    return true;
+
+  image.clear();
+  return false;
+}
+
+bool ReadLibraryImage(const char* image, size_t size, const std::vector<Library*>& dependencies, Library* library)
+{
+  ImageReader reader(image, size, dependencies, library);
+  if (reader.Read())
+    return true;
+
+  // Whatever was rebuilt before the image turned out to be bad would otherwise clash with analyzing into the library
+  library->Clear();
+  return false;
+}
+
+bool WriteLibraryFile(const char* path, Library* library, const std::vector<Library*>& dependencies)
+{
+  std::vector<char> image;
+  if (!WriteLibraryImage(library, dependencies, image))
+    return false;
+
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  file.write(image.data(), image.size());
+  return file.good();
+}
+
+bool ReadLibraryFile(const char* path, const std::vector<Library*>& dependencies, Library* library)
+{
+  MappedFile file(path);
+  if (file.mData == nullptr)
+    return false;
+
+  return ReadLibraryImage(file.mData, file.mSize, dependencies, library);
+}
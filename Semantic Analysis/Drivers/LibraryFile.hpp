@@ -0,0 +1,133 @@
+/******************************************************************\
+ * Copyright 2015, DigiPen Institute of Technology
+\******************************************************************/
+
+#pragma once
+#ifndef COMPILER_CLASS_LIBRARY_FILE
+#define COMPILER_CLASS_LIBRARY_FILE
+
+#include "SymbolTable.hpp"
+#include <cstdint>
+
+// A Library that has already been analyzed, saved as one block of bytes
+// The image holds every symbol of mAllSymbols (in order) with its type, parents, members, locals and signature
+// Everything is made of 32-bit fields in native byte order, and sections refer to each other by offset from the
+// start of the image, so reading it needs no pointer fixups wherever it sits in memory
+// The analyzer can't use symbols in place, though (they hold std::string names and virtual functions), so loading
+// always rebuilds every symbol on the heap and the image is not needed afterwards
+//
+// Layout (each section starts on a 4 byte boundary):
+//   LibraryImageHeader
+//   Strings:    one LibraryImageString per distinct name, pointing into the string data
+//   String data the bytes of every name, back to back (not terminated)
+//   Imports:    the symbols of dependencies that are referred to, by dependency index and name
+//   Symbols:    one LibraryImageSymbol per symbol
+//   Lists:      symbol references, which members, locals and parameter types are ranges of
+//   Globals:    the index of each symbol of mGlobals, in order
+namespace LibraryImage
+{
+  // 'SLIB'
+  const uint32_t Magic = 0x42494C53;
+  const uint32_t Version = 1;
+
+  // A reference to a symbol is its index in the image's symbols
+  // With ImportBit set, it is instead the index of an import (a symbol of one of the dependencies)
+  const uint32_t None = 0xFFFFFFFF;
+  const uint32_t ImportBit = 0x80000000;
+
+  namespace Kind
+  {
+    enum Enum
+    {
+      Type,
+      Variable,
+      Function,
+      Label
+    };
+  }
+}
+
+class LibraryImageHeader
+{
+public:
+  uint32_t mMagic;
+  uint32_t mVersion;
+  uint32_t mSize;
+  uint32_t mDependencyCount;
+
+  // The offset of each section from the start of the image, and how many entries it has (or bytes, for the data)
+  uint32_t mStrings;
+  uint32_t mStringCount;
+  uint32_t mStringData;
+  uint32_t mStringDataSize;
+  uint32_t mImports;
+  uint32_t mImportCount;
+  uint32_t mSymbols;
+  uint32_t mSymbolCount;
+  uint32_t mLists;
+  uint32_t mListSize;
+  uint32_t mGlobals;
+  uint32_t mGlobalCount;
+};
+
+class LibraryImageString
+{
+public:
+  // Relative to the start of the string data
+  uint32_t mOffset;
+  uint32_t mLength;
+};
+
+class LibraryImageImport
+{
+public:
+  // The index of the library in the dependencies, and the name of the global symbol we want from it
+  uint32_t mDependency;
+  uint32_t mName;
+};
+
+class LibraryImageSymbol
+{
+public:
+  // A LibraryImage::Kind
+  uint8_t mKind;
+  // The TypeMode of a Type
+  uint8_t mMode;
+  // Whether a Variable is a parameter
+  uint8_t mIsParameter;
+  uint8_t mPadding;
+
+  // The index of the name in the strings
+  uint32_t mName;
+
+  // Symbol references (or LibraryImage::None)
+  uint32_t mType;
+  uint32_t mParentType;
+  uint32_t mParentFunction;
+  uint32_t mPointerToType;
+  uint32_t mReturnType;
+
+  // The range of the lists that holds a class's members, a function's locals, or a function type's parameter types
+  uint32_t mFirst;
+  uint32_t mCount;
+};
+
+// Saves an analyzed library as an image
+// Any symbol it refers to that it does not own must be a global of one of the dependencies
+// Returns false (leaving the image empty) if it refers to a symbol it can't find
+bool WriteLibraryImage(Library* library, const std::vector<Library*>& dependencies, std::vector<char>& image);
+
+// Rebuilds a library from an image into an empty library
+// Every symbol is created again in the library's slabs with its own copy of its name, in one pass over the image
+// The dependencies must be the libraries the image was written with (in the same order), so that every
+// import can be found again by name, which relocates references to their types into this process
+// Returns false if the image is malformed or an import can't be found, in which case the library is left empty again
+bool ReadLibraryImage(const char* image, size_t size, const std::vector<Library*>& dependencies, Library* library);
+
+// The same, through a file
+// Reading maps the file into memory instead of reading it, and unmaps it as soon as the library is rebuilt
+// (nothing points into the mapping afterwards)
+bool WriteLibraryFile(const char* path, Library* library, const std::vector<Library*>& dependencies);
+bool ReadLibraryFile(const char* path, const std::vector<Library*>& dependencies, Library* library);
+
+#endif
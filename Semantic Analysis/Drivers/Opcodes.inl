@@ -0,0 +1,78 @@
+// The instructions of the VirtualMachine
+// A, B and C are the operands of an Instruction. Registers are named r, so rA is the register numbered A
+// A target is the index of an instruction, kept in B (low half) and C (high half)
+// An 'Extra' following an instruction holds a size (in A and B) that didn't fit, and is never run itself
+// Booleans are 0 or 1 and Bytes are 0 to 255, both held in a register the same way an Integer is
+
+OPCODE(Move,                  "rA = rB"                                  )
+OPCODE(LoadConstant,          "rA = constant B"                          )
+OPCODE(Clear,                 "rA = 0"                                   )
+OPCODE(FrameAddress,          "rA = frame + B:C"                         )
+
+OPCODE(IntegerAdd,            "rA = rB + rC"                             )
+OPCODE(IntegerAddImmediate,   "rA = rB + C (C is signed)"                )
+OPCODE(IntegerSubtract,       "rA = rB - rC"                             )
+OPCODE(IntegerMultiply,       "rA = rB * rC"                             )
+OPCODE(IntegerDivide,         "rA = rB / rC"                             )
+OPCODE(IntegerModulo,         "rA = rB % rC"                             )
+OPCODE(IntegerNegate,         "rA = -rB"                                 )
+
+OPCODE(FloatAdd,              "rA = rB + rC"                             )
+OPCODE(FloatSubtract,         "rA = rB - rC"                             )
+OPCODE(FloatMultiply,         "rA = rB * rC"                             )
+OPCODE(FloatDivide,           "rA = rB / rC"                             )
+OPCODE(FloatModulo,           "rA = fmod(rB, rC)"                        )
+OPCODE(FloatNegate,           "rA = -rB"                                 )
+
+OPCODE(IntegerLess,           "rA = rB < rC"                             )
+OPCODE(IntegerLessOrEqual,    "rA = rB <= rC"                            )
+OPCODE(IntegerEqual,          "rA = rB == rC"                            )
+OPCODE(IntegerNotEqual,       "rA = rB != rC"                            )
+OPCODE(FloatLess,             "rA = rB < rC"                             )
+OPCODE(FloatLessOrEqual,      "rA = rB <= rC"                            )
+OPCODE(FloatEqual,            "rA = rB == rC"                            )
+OPCODE(FloatNotEqual,         "rA = rB != rC"                            )
+OPCODE(PointerLess,           "rA = rB < rC"                             )
+OPCODE(PointerLessOrEqual,    "rA = rB <= rC"                            )
+OPCODE(PointerEqual,          "rA = rB == rC"                            )
+OPCODE(PointerNotEqual,       "rA = rB != rC"                            )
+OPCODE(ClassEqual,            "rA = the Extra bytes at rB and rC match"  )
+OPCODE(Not,                   "rA = !rB"                                 )
+
+OPCODE(IntegerToFloat,        "rA = (Float)rB"                           )
+OPCODE(FloatToInteger,        "rA = (Integer)rB"                         )
+OPCODE(FloatToByte,           "rA = (Byte)rB"                            )
+OPCODE(IntegerToByte,         "rA = (Byte)rB"                            )
+OPCODE(IntegerToBoolean,      "rA = rB != 0"                             )
+OPCODE(FloatToBoolean,        "rA = rB != 0.0"                           )
+OPCODE(PointerToBoolean,      "rA = rB != null"                          )
+OPCODE(IntegerToPointer,      "rA = (pointer)rB"                         )
+OPCODE(PointerToInteger,      "rA = (Integer)rB"                         )
+
+OPCODE(PointerAdd,            "rA = rB + rC bytes"                       )
+OPCODE(PointerAddImmediate,   "rA = rB + C bytes (C is signed)"          )
+OPCODE(MemberAddress,         "rA = rB + C bytes (rB not null)"          )
+OPCODE(PointerAddScaled,      "rA = rB + rC * Extra bytes"               )
+OPCODE(IndexAddress,          "rA = rB + rC * Extra bytes (rB not null)" )
+OPCODE(PointerDifference,     "rA = rB - rC in bytes"                    )
+
+OPCODE(LoadInteger,           "rA = 4 bytes at rB + C (Integer or Float)")
+OPCODE(LoadByte,              "rA = the Byte at rB + C"                  )
+OPCODE(LoadBoolean,           "rA = the Boolean at rB + C"               )
+OPCODE(LoadPointer,           "rA = the pointer at rB + C"               )
+OPCODE(StoreInteger,          "4 bytes at rB + C = rA"                   )
+OPCODE(StoreByte,             "the Byte (or Boolean) at rB + C = rA"     )
+OPCODE(StorePointer,          "the pointer at rB + C = rA"               )
+OPCODE(Copy,                  "the Extra bytes at rA = those at rB"      )
+OPCODE(Zero,                  "the Extra bytes at rA = 0"                )
+
+OPCODE(Jump,                  "go to target"                             )
+OPCODE(JumpIfTrue,            "go to target if rA"                       )
+OPCODE(JumpIfFalse,           "go to target if !rA"                      )
+OPCODE(Call,                  "rA = constant C(rB...)"                   )
+OPCODE(CallIndirect,          "rA = rC(rB...)"                           )
+OPCODE(Return,                "return rA"                                )
+OPCODE(ReturnVoid,            "return"                                   )
+OPCODE(ReturnClass,           "copy the Extra bytes at rA to the caller" )
+OPCODE(Error,                 "throw message A"                          )
+OPCODE(Extra,                 "a size for the instruction before"        )
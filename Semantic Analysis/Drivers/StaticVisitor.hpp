@@ -0,0 +1,292 @@
+/******************************************************************\
+ * Copyright 2015, DigiPen Institute of Technology
+\******************************************************************/
+
+#pragma once
+#ifndef COMPILER_CLASS_STATIC_VISITOR
+#define COMPILER_CLASS_STATIC_VISITOR
+
+#include "AstNodes.hpp"
+
+enum VisitResult
+{
+  Continue,
+  Stop
+};
+
+// A visitor that is resolved at compile time instead of through virtual calls
+// Derived passes itself as the template argument, pulls these overloads in with
+// 'using StaticVisitor<Derived>::Visit;' and then hides the ones it cares about
+// Any Visit it does not hide forwards to the base class of the node, just like the virtual Visitor
+// Walk switches on AbstractNode::mKind and visits nodes in the same order (and as many times) as AbstractNode::Walk
+template <typename Derived>
+class StaticVisitor
+{
+public:
+  VisitResult Visit(AbstractNode*   node)     { return Continue;                                 }
+  VisitResult Visit(BlockNode* node)          { return Self().Visit((AbstractNode*)node);       }
+  VisitResult Visit(StatementNode*  node)     { return Self().Visit((AbstractNode*)node);       }
+  VisitResult Visit(ExpressionNode* node)     { return Self().Visit((StatementNode*)node);      }
+  VisitResult Visit(UnaryOperatorNode* node)  { return Self().Visit((ExpressionNode*)node);     }
+  VisitResult Visit(BinaryOperatorNode* node) { return Self().Visit((ExpressionNode*)node);     }
+  VisitResult Visit(PostExpressionNode* node) { return Self().Visit((ExpressionNode*)node);     }
+  VisitResult Visit(MemberAccessNode*   node) { return Self().Visit((PostExpressionNode*)node); }
+  VisitResult Visit(ClassNode*      node)     { return Self().Visit((AbstractNode*)node);       }
+  VisitResult Visit(VariableNode*   node)     { return Self().Visit((StatementNode*)node);      }
+  VisitResult Visit(TypeNode*       node)     { return Self().Visit((AbstractNode*)node);       }
+  VisitResult Visit(ValueNode* node)          { return Self().Visit((ExpressionNode*)node);     }
+  VisitResult Visit(FunctionNode*   node)     { return Self().Visit((AbstractNode*)node);       }
+  VisitResult Visit(ParameterNode*  node)     { return Self().Visit((VariableNode*)node);       }
+  VisitResult Visit(LabelNode* node)          { return Self().Visit((StatementNode*)node);      }
+  VisitResult Visit(GotoNode* node)           { return Self().Visit((StatementNode*)node);      }
+  VisitResult Visit(CallNode* node)           { return Self().Visit((PostExpressionNode*)node); }
+  VisitResult Visit(CastNode* node)           { return Self().Visit((PostExpressionNode*)node); }
+  VisitResult Visit(IndexNode* node)          { return Self().Visit((PostExpressionNode*)node); }
+  VisitResult Visit(ForNode* node)            { return Self().Visit((StatementNode*)node);      }
+  VisitResult Visit(WhileNode* node)          { return Self().Visit((StatementNode*)node);      }
+  VisitResult Visit(ScopeNode* node)          { return Self().Visit((StatementNode*)node);      }
+  VisitResult Visit(IfNode* node)             { return Self().Visit((StatementNode*)node);      }
+  VisitResult Visit(BreakNode* node)          { return Self().Visit((StatementNode*)node);      }
+  VisitResult Visit(ContinueNode* node)       { return Self().Visit((StatementNode*)node);      }
+  VisitResult Visit(ReturnNode* node)         { return Self().Visit((StatementNode*)node);      }
+  VisitResult Visit(ErrorNode* node)          { return Self().Visit((StatementNode*)node);      }
+
+  // Visits the node and then (unless the visit returned Stop) its children
+  // Missing children are skipped
+  void Walk(AbstractNode* node);
+
+  template <typename T>
+  void Walk(const AstPtr<T>& node)
+  {
+    Walk(node.get());
+  }
+
+private:
+  Derived& Self()
+  {
+    return *static_cast<Derived*>(this);
+  }
+
+  template <typename T>
+  void WalkAll(const AstVector<T>& nodes)
+  {
+    for (size_t i = 0; i < nodes.size(); ++i)
+      Walk(nodes[i].get());
+  }
+
+  // The part of a MemberAccess, Call, Cast or Index walk that PostExpressionNode::Walk does
+  void WalkPostExpression(PostExpressionNode* node)
+  {
+    if (Self().Visit(node) == Continue)
+      Walk(node->mLeft);
+  }
+};
+
+template <typename Derived>
+void StaticVisitor<Derived>::Walk(AbstractNode* node)
+{
+  if (node == nullptr)
+    return;
+
+  switch (node->mKind)
+  {
+    case NodeKind::Block:
+    {
+      BlockNode* block = static_cast<BlockNode*>(node);
+      if (Self().Visit(block) == Continue)
+        WalkAll(block->mGlobals);
+      break;
+    }
+
+    case NodeKind::Class:
+    {
+      ClassNode* classNode = static_cast<ClassNode*>(node);
+      if (Self().Visit(classNode) == Continue)
+        WalkAll(classNode->mMembers);
+      break;
+    }
+
+    case NodeKind::Variable:
+    {
+      VariableNode* variable = static_cast<VariableNode*>(node);
+      if (Self().Visit(variable) == Continue)
+      {
+        Walk(variable->mType);
+        Walk(variable->mInitialValue);
+      }
+      break;
+    }
+
+    case NodeKind::Parameter:
+    {
+      // A parameter is visited as a ParameterNode and then again as a VariableNode
+      ParameterNode* parameter = static_cast<ParameterNode*>(node);
+      if (Self().Visit(parameter) == Continue && Self().Visit((VariableNode*)parameter) == Continue)
+      {
+        Walk(parameter->mType);
+        Walk(parameter->mInitialValue);
+      }
+      break;
+    }
+
+    case NodeKind::Scope:
+    {
+      ScopeNode* scope = static_cast<ScopeNode*>(node);
+      if (Self().Visit(scope) == Continue)
+        WalkAll(scope->mStatements);
+      break;
+    }
+
+    case NodeKind::Function:
+    {
+      FunctionNode* function = static_cast<FunctionNode*>(node);
+      if (Self().Visit(function) == Continue)
+      {
+        WalkAll(function->mParameters);
+        Walk(function->mReturnType);
+        Walk(function->mScope);
+      }
+      break;
+    }
+
+    case NodeKind::Type:
+      Self().Visit(static_cast<TypeNode*>(node));
+      break;
+
+    case NodeKind::Label:
+      Self().Visit(static_cast<LabelNode*>(node));
+      break;
+
+    case NodeKind::Goto:
+      Self().Visit(static_cast<GotoNode*>(node));
+      break;
+
+    case NodeKind::Return:
+    {
+      ReturnNode* returnNode = static_cast<ReturnNode*>(node);
+      if (Self().Visit(returnNode) == Continue)
+        Walk(returnNode->mReturnValue);
+      break;
+    }
+
+    case NodeKind::Break:
+      Self().Visit(static_cast<BreakNode*>(node));
+      break;
+
+    case NodeKind::Continue:
+      Self().Visit(static_cast<ContinueNode*>(node));
+      break;
+
+    case NodeKind::Error:
+      Self().Visit(static_cast<ErrorNode*>(node));
+      break;
+
+    case NodeKind::If:
+    {
+      IfNode* ifNode = static_cast<IfNode*>(node);
+      if (Self().Visit(ifNode) == Continue)
+      {
+        Walk(ifNode->mCondition);
+        Walk(ifNode->mScope);
+        Walk(ifNode->mElse);
+      }
+      break;
+    }
+
+    case NodeKind::While:
+    {
+      WhileNode* whileNode = static_cast<WhileNode*>(node);
+      if (Self().Visit(whileNode) == Continue)
+      {
+        Walk(whileNode->mCondition);
+        Walk(whileNode->mScope);
+      }
+      break;
+    }
+
+    case NodeKind::For:
+    {
+      ForNode* forNode = static_cast<ForNode*>(node);
+      if (Self().Visit(forNode) == Continue)
+      {
+        Walk(forNode->mInitialVariable);
+        Walk(forNode->mInitialExpression);
+        Walk(forNode->mCondition);
+        Walk(forNode->mIterator);
+        Walk(forNode->mScope);
+      }
+      break;
+    }
+
+    case NodeKind::Value:
+      Self().Visit(static_cast<ValueNode*>(node));
+      break;
+
+    case NodeKind::BinaryOperator:
+    {
+      BinaryOperatorNode* binary = static_cast<BinaryOperatorNode*>(node);
+      if (Self().Visit(binary) == Continue)
+      {
+        Walk(binary->mLeft);
+        Walk(binary->mRight);
+      }
+      break;
+    }
+
+    case NodeKind::UnaryOperator:
+    {
+      UnaryOperatorNode* unary = static_cast<UnaryOperatorNode*>(node);
+      if (Self().Visit(unary) == Continue)
+        Walk(unary->mRight);
+      break;
+    }
+
+    // These are visited as themselves and then again as a PostExpressionNode
+    // A Stop from the second visit only skips the left side
+    case NodeKind::MemberAccess:
+    {
+      MemberAccessNode* access = static_cast<MemberAccessNode*>(node);
+      if (Self().Visit(access) == Continue)
+        WalkPostExpression(access);
+      break;
+    }
+
+    case NodeKind::Call:
+    {
+      CallNode* call = static_cast<CallNode*>(node);
+      if (Self().Visit(call) == Continue)
+      {
+        WalkPostExpression(call);
+        WalkAll(call->mArguments);
+      }
+      break;
+    }
+
+    case NodeKind::Cast:
+    {
+      CastNode* cast = static_cast<CastNode*>(node);
+      if (Self().Visit(cast) == Continue)
+      {
+        WalkPostExpression(cast);
+        Walk(cast->mType);
+      }
+      break;
+    }
+
+    case NodeKind::Index:
+    {
+      IndexNode* index = static_cast<IndexNode*>(node);
+      if (Self().Visit(index) == Continue)
+      {
+        WalkPostExpression(index);
+        Walk(index->mIndex);
+      }
+      break;
+    }
+
+    default:
+      break;
+  }
+}
+
+#endif
@@ -0,0 +1,68 @@
+/******************************************************************\
+ * Copyright 2015, DigiPen Institute of Technology
+\******************************************************************/
+
+#include "StringAtom.hpp"
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+  class StringTable
+  {
+  public:
+    StringTable()
+    {
+      Intern(std::string());
+    }
+
+    Atom Intern(const std::string& text)
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      std::unordered_map<std::string, Atom>::iterator it = mAtoms.find(text);
+      if (it != mAtoms.end())
+        return it->second;
+
+      Atom atom = (Atom)mStrings.size();
+      it = mAtoms.insert(std::make_pair(text, atom)).first;
+
+      // The keys of an unordered_map never move, so they double as the text of each atom
+      mStrings.push_back(&it->first);
+      return atom;
+    }
+
+    const std::string& GetString(Atom atom)
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      return *mStrings[atom];
+    }
+
+  private:
+    std::mutex mMutex;
+    std::unordered_map<std::string, Atom> mAtoms;
+    std::vector<const std::string*> mStrings;
+  };
+
+  // Created on first use, so atoms may be interned while other globals are being constructed
+  StringTable& GetStringTable()
+  {
+    static StringTable table;
+    return table;
+  }
+}
+
+Atom InternString(const char* text, size_t length)
+{
+  return GetStringTable().Intern(std::string(text, length));
+}
+
+Atom InternString(const std::string& text)
+{
+  return GetStringTable().Intern(text);
+}
+
+const std::string& GetAtomString(Atom atom)
+{
+  return GetStringTable().GetString(atom);
+}
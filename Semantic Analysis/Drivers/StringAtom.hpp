@@ -0,0 +1,28 @@
+/******************************************************************\
+ * Copyright 2015, DigiPen Institute of Technology
+\******************************************************************/
+
+#pragma once
+#ifndef COMPILER_CLASS_STRING_ATOM
+#define COMPILER_CLASS_STRING_ATOM
+
+#include <cstdint>
+#include <string>
+
+// A string interned in the process wide string table
+// Equal strings always get the same atom, so names can be compared and hashed as integers
+typedef uint32_t Atom;
+
+// The atom of the empty string, and of any token that isn't a name
+const Atom EmptyAtom = 0;
+
+// Returns the atom for the text, adding it to the table the first time it is seen
+// Safe to call from several threads at once
+Atom InternString(const char* text, size_t length);
+Atom InternString(const std::string& text);
+
+// The text an atom was interned from
+// The string stays at the same address for the life of the process
+const std::string& GetAtomString(Atom atom);
+
+#endif
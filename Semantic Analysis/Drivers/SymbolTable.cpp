@@ -7,6 +7,7 @@
 #include <sstream>
 
 Symbol::Symbol() :
+  mAtom(EmptyAtom),
   mType(nullptr),
   mParentType(nullptr),
   mParentFunction(nullptr),
@@ -106,15 +107,28 @@ std::string Label::Dump()
 Type::Type() :
   mMode(TypeMode::Class),
   mPointerToType(nullptr),
-  mReturnType(nullptr)
+  mClass(nullptr),
+  mFunction(nullptr)
+{
+}
+
+Type::~Type()
 {
+  // The records live in the library's slabs, which free their memory
+  if (mClass)
+    mClass->~ClassTypeRecord();
+  if (mFunction)
+    mFunction->~FunctionTypeRecord();
 }
 
 void Type::Print(size_t depth)
 {
   Symbol::Print(depth);
 
-  for (Symbol* member : mMembers)
+  if (mClass == nullptr)
+    return;
+
+  for (Symbol* member : mClass->mMembers)
     member->Print(depth + 1);
 }
 
@@ -127,8 +141,106 @@ std::string Type::Dump()
   return stream.str();
 }
 
+FunctionTypeRecord::FunctionTypeRecord() :
+  mReturnType(nullptr)
+{
+}
+
+Type* FunctionTypeTable::Find(const std::vector<Type*>& parameterTypes, Type* returnType) const
+{
+  auto range = mTypes.equal_range(Hash(parameterTypes, returnType));
+  for (auto it = range.first; it != range.second; ++it)
+  {
+    Type* type = it->second;
+    if (type->mFunction->mReturnType == returnType && type->mFunction->mParameterTypes == parameterTypes)
+      return type;
+  }
+
+  return nullptr;
+}
+
+void FunctionTypeTable::Add(Type* functionType)
+{
+  mTypes.insert(std::make_pair(Hash(functionType->mFunction->mParameterTypes, functionType->mFunction->mReturnType), functionType));
+}
+
+void FunctionTypeTable::Remove(Type* functionType)
+{
+  auto range = mTypes.equal_range(Hash(functionType->mFunction->mParameterTypes, functionType->mFunction->mReturnType));
+  for (auto it = range.first; it != range.second; ++it)
+  {
+    if (it->second == functionType)
+    {
+      mTypes.erase(it);
+      return;
+    }
+  }
+}
+
+size_t FunctionTypeTable::Hash(const std::vector<Type*>& parameterTypes, Type* returnType)
+{
+  std::hash<Type*> hasher;
+  size_t hash = hasher(returnType);
+  for (Type* type : parameterTypes)
+    hash = hash * 31 + hasher(type);
+  return hash;
+}
+
 void Library::Print()
 {
   for (Symbol* symbol : mGlobals)
     symbol->Print();
 }
+
+void Library::Destroy(Symbol* symbol)
+{
+  if (Type* type = dynamic_cast<Type*>(symbol))
+  {
+    ClassTypeRecord* classRecord = type->mClass;
+    FunctionTypeRecord* functionRecord = type->mFunction;
+    type->~Type();
+    if (classRecord)
+      Free(classRecord);
+    if (functionRecord)
+      Free(functionRecord);
+    Free(type);
+  }
+  else if (Variable* variable = dynamic_cast<Variable*>(symbol))
+  {
+    variable->~Variable();
+    Free(variable);
+  }
+  else if (Function* function = dynamic_cast<Function*>(symbol))
+  {
+    function->~Function();
+    Free(function);
+  }
+  else if (Label* label = dynamic_cast<Label*>(symbol))
+  {
+    label->~Label();
+    Free(label);
+  }
+}
+
+void Library::Clear()
+{
+  mGlobals.clear();
+  mGlobalsByName.clear();
+  mPointerTypes.clear();
+  mFunctionTypes = FunctionTypeTable();
+
+  for (size_t i = 0; i < mAllSymbols.size(); ++i)
+    Destroy(mAllSymbols[i].release());
+  mAllSymbols.clear();
+}
+
+size_t Library::GetSlabBytes()
+{
+  std::lock_guard<std::mutex> lock(mSlabMutex);
+  return std::get<SymbolSlab<Type>>(mSlabs).GetReservedBytes() +
+         std::get<SymbolSlab<Variable>>(mSlabs).GetReservedBytes() +
+         std::get<SymbolSlab<Function>>(mSlabs).GetReservedBytes() +
+         std::get<SymbolSlab<Label>>(mSlabs).GetReservedBytes() +
+         std::get<SymbolSlab<ClassTypeRecord>>(mSlabs).GetReservedBytes() +
+         std::get<SymbolSlab<FunctionTypeRecord>>(mSlabs).GetReservedBytes();
+}
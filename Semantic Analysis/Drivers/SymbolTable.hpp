@@ -9,6 +9,9 @@
 
 #include "Driver1.hpp"
 #include "DriverShared.hpp"
+#include <mutex>
+#include <new>
+#include <tuple>
 
 // Forward declarations
 class Symbol;
@@ -17,6 +20,9 @@ class Variable;
 class Function;
 class Label;
 class Library;
+class AnalysisContext;
+class ClassTypeRecord;
+class FunctionTypeRecord;
 
 // A symbol is anything that must be identified by name
 class Symbol
@@ -37,6 +43,9 @@ public:
   // That way, all declarations of a pointer to Integer would be resolved to the same symbol name
   std::string mName;
 
+  // The interned mName, which every symbol map is keyed on
+  Atom mAtom;
+
   // The type that this symbol resolves to
   // For a Variable, this is the type it is declared as
   // For a Function, this is the signature type (TypeMode will be Function)
@@ -82,9 +91,12 @@ public:
   // Local variables and labels defined within this function
   std::vector<Symbol*> mLocals;
 
-  // Labels mapped by name
+  // The first of mLocals defined with each name
+  std::unordered_map<Atom, Symbol*> mLocalsByName;
+
+  // Labels mapped by name (atom)
   // Note that it is an error to have two labels defined with the same name (but not a variable and label)
-  std::unordered_map<std::string, Label*> mLabelsByName;
+  std::unordered_map<Atom, Label*> mLabelsByName;
 
   // Its quite common in a scripting language to have your function symbol
   // also point back at the executable version of the function
@@ -120,17 +132,13 @@ class Type : public Symbol
 {
 public:
   Type();
+  ~Type();
   void Print(size_t depth = 0) override;
   std::string Dump() override;
 
   // Whether this is a class (or primitive), pointer, or a function pointer type
   // Default mode is Class
   TypeMode::Enum mMode;
-  
-  //** Only relevant if this mMode is Class **//
-  // The members that belong to this type mapped by name
-  std::vector<Symbol*> mMembers;
-  std::unordered_map<std::string, Symbol*> mMembersByName;
 
   //** Only relevant if this mMode is Pointer **//
   // The type that we point to
@@ -139,23 +147,153 @@ public:
   // Note that for the symbols, we do not use the PointerCount
   Type* mPointerToType;
 
-  //** Only relevant if this mMode is Function **//
+  // The data only one mode needs is kept in a separate record (null for the other modes)
+  // That way pointer types, which are the most common, carry nothing they don't use
+  // The library that creates the type also creates its record, and the type destroys it
+  ClassTypeRecord* mClass;
+  FunctionTypeRecord* mFunction;
+};
+
+// The part of a Type that only a Class (or primitive) has
+class ClassTypeRecord
+{
+public:
+  // The members that belong to this type mapped by name (atom)
+  std::vector<Symbol*> mMembers;
+  std::unordered_map<Atom, Symbol*> mMembersByName;
+};
+
+// The part of a Type that only a Function has
+class FunctionTypeRecord
+{
+public:
+  FunctionTypeRecord();
+
   std::vector<Type*> mParameterTypes;
   Type* mReturnType;
 };
 
+// Function types hash-consed on their signature (the return type and the parameter types)
+// Finding a signature costs a hash of its types and one comparison, no matter how many symbols exist
+// Several libraries may share one table (such as a program and its dependencies) so that they also share
+// their function types. The table is not locked, so libraries sharing one must be analyzed one at a time.
+class FunctionTypeTable
+{
+public:
+  // The function type with exactly this signature (or null if there isn't one)
+  Type* Find(const std::vector<Type*>& parameterTypes, Type* returnType) const;
+
+  void Add(Type* functionType);
+  void Remove(Type* functionType);
+
+private:
+  static size_t Hash(const std::vector<Type*>& parameterTypes, Type* returnType);
+  std::unordered_multimap<size_t, Type*> mTypes;
+};
+
+// Memory for objects of one kind (a kind of symbol or type record), handed out from blocks that are freed together
+// The slab never runs destructors, whoever owns an object destroys it in place
+// The memory of an object destroyed before its library can be given back with Free, and is handed out again first
+template <typename T>
+class SymbolSlab
+{
+public:
+  SymbolSlab() :
+    mUsed(0),
+    mCapacity(0),
+    mReserved(0)
+  {
+  }
+
+  ~SymbolSlab()
+  {
+    for (size_t i = 0; i < mBlocks.size(); ++i)
+      ::operator delete(mBlocks[i]);
+  }
+
+  T* Create()
+  {
+    if (!mFree.empty())
+    {
+      T* memory = mFree.back();
+      mFree.pop_back();
+      return new (memory) T();
+    }
+
+    if (mUsed == mCapacity)
+    {
+      // Blocks start small so that tiny libraries stay cheap, and double up to the largest size
+      mCapacity = mCapacity == 0 ? 16 : mCapacity < 1024 ? mCapacity * 2 : mCapacity;
+      mBlocks.push_back(static_cast<T*>(::operator new(mCapacity * sizeof(T))));
+      mReserved += mCapacity;
+      mUsed = 0;
+    }
+
+    return new (mBlocks.back() + mUsed++) T();
+  }
+
+  // Takes back the memory of an object that has already been destroyed
+  void Free(T* object)
+  {
+    mFree.push_back(object);
+  }
+
+  // The bytes of every block, whether or not they are in use
+  size_t GetReservedBytes() const
+  {
+    return mReserved * sizeof(T);
+  }
+
+private:
+  SymbolSlab(const SymbolSlab&) = delete;
+  SymbolSlab& operator=(const SymbolSlab&) = delete;
+
+  std::vector<T*> mBlocks;
+  // How many objects the last block holds, and how many of them are in use
+  size_t mUsed;
+  size_t mCapacity;
+  // How many objects all of the blocks hold
+  size_t mReserved;
+  // Memory given back with Free
+  std::vector<T*> mFree;
+};
+
+// Symbols live in their library's slabs, so deleting one only destroys it
+struct SymbolDestroyer
+{
+  void operator()(Symbol* symbol) const
+  {
+    symbol->~Symbol();
+  }
+};
+
+typedef unique_vector<Symbol, SymbolDestroyer> SymbolVector;
+
 // The library owns all symbols and is responsible for destroying them
 class Library
 {
+  // The memory of every symbol and type record the library creates
+  // Declared first so that it is freed only after every symbol has been destroyed
+  std::tuple<SymbolSlab<Type>, SymbolSlab<Variable>, SymbolSlab<Function>, SymbolSlab<Label>,
+             SymbolSlab<ClassTypeRecord>, SymbolSlab<FunctionTypeRecord>> mSlabs;
+  std::mutex mSlabMutex;
+
 public:
   // The library owns all symbols and will cleanup their memory upon destruction
   // This is essentially a flattened array of all symbols (no hierarchy)
-  unique_vector<Symbol> mAllSymbols;
+  SymbolVector mAllSymbols;
 
-  // All symbols that should be made available globally (mapped by name)
+  // All symbols that should be made available globally (mapped by name atom)
   // You will typically use this to initialize your symbol scope stack (the first push)
   std::vector<Symbol*> mGlobals;
-  std::unordered_map<std::string, Symbol*> mGlobalsByName;
+  std::unordered_map<Atom, Symbol*> mGlobalsByName;
+
+  // The pointer types this library has handed out, by the type they point to
+  // Lets GetPointerType find an existing pointer type without building its name
+  std::unordered_map<Type*, Type*> mPointerTypes;
+
+  // The function types this library has handed out, by signature (see GetFunctionType)
+  FunctionTypeTable mFunctionTypes;
   
   // Prints out the symbols recursively, showing the hierarchy
   void Print();
@@ -164,14 +302,23 @@ public:
 
   // Create a Type, Variable, Function, or Label symbol
   // The library is responsible for the destruction of these, therefore they must be added to 'mAllSymbols'
+  // A Variable, Function or Label is owned by 'owner' instead when one is given (it must be handed to 'mAllSymbols' later)
   // If the symbol is not nested within a class or function then it must be added to 'mGlobals' and 'mGlobalsByName'
   // The name and library for the symbol should also be filled out
   // If global, this should throw ErrorSameName for duplicate symbol names
   // I recommend using templates to simplify this code
-  Type*     CreateType    (const std::string& name, bool isGlobal = false);
-  Variable* CreateVariable(const std::string& name, bool isGlobal = false);
-  Function* CreateFunction(const std::string& name, bool isGlobal = false);
-  Label*    CreateLabel   (const std::string& name, bool isGlobal = false);
+  // The context (when given) is the semantic analysis that the symbols are for, and receives any new global types
+  // Without one, the library only looks through its own symbols
+  Type*     CreateType    (const std::string& name, bool isGlobal = false, AnalysisContext* context = nullptr);
+  Variable* CreateVariable(const std::string& name, bool isGlobal = false, SymbolVector* owner = nullptr);
+  Function* CreateFunction(const std::string& name, bool isGlobal = false, SymbolVector* owner = nullptr);
+  Label*    CreateLabel   (const std::string& name, bool isGlobal = false, SymbolVector* owner = nullptr);
+
+  // The same, for a name that is already interned (such as the name of an Identifier token)
+  Type*     CreateType    (Atom name, bool isGlobal = false, AnalysisContext* context = nullptr);
+  Variable* CreateVariable(Atom name, bool isGlobal = false, SymbolVector* owner = nullptr);
+  Function* CreateFunction(Atom name, bool isGlobal = false, SymbolVector* owner = nullptr);
+  Label*    CreateLabel   (Atom name, bool isGlobal = false, SymbolVector* owner = nullptr);
 
   // Add a pointer to the given type
   // This function should find an existing symbol by normalized name or return a new symbol
@@ -179,17 +326,59 @@ public:
   // Passing 'Integer' with 'TypeMode::Value' would return 'Integer*' with 'TypeMode::Pointer'
   // Passing 'Float*' with 'TypeMode::Pointer' would return 'Float**' with 'TypeMode::Pointer'
   // The return should always be 'TypeMode::Pointer'
-  Type* GetPointerType(Type* pointerToType);
+  Type* GetPointerType(Type* pointerToType, AnalysisContext* context = nullptr);
 
   // Get a series of pointers given a base Class or Function type, and a number of pointers
   // If 'pointerCount' is 0, this should return the same type that was passed in
-  Type* GetPointerType(Type* pointerToType, size_t pointerCount);
+  Type* GetPointerType(Type* pointerToType, size_t pointerCount, AnalysisContext* context = nullptr);
   
   // Get a function symbol for the given types and return value
-  // This function should find an existing symbol by normalized name or return a new symbol
+  // This function should find an existing symbol in 'mFunctionTypes' or return a new symbol
   // Any newly created symbols should be added to 'mGlobals'
   // The return should always be 'TypeMode::Function'
-  Type* GetFunctionType(std::vector<Type*> parameterTypes, Type* returnType);
+  Type* GetFunctionType(std::vector<Type*> parameterTypes, Type* returnType, AnalysisContext* context = nullptr);
+
+  // Creates an empty symbol of this library that 'owner' (or 'mAllSymbols') owns from the start
+  // Used by the functions above, and to rebuild a library from an image (see ReadLibraryImage)
+  // The symbol is never copied or moved, so pointers to it stay valid for as long as the library lives
+  template <typename T>
+  T* Allocate(SymbolVector* owner = nullptr)
+  {
+    if (owner == nullptr)
+      owner = &mAllSymbols;
+
+    T* symbol = Construct<T>();
+    owner->push_back(SymbolVector::value_type(symbol));
+    symbol->mLibrary = this;
+    return symbol;
+  }
+
+  // Constructs a symbol or type record in its slab
+  // Locked, since the bodies of functions may be declaring their locals on several threads at once
+  template <typename T>
+  T* Construct()
+  {
+    std::lock_guard<std::mutex> lock(mSlabMutex);
+    return std::get<SymbolSlab<T>>(mSlabs).Create();
+  }
+
+  // Destroys a symbol of this library that nothing owns anymore, and gives its memory (and its type's records) back
+  // to the slabs, so that symbols removed while the library lives don't keep their memory until it is destroyed
+  void Destroy(Symbol* symbol);
+
+  // Destroys every symbol of the library and empties it, as if it had just been created
+  void Clear();
+
+  // The bytes of every slab, for checking that symbols removed from a long lived library are reused
+  size_t GetSlabBytes();
+
+private:
+  template <typename T>
+  void Free(T* object)
+  {
+    std::lock_guard<std::mutex> lock(mSlabMutex);
+    std::get<SymbolSlab<T>>(mSlabs).Free(object);
+  }
 };
 
 #endif
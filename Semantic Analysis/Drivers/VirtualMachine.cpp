@@ -0,0 +1,2286 @@
+/******************************************************************\
+ * Copyright 2015, DigiPen Institute of Technology
+\******************************************************************/
+
+#include "VirtualMachine.hpp"
+#include "Jit.hpp"
+#include "StaticVisitor.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unordered_set>
+
+// GCC and Clang can jump straight from one instruction to the next through a table of labels,
+// which predicts better than coming back around to one switch
+#if defined(__GNUC__) || defined(__clang__)
+#define VM_COMPUTED_GOTO 1
+#else
+#define VM_COMPUTED_GOTO 0
+#endif
+
+const char* const OpcodeNames[] =
+{
+  #define OPCODE(Name, Description) #Name,
+  #include "Opcodes.inl"
+  #undef OPCODE
+};
+
+namespace
+{
+  // The machine's stack, which the memory of every frame (and any class value a call returns) comes out of
+  const size_t StackSize = 1024 * 1024;
+
+  // Registers shared by all the frames, each frame's right after its caller's
+  const size_t RegisterFileSize = 256 * 1024;
+
+  // Calls don't nest on the host's stack, so this only stops runaway recursion (and is deeper than the Interpreter's 512)
+  const size_t MaxCallDepth = 16 * 1024;
+
+  // Register numbers and constant indices have to fit in an operand
+  const size_t MaxOperand = 0xFFFF;
+
+  void ErrorExecution(const std::string& error)
+  {
+    throw ExecutionException(error);
+  }
+
+  size_t AlignUp(size_t offset, size_t alignment)
+  {
+    return (offset + alignment - 1) & ~(alignment - 1);
+  }
+
+  uint32_t GetTarget(const Instruction& instruction)
+  {
+    return instruction.mB | ((uint32_t)instruction.mC << 16);
+  }
+
+  // The size in the Extra that follows an instruction
+  uint32_t GetExtra(const Instruction* instruction)
+  {
+    return instruction[1].mA | ((uint32_t)instruction[1].mB << 16);
+  }
+
+  bool FitsImmediate(int64_t value)
+  {
+    return value >= INT16_MIN && value <= INT16_MAX;
+  }
+
+  // The locals of a function that have their address taken, which have to live in memory
+  class AddressTakenFinder : public StaticVisitor<AddressTakenFinder>
+  {
+  public:
+    using StaticVisitor<AddressTakenFinder>::Visit;
+
+    VisitResult Visit(UnaryOperatorNode* node)
+    {
+      if (node->mOperator.mEnumTokenType == TokenType::BitwiseAndAddressOf && node->mRight->mKind == NodeKind::Value)
+      {
+        Symbol* symbol = static_cast<ValueNode*>(node->mRight.get())->mResolvedSymbol;
+        if (symbol != nullptr && symbol->mParentFunction != nullptr)
+          mLocals.insert(symbol);
+      }
+      return Continue;
+    }
+
+    std::unordered_set<Symbol*> mLocals;
+  };
+
+  // Whether an expression assigns to anything, which could change a local that was read before it
+  class AssignmentFinder : public StaticVisitor<AssignmentFinder>
+  {
+  public:
+    using StaticVisitor<AssignmentFinder>::Visit;
+
+    AssignmentFinder() :
+      mFound(false)
+    {
+    }
+
+    VisitResult Visit(BinaryOperatorNode* node)
+    {
+      if (node->mOperator.mEnumTokenType == TokenType::Assignment)
+        mFound = true;
+      return mFound ? Stop : Continue;
+    }
+
+    VisitResult Visit(UnaryOperatorNode* node)
+    {
+      TokenType::Enum op = node->mOperator.mEnumTokenType;
+      if (op == TokenType::Increment || op == TokenType::Decrement)
+        mFound = true;
+      return mFound ? Stop : Continue;
+    }
+
+    bool mFound;
+  };
+}
+
+#pragma region Compiler
+// Turns one function (or the initial values of a tree's globals) into a BytecodeFunction
+class BytecodeCompiler
+{
+public:
+  BytecodeCompiler(VirtualMachine* machine, BytecodeFunction* function);
+
+  void CompileFunction(FunctionNode* node);
+  void CompileGlobals(BlockNode* block);
+
+private:
+  // A value in a register, and the type it really has
+  class Operand
+  {
+  public:
+    uint16_t mRegister;
+    Type* mType;
+  };
+
+  // Where an expression's storage is: a local's register, or an address in a register plus an offset
+  class Place
+  {
+  public:
+    bool mIsRegister;
+    uint16_t mRegister;
+    size_t mOffset;
+    // Whether the address came from a pointer, and so could be null
+    bool mNullable;
+    Type* mType;
+  };
+
+  class Local
+  {
+  public:
+    // The local's value, or for a local in memory, its address
+    uint16_t mRegister;
+    bool mInMemory;
+    size_t mOffset;
+  };
+
+  class Loop
+  {
+  public:
+    std::vector<size_t> mBreaks;
+    std::vector<size_t> mContinues;
+  };
+
+  size_t Emit(Opcode::Enum opcode, size_t a = 0, size_t b = 0, size_t c = 0);
+  void EmitExtra(size_t value);
+  // Jumps are emitted before their target is known, and patched once it is
+  size_t EmitJump(Opcode::Enum opcode, size_t a = 0);
+  void PatchJump(size_t jump, size_t target);
+  void PatchJumps(const std::vector<size_t>& jumps, size_t target);
+  size_t Here() const;
+  void EmitError(const std::string& message);
+
+  uint16_t AddConstant(Register value);
+  uint16_t AllocateRegister();
+  uint16_t Destination(int target);
+  size_t AllocateFrame(Type* type);
+  Local& AddLocal(Variable* variable, bool inMemory);
+  bool IsLocalRegister(uint16_t reg) const;
+
+  void CompileScope(ScopeNode* scope);
+  void CompileStatement(StatementNode* statement);
+  void CompileVariable(VariableNode* node);
+  void CompileGoto(GotoNode* node);
+  void CompileReturn(ReturnNode* node);
+  void CompileConditionalJump(ExpressionNode* condition, Opcode::Enum opcode, std::vector<size_t>& jumps);
+
+  // The final instruction of an expression writes 'target' when it isn't -1
+  Operand CompileExpression(ExpressionNode* node, int target = -1);
+  Operand CompileValue(ValueNode* node, int target);
+  Operand CompileBinary(BinaryOperatorNode* node, int target);
+  Operand CompileArithmetic(BinaryOperatorNode* node, Operand left, Operand right, int target);
+  Operand CompileComparison(BinaryOperatorNode* node, Operand left, Operand right, int target);
+  Operand CompileUnary(UnaryOperatorNode* node, int target);
+  Operand CompileCall(CallNode* node, int target);
+  Operand Invalid(const std::string& message, Type* type, int target);
+
+  Place CompilePlace(ExpressionNode* node);
+  Place GetVariablePlace(Variable* variable);
+  Operand Load(const Place& place, int target);
+  void Store(const Place& place, Operand value);
+  // The address of a place in memory, in a register
+  uint16_t GetAddress(const Place& place, int target);
+  // A place whose offset fits in an operand
+  Place Reachable(const Place& place);
+
+  Operand Convert(Operand value, Type* type, int target = -1);
+  Operand ToBoolean(Operand value, int target = -1);
+  // Copies a local's register to a temporary when evaluating 'later' could assign to it
+  Operand Stable(Operand value, ExpressionNode* later);
+
+  VirtualMachine* mMachine;
+  BytecodeFunction* mFunction;
+  Type* mReturnType;
+
+  std::unordered_map<Variable*, Local> mLocals;
+  // Registers below this belong to locals, and the rest are temporaries that last for one statement
+  size_t mTemporaryBase;
+  size_t mNextTemporary;
+
+  std::vector<Loop> mLoops;
+  // Breaks and continues outside of any loop end the function
+  std::vector<size_t> mEndJumps;
+  // The scopes we're in, so a goto knows which labels it can reach
+  std::vector<ScopeNode*> mScopes;
+  std::unordered_map<Label*, size_t> mLabels;
+  std::vector<std::pair<size_t, Label*>> mGotos;
+};
+
+BytecodeCompiler::BytecodeCompiler(VirtualMachine* machine, BytecodeFunction* function) :
+  mMachine(machine),
+  mFunction(function),
+  mReturnType(VoidType),
+  mTemporaryBase(0),
+  mNextTemporary(0)
+{
+  mFunction->mParameterCount = 0;
+  mFunction->mRegisterCount = 0;
+  mFunction->mFrameSize = 0;
+}
+
+void BytecodeCompiler::CompileFunction(FunctionNode* node)
+{
+  Function* function = node->mSymbol;
+  mReturnType = function->mType->mFunction->mReturnType;
+  if (mReturnType == nullptr)
+    mReturnType = VoidType;
+
+  AddressTakenFinder finder;
+  finder.Walk(node->mScope.get());
+
+  // The parameters take the first registers, since that's where a call puts the arguments
+  // One that lives in memory is moved there first thing
+  mFunction->mParameterCount = node->mParameters.size();
+  mNextTemporary = node->mParameters.size();
+  for (size_t i = 0; i < node->mParameters.size(); ++i)
+  {
+    Variable* parameter = node->mParameters[i]->mSymbol;
+    bool inMemory = IsClass(parameter->mType) || finder.mLocals.count(parameter) != 0;
+    if (!inMemory)
+    {
+      Local& local = mLocals[parameter];
+      local.mRegister = (uint16_t)i;
+      local.mInMemory = false;
+      local.mOffset = 0;
+      continue;
+    }
+
+    AddLocal(parameter, true);
+    Operand value = { (uint16_t)i, parameter->mType };
+    Store(GetVariablePlace(parameter), value);
+  }
+
+  for (size_t i = 0; i < function->mLocals.size(); ++i)
+  {
+    Variable* variable = dynamic_cast<Variable*>(function->mLocals[i]);
+    if (variable == nullptr || mLocals.count(variable) != 0)
+      continue;
+
+    AddLocal(variable, IsClass(variable->mType) || finder.mLocals.count(variable) != 0);
+  }
+
+  mTemporaryBase = mNextTemporary;
+  CompileScope(node->mScope.get());
+
+  // Falling off the end (or breaking out of the function) only works for a function that returns nothing
+  PatchJumps(mEndJumps, Here());
+  if (mReturnType == VoidType)
+    Emit(Opcode::ReturnVoid);
+  else
+    EmitError("The function '" + function->mName + "' ended without returning a value");
+
+  for (size_t i = 0; i < mGotos.size(); ++i)
+    PatchJump(mGotos[i].first, mLabels[mGotos[i].second]);
+}
+
+void BytecodeCompiler::CompileGlobals(BlockNode* block)
+{
+  for (size_t i = 0; i < block->mGlobals.size(); ++i)
+  {
+    if (block->mGlobals[i]->mKind != NodeKind::Variable)
+      continue;
+
+    mNextTemporary = mTemporaryBase;
+    CompileVariable(static_cast<VariableNode*>(block->mGlobals[i].get()));
+  }
+
+  Emit(Opcode::ReturnVoid);
+}
+
+size_t BytecodeCompiler::Emit(Opcode::Enum opcode, size_t a, size_t b, size_t c)
+{
+  Instruction instruction;
+  instruction.mOpcode = (uint16_t)opcode;
+  instruction.mA = (uint16_t)a;
+  instruction.mB = (uint16_t)b;
+  instruction.mC = (uint16_t)c;
+  mFunction->mCode.push_back(instruction);
+  return mFunction->mCode.size() - 1;
+}
+
+void BytecodeCompiler::EmitExtra(size_t value)
+{
+  if (value > 0xFFFFFFFF)
+    ErrorExecution("A value is too big for the bytecode");
+  Emit(Opcode::Extra, value & 0xFFFF, value >> 16);
+}
+
+size_t BytecodeCompiler::EmitJump(Opcode::Enum opcode, size_t a)
+{
+  return Emit(opcode, a);
+}
+
+void BytecodeCompiler::PatchJump(size_t jump, size_t target)
+{
+  mFunction->mCode[jump].mB = (uint16_t)(target & 0xFFFF);
+  mFunction->mCode[jump].mC = (uint16_t)(target >> 16);
+}
+
+void BytecodeCompiler::PatchJumps(const std::vector<size_t>& jumps, size_t target)
+{
+  for (size_t i = 0; i < jumps.size(); ++i)
+    PatchJump(jumps[i], target);
+}
+
+size_t BytecodeCompiler::Here() const
+{
+  return mFunction->mCode.size();
+}
+
+void BytecodeCompiler::EmitError(const std::string& message)
+{
+  if (mFunction->mMessages.size() > MaxOperand)
+    ErrorExecution("A function has too many errors to compile");
+  mFunction->mMessages.push_back(message);
+  Emit(Opcode::Error, mFunction->mMessages.size() - 1);
+}
+
+uint16_t BytecodeCompiler::AddConstant(Register value)
+{
+  if (mFunction->mConstants.size() > MaxOperand)
+    ErrorExecution("A function has too many constants to compile");
+  mFunction->mConstants.push_back(value);
+  return (uint16_t)(mFunction->mConstants.size() - 1);
+}
+
+uint16_t BytecodeCompiler::AllocateRegister()
+{
+  if (mNextTemporary > MaxOperand)
+    ErrorExecution("A function needs too many registers to compile");
+  uint16_t reg = (uint16_t)mNextTemporary++;
+  if (mNextTemporary > mFunction->mRegisterCount)
+    mFunction->mRegisterCount = mNextTemporary;
+  return reg;
+}
+
+uint16_t BytecodeCompiler::Destination(int target)
+{
+  return target >= 0 ? (uint16_t)target : AllocateRegister();
+}
+
+size_t BytecodeCompiler::AllocateFrame(Type* type)
+{
+  size_t offset = AlignUp(mFunction->mFrameSize, mMachine->mMemory.GetAlignment(type));
+  mFunction->mFrameSize = offset + mMachine->mMemory.GetSize(type);
+  if (mFunction->mFrameSize > 0xFFFFFFFF)
+    ErrorExecution("A function's frame is too big to compile");
+  return offset;
+}
+
+BytecodeCompiler::Local& BytecodeCompiler::AddLocal(Variable* variable, bool inMemory)
+{
+  Local& local = mLocals[variable];
+  local.mRegister = AllocateRegister();
+  local.mInMemory = inMemory;
+  local.mOffset = 0;
+
+  // A local in memory keeps its address in its register for the whole call
+  if (inMemory)
+  {
+    local.mOffset = AllocateFrame(variable->mType);
+    Emit(Opcode::FrameAddress, local.mRegister, local.mOffset & 0xFFFF, local.mOffset >> 16);
+  }
+  return local;
+}
+
+bool BytecodeCompiler::IsLocalRegister(uint16_t reg) const
+{
+  return reg < mTemporaryBase;
+}
+#pragma endregion
+
+#pragma region Statements
+void BytecodeCompiler::CompileScope(ScopeNode* scope)
+{
+  mScopes.push_back(scope);
+  for (size_t i = 0; i < scope->mStatements.size(); ++i)
+  {
+    // Temporaries only live within a statement
+    mNextTemporary = mTemporaryBase;
+    CompileStatement(scope->mStatements[i].get());
+  }
+  mScopes.pop_back();
+}
+
+void BytecodeCompiler::CompileConditionalJump(ExpressionNode* condition, Opcode::Enum opcode, std::vector<size_t>& jumps)
+{
+  Operand value = ToBoolean(CompileExpression(condition));
+  jumps.push_back(EmitJump(opcode, value.mRegister));
+}
+
+void BytecodeCompiler::CompileStatement(StatementNode* statement)
+{
+  switch (statement->mKind)
+  {
+    case NodeKind::Variable:
+      CompileVariable(static_cast<VariableNode*>(statement));
+      break;
+
+    case NodeKind::Scope:
+      CompileScope(static_cast<ScopeNode*>(statement));
+      break;
+
+    case NodeKind::If:
+    {
+      // An else is an IfNode without a condition, and an else if is one with
+      std::vector<size_t> ends;
+      for (IfNode* node = static_cast<IfNode*>(statement); node != nullptr; node = node->mElse.get())
+      {
+        if (node->mCondition == nullptr)
+        {
+          CompileScope(node->mScope.get());
+          break;
+        }
+
+        std::vector<size_t> next;
+        CompileConditionalJump(node->mCondition.get(), Opcode::JumpIfFalse, next);
+        CompileScope(node->mScope.get());
+        if (node->mElse)
+          ends.push_back(EmitJump(Opcode::Jump));
+        PatchJumps(next, Here());
+      }
+      PatchJumps(ends, Here());
+      break;
+    }
+
+    case NodeKind::While:
+    {
+      // The condition goes at the bottom, so each time around takes one jump
+      WhileNode* node = static_cast<WhileNode*>(statement);
+      size_t entry = EmitJump(Opcode::Jump);
+      size_t body = Here();
+
+      mLoops.push_back(Loop());
+      CompileScope(node->mScope.get());
+      Loop loop = mLoops.back();
+      mLoops.pop_back();
+
+      size_t condition = Here();
+      PatchJump(entry, condition);
+      PatchJumps(loop.mContinues, condition);
+
+      mNextTemporary = mTemporaryBase;
+      std::vector<size_t> repeat;
+      CompileConditionalJump(node->mCondition.get(), Opcode::JumpIfTrue, repeat);
+      PatchJumps(repeat, body);
+      PatchJumps(loop.mBreaks, Here());
+      break;
+    }
+
+    case NodeKind::For:
+    {
+      ForNode* node = static_cast<ForNode*>(statement);
+      if (node->mInitialVariable)
+        CompileVariable(node->mInitialVariable.get());
+      else if (node->mInitialExpression)
+        CompileExpression(node->mInitialExpression.get());
+
+      size_t entry = EmitJump(Opcode::Jump);
+      size_t body = Here();
+
+      mLoops.push_back(Loop());
+      CompileScope(node->mScope.get());
+      Loop loop = mLoops.back();
+      mLoops.pop_back();
+
+      PatchJumps(loop.mContinues, Here());
+      mNextTemporary = mTemporaryBase;
+      if (node->mIterator)
+        CompileExpression(node->mIterator.get());
+
+      PatchJump(entry, Here());
+      mNextTemporary = mTemporaryBase;
+      std::vector<size_t> repeat;
+      if (node->mCondition)
+        CompileConditionalJump(node->mCondition.get(), Opcode::JumpIfTrue, repeat);
+      else
+        repeat.push_back(EmitJump(Opcode::Jump));
+      PatchJumps(repeat, body);
+      PatchJumps(loop.mBreaks, Here());
+      break;
+    }
+
+    case NodeKind::Label:
+    {
+      LabelNode* node = static_cast<LabelNode*>(statement);
+      mLabels[node->mSymbol] = Here();
+      break;
+    }
+
+    case NodeKind::Goto:
+      CompileGoto(static_cast<GotoNode*>(statement));
+      break;
+
+    case NodeKind::Return:
+      CompileReturn(static_cast<ReturnNode*>(statement));
+      break;
+
+    case NodeKind::Break:
+      if (mLoops.empty())
+        mEndJumps.push_back(EmitJump(Opcode::Jump));
+      else
+        mLoops.back().mBreaks.push_back(EmitJump(Opcode::Jump));
+      break;
+
+    case NodeKind::Continue:
+      if (mLoops.empty())
+        mEndJumps.push_back(EmitJump(Opcode::Jump));
+      else
+        mLoops.back().mContinues.push_back(EmitJump(Opcode::Jump));
+      break;
+
+    case NodeKind::Error:
+      EmitError("Unable to run a statement that failed to parse: " + static_cast<ErrorNode*>(statement)->mMessage);
+      break;
+
+    default:
+      CompileExpression(static_cast<ExpressionNode*>(statement));
+      break;
+  }
+}
+
+void BytecodeCompiler::CompileVariable(VariableNode* node)
+{
+  Variable* variable = node->mSymbol;
+  Place place = GetVariablePlace(variable);
+
+  if (node->mInitialValue)
+  {
+    Operand value = CompileExpression(node->mInitialValue.get(), place.mIsRegister ? place.mRegister : -1);
+    Store(place, Convert(value, variable->mType, place.mIsRegister ? place.mRegister : -1));
+  }
+  else if (place.mIsRegister)
+  {
+    Emit(Opcode::Clear, place.mRegister);
+  }
+  else
+  {
+    Emit(Opcode::Zero, GetAddress(place, -1));
+    EmitExtra(mMachine->mMemory.GetSize(variable->mType));
+  }
+}
+
+void BytecodeCompiler::CompileGoto(GotoNode* node)
+{
+  Label* label = node->mResolvedLabel;
+  if (label == nullptr)
+  {
+    EmitError("A goto was unable to find the label " + node->mName.str());
+    return;
+  }
+
+  // A goto can jump to a label in its own scope or any scope around it (but not into a nested one)
+  for (size_t i = 0; i < mScopes.size(); ++i)
+  {
+    ScopeNode* scope = mScopes[i];
+    for (size_t j = 0; j < scope->mStatements.size(); ++j)
+    {
+      StatementNode* statement = scope->mStatements[j].get();
+      if (statement->mKind == NodeKind::Label && static_cast<LabelNode*>(statement)->mSymbol == label)
+      {
+        mGotos.push_back(std::make_pair(EmitJump(Opcode::Jump), label));
+        return;
+      }
+    }
+  }
+
+  EmitError("A goto can only jump to a label in its own scope or a scope around it");
+}
+
+void BytecodeCompiler::CompileReturn(ReturnNode* node)
+{
+  if (mReturnType == VoidType)
+  {
+    // A value returned from a function that returns nothing still runs
+    if (node->mReturnValue)
+      CompileExpression(node->mReturnValue.get());
+    Emit(Opcode::ReturnVoid);
+    return;
+  }
+
+  if (node->mReturnValue == nullptr)
+  {
+    EmitError("The function '" + mFunction->mSymbol->mName + "' ended without returning a value");
+    return;
+  }
+
+  Operand value = Convert(CompileExpression(node->mReturnValue.get()), mReturnType);
+  if (IsClass(mReturnType))
+  {
+    Emit(Opcode::ReturnClass, value.mRegister);
+    EmitExtra(mMachine->mMemory.GetSize(mReturnType));
+  }
+  else
+  {
+    Emit(Opcode::Return, value.mRegister);
+  }
+}
+#pragma endregion
+
+#pragma region Expressions
+BytecodeCompiler::Operand BytecodeCompiler::CompileExpression(ExpressionNode* node, int target)
+{
+  Operand result;
+  switch (node->mKind)
+  {
+    case NodeKind::Value:
+      result = CompileValue(static_cast<ValueNode*>(node), target);
+      break;
+
+    case NodeKind::BinaryOperator:
+      result = CompileBinary(static_cast<BinaryOperatorNode*>(node), target);
+      break;
+
+    case NodeKind::UnaryOperator:
+      result = CompileUnary(static_cast<UnaryOperatorNode*>(node), target);
+      break;
+
+    case NodeKind::Call:
+      result = CompileCall(static_cast<CallNode*>(node), target);
+      break;
+
+    case NodeKind::Cast:
+    {
+      CastNode* cast = static_cast<CastNode*>(node);
+      result = Convert(CompileExpression(cast->mLeft.get()), cast->mType->mSymbol, target);
+      break;
+    }
+
+    case NodeKind::MemberAccess:
+    {
+      MemberAccessNode* access = static_cast<MemberAccessNode*>(node);
+      Symbol* member = access->mResolvedMember;
+
+      // Member functions don't take the object, but whatever it came from still runs
+      if (member->mType->mMode == TypeMode::Function)
+      {
+        if (access->mLeft->mKind != NodeKind::Value)
+          CompileExpression(access->mLeft.get());
+
+        Register constant;
+        constant.mPointer = nullptr;
+        constant.mFunction = static_cast<Function*>(member);
+        result.mRegister = Destination(target);
+        result.mType = member->mType;
+        Emit(Opcode::LoadConstant, result.mRegister, AddConstant(constant));
+        break;
+      }
+
+      result = Load(CompilePlace(node), target);
+      break;
+    }
+
+    case NodeKind::Index:
+      result = Load(CompilePlace(node), target);
+      break;
+
+    default:
+      result = Invalid("Unable to run an expression of this kind", VoidType, target);
+      break;
+  }
+
+  if (target >= 0 && result.mRegister != target)
+  {
+    Emit(Opcode::Move, target, result.mRegister);
+    result.mRegister = (uint16_t)target;
+  }
+  return result;
+}
+
+BytecodeCompiler::Operand BytecodeCompiler::Invalid(const std::string& message, Type* type, int target)
+{
+  // The error is only thrown if the program gets here, the same as when it is interpreted
+  EmitError(message);
+  Operand result = { Destination(target), type };
+  return result;
+}
+
+BytecodeCompiler::Operand BytecodeCompiler::CompileValue(ValueNode* node, int target)
+{
+  const Token& token = node->mToken;
+  Register constant;
+  constant.mPointer = nullptr;
+  Operand result;
+
+  switch (token.mEnumTokenType)
+  {
+    case TokenType::IntegerLiteral:
+      constant.mInteger = (int32_t)strtoll(token.mText, nullptr, 10);
+      result.mType = IntegerType;
+      break;
+
+    case TokenType::FloatLiteral:
+      constant.mFloat = (float)strtod(token.mText, nullptr);
+      result.mType = FloatType;
+      break;
+
+    case TokenType::True:
+    case TokenType::False:
+      constant.mInteger = token.mEnumTokenType == TokenType::True;
+      result.mType = BooleanType;
+      break;
+
+    case TokenType::Null:
+      result.mRegister = Destination(target);
+      result.mType = NullType;
+      Emit(Opcode::Clear, result.mRegister);
+      return result;
+
+    case TokenType::CharacterLiteral:
+    {
+      std::string text = Unescape(token.mText + 1, token.mLength - 2);
+      constant.mInteger = text.empty() ? 0 : (uint8_t)text[0];
+      result.mType = ByteType;
+      break;
+    }
+
+    case TokenType::StringLiteral:
+      constant.mPointer = mMachine->AddString(Unescape(token.mText + 1, token.mLength - 2));
+      result.mType = node->mResolvedType;
+      break;
+
+    case TokenType::Identifier:
+    {
+      Symbol* symbol = node->mResolvedSymbol;
+      if (symbol == nullptr)
+        return Invalid("The symbol '" + token.str() + "' was not found", VoidType, target);
+
+      if (symbol->mType->mMode == TypeMode::Function)
+      {
+        constant.mFunction = static_cast<Function*>(symbol);
+        result.mType = symbol->mType;
+        break;
+      }
+
+      return Load(GetVariablePlace(static_cast<Variable*>(symbol)), target);
+    }
+
+    default:
+      return Invalid("Unable to run the value '" + token.str() + "'", VoidType, target);
+  }
+
+  result.mRegister = Destination(target);
+  Emit(Opcode::LoadConstant, result.mRegister, AddConstant(constant));
+  return result;
+}
+
+BytecodeCompiler::Operand BytecodeCompiler::CompileBinary(BinaryOperatorNode* node, int target)
+{
+  // The parser hangs the left hand side off of mRight and the right hand side off of mLeft
+  ExpressionNode* leftNode = node->mRight.get();
+  ExpressionNode* rightNode = node->mLeft.get();
+
+  TokenType::Enum op = node->mOperator.mEnumTokenType;
+  switch (op)
+  {
+    case TokenType::Assignment:
+    {
+      Place place = CompilePlace(leftNode);
+      if (!place.mIsRegister)
+        place.mRegister = Stable(Operand{ place.mRegister, place.mType }, rightNode).mRegister;
+
+      int destination = place.mIsRegister ? place.mRegister : -1;
+      Operand value = Convert(CompileExpression(rightNode, destination), place.mType, destination);
+      Store(place, value);
+      return value;
+    }
+
+    case TokenType::LogicalAnd:
+    case TokenType::LogicalOr:
+    {
+      // Computed in a temporary, since the right hand side could read the register the result goes in
+      uint16_t result = AllocateRegister();
+      ToBoolean(CompileExpression(leftNode), result);
+      size_t skip = EmitJump(op == TokenType::LogicalAnd ? Opcode::JumpIfFalse : Opcode::JumpIfTrue, result);
+      ToBoolean(CompileExpression(rightNode), result);
+      PatchJump(skip, Here());
+
+      Operand operand = { result, BooleanType };
+      return operand;
+    }
+
+    default:
+      break;
+  }
+
+  Operand left = Stable(CompileExpression(leftNode), rightNode);
+
+  // Adding a small Integer constant doesn't need a register for it
+  if ((op == TokenType::Plus || op == TokenType::Minus) && left.mType == IntegerType &&
+    rightNode->mKind == NodeKind::Value && static_cast<ValueNode*>(rightNode)->mToken.mEnumTokenType == TokenType::IntegerLiteral)
+  {
+    int64_t value = (int32_t)strtoll(static_cast<ValueNode*>(rightNode)->mToken.mText, nullptr, 10);
+    if (op == TokenType::Minus)
+      value = -value;
+
+    if (FitsImmediate(value))
+    {
+      Operand result = { Destination(target), IntegerType };
+      Emit(Opcode::IntegerAddImmediate, result.mRegister, left.mRegister, (uint16_t)(int16_t)value);
+      return result;
+    }
+  }
+
+  Operand right = CompileExpression(rightNode);
+
+  switch (op)
+  {
+    case TokenType::LessThan:
+    case TokenType::GreaterThan:
+    case TokenType::LessThanOrEqualTo:
+    case TokenType::GreaterThanOrEqualTo:
+    case TokenType::Equality:
+    case TokenType::Inequality:
+      return CompileComparison(node, left, right, target);
+
+    default:
+      return CompileArithmetic(node, left, right, target);
+  }
+}
+
+BytecodeCompiler::Operand BytecodeCompiler::CompileComparison(BinaryOperatorNode* node, Operand left, Operand right, int target)
+{
+  TokenType::Enum op = node->mOperator.mEnumTokenType;
+
+  // Greater is less with the sides swapped
+  if (op == TokenType::GreaterThan || op == TokenType::GreaterThanOrEqualTo)
+  {
+    std::swap(left, right);
+    op = op == TokenType::GreaterThan ? TokenType::LessThan : TokenType::LessThanOrEqualTo;
+  }
+
+  Opcode::Enum less;
+  Opcode::Enum lessOrEqual;
+  Opcode::Enum equal;
+  Opcode::Enum notEqual;
+
+  if (IsPointer(left.mType) || IsPointer(right.mType))
+  {
+    if (!IsPointer(left.mType))
+      left = Convert(left, right.mType);
+    if (!IsPointer(right.mType))
+      right = Convert(right, left.mType);
+    less = Opcode::PointerLess;
+    lessOrEqual = Opcode::PointerLessOrEqual;
+    equal = Opcode::PointerEqual;
+    notEqual = Opcode::PointerNotEqual;
+  }
+  else if (IsPrimitive(left.mType) && IsPrimitive(right.mType))
+  {
+    if (left.mType == FloatType || right.mType == FloatType)
+    {
+      left = Convert(left, FloatType);
+      right = Convert(right, FloatType);
+      less = Opcode::FloatLess;
+      lessOrEqual = Opcode::FloatLessOrEqual;
+      equal = Opcode::FloatEqual;
+      notEqual = Opcode::FloatNotEqual;
+    }
+    else
+    {
+      less = Opcode::IntegerLess;
+      lessOrEqual = Opcode::IntegerLessOrEqual;
+      equal = Opcode::IntegerEqual;
+      notEqual = Opcode::IntegerNotEqual;
+    }
+  }
+  else if (IsClass(left.mType) && left.mType == right.mType && (op == TokenType::Equality || op == TokenType::Inequality))
+  {
+    Operand result = { Destination(target), BooleanType };
+    Emit(Opcode::ClassEqual, result.mRegister, left.mRegister, right.mRegister);
+    EmitExtra(mMachine->mMemory.GetSize(left.mType));
+    if (op == TokenType::Inequality)
+      Emit(Opcode::Not, result.mRegister, result.mRegister);
+    return result;
+  }
+  else
+  {
+    return Invalid("Unable to compare '" + left.mType->mName + "' with '" + right.mType->mName + "'", BooleanType, target);
+  }
+
+  Opcode::Enum opcode = op == TokenType::LessThan ? less : op == TokenType::LessThanOrEqualTo ? lessOrEqual : op == TokenType::Equality ? equal : notEqual;
+  Operand result = { Destination(target), BooleanType };
+  Emit(opcode, result.mRegister, left.mRegister, right.mRegister);
+  return result;
+}
+
+BytecodeCompiler::Operand BytecodeCompiler::CompileArithmetic(BinaryOperatorNode* node, Operand left, Operand right, int target)
+{
+  TokenType::Enum op = node->mOperator.mEnumTokenType;
+  std::string invalid = "The binary operator '" + node->mOperator.str() + "' is not valid between '" + left.mType->mName + "' and '" + right.mType->mName + "'";
+
+  if (op == TokenType::Plus || op == TokenType::Minus)
+  {
+    // Pointers move a whole element at a time, and two pointers are apart by some number of elements
+    if (IsPointer(left.mType) && IsPointer(right.mType) && op == TokenType::Minus)
+    {
+      size_t size = mMachine->mMemory.GetSize(left.mType->mPointerToType);
+      Operand result = { Destination(target), IntegerType };
+      Emit(Opcode::PointerDifference, result.mRegister, left.mRegister, right.mRegister);
+      if (size > 1)
+      {
+        Register constant;
+        constant.mPointer = nullptr;
+        constant.mInteger = (int32_t)size;
+        uint16_t divisor = AllocateRegister();
+        Emit(Opcode::LoadConstant, divisor, AddConstant(constant));
+        Emit(Opcode::IntegerDivide, result.mRegister, result.mRegister, divisor);
+      }
+      return result;
+    }
+
+    if (IsPointer(left.mType) != IsPointer(right.mType))
+    {
+      Operand pointer = IsPointer(left.mType) ? left : right;
+      Operand offset = IsPointer(left.mType) ? right : left;
+      if (!IsPrimitive(offset.mType) || pointer.mType == NullType || (op == TokenType::Minus && !IsPointer(left.mType)))
+        return Invalid(invalid, pointer.mType, target);
+
+      offset = Convert(offset, IntegerType);
+      if (op == TokenType::Minus)
+      {
+        uint16_t negated = AllocateRegister();
+        Emit(Opcode::IntegerNegate, negated, offset.mRegister);
+        offset.mRegister = negated;
+      }
+
+      Operand result = { Destination(target), pointer.mType };
+      Emit(Opcode::PointerAddScaled, result.mRegister, pointer.mRegister, offset.mRegister);
+      EmitExtra(mMachine->mMemory.GetSize(pointer.mType->mPointerToType));
+      return result;
+    }
+  }
+
+  if (!IsArithmetic(left.mType) || !IsArithmetic(right.mType))
+    return Invalid(invalid, IntegerType, target);
+
+  // Mixed operands (which only initial values let through) work in the wider of the two
+  if (left.mType == FloatType || right.mType == FloatType)
+  {
+    left = Convert(left, FloatType);
+    right = Convert(right, FloatType);
+
+    Opcode::Enum opcode;
+    switch (op)
+    {
+      case TokenType::Plus:     opcode = Opcode::FloatAdd;      break;
+      case TokenType::Minus:    opcode = Opcode::FloatSubtract; break;
+      case TokenType::Asterisk: opcode = Opcode::FloatMultiply; break;
+      case TokenType::Divide:   opcode = Opcode::FloatDivide;   break;
+      case TokenType::Modulo:   opcode = Opcode::FloatModulo;   break;
+      default: return Invalid(invalid, FloatType, target);
+    }
+
+    Operand result = { Destination(target), FloatType };
+    Emit(opcode, result.mRegister, left.mRegister, right.mRegister);
+    return result;
+  }
+
+  Opcode::Enum opcode;
+  switch (op)
+  {
+    case TokenType::Plus:     opcode = Opcode::IntegerAdd;      break;
+    case TokenType::Minus:    opcode = Opcode::IntegerSubtract; break;
+    case TokenType::Asterisk: opcode = Opcode::IntegerMultiply; break;
+    case TokenType::Divide:   opcode = Opcode::IntegerDivide;   break;
+    case TokenType::Modulo:   opcode = Opcode::IntegerModulo;   break;
+    default: return Invalid(invalid, IntegerType, target);
+  }
+
+  // Bytes wrap around at 256 (dividing two of them can't leave that range)
+  bool bytes = left.mType == ByteType && right.mType == ByteType;
+  Operand result = { Destination(target), bytes ? ByteType : IntegerType };
+  Emit(opcode, result.mRegister, left.mRegister, right.mRegister);
+  if (bytes && (op == TokenType::Plus || op == TokenType::Minus || op == TokenType::Asterisk))
+    Emit(Opcode::IntegerToByte, result.mRegister, result.mRegister);
+  return result;
+}
+
+BytecodeCompiler::Operand BytecodeCompiler::CompileUnary(UnaryOperatorNode* node, int target)
+{
+  TokenType::Enum op = node->mOperator.mEnumTokenType;
+  switch (op)
+  {
+    case TokenType::Asterisk:
+      return Load(CompilePlace(node), target);
+
+    case TokenType::BitwiseAndAddressOf:
+    {
+      Place place = CompilePlace(node->mRight.get());
+      if (place.mIsRegister)
+        return Invalid("The expression does not refer to anything that can be assigned to or have its address taken", node->mResolvedType, target);
+
+      Operand result = { GetAddress(place, target), node->mResolvedType };
+      return result;
+    }
+
+    case TokenType::Increment:
+    case TokenType::Decrement:
+    {
+      Place place = CompilePlace(node->mRight.get());
+      Type* type = place.mType;
+      int step = op == TokenType::Increment ? 1 : -1;
+
+      // A local in a register changes in place, anything else is loaded, changed and stored back
+      Operand value = Load(place, target);
+
+      if (type == IntegerType)
+      {
+        Emit(Opcode::IntegerAddImmediate, value.mRegister, value.mRegister, (uint16_t)(int16_t)step);
+      }
+      else if (type == ByteType)
+      {
+        Emit(Opcode::IntegerAddImmediate, value.mRegister, value.mRegister, (uint16_t)(int16_t)step);
+        Emit(Opcode::IntegerToByte, value.mRegister, value.mRegister);
+      }
+      else if (type == FloatType)
+      {
+        Register constant;
+        constant.mPointer = nullptr;
+        constant.mFloat = (float)step;
+        uint16_t one = AllocateRegister();
+        Emit(Opcode::LoadConstant, one, AddConstant(constant));
+        Emit(Opcode::FloatAdd, value.mRegister, value.mRegister, one);
+      }
+      else if (type->mMode == TypeMode::Pointer)
+      {
+        int64_t bytes = step * (int64_t)mMachine->mMemory.GetSize(type->mPointerToType);
+        if (FitsImmediate(bytes))
+        {
+          Emit(Opcode::PointerAddImmediate, value.mRegister, value.mRegister, (uint16_t)(int16_t)bytes);
+        }
+        else
+        {
+          Register constant;
+          constant.mPointer = nullptr;
+          constant.mInteger = (int32_t)bytes;
+          uint16_t offset = AllocateRegister();
+          Emit(Opcode::LoadConstant, offset, AddConstant(constant));
+          Emit(Opcode::PointerAdd, value.mRegister, value.mRegister, offset);
+        }
+      }
+      else
+      {
+        return Invalid("The unary operator '" + node->mOperator.str() + "' is not valid with the type '" + type->mName + "'", type, target);
+      }
+
+      if (!place.mIsRegister)
+        Store(place, value);
+      return value;
+    }
+
+    default:
+      break;
+  }
+
+  Operand value = CompileExpression(node->mRight.get());
+  switch (op)
+  {
+    case TokenType::Plus:
+      if (IsArithmetic(value.mType))
+        return value;
+      break;
+
+    case TokenType::Minus:
+    {
+      if (!IsArithmetic(value.mType))
+        break;
+
+      Operand result = { Destination(target), value.mType };
+      Emit(value.mType == FloatType ? Opcode::FloatNegate : Opcode::IntegerNegate, result.mRegister, value.mRegister);
+      if (value.mType == ByteType)
+        Emit(Opcode::IntegerToByte, result.mRegister, result.mRegister);
+      return result;
+    }
+
+    case TokenType::LogicalNot:
+    {
+      Operand result = ToBoolean(value);
+      uint16_t destination = Destination(target);
+      Emit(Opcode::Not, destination, result.mRegister);
+      result.mRegister = destination;
+      return result;
+    }
+
+    default:
+      break;
+  }
+
+  return Invalid("The unary operator '" + node->mOperator.str() + "' is not valid with the type '" + value.mType->mName + "'", value.mType, target);
+}
+
+BytecodeCompiler::Operand BytecodeCompiler::CompileCall(CallNode* node, int target)
+{
+  // Most calls name the function they call, which is then known now instead of when running
+  Function* function = nullptr;
+  ExpressionNode* callee = node->mLeft.get();
+  if (callee->mKind == NodeKind::Value)
+  {
+    Symbol* symbol = static_cast<ValueNode*>(callee)->mResolvedSymbol;
+    if (symbol != nullptr && symbol->mType->mMode == TypeMode::Function)
+      function = static_cast<Function*>(symbol);
+  }
+  else if (callee->mKind == NodeKind::MemberAccess)
+  {
+    MemberAccessNode* access = static_cast<MemberAccessNode*>(callee);
+    if (access->mResolvedMember->mType->mMode == TypeMode::Function)
+    {
+      function = static_cast<Function*>(access->mResolvedMember);
+      if (access->mLeft->mKind != NodeKind::Value)
+        CompileExpression(access->mLeft.get());
+    }
+  }
+
+  Operand calleeOperand = { 0, nullptr };
+  Type* signature = nullptr;
+  if (function != nullptr)
+  {
+    signature = function->mType;
+  }
+  else
+  {
+    calleeOperand = CompileExpression(callee);
+    signature = calleeOperand.mType;
+    if (signature->mMode != TypeMode::Function)
+      return Invalid("Attempting to perform a call on a type '" + signature->mName + "' that is non-callable", VoidType, target);
+  }
+
+  FunctionTypeRecord* record = signature->mFunction;
+  Type* returnType = record->mReturnType ? record->mReturnType : VoidType;
+  if (node->mArguments.size() != record->mParameterTypes.size())
+  {
+    std::string name = function ? function->mName : signature->mName;
+    return Invalid("The function '" + name + "' was called with the wrong number of arguments", returnType, target);
+  }
+
+  BytecodeFunction* bytecode = nullptr;
+  if (function != nullptr)
+  {
+    std::unordered_map<Function*, std::unique_ptr<BytecodeFunction>>::iterator found = mMachine->mCode.find(function);
+    if (found == mMachine->mCode.end())
+      return Invalid("The function '" + function->mName + "' has no body to run", returnType, target);
+    bytecode = found->second.get();
+  }
+
+  // The arguments go in a row of registers that the callee takes as its parameters
+  size_t count = node->mArguments.size();
+  size_t first = mNextTemporary;
+  for (size_t i = 0; i < count; ++i)
+    AllocateRegister();
+  for (size_t i = 0; i < count; ++i)
+  {
+    int argument = (int)(first + i);
+    Convert(CompileExpression(node->mArguments[i].get(), argument), record->mParameterTypes[i], argument);
+  }
+
+  // A class comes back into storage in the caller's frame, which the result register points at
+  Operand result = { Destination(target), returnType };
+  if (IsClass(returnType))
+  {
+    size_t offset = AllocateFrame(returnType);
+    Emit(Opcode::FrameAddress, result.mRegister, offset & 0xFFFF, offset >> 16);
+  }
+
+  if (bytecode != nullptr)
+  {
+    Register constant;
+    constant.mPointer = nullptr;
+    constant.mBytecode = bytecode;
+    Emit(Opcode::Call, result.mRegister, first, AddConstant(constant));
+  }
+  else
+  {
+    Emit(Opcode::CallIndirect, result.mRegister, first, calleeOperand.mRegister);
+  }
+  return result;
+}
+#pragma endregion
+
+#pragma region Places
+BytecodeCompiler::Place BytecodeCompiler::GetVariablePlace(Variable* variable)
+{
+  Place place;
+  place.mType = variable->mType;
+  place.mOffset = 0;
+  place.mNullable = false;
+
+  std::unordered_map<Variable*, Local>::iterator found = mLocals.find(variable);
+  if (found != mLocals.end())
+  {
+    place.mIsRegister = !found->second.mInMemory;
+    place.mRegister = found->second.mRegister;
+    return place;
+  }
+
+  // A global's address never changes, so it's a constant
+  Register constant;
+  constant.mPointer = mMachine->GetGlobalAddress(variable);
+  place.mIsRegister = false;
+  place.mRegister = AllocateRegister();
+  Emit(Opcode::LoadConstant, place.mRegister, AddConstant(constant));
+  return place;
+}
+
+BytecodeCompiler::Place BytecodeCompiler::CompilePlace(ExpressionNode* node)
+{
+  Place place;
+  place.mIsRegister = false;
+  place.mOffset = 0;
+  place.mNullable = false;
+
+  switch (node->mKind)
+  {
+    case NodeKind::Value:
+    {
+      ValueNode* value = static_cast<ValueNode*>(node);
+      Symbol* symbol = value->mResolvedSymbol;
+      if (value->mToken.mEnumTokenType != TokenType::Identifier || symbol == nullptr || symbol->mType->mMode == TypeMode::Function)
+        break;
+      return GetVariablePlace(static_cast<Variable*>(symbol));
+    }
+
+    case NodeKind::MemberAccess:
+    {
+      MemberAccessNode* access = static_cast<MemberAccessNode*>(node);
+      Symbol* member = access->mResolvedMember;
+      if (member->mType->mMode == TypeMode::Function)
+        break;
+
+      if (access->mOperator.mEnumTokenType == TokenType::Arrow)
+      {
+        place.mRegister = CompileExpression(access->mLeft.get()).mRegister;
+        place.mNullable = true;
+      }
+      else
+      {
+        place = CompilePlace(access->mLeft.get());
+      }
+
+      place.mIsRegister = false;
+      place.mOffset += mMachine->mMemory.GetMemberOffset(static_cast<Variable*>(member));
+      place.mType = member->mType;
+      return place;
+    }
+
+    case NodeKind::UnaryOperator:
+    {
+      UnaryOperatorNode* unary = static_cast<UnaryOperatorNode*>(node);
+      if (unary->mOperator.mEnumTokenType != TokenType::Asterisk)
+        break;
+
+      Operand pointer = CompileExpression(unary->mRight.get());
+      place.mRegister = pointer.mRegister;
+      place.mNullable = true;
+      place.mType = pointer.mType->mPointerToType;
+      return place;
+    }
+
+    case NodeKind::Index:
+    {
+      IndexNode* index = static_cast<IndexNode*>(node);
+      Operand pointer = Stable(CompileExpression(index->mLeft.get()), index->mIndex.get());
+      Operand offset = Convert(CompileExpression(index->mIndex.get()), IntegerType);
+      place.mType = pointer.mType->mPointerToType;
+      place.mRegister = AllocateRegister();
+      Emit(Opcode::IndexAddress, place.mRegister, pointer.mRegister, offset.mRegister);
+      EmitExtra(mMachine->mMemory.GetSize(place.mType));
+      return place;
+    }
+
+    default:
+      break;
+  }
+
+  // A class value that a call returned can still have its members read
+  Operand value = CompileExpression(node);
+  if (IsClass(value.mType))
+  {
+    place.mRegister = value.mRegister;
+    place.mType = value.mType;
+    return place;
+  }
+
+  EmitError("The expression does not refer to anything that can be assigned to or have its address taken");
+  place.mRegister = value.mRegister;
+  place.mType = value.mType;
+  return place;
+}
+
+BytecodeCompiler::Place BytecodeCompiler::Reachable(const Place& place)
+{
+  if (place.mIsRegister || place.mOffset <= MaxOperand)
+    return place;
+
+  Place reachable = place;
+  reachable.mRegister = GetAddress(place, -1);
+  reachable.mOffset = 0;
+  reachable.mNullable = false;
+  return reachable;
+}
+
+uint16_t BytecodeCompiler::GetAddress(const Place& place, int target)
+{
+  if (place.mOffset == 0 && !place.mNullable)
+  {
+    if (target < 0 || target == place.mRegister)
+      return place.mRegister;
+    Emit(Opcode::Move, target, place.mRegister);
+    return (uint16_t)target;
+  }
+
+  uint16_t address = Destination(target);
+  if (place.mOffset <= MaxOperand)
+  {
+    // PointerAddImmediate's offset is signed, so a far member of an address known not to be null still uses MemberAddress
+    bool check = place.mNullable || place.mOffset > INT16_MAX;
+    Emit(check ? Opcode::MemberAddress : Opcode::PointerAddImmediate, address, place.mRegister, place.mOffset);
+    return address;
+  }
+
+  // Too far for an operand (a huge class), so the offset comes from a constant after checking the address
+  Register constant;
+  constant.mPointer = nullptr;
+  constant.mInteger = (int32_t)place.mOffset;
+  uint16_t offset = AllocateRegister();
+  Emit(Opcode::LoadConstant, offset, AddConstant(constant));
+  Emit(Opcode::MemberAddress, address, place.mRegister, 0);
+  Emit(Opcode::PointerAdd, address, address, offset);
+  return address;
+}
+
+BytecodeCompiler::Operand BytecodeCompiler::Load(const Place& original, int target)
+{
+  Type* type = original.mType;
+  if (original.mIsRegister)
+  {
+    Operand result = { original.mRegister, type };
+    return result;
+  }
+
+  // A class value is its address
+  if (IsClass(type))
+  {
+    Operand result = { GetAddress(original, target), type };
+    return result;
+  }
+
+  Opcode::Enum opcode;
+  if (type == IntegerType || type == FloatType)
+    opcode = Opcode::LoadInteger;
+  else if (type == ByteType)
+    opcode = Opcode::LoadByte;
+  else if (type == BooleanType)
+    opcode = Opcode::LoadBoolean;
+  else if (IsPointer(type) || type->mMode == TypeMode::Function)
+    opcode = Opcode::LoadPointer;
+  else
+    return Invalid("Unable to read a value of the type '" + type->mName + "'", type, target);
+
+  Place place = Reachable(original);
+  Operand result = { Destination(target), type };
+  Emit(opcode, result.mRegister, place.mRegister, place.mOffset);
+  return result;
+}
+
+void BytecodeCompiler::Store(const Place& original, Operand value)
+{
+  Type* type = original.mType;
+  if (original.mIsRegister)
+  {
+    if (value.mRegister != original.mRegister)
+      Emit(Opcode::Move, original.mRegister, value.mRegister);
+    return;
+  }
+
+  if (IsClass(type))
+  {
+    Emit(Opcode::Copy, GetAddress(original, -1), value.mRegister);
+    EmitExtra(mMachine->mMemory.GetSize(type));
+    return;
+  }
+
+  Opcode::Enum opcode;
+  if (type == IntegerType || type == FloatType)
+    opcode = Opcode::StoreInteger;
+  else if (type == ByteType || type == BooleanType)
+    opcode = Opcode::StoreByte;
+  else if (IsPointer(type) || type->mMode == TypeMode::Function)
+    opcode = Opcode::StorePointer;
+  else
+  {
+    EmitError("Unable to store a value of the type '" + type->mName + "'");
+    return;
+  }
+
+  Place place = Reachable(original);
+  Emit(opcode, value.mRegister, place.mRegister, place.mOffset);
+}
+#pragma endregion
+
+#pragma region Conversions
+BytecodeCompiler::Operand BytecodeCompiler::Convert(Operand value, Type* type, int target)
+{
+  Type* from = value.mType;
+  Opcode::Enum opcode = Opcode::Move;
+  bool converts = true;
+
+  if (from == type)
+  {
+  }
+  else if (IsPrimitive(type) && IsPrimitive(from))
+  {
+    // Booleans and Bytes already hold what an Integer would, and a Boolean is a Byte that's 0 or 1
+    if (type == IntegerType)
+      opcode = from == FloatType ? Opcode::FloatToInteger : Opcode::Move;
+    else if (type == FloatType)
+      opcode = Opcode::IntegerToFloat;
+    else if (type == ByteType)
+      opcode = from == FloatType ? Opcode::FloatToByte : from == IntegerType ? Opcode::IntegerToByte : Opcode::Move;
+    else
+      opcode = from == FloatType ? Opcode::FloatToBoolean : Opcode::IntegerToBoolean;
+  }
+  else if (IsPointer(type) && IsPointer(from))
+  {
+  }
+  else if (IsPointer(type) && from == IntegerType)
+  {
+    opcode = Opcode::IntegerToPointer;
+  }
+  else if (type == IntegerType && IsPointer(from))
+  {
+    opcode = Opcode::PointerToInteger;
+  }
+  else if (type == BooleanType && IsPointer(from))
+  {
+    opcode = Opcode::PointerToBoolean;
+  }
+  else
+  {
+    converts = false;
+  }
+
+  if (!converts)
+    return Invalid("Unable to convert from '" + from->mName + "' to '" + type->mName + "'", type, target);
+
+  Operand result = { value.mRegister, type };
+  if (opcode == Opcode::Move)
+  {
+    if (target >= 0 && target != value.mRegister)
+    {
+      Emit(Opcode::Move, target, value.mRegister);
+      result.mRegister = (uint16_t)target;
+    }
+    return result;
+  }
+
+  result.mRegister = Destination(target);
+  Emit(opcode, result.mRegister, value.mRegister);
+  return result;
+}
+
+BytecodeCompiler::Operand BytecodeCompiler::ToBoolean(Operand value, int target)
+{
+  // Conditions take a Boolean, or a pointer that isn't null
+  return Convert(value, BooleanType, target);
+}
+
+BytecodeCompiler::Operand BytecodeCompiler::Stable(Operand value, ExpressionNode* later)
+{
+  if (!IsLocalRegister(value.mRegister))
+    return value;
+
+  AssignmentFinder finder;
+  finder.Walk(later);
+  if (!finder.mFound)
+    return value;
+
+  Operand copy = { AllocateRegister(), value.mType };
+  Emit(Opcode::Move, copy.mRegister, value.mRegister);
+  return copy;
+}
+#pragma endregion
+
+#pragma region Machine
+BytecodeFunction::BytecodeFunction() :
+  mSymbol(nullptr),
+  mNode(nullptr),
+  mParameterCount(0),
+  mRegisterCount(0),
+  mFrameSize(0),
+  mHotness(0),
+  mNative(nullptr)
+{
+}
+
+VirtualMachine::VirtualMachine() :
+  mStack(new char[StackSize]),
+  mStackTop(0),
+  mRegisters(new Register[RegisterFileSize]),
+  mTierUpThreshold(DefaultTierUpThreshold)
+{
+  mFrames.reserve(64);
+
+  mContext.mMachine = this;
+  mContext.mResult.mPointer = nullptr;
+  mContext.mMessage = nullptr;
+  mContext.mDepth = 0;
+  mContext.mMaxDepth = MaxCallDepth;
+  mContext.mStackLimit = 0;
+  mContext.mRegisterEnd = mRegisters.get() + RegisterFileSize;
+  mContext.mStackTop = &mStackTop;
+}
+
+VirtualMachine::~VirtualMachine()
+{
+  // The functions go back to running from their nodes (unless something else has taken them since)
+  for (std::unordered_map<Function*, std::unique_ptr<BytecodeFunction>>::iterator it = mCode.begin(); it != mCode.end(); ++it)
+  {
+    void* executable = it->first->mExecutableFunction;
+    BytecodeFunction* code = it->second.get();
+    if (executable == code || (code->mNative != nullptr && executable == reinterpret_cast<void*>(code->mNative)))
+      it->first->mExecutableFunction = code->mNode;
+  }
+}
+
+void VirtualMachine::Load(BlockNode* block)
+{
+  // Every function gets its BytecodeFunction before any are compiled, so a call can refer to one compiled later
+  std::vector<FunctionNode*> nodes;
+  for (size_t i = 0; i < block->mGlobals.size(); ++i)
+  {
+    AbstractNode* global = block->mGlobals[i].get();
+    if (global->mKind == NodeKind::Function)
+    {
+      nodes.push_back(static_cast<FunctionNode*>(global));
+    }
+    else if (global->mKind == NodeKind::Class)
+    {
+      ClassNode* node = static_cast<ClassNode*>(global);
+      for (size_t j = 0; j < node->mMembers.size(); ++j)
+      {
+        if (node->mMembers[j]->mKind == NodeKind::Function)
+          nodes.push_back(static_cast<FunctionNode*>(node->mMembers[j].get()));
+      }
+    }
+  }
+
+  for (size_t i = 0; i < nodes.size(); ++i)
+  {
+    std::unique_ptr<BytecodeFunction>& code = mCode[nodes[i]->mSymbol];
+    code.reset(new BytecodeFunction());
+    code->mSymbol = nodes[i]->mSymbol;
+    code->mNode = nodes[i];
+  }
+
+  try
+  {
+    for (size_t i = 0; i < nodes.size(); ++i)
+    {
+      BytecodeCompiler compiler(this, mCode[nodes[i]->mSymbol].get());
+      compiler.CompileFunction(nodes[i]);
+    }
+  }
+  catch (...)
+  {
+    for (size_t i = 0; i < nodes.size(); ++i)
+      mCode.erase(nodes[i]->mSymbol);
+    throw;
+  }
+
+  for (size_t i = 0; i < nodes.size(); ++i)
+  {
+    Function* function = nodes[i]->mSymbol;
+    function->mExecutableFunction = mCode[function].get();
+    if (function->mParentType == nullptr)
+      mFunctions[function->mAtom] = function;
+  }
+
+  // The initial values of the globals run once, as a function of their own
+  BytecodeFunction globals;
+  BytecodeCompiler compiler(this, &globals);
+  compiler.CompileGlobals(block);
+
+  size_t top = mStackTop;
+  try
+  {
+    Register result;
+    result.mPointer = nullptr;
+    Run(&globals, mRegisters.get(), result);
+  }
+  catch (...)
+  {
+    mFrames.clear();
+    mStackTop = top;
+    throw;
+  }
+}
+
+Function* VirtualMachine::FindFunction(const std::string& name) const
+{
+  std::unordered_map<Atom, Function*>::const_iterator it = mFunctions.find(InternString(name));
+  if (it == mFunctions.end())
+    return nullptr;
+  return it->second;
+}
+
+RuntimeValue VirtualMachine::Call(Function* function, const std::vector<RuntimeValue>& arguments)
+{
+  std::unordered_map<Function*, std::unique_ptr<BytecodeFunction>>::iterator found = mCode.find(function);
+  if (found == mCode.end())
+    ErrorExecution("The function '" + function->mName + "' has no body to run");
+
+  BytecodeFunction* code = found->second.get();
+  if (arguments.size() != code->mParameterCount)
+    ErrorExecution("The function '" + function->mName + "' was called with the wrong number of arguments");
+
+  // Anything the last call left on the stack is given back now
+  mStackTop = 0;
+
+  FunctionTypeRecord* signature = function->mType->mFunction;
+  Register* registers = mRegisters.get();
+  for (size_t i = 0; i < arguments.size(); ++i)
+  {
+    Type* type = signature->mParameterTypes[i];
+    RuntimeValue value = ConvertValue(arguments[i], type);
+    registers[i].mPointer = nullptr;
+    if (type == IntegerType)
+      registers[i].mInteger = value.mInteger;
+    else if (type == FloatType)
+      registers[i].mFloat = value.mFloat;
+    else if (type == BooleanType)
+      registers[i].mInteger = value.mBoolean ? 1 : 0;
+    else if (type == ByteType)
+      registers[i].mInteger = value.mByte;
+    else if (type->mMode == TypeMode::Function)
+      registers[i].mFunction = value.mFunction;
+    else
+      registers[i].mPointer = value.mPointer;
+  }
+
+  Type* returnType = signature->mReturnType ? signature->mReturnType : VoidType;
+  Register result;
+  result.mPointer = nullptr;
+  if (IsClass(returnType))
+    result.mPointer = AllocateStack(mMemory.GetSize(returnType));
+
+  try
+  {
+    if (code->mNative != nullptr)
+      RunNative(code, registers, result);
+    else
+      Run(code, registers, result);
+  }
+  catch (...)
+  {
+    mFrames.clear();
+    mStackTop = 0;
+    mContext.mDepth = 0;
+    throw;
+  }
+
+  RuntimeValue value;
+  value.mType = returnType;
+  if (returnType == IntegerType)
+    value.mInteger = result.mInteger;
+  else if (returnType == FloatType)
+    value.mFloat = result.mFloat;
+  else if (returnType == BooleanType)
+    value.mBoolean = result.mInteger != 0;
+  else if (returnType == ByteType)
+    value.mByte = (uint8_t)result.mInteger;
+  else if (returnType->mMode == TypeMode::Function)
+    value.mFunction = result.mFunction;
+  else if (returnType != VoidType)
+    value.mPointer = result.mPointer;
+  return value;
+}
+
+std::string VirtualMachine::Disassemble(Function* function) const
+{
+  std::unordered_map<Function*, std::unique_ptr<BytecodeFunction>>::const_iterator found = mCode.find(function);
+  if (found == mCode.end())
+    return std::string();
+
+  const BytecodeFunction* code = found->second.get();
+  std::string text;
+  char line[128];
+  snprintf(line, sizeof(line), "%s: %d registers, %d frame bytes\n", function->mName.c_str(), (int)code->mRegisterCount, (int)code->mFrameSize);
+  text += line;
+
+  for (size_t i = 0; i < code->mCode.size(); ++i)
+  {
+    const Instruction& instruction = code->mCode[i];
+    switch (instruction.mOpcode)
+    {
+      case Opcode::Jump:
+      case Opcode::JumpIfTrue:
+      case Opcode::JumpIfFalse:
+        snprintf(line, sizeof(line), "%5d  %-20s %d -> %d\n", (int)i, OpcodeNames[instruction.mOpcode], instruction.mA, (int)GetTarget(instruction));
+        break;
+
+      case Opcode::FrameAddress:
+        snprintf(line, sizeof(line), "%5d  %-20s %d, %d\n", (int)i, OpcodeNames[instruction.mOpcode], instruction.mA, (int)GetTarget(instruction));
+        break;
+
+      case Opcode::Extra:
+        snprintf(line, sizeof(line), "%5d  %-20s %d\n", (int)i, OpcodeNames[instruction.mOpcode], (int)GetExtra(&instruction - 1));
+        break;
+
+      case Opcode::Error:
+        snprintf(line, sizeof(line), "%5d  %-20s \"%s\"\n", (int)i, OpcodeNames[instruction.mOpcode], code->mMessages[instruction.mA].c_str());
+        break;
+
+      default:
+        snprintf(line, sizeof(line), "%5d  %-20s %d, %d, %d\n", (int)i, OpcodeNames[instruction.mOpcode], instruction.mA, instruction.mB, instruction.mC);
+        break;
+    }
+    text += line;
+  }
+
+  return text;
+}
+
+void VirtualMachine::SetTierUpThreshold(size_t hotness)
+{
+  mTierUpThreshold = hotness;
+}
+
+char* VirtualMachine::AllocateStack(size_t size)
+{
+  size_t base = AlignUp(mStackTop, sizeof(char*));
+  if (base + size > StackSize)
+    ErrorExecution("The stack overflowed");
+
+  mStackTop = base + size;
+  return mStack.get() + base;
+}
+
+char* VirtualMachine::GetGlobalAddress(Variable* variable)
+{
+  // Globals of libraries that weren't loaded start zeroed
+  std::unique_ptr<char[]>& storage = mGlobals[variable];
+  if (storage == nullptr)
+  {
+    size_t size = mMemory.GetSize(variable->mType);
+    storage.reset(new char[size ? size : 1]());
+  }
+  return storage.get();
+}
+
+char* VirtualMachine::AddString(const std::string& text)
+{
+  std::unique_ptr<char[]> copy(new char[text.size() + 1]);
+  memcpy(copy.get(), text.c_str(), text.size() + 1);
+  mStrings.push_back(std::move(copy));
+  return mStrings.back().get();
+}
+#pragma endregion
+
+#pragma region Dispatch
+void VirtualMachine::Heat(BytecodeFunction* function)
+{
+  // Only the first time it gets this hot, so a function the JIT can't compile isn't tried again
+  if (++function->mHotness != mTierUpThreshold || function->mSymbol == nullptr)
+    return;
+
+  if (mJit == nullptr)
+    mJit.reset(new BaselineJit());
+  function->mNative = mJit->Compile(function);
+
+  Function* symbol = function->mSymbol;
+  if (function->mNative != nullptr && symbol->mExecutableFunction == function)
+    symbol->mExecutableFunction = reinterpret_cast<void*>(function->mNative);
+}
+
+void VirtualMachine::RunNative(BytecodeFunction* function, Register* registers, Register& result)
+{
+  // Outside of machine code, so this is as high as the host's stack will be while it runs
+  if (mContext.mDepth == 0)
+    mContext.mStackLimit = BaselineJit::StackLimit();
+
+  mContext.mResult = result;
+  if (function->mNative(registers, &mContext) != 0)
+    ErrorExecution(*mContext.mMessage);
+  result = mContext.mResult;
+}
+
+void VirtualMachine::Run(BytecodeFunction* function, Register* registers, Register& result)
+{
+  size_t depth = mFrames.size();
+  Heat(function);
+
+  Frame entry;
+  entry.mFunction = function;
+  entry.mRegisters = registers;
+  entry.mStackTop = mStackTop;
+  entry.mMemory = AllocateStack(function->mFrameSize);
+  entry.mReturnTo = nullptr;
+  entry.mResult = 0;
+  mFrames.push_back(entry);
+
+  if (registers + function->mRegisterCount > mRegisters.get() + RegisterFileSize)
+    ErrorExecution("The call stack overflowed");
+
+  const Instruction* code = function->mCode.data();
+  const Instruction* pc = code;
+  Register* r = registers;
+  const Register* k = function->mConstants.data();
+  char* frame = entry.mMemory;
+  Register* registerEnd = mRegisters.get() + RegisterFileSize;
+
+  BytecodeFunction* callee = nullptr;
+  Register value;
+
+#if VM_COMPUTED_GOTO
+  static void* const dispatch[] =
+  {
+    #define OPCODE(Name, Description) &&Do##Name,
+    #include "Opcodes.inl"
+    #undef OPCODE
+  };
+  #define VM_DISPATCH() goto *dispatch[pc->mOpcode]
+  #define VM_CASE(Name) Do##Name:
+  #define VM_NEXT() ++pc; VM_DISPATCH()
+  #define VM_SKIP() pc += 2; VM_DISPATCH()
+#else
+  #define VM_DISPATCH() goto Dispatch
+  #define VM_CASE(Name) case Opcode::Name:
+  #define VM_NEXT() ++pc; VM_DISPATCH()
+  #define VM_SKIP() pc += 2; VM_DISPATCH()
+#endif
+
+  #define A r[pc->mA]
+  #define B r[pc->mB]
+  #define C r[pc->mC]
+
+#if VM_COMPUTED_GOTO
+  VM_DISPATCH();
+  {
+#else
+Dispatch:
+  {
+    switch (pc->mOpcode)
+    {
+#endif
+      VM_CASE(Move)
+        A = B;
+        VM_NEXT();
+
+      VM_CASE(LoadConstant)
+        A = k[pc->mB];
+        VM_NEXT();
+
+      VM_CASE(Clear)
+        A.mPointer = nullptr;
+        VM_NEXT();
+
+      VM_CASE(FrameAddress)
+        A.mPointer = frame + GetTarget(*pc);
+        VM_NEXT();
+
+      // Integers wrap around instead of overflowing, the same as the machine does
+      VM_CASE(IntegerAdd)
+        A.mInteger = (int32_t)((uint32_t)B.mInteger + (uint32_t)C.mInteger);
+        VM_NEXT();
+
+      VM_CASE(IntegerAddImmediate)
+        A.mInteger = (int32_t)((uint32_t)B.mInteger + (uint32_t)(int32_t)(int16_t)pc->mC);
+        VM_NEXT();
+
+      VM_CASE(IntegerSubtract)
+        A.mInteger = (int32_t)((uint32_t)B.mInteger - (uint32_t)C.mInteger);
+        VM_NEXT();
+
+      VM_CASE(IntegerMultiply)
+        A.mInteger = (int32_t)((uint32_t)B.mInteger * (uint32_t)C.mInteger);
+        VM_NEXT();
+
+      VM_CASE(IntegerDivide)
+      {
+        int32_t divisor = C.mInteger;
+        if (divisor == 0)
+          ErrorExecution("Division by zero");
+        A.mInteger = divisor == -1 ? (int32_t)(0u - (uint32_t)B.mInteger) : B.mInteger / divisor;
+        VM_NEXT();
+      }
+
+      VM_CASE(IntegerModulo)
+      {
+        int32_t divisor = C.mInteger;
+        if (divisor == 0)
+          ErrorExecution("Division by zero");
+        A.mInteger = divisor == -1 ? 0 : B.mInteger % divisor;
+        VM_NEXT();
+      }
+
+      VM_CASE(IntegerNegate)
+        A.mInteger = (int32_t)(0u - (uint32_t)B.mInteger);
+        VM_NEXT();
+
+      VM_CASE(FloatAdd)
+        A.mFloat = B.mFloat + C.mFloat;
+        VM_NEXT();
+
+      VM_CASE(FloatSubtract)
+        A.mFloat = B.mFloat - C.mFloat;
+        VM_NEXT();
+
+      VM_CASE(FloatMultiply)
+        A.mFloat = B.mFloat * C.mFloat;
+        VM_NEXT();
+
+      VM_CASE(FloatDivide)
+        A.mFloat = B.mFloat / C.mFloat;
+        VM_NEXT();
+
+      VM_CASE(FloatModulo)
+        A.mFloat = fmodf(B.mFloat, C.mFloat);
+        VM_NEXT();
+
+      VM_CASE(FloatNegate)
+        A.mFloat = -B.mFloat;
+        VM_NEXT();
+
+      VM_CASE(IntegerLess)
+        A.mInteger = B.mInteger < C.mInteger;
+        VM_NEXT();
+
+      VM_CASE(IntegerLessOrEqual)
+        A.mInteger = B.mInteger <= C.mInteger;
+        VM_NEXT();
+
+      VM_CASE(IntegerEqual)
+        A.mInteger = B.mInteger == C.mInteger;
+        VM_NEXT();
+
+      VM_CASE(IntegerNotEqual)
+        A.mInteger = B.mInteger != C.mInteger;
+        VM_NEXT();
+
+      VM_CASE(FloatLess)
+        A.mInteger = B.mFloat < C.mFloat;
+        VM_NEXT();
+
+      VM_CASE(FloatLessOrEqual)
+        A.mInteger = B.mFloat <= C.mFloat;
+        VM_NEXT();
+
+      VM_CASE(FloatEqual)
+        A.mInteger = B.mFloat == C.mFloat;
+        VM_NEXT();
+
+      VM_CASE(FloatNotEqual)
+        A.mInteger = B.mFloat != C.mFloat;
+        VM_NEXT();
+
+      VM_CASE(PointerLess)
+        A.mInteger = (intptr_t)B.mPointer < (intptr_t)C.mPointer;
+        VM_NEXT();
+
+      VM_CASE(PointerLessOrEqual)
+        A.mInteger = (intptr_t)B.mPointer <= (intptr_t)C.mPointer;
+        VM_NEXT();
+
+      VM_CASE(PointerEqual)
+        A.mInteger = B.mPointer == C.mPointer;
+        VM_NEXT();
+
+      VM_CASE(PointerNotEqual)
+        A.mInteger = B.mPointer != C.mPointer;
+        VM_NEXT();
+
+      VM_CASE(ClassEqual)
+        A.mInteger = memcmp(B.mPointer, C.mPointer, GetExtra(pc)) == 0;
+        VM_SKIP();
+
+      VM_CASE(Not)
+        A.mInteger = !B.mInteger;
+        VM_NEXT();
+
+      VM_CASE(IntegerToFloat)
+        A.mFloat = (float)B.mInteger;
+        VM_NEXT();
+
+      VM_CASE(FloatToInteger)
+        A.mInteger = FloatToInteger(B.mFloat);
+        VM_NEXT();
+
+      VM_CASE(FloatToByte)
+        A.mInteger = (uint8_t)FloatToInteger(B.mFloat);
+        VM_NEXT();
+
+      VM_CASE(IntegerToByte)
+        A.mInteger = (uint8_t)B.mInteger;
+        VM_NEXT();
+
+      VM_CASE(IntegerToBoolean)
+        A.mInteger = B.mInteger != 0;
+        VM_NEXT();
+
+      VM_CASE(FloatToBoolean)
+        A.mInteger = B.mFloat != 0.0f;
+        VM_NEXT();
+
+      VM_CASE(PointerToBoolean)
+        A.mInteger = B.mPointer != nullptr;
+        VM_NEXT();
+
+      VM_CASE(IntegerToPointer)
+        A.mPointer = (char*)(intptr_t)B.mInteger;
+        VM_NEXT();
+
+      VM_CASE(PointerToInteger)
+        A.mInteger = (int32_t)(intptr_t)B.mPointer;
+        VM_NEXT();
+
+      VM_CASE(PointerAdd)
+        A.mPointer = B.mPointer + C.mInteger;
+        VM_NEXT();
+
+      VM_CASE(PointerAddImmediate)
+        A.mPointer = B.mPointer + (int16_t)pc->mC;
+        VM_NEXT();
+
+      VM_CASE(MemberAddress)
+        if (B.mPointer == nullptr)
+          goto NullPointer;
+        A.mPointer = B.mPointer + pc->mC;
+        VM_NEXT();
+
+      VM_CASE(PointerAddScaled)
+        A.mPointer = B.mPointer + (ptrdiff_t)C.mInteger * (ptrdiff_t)GetExtra(pc);
+        VM_SKIP();
+
+      VM_CASE(IndexAddress)
+        if (B.mPointer == nullptr)
+          ErrorExecution("Indexed a null pointer");
+        A.mPointer = B.mPointer + (ptrdiff_t)C.mInteger * (ptrdiff_t)GetExtra(pc);
+        VM_SKIP();
+
+      VM_CASE(PointerDifference)
+        A.mInteger = (int32_t)(B.mPointer - C.mPointer);
+        VM_NEXT();
+
+      VM_CASE(LoadInteger)
+        if (B.mPointer == nullptr)
+          goto NullPointer;
+        memcpy(&A.mInteger, B.mPointer + pc->mC, sizeof(int32_t));
+        VM_NEXT();
+
+      VM_CASE(LoadByte)
+        if (B.mPointer == nullptr)
+          goto NullPointer;
+        A.mInteger = (uint8_t)B.mPointer[pc->mC];
+        VM_NEXT();
+
+      VM_CASE(LoadBoolean)
+        if (B.mPointer == nullptr)
+          goto NullPointer;
+        A.mInteger = B.mPointer[pc->mC] != 0;
+        VM_NEXT();
+
+      VM_CASE(LoadPointer)
+        if (B.mPointer == nullptr)
+          goto NullPointer;
+        memcpy(&A.mPointer, B.mPointer + pc->mC, sizeof(char*));
+        VM_NEXT();
+
+      VM_CASE(StoreInteger)
+        if (B.mPointer == nullptr)
+          goto NullPointer;
+        memcpy(B.mPointer + pc->mC, &A.mInteger, sizeof(int32_t));
+        VM_NEXT();
+
+      VM_CASE(StoreByte)
+        if (B.mPointer == nullptr)
+          goto NullPointer;
+        B.mPointer[pc->mC] = (char)A.mInteger;
+        VM_NEXT();
+
+      VM_CASE(StorePointer)
+        if (B.mPointer == nullptr)
+          goto NullPointer;
+        memcpy(B.mPointer + pc->mC, &A.mPointer, sizeof(char*));
+        VM_NEXT();
+
+      VM_CASE(Copy)
+        if (A.mPointer == nullptr || B.mPointer == nullptr)
+          goto NullPointer;
+        memmove(A.mPointer, B.mPointer, GetExtra(pc));
+        VM_SKIP();
+
+      VM_CASE(Zero)
+        memset(A.mPointer, 0, GetExtra(pc));
+        VM_SKIP();
+
+      // Loops jump backwards, which counts toward compiling the function (it runs as machine code from its next call)
+      VM_CASE(Jump)
+      {
+        const Instruction* target = code + GetTarget(*pc);
+        if (target <= pc)
+          Heat(mFrames.back().mFunction);
+        pc = target;
+        VM_DISPATCH();
+      }
+
+      VM_CASE(JumpIfTrue)
+        if (A.mInteger)
+        {
+          const Instruction* target = code + GetTarget(*pc);
+          if (target <= pc)
+            Heat(mFrames.back().mFunction);
+          pc = target;
+        }
+        else
+        {
+          ++pc;
+        }
+        VM_DISPATCH();
+
+      VM_CASE(JumpIfFalse)
+        if (!A.mInteger)
+          pc = code + GetTarget(*pc);
+        else
+          ++pc;
+        VM_DISPATCH();
+
+      VM_CASE(Call)
+        callee = k[pc->mC].mBytecode;
+        goto Enter;
+
+      VM_CASE(CallIndirect)
+      {
+        // The function could be from a tree that wasn't loaded, so it's looked up instead of trusting mExecutableFunction
+        if (C.mFunction == nullptr)
+          ErrorExecution("Called a null function");
+        std::unordered_map<Function*, std::unique_ptr<BytecodeFunction>>::iterator found = mCode.find(C.mFunction);
+        if (found == mCode.end())
+          ErrorExecution("The function '" + C.mFunction->mName + "' has no body to run");
+        callee = found->second.get();
+        goto Enter;
+      }
+
+      VM_CASE(Return)
+        value = A;
+        goto Leave;
+
+      VM_CASE(ReturnVoid)
+        value.mPointer = nullptr;
+        goto Leave;
+
+      VM_CASE(ReturnClass)
+      {
+        // The caller's storage is below this frame, so the copy can't overlap it
+        Frame& done = mFrames.back();
+        char* destination = mFrames.size() - 1 == depth ? result.mPointer : mFrames[mFrames.size() - 2].mRegisters[done.mResult].mPointer;
+        memmove(destination, A.mPointer, GetExtra(pc));
+        value.mPointer = destination;
+        goto Leave;
+      }
+
+      VM_CASE(Error)
+        ErrorExecution(mFrames.back().mFunction->mMessages[pc->mA]);
+        VM_NEXT();
+
+      VM_CASE(Extra)
+        VM_NEXT();
+
+#if !VM_COMPUTED_GOTO
+      default:
+        ErrorExecution("Unable to run an unknown instruction");
+    }
+#endif
+  }
+
+Enter:
+  {
+    if (mFrames.size() - depth >= MaxCallDepth)
+      ErrorExecution("The call stack overflowed");
+
+    Register* calleeRegisters = r + mFrames.back().mFunction->mRegisterCount;
+    if (calleeRegisters + callee->mRegisterCount > registerEnd)
+      ErrorExecution("The call stack overflowed");
+
+    const Register* arguments = &B;
+    for (size_t i = 0; i < callee->mParameterCount; ++i)
+      calleeRegisters[i] = arguments[i];
+
+    Heat(callee);
+    if (callee->mNative != nullptr)
+    {
+      RunNative(callee, calleeRegisters, A);
+      VM_NEXT();
+    }
+
+    Frame next;
+    next.mFunction = callee;
+    next.mRegisters = calleeRegisters;
+    next.mStackTop = mStackTop;
+    next.mMemory = AllocateStack(callee->mFrameSize);
+    next.mReturnTo = pc + 1;
+    next.mResult = pc->mA;
+    mFrames.push_back(next);
+
+    r = calleeRegisters;
+    k = callee->mConstants.data();
+    frame = next.mMemory;
+    code = callee->mCode.data();
+    pc = code;
+    VM_DISPATCH();
+  }
+
+Leave:
+  {
+    Frame done = mFrames.back();
+    mFrames.pop_back();
+    mStackTop = done.mStackTop;
+    if (mFrames.size() == depth)
+    {
+      result = value;
+      return;
+    }
+
+    Frame& caller = mFrames.back();
+    r = caller.mRegisters;
+    k = caller.mFunction->mConstants.data();
+    frame = caller.mMemory;
+    code = caller.mFunction->mCode.data();
+    pc = done.mReturnTo;
+    r[done.mResult] = value;
+    VM_DISPATCH();
+  }
+
+NullPointer:
+  ErrorExecution("Accessed memory through a null pointer");
+
+  #undef A
+  #undef B
+  #undef C
+  #undef VM_DISPATCH
+  #undef VM_CASE
+  #undef VM_NEXT
+  #undef VM_SKIP
+}
+#pragma endregion
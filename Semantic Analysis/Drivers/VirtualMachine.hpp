@@ -0,0 +1,200 @@
+/******************************************************************\
+ * Copyright 2015, DigiPen Institute of Technology
+\******************************************************************/
+
+#pragma once
+#ifndef COMPILER_CLASS_VIRTUAL_MACHINE
+#define COMPILER_CLASS_VIRTUAL_MACHINE
+
+#include "Interpreter.hpp"
+
+// Runs analyzed trees as register based bytecode
+// Loading a tree compiles each of its functions to a BytecodeFunction and points Function::mExecutableFunction at it
+// (until the machine is destroyed, which points it back at the FunctionNode)
+//
+// Opcodes are typed: the types analysis resolved decide between IntegerAdd and FloatAdd, where conversions go and how
+// wide a load or store is, so nothing is looked up while running. Initial values are the exception, since analysis
+// gives their top node the declared type, so the compiler follows the type each value actually has
+// Locals live in registers, except for classes and locals that have their address taken, which live in the frame
+// Memory is laid out the same as the Interpreter lays it out, and a program gives the same results and errors, except:
+//  - every null pointer is reported the same way
+//  - calls can nest deeper before the call stack overflows: the Interpreter recurses on the host's stack and stops at
+//    512 calls, bytecode calls don't and stop at 16K, and machine code stops at 16K or when the host's stack runs low
+//    (whichever comes first), so a deep recursion that overflows in the Interpreter can return here
+//
+// A function that gets hot (called or looped enough times) is compiled to machine code by a BaselineJit,
+// and from then on mExecutableFunction points at its NativeFunction instead
+
+namespace Opcode
+{
+  enum Enum
+  {
+    #define OPCODE(Name, Description) Name,
+    #include "Opcodes.inl"
+    #undef OPCODE
+    Count
+  };
+}
+
+// An array of names for each of the opcodes (the index is the opcode)
+extern const char* const OpcodeNames[];
+
+// See Opcodes.inl for what each opcode does with its operands
+class Instruction
+{
+public:
+  uint16_t mOpcode;
+  uint16_t mA;
+  uint16_t mB;
+  uint16_t mC;
+};
+
+class BytecodeFunction;
+class BaselineJit;
+
+// A class value is held as a pointer to its storage
+union Register
+{
+  int32_t mInteger;
+  float mFloat;
+  char* mPointer;
+  Function* mFunction;
+  // Only in constants, for the function a Call calls
+  BytecodeFunction* mBytecode;
+};
+
+class VirtualMachine;
+
+// What machine code shares with the VirtualMachine that runs it (see Jit.hpp)
+class NativeContext
+{
+public:
+  VirtualMachine* mMachine;
+  // What a function returned (for a class, where it goes, which the caller sets before the call)
+  Register mResult;
+  // Why the code stopped, when it returns 1
+  const std::string* mMessage;
+  // Machine code calls nest on the host's stack, so they're counted
+  size_t mDepth;
+  size_t mMaxDepth;
+  // And a call fails once the host's stack pointer is below this (see BaselineJit::StackLimit)
+  uintptr_t mStackLimit;
+  Register* mRegisterEnd;
+  size_t* mStackTop;
+};
+
+// Takes its arguments in the first of 'registers' and returns 0, or 1 if it stopped with an error
+typedef uint32_t (*NativeFunction)(Register* registers, NativeContext* context);
+
+class BytecodeFunction
+{
+public:
+  BytecodeFunction();
+
+  Function* mSymbol;
+  // Null for the code that initializes the globals of a tree
+  FunctionNode* mNode;
+
+  std::vector<Instruction> mCode;
+  std::vector<Register> mConstants;
+  // What each Error instruction throws
+  std::vector<std::string> mMessages;
+
+  // The parameters come in the first registers
+  size_t mParameterCount;
+  size_t mRegisterCount;
+  // Bytes of the frame, for the locals that live in memory and the class values calls return
+  size_t mFrameSize;
+
+  // Calls plus times around a loop, which decides when the function is compiled to machine code
+  size_t mHotness;
+  // Null until then (or if the JIT can't compile it)
+  NativeFunction mNative;
+};
+
+class VirtualMachine
+{
+public:
+  VirtualMachine();
+  ~VirtualMachine();
+
+  // Compiles the functions of an analyzed tree, then gives its globals storage and runs their initial values (in order)
+  // Several trees can be loaded, as long as the ones they depend on are loaded first
+  // The trees (and the text their tokens point into) must outlive the machine
+  void Load(BlockNode* block);
+
+  // The global function with the name, from the loaded trees (or null)
+  Function* FindFunction(const std::string& name) const;
+
+  // Runs a function with the arguments (converted to its parameter types) and returns what it returned
+  // Throws an ExecutionException if the program can't go on, which leaves the machine ready for another call
+  // A class value that is returned is left on the machine's stack, where it lasts until the next call
+  RuntimeValue Call(Function* function, const std::vector<RuntimeValue>& arguments);
+
+  // The instructions of a loaded function, one per line
+  std::string Disassemble(Function* function) const;
+
+  // How hot a function gets before it's compiled to machine code (0 keeps everything in bytecode)
+  void SetTierUpThreshold(size_t hotness);
+  static const size_t DefaultTierUpThreshold = 1000;
+
+private:
+  VirtualMachine(const VirtualMachine&) = delete;
+  VirtualMachine& operator=(const VirtualMachine&) = delete;
+
+  friend class BytecodeCompiler;
+  friend class BaselineJit;
+
+  // One call of a function
+  class Frame
+  {
+  public:
+    BytecodeFunction* mFunction;
+    Register* mRegisters;
+    char* mMemory;
+    // Where the caller picks up, and the register the result goes in
+    const Instruction* mReturnTo;
+    uint16_t mResult;
+    // The top of the stack before the frame's memory was taken from it
+    size_t mStackTop;
+  };
+
+  // Memory on the machine's stack, which is given back when the stack is reset to an earlier top
+  char* AllocateStack(size_t size);
+
+  // Storage for a global, made the first time it's used
+  char* GetGlobalAddress(Variable* variable);
+
+  // A copy of the text of a string literal, null terminated, that lasts as long as the machine
+  char* AddString(const std::string& text);
+
+  // Runs the function until it returns, with its arguments already in the registers
+  // The result goes in 'result' (for a class, the storage 'result' points at is filled in)
+  void Run(BytecodeFunction* function, Register* registers, Register& result);
+
+  // Runs a function's machine code, throwing if it stopped with an error
+  void RunNative(BytecodeFunction* function, Register* registers, Register& result);
+
+  // Counts a call or a loop, and compiles the function once it is hot enough
+  void Heat(BytecodeFunction* function);
+
+  MemoryLayout mMemory;
+
+  std::unordered_map<Function*, std::unique_ptr<BytecodeFunction>> mCode;
+  std::unordered_map<Atom, Function*> mFunctions;
+  std::unordered_map<Variable*, std::unique_ptr<char[]>> mGlobals;
+  std::vector<std::unique_ptr<char[]>> mStrings;
+
+  std::unique_ptr<char[]> mStack;
+  size_t mStackTop;
+  std::unique_ptr<Register[]> mRegisters;
+  std::vector<Frame> mFrames;
+
+  std::unique_ptr<BaselineJit> mJit;
+  size_t mTierUpThreshold;
+  NativeContext mContext;
+  // The error a call from machine code back into bytecode stopped with
+  std::string mNativeError;
+};
+
+#endif
@@ -0,0 +1,87 @@
+/******************************************************************\
+ * Copyright 2015, DigiPen Institute of Technology
+\******************************************************************/
+// Builds very deep trees and times how long they take to delete
+// Build it together with the Drivers and the other UserCode files with AST_TEARDOWN_BENCHMARK defined
+// Each tree is built twice: once with every node allocated on its own (deleted through the AstDeleter worklist)
+// and once in an AstArena (deleted all at once). A recursive teardown would overflow the stack on all of them.
+
+#include "../Drivers/AstArena.hpp"
+
+#if AST_TEARDOWN_BENCHMARK
+#include <chrono>
+#include <cstdio>
+
+static const size_t ChainLength = 1000000;
+
+// Heap allocates a node, or creates it in the arena when one is given
+template <typename T>
+static AstPtr<T> MakeNode(AstArena* arena)
+{
+  if (arena)
+    return arena->Create<T>();
+  return AstPtr<T>(new T());
+}
+
+// if (a) { } else if (a) { } else if (a) { } ...
+static AstPtr<AbstractNode> MakeElseIfChain(AstArena* arena)
+{
+  AstPtr<IfNode> root = MakeNode<IfNode>(arena);
+  IfNode* tail = root.get();
+  for (size_t i = 0; i < ChainLength; ++i)
+  {
+    tail->mCondition = MakeNode<ValueNode>(arena);
+    tail->mScope = MakeNode<ScopeNode>(arena);
+    tail->mElse = MakeNode<IfNode>(arena);
+    tail = tail->mElse.get();
+  }
+
+  return root;
+}
+
+// ((((a + a) + a) + a) + a) ...
+static AstPtr<AbstractNode> MakeBinaryChain(AstArena* arena)
+{
+  AstPtr<ExpressionNode> root = MakeNode<ValueNode>(arena);
+  for (size_t i = 0; i < ChainLength; ++i)
+  {
+    AstPtr<BinaryOperatorNode> op = MakeNode<BinaryOperatorNode>(arena);
+    op->mLeft = std::move(root);
+    op->mRight = MakeNode<ValueNode>(arena);
+    root = std::move(op);
+  }
+
+  return root;
+}
+
+static void Measure(const char* name, AstPtr<AbstractNode> (*makeTree)(AstArena*), bool useArena)
+{
+  typedef std::chrono::steady_clock Clock;
+
+  Clock::time_point start = Clock::now();
+  AstArena* arena = useArena ? new AstArena() : nullptr;
+  AstPtr<AbstractNode> root = makeTree(arena);
+  if (arena)
+    arena->SetRoot(root.get());
+  Clock::time_point built = Clock::now();
+
+  root = nullptr;
+  Clock::time_point deleted = Clock::now();
+
+  fprintf(stderr, "%-16s %-6s %10.1f %10.1f\n",
+    name,
+    useArena ? "arena" : "heap",
+    std::chrono::duration<double, std::milli>(built - start).count(),
+    std::chrono::duration<double, std::milli>(deleted - built).count());
+}
+
+int main(int argc, char* argv[])
+{
+  fprintf(stderr, "%-16s %-6s %10s %10s\n", "Tree", "Memory", "Build ms", "Delete ms");
+  Measure("else if chain", MakeElseIfChain, false);
+  Measure("else if chain", MakeElseIfChain, true);
+  Measure("binary chain", MakeBinaryChain, false);
+  Measure("binary chain", MakeBinaryChain, true);
+  return 0;
+}
+#endif
@@ -0,0 +1,350 @@
+/******************************************************************\
+ * Copyright 2015, DigiPen Institute of Technology
+\******************************************************************/
+// Measures the Interpreter, the VirtualMachine running bytecode, and the VirtualMachine with its JIT on small compute heavy programs
+// Each program is analyzed once, loaded into each, and then its entry function is called a number of times on each
+// (the JIT compiles functions as they get hot, so the first call or two of a program still runs bytecode)
+// The result of every call is checked against the same computation done natively, so a wrong answer fails the run
+// Build it together with the Drivers and the other UserCode files with INTERPRETER_BENCHMARK defined and run:
+//   InterpreterBenchmark
+// Results go to stderr. The parser's trace is off, so nothing is printed to stdout.
+
+#include "../Drivers/VirtualMachine.hpp"
+
+#if INTERPRETER_BENCHMARK
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+// Recursive calls with Integer arithmetic and an if
+static const char* const FibSource =
+  "function Fib(n : Integer) : Integer\n"
+  "{\n"
+  "  if (n < 2) { return n; }\n"
+  "  return Fib(n - 1) + Fib(n - 2);\n"
+  "}\n"
+  "function Run(n : Integer) : Integer { return Fib(n); }\n";
+
+static int32_t Fib(int32_t n)
+{
+  return n < 2 ? n : Fib(n - 1) + Fib(n - 2);
+}
+
+// Nested loops, continue, break, modulo and a goto
+static const char* const LoopsSource =
+  "function Run(n : Integer) : Integer\n"
+  "{\n"
+  "  var total : Integer = 0;\n"
+  "  for (var i : Integer = 0; i < n; ++i)\n"
+  "  {\n"
+  "    var j : Integer = 0;\n"
+  "    while (true)\n"
+  "    {\n"
+  "      if (j == n) { break; }\n"
+  "      ++j;\n"
+  "      if ((i + j) % 3 == 0) { continue; }\n"
+  "      total = total + i * j % 7;\n"
+  "    }\n"
+  "  }\n"
+  "  var k : Integer = n;\n"
+  "  label again;\n"
+  "  total = total * 31 + k;\n"
+  "  --k;\n"
+  "  if (k > 0) { goto again; }\n"
+  "  return total;\n"
+  "}\n";
+
+static int32_t Loops(int32_t n)
+{
+  uint32_t total = 0;
+  for (int32_t i = 0; i < n; ++i)
+  {
+    for (int32_t j = 1; j <= n; ++j)
+    {
+      if ((i + j) % 3 == 0)
+        continue;
+      total += (uint32_t)(i * j % 7);
+    }
+  }
+
+  for (int32_t k = n; k > 0; --k)
+    total = total * 31 + (uint32_t)k;
+  return (int32_t)total;
+}
+
+// Float arithmetic and casts (Newton's method for square roots, summed)
+static const char* const FloatSource =
+  "function Root(x : Float) : Float\n"
+  "{\n"
+  "  var guess : Float = x;\n"
+  "  for (var i : Integer = 0; i < 20; ++i) { guess = (guess + x / guess) * 0.5; }\n"
+  "  return guess;\n"
+  "}\n"
+  "function Run(n : Integer) : Integer\n"
+  "{\n"
+  "  var sum : Float = 0.0;\n"
+  "  for (var i : Integer = 1; i <= n; ++i) { sum = sum + Root(i as Float); }\n"
+  "  return sum as Integer;\n"
+  "}\n";
+
+static int32_t Roots(int32_t n)
+{
+  float sum = 0.0f;
+  for (int32_t i = 1; i <= n; ++i)
+  {
+    float x = (float)i;
+    float guess = x;
+    for (int j = 0; j < 20; ++j)
+      guess = (guess + x / guess) * 0.5f;
+    sum = sum + guess;
+  }
+  return (int32_t)sum;
+}
+
+// Classes, member access through pointers and a linked list walked over and over
+static const char* const ListSource =
+  "class Node\n"
+  "{\n"
+  "  var Value : Integer;\n"
+  "  var Next : Node*;\n"
+  "}\n"
+  "function Sum(first : Node*) : Integer\n"
+  "{\n"
+  "  var total : Integer = 0;\n"
+  "  var node : Node* = first;\n"
+  "  while (node) { total = total + node->Value; node = node->Next; }\n"
+  "  return total;\n"
+  "}\n"
+  "function Run(n : Integer) : Integer\n"
+  "{\n"
+  "  var a : Node; var b : Node; var c : Node; var d : Node;\n"
+  "  var none : Node* = null;\n"
+  "  a.Next = &b; b.Next = &c; c.Next = &d; d.Next = none;\n"
+  "  var total : Integer = 0;\n"
+  "  for (var i : Integer = 0; i < n; ++i)\n"
+  "  {\n"
+  "    a.Value = i; b.Value = i * 2; c.Value = i * 3; d.Value = i * 4;\n"
+  "    total = total + Sum(&a);\n"
+  "  }\n"
+  "  return total;\n"
+  "}\n";
+
+static int32_t List(int32_t n)
+{
+  uint32_t total = 0;
+  for (int32_t i = 0; i < n; ++i)
+    total += (uint32_t)(i * 10);
+  return (int32_t)total;
+}
+
+// Many calls to small functions that take and return a few values
+static const char* const CallsSource =
+  "function Max(a : Integer, b : Integer) : Integer { if (a > b) { return a; } return b; }\n"
+  "function Clamp(x : Integer, low : Integer, high : Integer) : Integer { return Max(low, 0 - Max(0 - x, 0 - high)); }\n"
+  "function Run(n : Integer) : Integer\n"
+  "{\n"
+  "  var total : Integer = 0;\n"
+  "  for (var i : Integer = 0; i < n; ++i) { total = total + Clamp(i % 100, 10, 90); }\n"
+  "  return total;\n"
+  "}\n";
+
+static int32_t Calls(int32_t n)
+{
+  uint32_t total = 0;
+  for (int32_t i = 0; i < n; ++i)
+  {
+    int32_t x = i % 100;
+    total += (uint32_t)(x < 10 ? 10 : x > 90 ? 90 : x);
+  }
+  return (int32_t)total;
+}
+
+// Reading and writing the members of classes held by value, some nested in others
+static const char* const FieldsSource =
+  "class Point { var X : Integer; var Y : Integer; }\n"
+  "class Box { var Min : Point; var Max : Point; var Hits : Integer; }\n"
+  "function Run(n : Integer) : Integer\n"
+  "{\n"
+  "  var box : Box;\n"
+  "  box.Min.X = 0; box.Min.Y = 0; box.Max.X = 50; box.Max.Y = 30; box.Hits = 0;\n"
+  "  var p : Point;\n"
+  "  for (var i : Integer = 0; i < n; ++i)\n"
+  "  {\n"
+  "    p.X = i % 64; p.Y = i % 37;\n"
+  "    if (p.X >= box.Min.X && p.X <= box.Max.X && p.Y >= box.Min.Y && p.Y <= box.Max.Y) { box.Hits = box.Hits + 1; }\n"
+  "  }\n"
+  "  return box.Hits;\n"
+  "}\n";
+
+static int32_t Fields(int32_t n)
+{
+  int32_t hits = 0;
+  for (int32_t i = 0; i < n; ++i)
+  {
+    if (i % 64 <= 50 && i % 37 <= 30)
+      ++hits;
+  }
+  return hits;
+}
+
+// String literals, indexing and Byte comparisons (counts the vowels in a sentence over and over)
+static const char* const StringsSource =
+  "function Vowels(text : Byte*) : Integer\n"
+  "{\n"
+  "  var count : Integer = 0;\n"
+  "  var i : Integer = 0;\n"
+  "  while (text[i] as Integer != 0)\n"
+  "  {\n"
+  "    var c : Byte = text[i];\n"
+  "    if (c == 'a' || c == 'e' || c == 'i' || c == 'o' || c == 'u') { ++count; }\n"
+  "    ++i;\n"
+  "  }\n"
+  "  return count;\n"
+  "}\n"
+  "function Run(n : Integer) : Integer\n"
+  "{\n"
+  "  var total : Integer = 0;\n"
+  "  for (var i : Integer = 0; i < n; ++i) { total = total + Vowels(\"the quick brown fox jumps over the lazy dog\"); }\n"
+  "  return total;\n"
+  "}\n";
+
+static int32_t Strings(int32_t n)
+{
+  // "the quick brown fox jumps over the lazy dog" has 11 vowels
+  return n * 11;
+}
+
+static void Lex(const std::string& source, std::vector<Token>& tokens)
+{
+  DfaState* root = CreateLanguageDfa();
+  const char* stream = source.c_str();
+  while (*stream != '\0')
+  {
+    Token token;
+    ReadLanguageToken(root, stream, token);
+    if (token.mLength == 0)
+    {
+      ++stream;
+      continue;
+    }
+
+    tokens.push_back(token);
+    stream += token.mLength;
+  }
+
+  DeleteStateAndChildren(root);
+  RemoveWhitespaceAndComments(tokens);
+}
+
+int main(int argc, char* argv[])
+{
+  typedef std::chrono::steady_clock Clock;
+
+  struct BenchmarkProgram
+  {
+    const char* mName;
+    const char* mSource;
+    int32_t (*mNative)(int32_t);
+    // The argument Run is called with, and how many times
+    int32_t mArgument;
+    size_t mRuns;
+  };
+
+  const BenchmarkProgram programs[] =
+  {
+    { "fib",     FibSource,     Fib,     20,    10 },
+    { "loops",   LoopsSource,   Loops,   200,   10 },
+    { "float",   FloatSource,   Roots,   2000,  10 },
+    { "list",    ListSource,    List,    5000,  10 },
+    { "strings", StringsSource, Strings, 500,   10 },
+    { "calls",   CallsSource,   Calls,   50000, 10 },
+    { "fields",  FieldsSource,  Fields,  50000, 10 }
+  };
+
+  Library* core = InitializeCoreLibrary();
+  fprintf(stderr, "%-8s %9s %12s %12s %12s %12s %8s\n", "Program", "Argument", "Result", "Interpreter", "Bytecode", "Native", "Speedup");
+
+  for (size_t i = 0; i < DriverArraySize(programs); ++i)
+  {
+    const BenchmarkProgram& program = programs[i];
+    std::vector<Token> tokens;
+    Lex(program.mSource, tokens);
+
+    // The trace is only for the driver tests, so it's turned off for the parse and then put back
+    bool tracing = IsParseTracing();
+    SetParseTracing(false);
+    AstPtr<BlockNode> block = TryParseBlock(tokens);
+    SetParseTracing(tracing);
+    if (block == nullptr)
+    {
+      fprintf(stderr, "%s failed to parse\n", program.mName);
+      return 1;
+    }
+
+    std::vector<Library*> dependencies;
+    dependencies.push_back(core);
+    Library library;
+    try
+    {
+      SemanticAnalyize(block.get(), dependencies, &library);
+    }
+    catch (SemanticException& e)
+    {
+      fprintf(stderr, "%s failed analysis: %s\n", program.mName, e.what());
+      return 1;
+    }
+
+    Interpreter interpreter;
+    interpreter.Load(block.get());
+    VirtualMachine bytecode;
+    bytecode.SetTierUpThreshold(0);
+    bytecode.Load(block.get());
+    VirtualMachine native;
+    native.Load(block.get());
+
+    std::vector<RuntimeValue> arguments;
+    arguments.push_back(RuntimeValue::MakeInteger(program.mArgument));
+    int32_t expected = program.mNative(program.mArgument);
+
+    // Microseconds per call, in the Interpreter, then bytecode, then machine code
+    double microseconds[3] = { 0.0, 0.0, 0.0 };
+    for (size_t engine = 0; engine < 3; ++engine)
+    {
+      double seconds = 0.0;
+      for (size_t r = 0; r < program.mRuns; ++r)
+      {
+        RuntimeValue result;
+        Clock::time_point start = Clock::now();
+        try
+        {
+          if (engine == 0)
+            result = interpreter.Call(interpreter.FindFunction("Run"), arguments);
+          else if (engine == 1)
+            result = bytecode.Call(bytecode.FindFunction("Run"), arguments);
+          else
+            result = native.Call(native.FindFunction("Run"), arguments);
+        }
+        catch (ExecutionException& e)
+        {
+          fprintf(stderr, "%s failed to run: %s\n", program.mName, e.what());
+          return 1;
+        }
+        seconds += std::chrono::duration<double>(Clock::now() - start).count();
+
+        if (result.mType != IntegerType || result.mInteger != expected)
+        {
+          fprintf(stderr, "%s returned %d instead of %d\n", program.mName, result.mInteger, expected);
+          return 1;
+        }
+      }
+      microseconds[engine] = seconds * 1000000.0 / program.mRuns;
+    }
+
+    // The speedup is of machine code over the Interpreter
+    fprintf(stderr, "%-8s %9d %12d %12.1f %12.1f %12.1f %7.1fx\n", program.mName, program.mArgument, expected,
+      microseconds[0], microseconds[1], microseconds[2], microseconds[0] / microseconds[2]);
+  }
+
+  return 0;
+}
+#endif
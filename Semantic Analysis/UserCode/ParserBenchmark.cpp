@@ -0,0 +1,404 @@
+/******************************************************************\
+ * Copyright 2015, DigiPen Institute of Technology
+\******************************************************************/
+// Measures ParseBlock by itself (no lexing, token printing or tree printing)
+// Build it together with the Drivers and the other UserCode files with PARSER_BENCHMARK defined and run:
+//   ParserBenchmark > NUL
+// Results go to stderr; stdout only receives the PrintRule trace of the tracing runs.
+// Synthetic programs from tiny to very large are lexed once up front and then parsed over and over,
+// once with the trace on and once with it off. For each we report tokens/s, AST nodes/s,
+// bytes allocated per node and the peak heap used while parsing.
+// A second table compares two passes run on the parsed tree against the same passes run on its FlatAst:
+// counting the nodes of each kind (a bare walk) and PrintTree (whose text goes to stdout).
+
+#include "../Drivers/Driver3.hpp"
+#include "../Drivers/FlatAst.hpp"
+
+#if PARSER_BENCHMARK
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+#pragma region HeapCounting
+namespace
+{
+  // Heap usage of the whole program, kept by the replacement operator new / delete below
+  size_t LiveBytes = 0;
+  size_t PeakBytes = 0;
+  size_t AllocatedBytes = 0;
+
+  // Every block starts with its size, padded so the memory we hand out stays aligned
+  const size_t HeaderSize = alignof(std::max_align_t);
+}
+
+void* operator new(size_t size)
+{
+  char* block = static_cast<char*>(malloc(size + HeaderSize));
+  if (block == nullptr)
+    throw std::bad_alloc();
+
+  *reinterpret_cast<size_t*>(block) = size;
+  LiveBytes += size;
+  AllocatedBytes += size;
+  if (LiveBytes > PeakBytes)
+    PeakBytes = LiveBytes;
+
+  return block + HeaderSize;
+}
+
+void operator delete(void* memory) noexcept
+{
+  if (memory == nullptr)
+    return;
+
+  char* block = static_cast<char*>(memory) - HeaderSize;
+  LiveBytes -= *reinterpret_cast<size_t*>(block);
+  free(block);
+}
+
+void* operator new[](size_t size)
+{
+  return operator new(size);
+}
+
+void operator delete[](void* memory) noexcept
+{
+  operator delete(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+  operator delete(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept
+{
+  operator delete(memory);
+}
+#pragma endregion
+
+#pragma region NodeCounting
+// The same Visitor that User3.cpp walks the tree with
+enum VisitResult
+{
+  Continue,
+  Stop
+};
+
+class Visitor
+{
+public:
+  virtual VisitResult Visit(AbstractNode*   node)     { return Continue;                               }
+  virtual VisitResult Visit(BlockNode* node)          { return this->Visit((AbstractNode*)node);       }
+  virtual VisitResult Visit(StatementNode*  node)     { return this->Visit((AbstractNode*)node);       }
+  virtual VisitResult Visit(ExpressionNode* node)     { return this->Visit((StatementNode*)node);      }
+  //virtual VisitResult Visit(LiteralNode*    node)   { return this->Visit((ExpressionNode*)node);     }
+  virtual VisitResult Visit(UnaryOperatorNode* node)  { return this->Visit((ExpressionNode*)node);     }
+  virtual VisitResult Visit(BinaryOperatorNode* node) { return this->Visit((ExpressionNode*)node);     }
+  virtual VisitResult Visit(PostExpressionNode* node) { return this->Visit((ExpressionNode*)node);     }
+  virtual VisitResult Visit(MemberAccessNode*   node) { return this->Visit((PostExpressionNode*)node); }
+  virtual VisitResult Visit(ClassNode*      node)     { return this->Visit((AbstractNode*)node);       }
+  //virtual VisitResult Visit(MemberNode*     node)   { return this->Visit((AbstractNode*)node);       }
+  virtual VisitResult Visit(VariableNode*   node)     { return this->Visit((StatementNode*)node);      }
+  virtual VisitResult Visit(TypeNode*       node)     { return this->Visit((AbstractNode*)node);       }
+  //virtual VisitResult Visit(NamedReference* node)   { return this->Visit((ExpressionNode*)node);     }
+  virtual VisitResult Visit(ValueNode* node)          { return this->Visit((ExpressionNode*)node);     }
+  virtual VisitResult Visit(FunctionNode*   node)     { return this->Visit((AbstractNode*)node);       }
+  virtual VisitResult Visit(ParameterNode*  node)     { return this->Visit((AbstractNode*)node);       }
+  virtual VisitResult Visit(LabelNode* node)          { return this->Visit((StatementNode*)node);      }
+  virtual VisitResult Visit(GotoNode* node)           { return this->Visit((StatementNode*)node);      }
+  virtual VisitResult Visit(CallNode* node)           { return this->Visit((PostExpressionNode*)node); }
+  virtual VisitResult Visit(CastNode* node)           { return this->Visit((PostExpressionNode*)node); }
+  virtual VisitResult Visit(IndexNode* node)          { return this->Visit((PostExpressionNode*)node); }
+  virtual VisitResult Visit(ForNode* node)            { return this->Visit((StatementNode*)node);      }
+  virtual VisitResult Visit(WhileNode* node)          { return this->Visit((StatementNode*)node);      }
+  virtual VisitResult Visit(ScopeNode* node)          { return this->Visit((StatementNode*)node);      }
+  virtual VisitResult Visit(IfNode* node)             { return this->Visit((StatementNode*)node);      }
+  virtual VisitResult Visit(BreakNode* node)          { return this->Visit((StatementNode*)node);      }
+  virtual VisitResult Visit(ContinueNode* node)       { return this->Visit((StatementNode*)node);      }
+  virtual VisitResult Visit(ReturnNode* node)         { return this->Visit((StatementNode*)node);      }
+  virtual VisitResult Visit(ErrorNode* node)          { return this->Visit((StatementNode*)node);      }
+};
+
+class NodeCountVisitor : public Visitor
+{
+public:
+  NodeCountVisitor() :
+    mCount(0)
+  {
+  }
+
+  VisitResult Visit(AbstractNode* node) override
+  {
+    ++mCount;
+    return Continue;
+  }
+
+  size_t mCount;
+};
+
+// Counts the nodes of each kind, walking the tree
+// Walk visits parameters and postfix expressions a second time (as their base type) straight after the first,
+// so a repeated visit is skipped to count every node once
+class KindCountVisitor : public Visitor
+{
+public:
+  KindCountVisitor() :
+    mCounts(),
+    mLast(nullptr)
+  {
+  }
+
+  VisitResult Visit(AbstractNode* node) override
+  {
+    if (node != mLast)
+      ++mCounts[node->mKind];
+    mLast = node;
+    return Continue;
+  }
+
+  size_t mCounts[NodeKind::Count];
+  AbstractNode* mLast;
+};
+
+// Counts the nodes of each kind, reading the flat form front to back
+static void CountKinds(const FlatAst& flat, size_t (&counts)[NodeKind::Count])
+{
+  for (size_t i = 0; i < flat.mNodes.size(); ++i)
+    ++counts[flat.mNodes[i].mKind];
+}
+#pragma endregion
+
+// One class followed by 'functions' copies of a function that uses every kind of statement and most operators
+static std::string MakeProgram(size_t functions)
+{
+  std::string source =
+    "class Player\n"
+    "{\n"
+    "  var Health : Integer = 100;\n"
+    "  var Name : Byte*;\n"
+    "  function TakeDamage(amount : Integer) : Boolean\n"
+    "  {\n"
+    "    Health -= amount;\n"
+    "    return Health <= 0;\n"
+    "  }\n"
+    "}\n";
+
+  for (size_t i = 0; i < functions; ++i)
+  {
+    source += "function Update" + std::to_string(i) + "(player : Player*, delta : Float) : Integer\n";
+    source +=
+      "{\n"
+      "  var total : Integer = 0;\n"
+      "  for (var i : Integer = 0; i < 10; ++i)\n"
+      "  {\n"
+      "    total += (i * 3 + 7) % 5 - -i;\n"
+      "    if (total > 100 && !player->TakeDamage(total as Integer)) { break; }\n"
+      "    else if (total == 42) { continue; }\n"
+      "    else { total = total / 2; }\n"
+      "  }\n"
+      "  while (player->Health > 0 || delta < 1.0) { player->Health -= 1; delta = delta * 2.0; }\n"
+      "  var name : Byte* = \"player\";\n"
+      "  label done;\n"
+      "  goto done;\n"
+      "  return total + name[0] as Integer;\n"
+      "}\n";
+  }
+
+  return source;
+}
+
+static void Lex(const std::string& source, std::vector<Token>& tokens)
+{
+  DfaState* root = CreateLanguageDfa();
+  const char* stream = source.c_str();
+  while (*stream != '\0')
+  {
+    Token token;
+    ReadLanguageToken(root, stream, token);
+    if (token.mLength == 0)
+    {
+      ++stream;
+      continue;
+    }
+
+    tokens.push_back(token);
+    stream += token.mLength;
+  }
+
+  DeleteStateAndChildren(root);
+  RemoveWhitespaceAndComments(tokens);
+}
+
+struct ParseMeasurement
+{
+  double mSecondsPerParse;
+  size_t mNodes;
+  size_t mBytes;
+  size_t mPeakBytes;
+};
+
+static bool Measure(std::vector<Token>& tokens, bool tracing, ParseMeasurement& measurement)
+{
+  typedef std::chrono::steady_clock Clock;
+  SetParseTracing(tracing);
+
+  // One parse on its own to see what it allocates
+  size_t liveBefore = LiveBytes;
+  size_t allocatedBefore = AllocatedBytes;
+  PeakBytes = LiveBytes;
+  {
+    std::string error;
+    AstPtr<BlockNode> block = TryParseBlock(tokens, &error);
+    if (block == nullptr)
+    {
+      fprintf(stderr, "The benchmark program failed to parse: %s\n", error.c_str());
+      return false;
+    }
+
+    measurement.mBytes = AllocatedBytes - allocatedBefore;
+    measurement.mPeakBytes = PeakBytes - liveBefore;
+
+    NodeCountVisitor counter;
+    block->Walk(&counter);
+    measurement.mNodes = counter.mCount;
+  }
+
+  // Then as many parses as fit in a quarter of a second (at least one)
+  size_t parses = 0;
+  Clock::time_point start = Clock::now();
+  Clock::duration elapsed;
+  do
+  {
+    TryParseBlock(tokens);
+    ++parses;
+    elapsed = Clock::now() - start;
+  } while (elapsed < std::chrono::milliseconds(250));
+
+  measurement.mSecondsPerParse = std::chrono::duration<double>(elapsed).count() / parses;
+  return true;
+}
+
+// Runs a pass as many times as fit in a quarter of a second (at least once) and returns the seconds per run
+template <typename Pass>
+static double TimePass(Pass pass)
+{
+  typedef std::chrono::steady_clock Clock;
+
+  size_t runs = 0;
+  Clock::time_point start = Clock::now();
+  Clock::duration elapsed;
+  do
+  {
+    pass();
+    ++runs;
+    elapsed = Clock::now() - start;
+  } while (elapsed < std::chrono::milliseconds(250));
+
+  return std::chrono::duration<double>(elapsed).count() / runs;
+}
+
+// Times the passes on the tree and on its flat form, which must agree on what they count
+static bool MeasurePasses(const char* name, std::vector<Token>& tokens)
+{
+  SetParseTracing(false);
+  AstPtr<BlockNode> block = TryParseBlock(tokens);
+  FlatAst flat;
+  Flatten(block.get(), flat);
+
+  KindCountVisitor treeCounter;
+  block->Walk(&treeCounter);
+  size_t flatCounts[NodeKind::Count] = {};
+  CountKinds(flat, flatCounts);
+  for (size_t i = 0; i < NodeKind::Count; ++i)
+  {
+    if (treeCounter.mCounts[i] != flatCounts[i])
+    {
+      fprintf(stderr, "The flat form of the %s program has different nodes than its tree\n", name);
+      return false;
+    }
+  }
+
+  // The counts are kept so that the compiler can't skip the loops
+  volatile size_t kept = 0;
+  double walkTree = TimePass([&]() { KindCountVisitor counter; block->Walk(&counter); kept += counter.mCounts[NodeKind::Value]; });
+  double walkFlat = TimePass([&]() { size_t counts[NodeKind::Count] = {}; CountKinds(flat, counts); kept += counts[NodeKind::Value]; });
+  double printTree = TimePass([&]() { PrintTree(block.get()); });
+  double printFlat = TimePass([&]() { PrintTree(flat); });
+
+  fprintf(stderr, "%-8s %9d %12.3f %12.3f %12.3f %12.3f\n",
+    name, (int)flat.mNodes.size(), walkTree * 1000, walkFlat * 1000, printTree * 1000, printFlat * 1000);
+  return true;
+}
+
+int main(int argc, char* argv[])
+{
+  struct BenchmarkProgram
+  {
+    const char* mName;
+    size_t mFunctions;
+    // The trace copies each rule's text into its parent, so it is too slow to be worth running on the largest input
+    bool mTrace;
+  };
+
+  const BenchmarkProgram programs[] =
+  {
+    { "tiny",   0,     true  },
+    { "small",  10,    true  },
+    { "medium", 100,   true  },
+    { "large",  1000,  true  },
+    { "huge",   10000, false }
+  };
+
+  fprintf(stderr, "%-8s %9s %9s %-6s %12s %12s %11s %10s\n",
+    "Program", "Tokens", "Nodes", "Trace", "Tokens/s", "Nodes/s", "Bytes/node", "Peak KB");
+
+  for (size_t i = 0; i < DriverArraySize(programs); ++i)
+  {
+    const BenchmarkProgram& program = programs[i];
+    std::string source = MakeProgram(program.mFunctions);
+    std::vector<Token> tokens;
+    Lex(source, tokens);
+
+    for (int trace = 0; trace < 2; ++trace)
+    {
+      if (trace && !program.mTrace)
+      {
+        fprintf(stderr, "%-8s %9d %9s %-6s (skipped)\n", program.mName, (int)tokens.size(), "", "on");
+        continue;
+      }
+
+      ParseMeasurement measurement;
+      if (!Measure(tokens, trace != 0, measurement))
+        return 1;
+
+      fprintf(stderr, "%-8s %9d %9d %-6s %12.0f %12.0f %11.1f %10d\n",
+        program.mName,
+        (int)tokens.size(),
+        (int)measurement.mNodes,
+        trace ? "on" : "off",
+        tokens.size() / measurement.mSecondsPerParse,
+        measurement.mNodes / measurement.mSecondsPerParse,
+        (double)measurement.mBytes / measurement.mNodes,
+        (int)(measurement.mPeakBytes / 1024));
+    }
+  }
+
+  fprintf(stderr, "\n%-8s %9s %12s %12s %12s %12s\n",
+    "Program", "Nodes", "Walk tree ms", "Walk flat ms", "Print tree ms", "Print flat ms");
+
+  for (size_t i = 0; i < DriverArraySize(programs); ++i)
+  {
+    std::vector<Token> tokens;
+    Lex(MakeProgram(programs[i].mFunctions), tokens);
+    if (!MeasurePasses(programs[i].mName, tokens))
+      return 1;
+  }
+
+  SetParseTracing(true);
+  return 0;
+}
+#endif
@@ -0,0 +1,538 @@
+/******************************************************************\
+ * Copyright 2015, DigiPen Institute of Technology
+\******************************************************************/
+// Offline tool that turns the EBNF in 'Drivers/Grammar.txt' into the LL(1) tables used by 'Recognize'
+// Build it on its own with PARSER_GENERATOR defined and run:
+//   ParserGenerator ../Drivers/Grammar.txt RecognizerTable.inl
+// Every named rule keeps its name (so the recognizer can print it), while groups, '*' and '?' are
+// expanded into unnamed helper rules. The tool fails if the grammar stops being LL(1).
+// Besides the table it writes each rule's nullable production, which the recognizer falls back to the way a
+// recursive descent parser skips an optional part when the next token can't start it.
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+  // Grammar symbols are terminals (token names) or indices into the rule list
+  struct GrammarSymbol
+  {
+    bool mTerminal;
+    int mRule;
+    std::string mTerminalName;
+  };
+
+  typedef std::vector<GrammarSymbol> Sequence;
+
+  struct GrammarRule
+  {
+    std::string mName;
+    // Helper rules created from groups / repetition are not printed by the recognizer
+    bool mNamed;
+    std::vector<Sequence> mAlternatives;
+  };
+
+  // The end of the token stream is treated as one more terminal
+  const char* const EndOfInput = "$";
+
+  class Grammar
+  {
+  public:
+    bool Load(const char* path);
+    bool BuildTable();
+    bool Emit(const char* path, const char* grammarPath);
+
+  private:
+    // EBNF parsing (one rule per line)
+    int FindOrAddRule(const std::string& name, bool named);
+    bool ParseLine(const std::string& line, size_t lineNumber);
+    bool ParseAlternatives(int rule);
+    bool ParseSequence(Sequence& sequence);
+    bool ParseItem(Sequence& sequence);
+    int AddHelperRule(int owner);
+    void SkipSpaces();
+    bool Fail(const std::string& message);
+
+    // FIRST / FOLLOW
+    std::set<std::string> FirstOf(const Sequence& sequence, size_t start, bool* nullable);
+
+    std::vector<GrammarRule> mRules;
+    std::map<std::string, int> mRulesByName;
+    std::vector<size_t> mHelperCounts;
+
+    std::vector<std::set<std::string>> mFirst;
+    std::vector<std::set<std::string>> mFollow;
+    std::vector<bool> mNullable;
+
+    // Flattened productions and the table (rule x terminal -> production index or -1)
+    std::vector<std::pair<int, const Sequence*>> mProductions;
+    std::vector<std::string> mTerminals;
+    std::vector<std::vector<int>> mTable;
+    // The nullable production of each rule (-1 if the rule can't match nothing)
+    std::vector<int> mEmptyProductions;
+
+    std::string mLine;
+    size_t mPosition;
+    size_t mLineNumber;
+    int mCurrentRule;
+  };
+
+  bool Grammar::Fail(const std::string& message)
+  {
+    std::cerr << "Grammar.txt(" << mLineNumber << "): " << message << std::endl;
+    return false;
+  }
+
+  int Grammar::FindOrAddRule(const std::string& name, bool named)
+  {
+    auto it = mRulesByName.find(name);
+    if (it != mRulesByName.end())
+      return it->second;
+
+    GrammarRule rule;
+    rule.mName = name;
+    rule.mNamed = named;
+    mRules.push_back(rule);
+    mHelperCounts.push_back(0);
+    mRulesByName[name] = (int)mRules.size() - 1;
+    return (int)mRules.size() - 1;
+  }
+
+  int Grammar::AddHelperRule(int owner)
+  {
+    std::stringstream name;
+    name << mRules[owner].mName << "_" << ++mHelperCounts[owner];
+    return FindOrAddRule(name.str(), false);
+  }
+
+  void Grammar::SkipSpaces()
+  {
+    while (mPosition < mLine.size() && isspace((unsigned char)mLine[mPosition]))
+      ++mPosition;
+  }
+
+  bool Grammar::Load(const char* path)
+  {
+    std::ifstream file(path);
+    if (!file)
+    {
+      std::cerr << "Unable to open grammar '" << path << "'" << std::endl;
+      return false;
+    }
+
+    std::string line;
+    size_t lineNumber = 0;
+    while (std::getline(file, line))
+    {
+      ++lineNumber;
+      if (!ParseLine(line, lineNumber))
+        return false;
+    }
+
+    for (const GrammarRule& rule : mRules)
+    {
+      if (rule.mAlternatives.empty())
+      {
+        std::cerr << "Rule '" << rule.mName << "' is referenced but never defined" << std::endl;
+        return false;
+      }
+    }
+
+    return !mRules.empty();
+  }
+
+  bool Grammar::ParseLine(const std::string& line, size_t lineNumber)
+  {
+    mLine = line.substr(0, line.find("//"));
+    mPosition = 0;
+    mLineNumber = lineNumber;
+
+    SkipSpaces();
+    if (mPosition == mLine.size())
+      return true;
+
+    size_t start = mPosition;
+    while (mPosition < mLine.size() && (isalnum((unsigned char)mLine[mPosition]) || mLine[mPosition] == '_'))
+      ++mPosition;
+
+    std::string name = mLine.substr(start, mPosition - start);
+    SkipSpaces();
+    if (name.empty() || mPosition == mLine.size() || mLine[mPosition] != '=')
+      return Fail("expected 'Rule = ...'");
+    ++mPosition;
+
+    int rule = FindOrAddRule(name, true);
+    if (!mRules[rule].mAlternatives.empty())
+      return Fail("rule '" + name + "' is defined twice");
+    mCurrentRule = rule;
+
+    if (!ParseAlternatives(rule))
+      return false;
+
+    SkipSpaces();
+    if (mPosition != mLine.size())
+      return Fail("unexpected '" + mLine.substr(mPosition) + "'");
+    return true;
+  }
+
+  bool Grammar::ParseAlternatives(int rule)
+  {
+    for (;;)
+    {
+      Sequence sequence;
+      if (!ParseSequence(sequence))
+        return false;
+      mRules[rule].mAlternatives.push_back(sequence);
+
+      SkipSpaces();
+      if (mPosition == mLine.size() || mLine[mPosition] != '|')
+        return true;
+      ++mPosition;
+    }
+  }
+
+  bool Grammar::ParseSequence(Sequence& sequence)
+  {
+    for (;;)
+    {
+      SkipSpaces();
+      if (mPosition == mLine.size() || mLine[mPosition] == '|' || mLine[mPosition] == ')')
+        return true;
+
+      if (!ParseItem(sequence))
+        return false;
+    }
+  }
+
+  bool Grammar::ParseItem(Sequence& sequence)
+  {
+    // Helper rules are named after the rule being defined on this line
+    int owner = mCurrentRule;
+
+    GrammarSymbol symbol;
+    symbol.mTerminal = false;
+    symbol.mRule = -1;
+
+    char c = mLine[mPosition];
+    if (c == '<')
+    {
+      size_t end = mLine.find('>', mPosition);
+      if (end == std::string::npos)
+        return Fail("unterminated token name");
+
+      symbol.mTerminal = true;
+      symbol.mTerminalName = mLine.substr(mPosition + 1, end - mPosition - 1);
+      mPosition = end + 1;
+    }
+    else if (c == '(')
+    {
+      ++mPosition;
+      symbol.mRule = AddHelperRule(owner);
+      if (!ParseAlternatives(symbol.mRule))
+        return false;
+
+      SkipSpaces();
+      if (mPosition == mLine.size() || mLine[mPosition] != ')')
+        return Fail("missing ')'");
+      ++mPosition;
+    }
+    else if (isalpha((unsigned char)c))
+    {
+      size_t start = mPosition;
+      while (mPosition < mLine.size() && (isalnum((unsigned char)mLine[mPosition]) || mLine[mPosition] == '_'))
+        ++mPosition;
+      symbol.mRule = FindOrAddRule(mLine.substr(start, mPosition - start), true);
+    }
+    else
+    {
+      return Fail(std::string("unexpected character '") + c + "'");
+    }
+
+    // Postfix operators wrap the item in a helper rule:
+    //   X* -> Helper = X Helper | (empty)
+    //   X? -> Helper = X | (empty)
+    while (mPosition < mLine.size() && (mLine[mPosition] == '*' || mLine[mPosition] == '?' || mLine[mPosition] == '+'))
+    {
+      char op = mLine[mPosition++];
+      int helper = AddHelperRule(owner);
+
+      GrammarSymbol helperSymbol;
+      helperSymbol.mTerminal = false;
+      helperSymbol.mRule = helper;
+
+      Sequence repeat;
+      repeat.push_back(symbol);
+      if (op != '?')
+        repeat.push_back(helperSymbol);
+
+      mRules[helper].mAlternatives.push_back(repeat);
+      mRules[helper].mAlternatives.push_back(Sequence());
+
+      // X+ is X followed by X*
+      if (op == '+')
+        sequence.push_back(symbol);
+
+      symbol = helperSymbol;
+    }
+
+    sequence.push_back(symbol);
+    return true;
+  }
+
+  std::set<std::string> Grammar::FirstOf(const Sequence& sequence, size_t start, bool* nullable)
+  {
+    std::set<std::string> result;
+    for (size_t i = start; i < sequence.size(); ++i)
+    {
+      const GrammarSymbol& symbol = sequence[i];
+      if (symbol.mTerminal)
+      {
+        result.insert(symbol.mTerminalName);
+        *nullable = false;
+        return result;
+      }
+
+      result.insert(mFirst[symbol.mRule].begin(), mFirst[symbol.mRule].end());
+      if (!mNullable[symbol.mRule])
+      {
+        *nullable = false;
+        return result;
+      }
+    }
+
+    *nullable = true;
+    return result;
+  }
+
+  bool Grammar::BuildTable()
+  {
+    size_t ruleCount = mRules.size();
+    mFirst.assign(ruleCount, std::set<std::string>());
+    mFollow.assign(ruleCount, std::set<std::string>());
+    mNullable.assign(ruleCount, false);
+
+    // FIRST and nullable (iterate to a fixed point)
+    for (bool changed = true; changed;)
+    {
+      changed = false;
+      for (size_t r = 0; r < ruleCount; ++r)
+      {
+        for (const Sequence& alternative : mRules[r].mAlternatives)
+        {
+          bool nullable = false;
+          std::set<std::string> first = FirstOf(alternative, 0, &nullable);
+
+          size_t before = mFirst[r].size();
+          mFirst[r].insert(first.begin(), first.end());
+          changed |= before != mFirst[r].size();
+
+          if (nullable && !mNullable[r])
+            changed = mNullable[r] = true;
+        }
+      }
+    }
+
+    // FOLLOW (the first rule in the file is the start rule)
+    mFollow[0].insert(EndOfInput);
+    for (bool changed = true; changed;)
+    {
+      changed = false;
+      for (size_t r = 0; r < ruleCount; ++r)
+      {
+        for (const Sequence& alternative : mRules[r].mAlternatives)
+        {
+          for (size_t i = 0; i < alternative.size(); ++i)
+          {
+            if (alternative[i].mTerminal)
+              continue;
+
+            std::set<std::string>& follow = mFollow[alternative[i].mRule];
+            size_t before = follow.size();
+
+            bool nullable = false;
+            std::set<std::string> rest = FirstOf(alternative, i + 1, &nullable);
+            follow.insert(rest.begin(), rest.end());
+            if (nullable)
+              follow.insert(mFollow[r].begin(), mFollow[r].end());
+
+            changed |= before != follow.size();
+          }
+        }
+      }
+    }
+
+    // Every terminal that appears anywhere gets a column (plus the end of input)
+    std::set<std::string> terminals;
+    for (const GrammarRule& rule : mRules)
+      for (const Sequence& alternative : rule.mAlternatives)
+        for (const GrammarSymbol& symbol : alternative)
+          if (symbol.mTerminal)
+            terminals.insert(symbol.mTerminalName);
+
+    mTerminals.assign(terminals.begin(), terminals.end());
+    mTerminals.push_back(EndOfInput);
+
+    std::map<std::string, size_t> columns;
+    for (size_t i = 0; i < mTerminals.size(); ++i)
+      columns[mTerminals[i]] = i;
+
+    mTable.assign(ruleCount, std::vector<int>(mTerminals.size(), -1));
+    mEmptyProductions.assign(ruleCount, -1);
+
+    for (size_t r = 0; r < ruleCount; ++r)
+      for (const Sequence& alternative : mRules[r].mAlternatives)
+        mProductions.push_back(std::make_pair((int)r, &alternative));
+
+    // Entries predicted by FIRST are placed before entries predicted by FOLLOW, so when an
+    // optional/repeated item could also end the rule we stay greedy (the same choice the
+    // hand written parser makes, eg: 'a as Integer * b' reads the '*' as part of the type)
+    bool success = true;
+    for (int pass = 0; pass < 2; ++pass)
+    {
+      for (size_t p = 0; p < mProductions.size(); ++p)
+      {
+        int r = mProductions[p].first;
+        bool nullable = false;
+        std::set<std::string> predict = FirstOf(*mProductions[p].second, 0, &nullable);
+        if (pass == 1)
+        {
+          if (!nullable)
+            continue;
+          if (mEmptyProductions[r] == -1)
+            mEmptyProductions[r] = (int)p;
+          predict = mFollow[r];
+        }
+
+        for (const std::string& terminal : predict)
+        {
+          int& cell = mTable[r][columns[terminal]];
+          if (cell == -1 || cell == (int)p)
+          {
+            cell = (int)p;
+          }
+          else if (pass == 1 && mProductions[cell].first == r && !mProductions[cell].second->empty())
+          {
+            std::cerr << "Note: rule '" << mRules[r].mName << "' prefers to continue on token '" << terminal << "'" << std::endl;
+          }
+          else
+          {
+            std::cerr << "LL(1) conflict in rule '" << mRules[r].mName << "' on token '" << terminal << "'" << std::endl;
+            success = false;
+          }
+        }
+      }
+    }
+
+    return success;
+  }
+
+  bool Grammar::Emit(const char* path, const char* grammarPath)
+  {
+    std::ofstream out(path);
+    if (!out)
+    {
+      std::cerr << "Unable to write '" << path << "'" << std::endl;
+      return false;
+    }
+
+    // Symbols inside a production: terminals are the TokenType value, rules are ~index
+    out << "// Generated by ParserGenerator.cpp from " << grammarPath << " (do not edit by hand)\n";
+    out << "// Regenerate whenever the grammar changes:\n";
+    out << "//   ParserGenerator " << grammarPath << " RecognizerTable.inl\n";
+    out << "// Production symbols are either a TokenType (>= 0) or the bitwise-not of a rule index (< 0)\n\n";
+
+    out << "namespace RecognizerTable\n{\n";
+    out << "  const int RuleCount = " << mRules.size() << ";\n";
+    out << "  const int ColumnCount = " << mTerminals.size() << ";\n";
+    out << "  const int EndOfInputColumn = " << mTerminals.size() - 1 << ";\n";
+    out << "  const int StartRule = 0;\n\n";
+
+    out << "  // Helper rules (from groups, '*' and '?') have no name and are not printed\n";
+    out << "  const char* const RuleNames[RuleCount] =\n  {\n";
+    for (const GrammarRule& rule : mRules)
+    {
+      if (rule.mNamed)
+        out << "    \"" << rule.mName << "\",\n";
+      else
+        out << "    nullptr, // " << rule.mName << "\n";
+    }
+    out << "  };\n\n";
+
+    out << "  // Maps a TokenType to its column in the table (-1 for tokens the grammar never uses)\n";
+    out << "  inline int GetColumn(int tokenType)\n  {\n    switch (tokenType)\n    {\n";
+    for (size_t i = 0; i + 1 < mTerminals.size(); ++i)
+      out << "      case TokenType::" << mTerminals[i] << ": return " << i << ";\n";
+    out << "      default: return -1;\n    }\n  }\n\n";
+
+    out << "  const int ProductionSymbols[] =\n  {\n";
+    std::vector<size_t> offsets;
+    size_t offset = 0;
+    for (auto& production : mProductions)
+    {
+      offsets.push_back(offset);
+      out << "    /* " << mRules[production.first].mName << " */";
+      for (const GrammarSymbol& symbol : *production.second)
+      {
+        if (symbol.mTerminal)
+          out << " TokenType::" << symbol.mTerminalName << ",";
+        else
+          out << " ~" << symbol.mRule << ",";
+        ++offset;
+      }
+      out << "\n";
+    }
+    out << "    0 // Sentinel (keeps the array non-empty)\n  };\n\n";
+
+    out << "  struct Production\n  {\n    unsigned short mFirstSymbol;\n    unsigned short mSymbolCount;\n  };\n\n";
+    out << "  const Production Productions[] =\n  {\n";
+    for (size_t i = 0; i < mProductions.size(); ++i)
+    {
+      out << "    { " << offsets[i] << ", " << mProductions[i].second->size() << " }, // "
+          << i << ": " << mRules[mProductions[i].first].mName << "\n";
+    }
+    out << "  };\n\n";
+
+    out << "  // Rule x column -> production index (-1 is a syntax error)\n";
+    out << "  const short Table[RuleCount][ColumnCount] =\n  {\n";
+    for (size_t r = 0; r < mRules.size(); ++r)
+    {
+      out << "    {";
+      for (size_t c = 0; c < mTerminals.size(); ++c)
+        out << (c ? "," : "") << mTable[r][c];
+      out << "}, // " << mRules[r].mName << "\n";
+    }
+    out << "  };\n\n";
+
+    out << "  // Rule -> the production that matches nothing (-1 if the rule can't)\n";
+    out << "  const short EmptyProductions[RuleCount] =\n  {\n";
+    for (size_t r = 0; r < mRules.size(); ++r)
+      out << "    " << mEmptyProductions[r] << ", // " << mRules[r].mName << "\n";
+    out << "  };\n}\n";
+
+    return true;
+  }
+}
+
+#if PARSER_GENERATOR
+int main(int argc, char* argv[])
+{
+  if (argc != 3)
+  {
+    std::cerr << "Usage: ParserGenerator <Grammar.txt> <RecognizerTable.inl>" << std::endl;
+    return 1;
+  }
+
+  Grammar grammar;
+  if (!grammar.Load(argv[1]) || !grammar.BuildTable() || !grammar.Emit(argv[2], argv[1]))
+    return 1;
+
+  return 0;
+}
+#endif
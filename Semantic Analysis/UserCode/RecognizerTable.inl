@@ -0,0 +1,637 @@
+// Generated by ParserGenerator.cpp from ../Drivers/Grammar.txt (do not edit by hand)
+// Regenerate whenever the grammar changes:
+//   ParserGenerator ../Drivers/Grammar.txt RecognizerTable.inl
+// Production symbols are either a TokenType (>= 0) or the bitwise-not of a rule index (< 0)
+
+namespace RecognizerTable
+{
+  const int RuleCount = 79;
+  const int ColumnCount = 56;
+  const int EndOfInputColumn = 55;
+  const int StartRule = 0;
+
+  // Helper rules (from groups, '*' and '?') have no name and are not printed
+  const char* const RuleNames[RuleCount] =
+  {
+    "Block",
+    nullptr, // Block_1
+    "Class",
+    "Function",
+    "Var",
+    nullptr, // Block_2
+    nullptr, // Class_1
+    nullptr, // Class_2
+    "SpecifiedType",
+    nullptr, // Var_1
+    "Expression",
+    nullptr, // Var_2
+    nullptr, // Function_1
+    "Parameter",
+    nullptr, // Function_2
+    nullptr, // Function_3
+    nullptr, // Function_4
+    nullptr, // Function_5
+    "Scope",
+    "Type",
+    nullptr, // Type_1
+    nullptr, // Scope_1
+    "Statement",
+    nullptr, // Scope_2
+    "FreeStatement",
+    "DelimitedStatement",
+    "Label",
+    "Goto",
+    "Return",
+    "If",
+    "While",
+    "For",
+    nullptr, // Return_1
+    nullptr, // Return_2
+    "GroupedExpression",
+    "Else",
+    nullptr, // If_1
+    nullptr, // Else_1
+    nullptr, // For_1
+    nullptr, // For_2
+    nullptr, // For_3
+    nullptr, // For_4
+    "Value",
+    "Expression1",
+    nullptr, // Expression_1
+    nullptr, // Expression_2
+    nullptr, // Expression_3
+    "Expression2",
+    nullptr, // Expression1_1
+    nullptr, // Expression1_2
+    "Expression3",
+    nullptr, // Expression2_1
+    nullptr, // Expression2_2
+    "Expression4",
+    nullptr, // Expression3_1
+    nullptr, // Expression3_2
+    nullptr, // Expression3_3
+    "Expression5",
+    nullptr, // Expression4_1
+    nullptr, // Expression4_2
+    nullptr, // Expression4_3
+    "Expression6",
+    nullptr, // Expression5_1
+    nullptr, // Expression5_2
+    nullptr, // Expression5_3
+    nullptr, // Expression6_1
+    nullptr, // Expression6_2
+    "Expression7",
+    nullptr, // Expression7_1
+    "MemberAccess",
+    "Call",
+    "Cast",
+    "Index",
+    nullptr, // Expression7_2
+    nullptr, // MemberAccess_1
+    nullptr, // Call_1
+    nullptr, // Call_2
+    nullptr, // Call_3
+    nullptr, // Call_4
+  };
+
+  // Maps a TokenType to its column in the table (-1 for tokens the grammar never uses)
+  inline int GetColumn(int tokenType)
+  {
+    switch (tokenType)
+    {
+      case TokenType::Arrow: return 0;
+      case TokenType::As: return 1;
+      case TokenType::Assignment: return 2;
+      case TokenType::AssignmentDivide: return 3;
+      case TokenType::AssignmentMinus: return 4;
+      case TokenType::AssignmentModulo: return 5;
+      case TokenType::AssignmentMultiply: return 6;
+      case TokenType::AssignmentPlus: return 7;
+      case TokenType::Asterisk: return 8;
+      case TokenType::BitwiseAndAddressOf: return 9;
+      case TokenType::Break: return 10;
+      case TokenType::CharacterLiteral: return 11;
+      case TokenType::Class: return 12;
+      case TokenType::CloseBracket: return 13;
+      case TokenType::CloseCurley: return 14;
+      case TokenType::CloseParentheses: return 15;
+      case TokenType::Colon: return 16;
+      case TokenType::Comma: return 17;
+      case TokenType::Continue: return 18;
+      case TokenType::Decrement: return 19;
+      case TokenType::Divide: return 20;
+      case TokenType::Dot: return 21;
+      case TokenType::Else: return 22;
+      case TokenType::Equality: return 23;
+      case TokenType::False: return 24;
+      case TokenType::FloatLiteral: return 25;
+      case TokenType::For: return 26;
+      case TokenType::Function: return 27;
+      case TokenType::Goto: return 28;
+      case TokenType::GreaterThan: return 29;
+      case TokenType::GreaterThanOrEqualTo: return 30;
+      case TokenType::Identifier: return 31;
+      case TokenType::If: return 32;
+      case TokenType::Increment: return 33;
+      case TokenType::Inequality: return 34;
+      case TokenType::IntegerLiteral: return 35;
+      case TokenType::Label: return 36;
+      case TokenType::LessThan: return 37;
+      case TokenType::LessThanOrEqualTo: return 38;
+      case TokenType::LogicalAnd: return 39;
+      case TokenType::LogicalNot: return 40;
+      case TokenType::LogicalOr: return 41;
+      case TokenType::Minus: return 42;
+      case TokenType::Modulo: return 43;
+      case TokenType::Null: return 44;
+      case TokenType::OpenBracket: return 45;
+      case TokenType::OpenCurley: return 46;
+      case TokenType::OpenParentheses: return 47;
+      case TokenType::Plus: return 48;
+      case TokenType::Return: return 49;
+      case TokenType::Semicolon: return 50;
+      case TokenType::StringLiteral: return 51;
+      case TokenType::True: return 52;
+      case TokenType::Var: return 53;
+      case TokenType::While: return 54;
+      default: return -1;
+    }
+  }
+
+  const int ProductionSymbols[] =
+  {
+    /* Block */ ~5,
+    /* Block_1 */ ~2,
+    /* Block_1 */ ~3,
+    /* Block_1 */ ~4, TokenType::Semicolon,
+    /* Class */ TokenType::Class, TokenType::Identifier, TokenType::OpenCurley, ~7, TokenType::CloseCurley,
+    /* Function */ TokenType::Function, TokenType::Identifier, TokenType::OpenParentheses, ~16, TokenType::CloseParentheses, ~17, ~18,
+    /* Var */ TokenType::Var, TokenType::Identifier, ~8, ~11,
+    /* Block_2 */ ~1, ~5,
+    /* Block_2 */
+    /* Class_1 */ ~4, TokenType::Semicolon,
+    /* Class_1 */ ~3,
+    /* Class_2 */ ~6, ~7,
+    /* Class_2 */
+    /* SpecifiedType */ TokenType::Colon, ~19,
+    /* Var_1 */ TokenType::Assignment, ~10,
+    /* Expression */ ~43, ~46,
+    /* Var_2 */ ~9,
+    /* Var_2 */
+    /* Function_1 */ ~13, ~15,
+    /* Parameter */ TokenType::Identifier, ~8,
+    /* Function_2 */ TokenType::Comma, ~13,
+    /* Function_3 */ ~14, ~15,
+    /* Function_3 */
+    /* Function_4 */ ~12,
+    /* Function_4 */
+    /* Function_5 */ ~8,
+    /* Function_5 */
+    /* Scope */ TokenType::OpenCurley, ~23, TokenType::CloseCurley,
+    /* Type */ TokenType::Identifier, ~20,
+    /* Type_1 */ TokenType::Asterisk, ~20,
+    /* Type_1 */
+    /* Scope_1 */ ~22,
+    /* Statement */ ~24,
+    /* Statement */ ~25, TokenType::Semicolon,
+    /* Scope_2 */ ~21, ~23,
+    /* Scope_2 */
+    /* FreeStatement */ ~29,
+    /* FreeStatement */ ~30,
+    /* FreeStatement */ ~31,
+    /* DelimitedStatement */ ~26,
+    /* DelimitedStatement */ ~27,
+    /* DelimitedStatement */ ~28,
+    /* DelimitedStatement */ TokenType::Break,
+    /* DelimitedStatement */ TokenType::Continue,
+    /* DelimitedStatement */ ~4,
+    /* DelimitedStatement */ ~10,
+    /* Label */ TokenType::Label, TokenType::Identifier,
+    /* Goto */ TokenType::Goto, TokenType::Identifier,
+    /* Return */ TokenType::Return, ~33,
+    /* If */ TokenType::If, ~34, ~18, ~36,
+    /* While */ TokenType::While, ~34, ~18,
+    /* For */ TokenType::For, TokenType::OpenParentheses, ~39, TokenType::Semicolon, ~40, TokenType::Semicolon, ~41, TokenType::CloseParentheses, ~18,
+    /* Return_1 */ ~10,
+    /* Return_2 */ ~32,
+    /* Return_2 */
+    /* GroupedExpression */ TokenType::OpenParentheses, ~10, TokenType::CloseParentheses,
+    /* Else */ TokenType::Else, ~37,
+    /* If_1 */ ~35,
+    /* If_1 */
+    /* Else_1 */ ~29,
+    /* Else_1 */ ~18,
+    /* For_1 */ ~4,
+    /* For_1 */ ~10,
+    /* For_2 */ ~38,
+    /* For_2 */
+    /* For_3 */ ~10,
+    /* For_3 */
+    /* For_4 */ ~10,
+    /* For_4 */
+    /* Value */ TokenType::True,
+    /* Value */ TokenType::False,
+    /* Value */ TokenType::Null,
+    /* Value */ TokenType::IntegerLiteral,
+    /* Value */ TokenType::FloatLiteral,
+    /* Value */ TokenType::StringLiteral,
+    /* Value */ TokenType::CharacterLiteral,
+    /* Value */ TokenType::Identifier,
+    /* Value */ ~34,
+    /* Expression1 */ ~47, ~49,
+    /* Expression_1 */ ~45, ~10,
+    /* Expression_2 */ TokenType::Assignment,
+    /* Expression_2 */ TokenType::AssignmentPlus,
+    /* Expression_2 */ TokenType::AssignmentMinus,
+    /* Expression_2 */ TokenType::AssignmentMultiply,
+    /* Expression_2 */ TokenType::AssignmentDivide,
+    /* Expression_2 */ TokenType::AssignmentModulo,
+    /* Expression_3 */ ~44,
+    /* Expression_3 */
+    /* Expression2 */ ~50, ~52,
+    /* Expression1_1 */ TokenType::LogicalOr, ~47,
+    /* Expression1_2 */ ~48, ~49,
+    /* Expression1_2 */
+    /* Expression3 */ ~53, ~56,
+    /* Expression2_1 */ TokenType::LogicalAnd, ~50,
+    /* Expression2_2 */ ~51, ~52,
+    /* Expression2_2 */
+    /* Expression4 */ ~57, ~60,
+    /* Expression3_1 */ ~55, ~53,
+    /* Expression3_2 */ TokenType::LessThan,
+    /* Expression3_2 */ TokenType::GreaterThan,
+    /* Expression3_2 */ TokenType::LessThanOrEqualTo,
+    /* Expression3_2 */ TokenType::GreaterThanOrEqualTo,
+    /* Expression3_2 */ TokenType::Equality,
+    /* Expression3_2 */ TokenType::Inequality,
+    /* Expression3_3 */ ~54, ~56,
+    /* Expression3_3 */
+    /* Expression5 */ ~61, ~64,
+    /* Expression4_1 */ ~59, ~57,
+    /* Expression4_2 */ TokenType::Plus,
+    /* Expression4_2 */ TokenType::Minus,
+    /* Expression4_3 */ ~58, ~60,
+    /* Expression4_3 */
+    /* Expression6 */ ~66, ~67,
+    /* Expression5_1 */ ~63, ~61,
+    /* Expression5_2 */ TokenType::Asterisk,
+    /* Expression5_2 */ TokenType::Divide,
+    /* Expression5_2 */ TokenType::Modulo,
+    /* Expression5_3 */ ~62, ~64,
+    /* Expression5_3 */
+    /* Expression6_1 */ TokenType::Asterisk,
+    /* Expression6_1 */ TokenType::BitwiseAndAddressOf,
+    /* Expression6_1 */ TokenType::Plus,
+    /* Expression6_1 */ TokenType::Minus,
+    /* Expression6_1 */ TokenType::LogicalNot,
+    /* Expression6_1 */ TokenType::Increment,
+    /* Expression6_1 */ TokenType::Decrement,
+    /* Expression6_2 */ ~65, ~66,
+    /* Expression6_2 */
+    /* Expression7 */ ~42, ~73,
+    /* Expression7_1 */ ~69,
+    /* Expression7_1 */ ~70,
+    /* Expression7_1 */ ~71,
+    /* Expression7_1 */ ~72,
+    /* MemberAccess */ ~74, TokenType::Identifier,
+    /* Call */ TokenType::OpenParentheses, ~78, TokenType::CloseParentheses,
+    /* Cast */ TokenType::As, ~19,
+    /* Index */ TokenType::OpenBracket, ~10, TokenType::CloseBracket,
+    /* Expression7_2 */ ~68, ~73,
+    /* Expression7_2 */
+    /* MemberAccess_1 */ TokenType::Dot,
+    /* MemberAccess_1 */ TokenType::Arrow,
+    /* Call_1 */ ~10, ~77,
+    /* Call_2 */ TokenType::Comma, ~10,
+    /* Call_3 */ ~76, ~77,
+    /* Call_3 */
+    /* Call_4 */ ~75,
+    /* Call_4 */
+    0 // Sentinel (keeps the array non-empty)
+  };
+
+  struct Production
+  {
+    unsigned short mFirstSymbol;
+    unsigned short mSymbolCount;
+  };
+
+  const Production Productions[] =
+  {
+    { 0, 1 }, // 0: Block
+    { 1, 1 }, // 1: Block_1
+    { 2, 1 }, // 2: Block_1
+    { 3, 2 }, // 3: Block_1
+    { 5, 5 }, // 4: Class
+    { 10, 7 }, // 5: Function
+    { 17, 4 }, // 6: Var
+    { 21, 2 }, // 7: Block_2
+    { 23, 0 }, // 8: Block_2
+    { 23, 2 }, // 9: Class_1
+    { 25, 1 }, // 10: Class_1
+    { 26, 2 }, // 11: Class_2
+    { 28, 0 }, // 12: Class_2
+    { 28, 2 }, // 13: SpecifiedType
+    { 30, 2 }, // 14: Var_1
+    { 32, 2 }, // 15: Expression
+    { 34, 1 }, // 16: Var_2
+    { 35, 0 }, // 17: Var_2
+    { 35, 2 }, // 18: Function_1
+    { 37, 2 }, // 19: Parameter
+    { 39, 2 }, // 20: Function_2
+    { 41, 2 }, // 21: Function_3
+    { 43, 0 }, // 22: Function_3
+    { 43, 1 }, // 23: Function_4
+    { 44, 0 }, // 24: Function_4
+    { 44, 1 }, // 25: Function_5
+    { 45, 0 }, // 26: Function_5
+    { 45, 3 }, // 27: Scope
+    { 48, 2 }, // 28: Type
+    { 50, 2 }, // 29: Type_1
+    { 52, 0 }, // 30: Type_1
+    { 52, 1 }, // 31: Scope_1
+    { 53, 1 }, // 32: Statement
+    { 54, 2 }, // 33: Statement
+    { 56, 2 }, // 34: Scope_2
+    { 58, 0 }, // 35: Scope_2
+    { 58, 1 }, // 36: FreeStatement
+    { 59, 1 }, // 37: FreeStatement
+    { 60, 1 }, // 38: FreeStatement
+    { 61, 1 }, // 39: DelimitedStatement
+    { 62, 1 }, // 40: DelimitedStatement
+    { 63, 1 }, // 41: DelimitedStatement
+    { 64, 1 }, // 42: DelimitedStatement
+    { 65, 1 }, // 43: DelimitedStatement
+    { 66, 1 }, // 44: DelimitedStatement
+    { 67, 1 }, // 45: DelimitedStatement
+    { 68, 2 }, // 46: Label
+    { 70, 2 }, // 47: Goto
+    { 72, 2 }, // 48: Return
+    { 74, 4 }, // 49: If
+    { 78, 3 }, // 50: While
+    { 81, 9 }, // 51: For
+    { 90, 1 }, // 52: Return_1
+    { 91, 1 }, // 53: Return_2
+    { 92, 0 }, // 54: Return_2
+    { 92, 3 }, // 55: GroupedExpression
+    { 95, 2 }, // 56: Else
+    { 97, 1 }, // 57: If_1
+    { 98, 0 }, // 58: If_1
+    { 98, 1 }, // 59: Else_1
+    { 99, 1 }, // 60: Else_1
+    { 100, 1 }, // 61: For_1
+    { 101, 1 }, // 62: For_1
+    { 102, 1 }, // 63: For_2
+    { 103, 0 }, // 64: For_2
+    { 103, 1 }, // 65: For_3
+    { 104, 0 }, // 66: For_3
+    { 104, 1 }, // 67: For_4
+    { 105, 0 }, // 68: For_4
+    { 105, 1 }, // 69: Value
+    { 106, 1 }, // 70: Value
+    { 107, 1 }, // 71: Value
+    { 108, 1 }, // 72: Value
+    { 109, 1 }, // 73: Value
+    { 110, 1 }, // 74: Value
+    { 111, 1 }, // 75: Value
+    { 112, 1 }, // 76: Value
+    { 113, 1 }, // 77: Value
+    { 114, 2 }, // 78: Expression1
+    { 116, 2 }, // 79: Expression_1
+    { 118, 1 }, // 80: Expression_2
+    { 119, 1 }, // 81: Expression_2
+    { 120, 1 }, // 82: Expression_2
+    { 121, 1 }, // 83: Expression_2
+    { 122, 1 }, // 84: Expression_2
+    { 123, 1 }, // 85: Expression_2
+    { 124, 1 }, // 86: Expression_3
+    { 125, 0 }, // 87: Expression_3
+    { 125, 2 }, // 88: Expression2
+    { 127, 2 }, // 89: Expression1_1
+    { 129, 2 }, // 90: Expression1_2
+    { 131, 0 }, // 91: Expression1_2
+    { 131, 2 }, // 92: Expression3
+    { 133, 2 }, // 93: Expression2_1
+    { 135, 2 }, // 94: Expression2_2
+    { 137, 0 }, // 95: Expression2_2
+    { 137, 2 }, // 96: Expression4
+    { 139, 2 }, // 97: Expression3_1
+    { 141, 1 }, // 98: Expression3_2
+    { 142, 1 }, // 99: Expression3_2
+    { 143, 1 }, // 100: Expression3_2
+    { 144, 1 }, // 101: Expression3_2
+    { 145, 1 }, // 102: Expression3_2
+    { 146, 1 }, // 103: Expression3_2
+    { 147, 2 }, // 104: Expression3_3
+    { 149, 0 }, // 105: Expression3_3
+    { 149, 2 }, // 106: Expression5
+    { 151, 2 }, // 107: Expression4_1
+    { 153, 1 }, // 108: Expression4_2
+    { 154, 1 }, // 109: Expression4_2
+    { 155, 2 }, // 110: Expression4_3
+    { 157, 0 }, // 111: Expression4_3
+    { 157, 2 }, // 112: Expression6
+    { 159, 2 }, // 113: Expression5_1
+    { 161, 1 }, // 114: Expression5_2
+    { 162, 1 }, // 115: Expression5_2
+    { 163, 1 }, // 116: Expression5_2
+    { 164, 2 }, // 117: Expression5_3
+    { 166, 0 }, // 118: Expression5_3
+    { 166, 1 }, // 119: Expression6_1
+    { 167, 1 }, // 120: Expression6_1
+    { 168, 1 }, // 121: Expression6_1
+    { 169, 1 }, // 122: Expression6_1
+    { 170, 1 }, // 123: Expression6_1
+    { 171, 1 }, // 124: Expression6_1
+    { 172, 1 }, // 125: Expression6_1
+    { 173, 2 }, // 126: Expression6_2
+    { 175, 0 }, // 127: Expression6_2
+    { 175, 2 }, // 128: Expression7
+    { 177, 1 }, // 129: Expression7_1
+    { 178, 1 }, // 130: Expression7_1
+    { 179, 1 }, // 131: Expression7_1
+    { 180, 1 }, // 132: Expression7_1
+    { 181, 2 }, // 133: MemberAccess
+    { 183, 3 }, // 134: Call
+    { 186, 2 }, // 135: Cast
+    { 188, 3 }, // 136: Index
+    { 191, 2 }, // 137: Expression7_2
+    { 193, 0 }, // 138: Expression7_2
+    { 193, 1 }, // 139: MemberAccess_1
+    { 194, 1 }, // 140: MemberAccess_1
+    { 195, 2 }, // 141: Call_1
+    { 197, 2 }, // 142: Call_2
+    { 199, 2 }, // 143: Call_3
+    { 201, 0 }, // 144: Call_3
+    { 201, 1 }, // 145: Call_4
+    { 202, 0 }, // 146: Call_4
+  };
+
+  // Rule x column -> production index (-1 is a syntax error)
+  const short Table[RuleCount][ColumnCount] =
+  {
+    {-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,0,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,0,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,0,-1,0}, // Block
+    {-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,2,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,3,-1,-1}, // Block_1
+    {-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,4,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1}, // Class
+    {-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,5,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1}, // Function
+    {-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,6,-1,-1}, // Var
+    {-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,7,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,7,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,7,-1,8}, // Block_2
+    {-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,10,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,9,-1,-1}, // Class_1
+    {-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,12,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,11,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,11,-1,-1}, // Class_2
+    {-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,13,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1}, // SpecifiedType
+    {-1,-1,14,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1}, // Var_1
+    {-1,-1,-1,-1,-1,-1,-1,-1,15,15,-1,15,-1,-1,-1,-1,-1,-1,-1,15,-1,-1,-1,-1,15,15,-1,-1,-1,-1,-1,15,-1,15,-1,15,-1,-1,-1,-1,15,-1,15,-1,15,-1,-1,15,15,-1,-1,15,15,-1,-1,-1}, // Expression
+    {-1,-1,16,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,17,-1,-1,-1,-1,-1}, // Var_2
+    {-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,18,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1}, // Function_1
+    {-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,19,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1}, // Parameter
+    {-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,20,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1}, // Function_2
+    {-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,22,-1,21,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1}, // Function_3
+    {-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,24,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,23,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1}, // Function_4
+    {-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,25,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,26,-1,-1,-1,-1,-1,-1,-1,-1,-1}, // Function_5
+    {-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,27,-1,-1,-1,-1,-1,-1,-1,-1,-1}, // Scope
+    {-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,28,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1}, // Type
+    {30,30,30,30,30,30,30,30,29,-1,-1,-1,-1,30,-1,30,-1,30,-1,-1,30,30,-1,30,-1,-1,-1,-1,-1,30,30,-1,-1,-1,30,-1,-1,30,30,30,-1,30,30,30,-1,30,30,30,30,-1,30,-1,-1,-1,-1,-1}, // Type_1
+    {-1,-1,-1,-1,-1,-1,-1,-1,31,31,31,31,-1,-1,-1,-1,-1,-1,31,31,-1,-1,-1,-1,31,31,31,-1,31,-1,-1,31,31,31,-1,31,31,-1,-1,-1,31,-1,31,-1,31,-1,-1,31,31,31,-1,31,31,31,31,-1}, // Scope_1
+    {-1,-1,-1,-1,-1,-1,-1,-1,33,33,33,33,-1,-1,-1,-1,-1,-1,33,33,-1,-1,-1,-1,33,33,32,-1,33,-1,-1,33,32,33,-1,33,33,-1,-1,-1,33,-1,33,-1,33,-1,-1,33,33,33,-1,33,33,33,32,-1}, // Statement
+    {-1,-1,-1,-1,-1,-1,-1,-1,34,34,34,34,-1,-1,35,-1,-1,-1,34,34,-1,-1,-1,-1,34,34,34,-1,34,-1,-1,34,34,34,-1,34,34,-1,-1,-1,34,-1,34,-1,34,-1,-1,34,34,34,-1,34,34,34,34,-1}, // Scope_2
+    {-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,38,-1,-1,-1,-1,-1,36,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,37,-1}, // FreeStatement
+    {-1,-1,-1,-1,-1,-1,-1,-1,45,45,42,45,-1,-1,-1,-1,-1,-1,43,45,-1,-1,-1,-1,45,45,-1,-1,40,-1,-1,45,-1,45,-1,45,39,-1,-1,-1,45,-1,45,-1,45,-1,-1,45,45,41,-1,45,45,44,-1,-1}, // DelimitedStatement
+    {-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,46,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1}, // Label
+    {-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,47,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1}, // Goto
+    {-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,48,-1,-1,-1,-1,-1,-1}, // Return
+    {-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,49,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1}, // If
+    {-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,50,-1}, // While
+    {-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,51,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1}, // For
+    {-1,-1,-1,-1,-1,-1,-1,-1,52,52,-1,52,-1,-1,-1,-1,-1,-1,-1,52,-1,-1,-1,-1,52,52,-1,-1,-1,-1,-1,52,-1,52,-1,52,-1,-1,-1,-1,52,-1,52,-1,52,-1,-1,52,52,-1,-1,52,52,-1,-1,-1}, // Return_1
+    {-1,-1,-1,-1,-1,-1,-1,-1,53,53,-1,53,-1,-1,-1,-1,-1,-1,-1,53,-1,-1,-1,-1,53,53,-1,-1,-1,-1,-1,53,-1,53,-1,53,-1,-1,-1,-1,53,-1,53,-1,53,-1,-1,53,53,-1,54,53,53,-1,-1,-1}, // Return_2
+    {-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,55,-1,-1,-1,-1,-1,-1,-1,-1}, // GroupedExpression
+    {-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,56,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1}, // Else
+    {-1,-1,-1,-1,-1,-1,-1,-1,58,58,58,58,-1,-1,58,-1,-1,-1,58,58,-1,-1,57,-1,58,58,58,-1,58,-1,-1,58,58,58,-1,58,58,-1,-1,-1,58,-1,58,-1,58,-1,-1,58,58,58,-1,58,58,58,58,-1}, // If_1
+    {-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,59,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,60,-1,-1,-1,-1,-1,-1,-1,-1,-1}, // Else_1
+    {-1,-1,-1,-1,-1,-1,-1,-1,62,62,-1,62,-1,-1,-1,-1,-1,-1,-1,62,-1,-1,-1,-1,62,62,-1,-1,-1,-1,-1,62,-1,62,-1,62,-1,-1,-1,-1,62,-1,62,-1,62,-1,-1,62,62,-1,-1,62,62,61,-1,-1}, // For_1
+    {-1,-1,-1,-1,-1,-1,-1,-1,63,63,-1,63,-1,-1,-1,-1,-1,-1,-1,63,-1,-1,-1,-1,63,63,-1,-1,-1,-1,-1,63,-1,63,-1,63,-1,-1,-1,-1,63,-1,63,-1,63,-1,-1,63,63,-1,64,63,63,63,-1,-1}, // For_2
+    {-1,-1,-1,-1,-1,-1,-1,-1,65,65,-1,65,-1,-1,-1,-1,-1,-1,-1,65,-1,-1,-1,-1,65,65,-1,-1,-1,-1,-1,65,-1,65,-1,65,-1,-1,-1,-1,65,-1,65,-1,65,-1,-1,65,65,-1,66,65,65,-1,-1,-1}, // For_3
+    {-1,-1,-1,-1,-1,-1,-1,-1,67,67,-1,67,-1,-1,-1,68,-1,-1,-1,67,-1,-1,-1,-1,67,67,-1,-1,-1,-1,-1,67,-1,67,-1,67,-1,-1,-1,-1,67,-1,67,-1,67,-1,-1,67,67,-1,-1,67,67,-1,-1,-1}, // For_4
+    {-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,75,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,70,73,-1,-1,-1,-1,-1,76,-1,-1,-1,72,-1,-1,-1,-1,-1,-1,-1,-1,71,-1,-1,77,-1,-1,-1,74,69,-1,-1,-1}, // Value
+    {-1,-1,-1,-1,-1,-1,-1,-1,78,78,-1,78,-1,-1,-1,-1,-1,-1,-1,78,-1,-1,-1,-1,78,78,-1,-1,-1,-1,-1,78,-1,78,-1,78,-1,-1,-1,-1,78,-1,78,-1,78,-1,-1,78,78,-1,-1,78,78,-1,-1,-1}, // Expression1
+    {-1,-1,79,79,79,79,79,79,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1}, // Expression_1
+    {-1,-1,80,84,82,85,83,81,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1}, // Expression_2
+    {-1,-1,86,86,86,86,86,86,-1,-1,-1,-1,-1,87,-1,87,-1,87,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,87,-1,-1,-1,-1,-1}, // Expression_3
+    {-1,-1,-1,-1,-1,-1,-1,-1,88,88,-1,88,-1,-1,-1,-1,-1,-1,-1,88,-1,-1,-1,-1,88,88,-1,-1,-1,-1,-1,88,-1,88,-1,88,-1,-1,-1,-1,88,-1,88,-1,88,-1,-1,88,88,-1,-1,88,88,-1,-1,-1}, // Expression2
+    {-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,89,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1}, // Expression1_1
+    {-1,-1,91,91,91,91,91,91,-1,-1,-1,-1,-1,91,-1,91,-1,91,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,90,-1,-1,-1,-1,-1,-1,-1,-1,91,-1,-1,-1,-1,-1}, // Expression1_2
+    {-1,-1,-1,-1,-1,-1,-1,-1,92,92,-1,92,-1,-1,-1,-1,-1,-1,-1,92,-1,-1,-1,-1,92,92,-1,-1,-1,-1,-1,92,-1,92,-1,92,-1,-1,-1,-1,92,-1,92,-1,92,-1,-1,92,92,-1,-1,92,92,-1,-1,-1}, // Expression3
+    {-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,93,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1}, // Expression2_1
+    {-1,-1,95,95,95,95,95,95,-1,-1,-1,-1,-1,95,-1,95,-1,95,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,94,-1,95,-1,-1,-1,-1,-1,-1,-1,-1,95,-1,-1,-1,-1,-1}, // Expression2_2
+    {-1,-1,-1,-1,-1,-1,-1,-1,96,96,-1,96,-1,-1,-1,-1,-1,-1,-1,96,-1,-1,-1,-1,96,96,-1,-1,-1,-1,-1,96,-1,96,-1,96,-1,-1,-1,-1,96,-1,96,-1,96,-1,-1,96,96,-1,-1,96,96,-1,-1,-1}, // Expression4
+    {-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,97,-1,-1,-1,-1,-1,97,97,-1,-1,-1,97,-1,-1,97,97,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1}, // Expression3_1
+    {-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,102,-1,-1,-1,-1,-1,99,101,-1,-1,-1,103,-1,-1,98,100,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1}, // Expression3_2
+    {-1,-1,105,105,105,105,105,105,-1,-1,-1,-1,-1,105,-1,105,-1,105,-1,-1,-1,-1,-1,104,-1,-1,-1,-1,-1,104,104,-1,-1,-1,104,-1,-1,104,104,105,-1,105,-1,-1,-1,-1,-1,-1,-1,-1,105,-1,-1,-1,-1,-1}, // Expression3_3
+    {-1,-1,-1,-1,-1,-1,-1,-1,106,106,-1,106,-1,-1,-1,-1,-1,-1,-1,106,-1,-1,-1,-1,106,106,-1,-1,-1,-1,-1,106,-1,106,-1,106,-1,-1,-1,-1,106,-1,106,-1,106,-1,-1,106,106,-1,-1,106,106,-1,-1,-1}, // Expression5
+    {-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,107,-1,-1,-1,-1,-1,107,-1,-1,-1,-1,-1,-1,-1}, // Expression4_1
+    {-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,109,-1,-1,-1,-1,-1,108,-1,-1,-1,-1,-1,-1,-1}, // Expression4_2
+    {-1,-1,111,111,111,111,111,111,-1,-1,-1,-1,-1,111,-1,111,-1,111,-1,-1,-1,-1,-1,111,-1,-1,-1,-1,-1,111,111,-1,-1,-1,111,-1,-1,111,111,111,-1,111,110,-1,-1,-1,-1,-1,110,-1,111,-1,-1,-1,-1,-1}, // Expression4_3
+    {-1,-1,-1,-1,-1,-1,-1,-1,112,112,-1,112,-1,-1,-1,-1,-1,-1,-1,112,-1,-1,-1,-1,112,112,-1,-1,-1,-1,-1,112,-1,112,-1,112,-1,-1,-1,-1,112,-1,112,-1,112,-1,-1,112,112,-1,-1,112,112,-1,-1,-1}, // Expression6
+    {-1,-1,-1,-1,-1,-1,-1,-1,113,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,113,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,113,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1}, // Expression5_1
+    {-1,-1,-1,-1,-1,-1,-1,-1,114,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,115,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,116,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1}, // Expression5_2
+    {-1,-1,118,118,118,118,118,118,117,-1,-1,-1,-1,118,-1,118,-1,118,-1,-1,117,-1,-1,118,-1,-1,-1,-1,-1,118,118,-1,-1,-1,118,-1,-1,118,118,118,-1,118,118,117,-1,-1,-1,-1,118,-1,118,-1,-1,-1,-1,-1}, // Expression5_3
+    {-1,-1,-1,-1,-1,-1,-1,-1,119,120,-1,-1,-1,-1,-1,-1,-1,-1,-1,125,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,124,-1,-1,-1,-1,-1,-1,123,-1,122,-1,-1,-1,-1,-1,121,-1,-1,-1,-1,-1,-1,-1}, // Expression6_1
+    {-1,-1,-1,-1,-1,-1,-1,-1,126,126,-1,127,-1,-1,-1,-1,-1,-1,-1,126,-1,-1,-1,-1,127,127,-1,-1,-1,-1,-1,127,-1,126,-1,127,-1,-1,-1,-1,126,-1,126,-1,127,-1,-1,127,126,-1,-1,127,127,-1,-1,-1}, // Expression6_2
+    {-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,128,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,128,128,-1,-1,-1,-1,-1,128,-1,-1,-1,128,-1,-1,-1,-1,-1,-1,-1,-1,128,-1,-1,128,-1,-1,-1,128,128,-1,-1,-1}, // Expression7
+    {129,131,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,129,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,132,-1,130,-1,-1,-1,-1,-1,-1,-1,-1}, // Expression7_1
+    {133,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,133,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1}, // MemberAccess
+    {-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,134,-1,-1,-1,-1,-1,-1,-1,-1}, // Call
+    {-1,135,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1}, // Cast
+    {-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,136,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1}, // Index
+    {137,137,138,138,138,138,138,138,138,-1,-1,-1,-1,138,-1,138,-1,138,-1,-1,138,137,-1,138,-1,-1,-1,-1,-1,138,138,-1,-1,-1,138,-1,-1,138,138,138,-1,138,138,138,-1,137,-1,137,138,-1,138,-1,-1,-1,-1,-1}, // Expression7_2
+    {140,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,139,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1}, // MemberAccess_1
+    {-1,-1,-1,-1,-1,-1,-1,-1,141,141,-1,141,-1,-1,-1,-1,-1,-1,-1,141,-1,-1,-1,-1,141,141,-1,-1,-1,-1,-1,141,-1,141,-1,141,-1,-1,-1,-1,141,-1,141,-1,141,-1,-1,141,141,-1,-1,141,141,-1,-1,-1}, // Call_1
+    {-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,142,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1}, // Call_2
+    {-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,144,-1,143,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1}, // Call_3
+    {-1,-1,-1,-1,-1,-1,-1,-1,145,145,-1,145,-1,-1,-1,146,-1,-1,-1,145,-1,-1,-1,-1,145,145,-1,-1,-1,-1,-1,145,-1,145,-1,145,-1,-1,-1,-1,145,-1,145,-1,145,-1,-1,145,145,-1,-1,145,145,-1,-1,-1}, // Call_4
+  };
+
+  // Rule -> the production that matches nothing (-1 if the rule can't)
+  const short EmptyProductions[RuleCount] =
+  {
+    0, // Block
+    -1, // Block_1
+    -1, // Class
+    -1, // Function
+    -1, // Var
+    8, // Block_2
+    -1, // Class_1
+    12, // Class_2
+    -1, // SpecifiedType
+    -1, // Var_1
+    -1, // Expression
+    17, // Var_2
+    -1, // Function_1
+    -1, // Parameter
+    -1, // Function_2
+    22, // Function_3
+    24, // Function_4
+    26, // Function_5
+    -1, // Scope
+    -1, // Type
+    30, // Type_1
+    -1, // Scope_1
+    -1, // Statement
+    35, // Scope_2
+    -1, // FreeStatement
+    -1, // DelimitedStatement
+    -1, // Label
+    -1, // Goto
+    -1, // Return
+    -1, // If
+    -1, // While
+    -1, // For
+    -1, // Return_1
+    54, // Return_2
+    -1, // GroupedExpression
+    -1, // Else
+    58, // If_1
+    -1, // Else_1
+    -1, // For_1
+    64, // For_2
+    66, // For_3
+    68, // For_4
+    -1, // Value
+    -1, // Expression1
+    -1, // Expression_1
+    -1, // Expression_2
+    87, // Expression_3
+    -1, // Expression2
+    -1, // Expression1_1
+    91, // Expression1_2
+    -1, // Expression3
+    -1, // Expression2_1
+    95, // Expression2_2
+    -1, // Expression4
+    -1, // Expression3_1
+    -1, // Expression3_2
+    105, // Expression3_3
+    -1, // Expression5
+    -1, // Expression4_1
+    -1, // Expression4_2
+    111, // Expression4_3
+    -1, // Expression6
+    -1, // Expression5_1
+    -1, // Expression5_2
+    118, // Expression5_3
+    -1, // Expression6_1
+    127, // Expression6_2
+    -1, // Expression7
+    -1, // Expression7_1
+    -1, // MemberAccess
+    -1, // Call
+    -1, // Cast
+    -1, // Index
+    138, // Expression7_2
+    -1, // MemberAccess_1
+    -1, // Call_1
+    -1, // Call_2
+    144, // Call_3
+    146, // Call_4
+  };
+}
@@ -0,0 +1,458 @@
+/******************************************************************\
+ * Copyright 2015, DigiPen Institute of Technology
+\******************************************************************/
+// Measures each pass of SemanticAnalyize, plus PrintTreeWithSymbols, on synthetic programs
+// Every program is analyzed with the classic passes, then with the fused passes (see SetFusedSemanticPasses)
+// on one thread, and then with the fused passes on every core (see SetSemanticThreads)
+// Then the analyzed library is saved as an image and rebuilt from it (see WriteLibraryImage and ReadLibraryImage),
+// next to what getting the same library from source costs (lexing, parsing and analysis, without printing)
+// Then the program is compiled through a CompilationCache, once missing and then hitting
+// Last, one function is edited and only its body is analyzed again (see IncrementalAnalyzer), which must not grow the library
+// Build it together with the Drivers and the other UserCode files with SEMANTIC_BENCHMARK defined and run:
+//   SemanticBenchmark > NUL
+// Results go to stderr; stdout only receives the printed trees.
+// Every program is lexed once up front. Analysis changes the tree, so each run parses a fresh copy first.
+
+#include "../Drivers/Driver4.hpp"
+#include "../Drivers/LibraryFile.hpp"
+#include "../Drivers/CompilationCache.hpp"
+
+#if SEMANTIC_BENCHMARK
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+
+// One class followed by 'functions' functions that the analyzer accepts
+// Between them they reach every pass's Visit overloads (declarations, scopes, loops, calls, casts, members, indexing)
+static std::string MakeProgram(size_t functions)
+{
+  std::string source =
+    "class Player\n"
+    "{\n"
+    "  var Health : Integer;\n"
+    "  var Speed : Float;\n"
+    "}\n";
+
+  for (size_t i = 0; i < functions; ++i)
+  {
+    std::string name = "Update" + std::to_string(i);
+    source += "function " + name + "(amount : Integer, player : Player*) : Integer\n";
+    source +=
+      "{\n"
+      "  var total : Integer = amount * 3 + 7;\n"
+      "  var scale : Float = 1.0;\n"
+      "  var text : Byte* = \"player\";\n"
+      "  var first : Byte = text[0];\n"
+      "  while (total < 100) { total = total + player->Health; scale = scale * 2.0; }\n"
+      "  for (var i : Integer = 0; i < 10; ++i)\n"
+      "  {\n"
+      "    if (total > 5 && player->Health > 0) { total = total - -i; }\n"
+      "    else { continue; }\n"
+      "  }\n"
+      "  label done;\n"
+      "  goto done;\n"
+      "  total = total + first as Integer + scale as Integer;\n";
+    source += "  " + name + "(total, player);\n";
+    source +=
+      "  return total;\n"
+      "}\n";
+  }
+
+  return source;
+}
+
+// The first function of MakeProgram on its own, as an editor would parse it again after it was edited
+static std::string MakeEditedFunction()
+{
+  std::string program = MakeProgram(1);
+  return program.substr(program.find("function"));
+}
+
+// One function that declares 'locals' locals, each one initialized from the one before it
+// Stresses declaring and resolving names in a function with a lot of locals
+static std::string MakeLocalsProgram(size_t locals)
+{
+  std::string source =
+    "function Locals() : Integer\n"
+    "{\n"
+    "  var local0 : Integer = 0;\n";
+
+  for (size_t i = 1; i < locals; ++i)
+    source += "  var local" + std::to_string(i) + " : Integer = local" + std::to_string(i - 1) + " + 1;\n";
+
+  source += "  return local" + std::to_string(locals - 1) + ";\n";
+  source += "}\n";
+  return source;
+}
+
+static void Lex(const std::string& source, std::vector<Token>& tokens)
+{
+  DfaState* root = CreateLanguageDfa();
+  const char* stream = source.c_str();
+  while (*stream != '\0')
+  {
+    Token token;
+    ReadLanguageToken(root, stream, token);
+    if (token.mLength == 0)
+    {
+      ++stream;
+      continue;
+    }
+
+    tokens.push_back(token);
+    stream += token.mLength;
+  }
+
+  DeleteStateAndChildren(root);
+  RemoveWhitespaceAndComments(tokens);
+}
+
+// Passes are listed in the order SemanticAnalyize runs them, followed by printing
+static const size_t MaxPasses = 8;
+
+struct AnalysisMeasurement
+{
+  size_t mRuns;
+  size_t mPasses;
+  const char* mNames[MaxPasses];
+  double mSeconds[MaxPasses];
+};
+
+static bool Measure(std::vector<Token>& tokens, bool fused, size_t threads, AnalysisMeasurement& measurement)
+{
+  typedef std::chrono::steady_clock Clock;
+  SetFusedSemanticPasses(fused);
+  SetSemanticThreads(threads);
+
+  std::vector<Library*> dependencies;
+  dependencies.push_back(InitializeCoreLibrary());
+
+  measurement.mRuns = 0;
+  measurement.mPasses = 0;
+  for (size_t i = 0; i < MaxPasses; ++i)
+    measurement.mSeconds[i] = 0.0;
+
+  // As many analyses as fit in half a second (at least one)
+  Clock::duration elapsed = Clock::duration::zero();
+  do
+  {
+    std::string error;
+    AstPtr<BlockNode> block = TryParseBlock(tokens, &error);
+    if (block == nullptr)
+    {
+      fprintf(stderr, "The benchmark program failed to parse: %s\n", error.c_str());
+      return false;
+    }
+
+    Clock::time_point start = Clock::now();
+    Library library;
+    try
+    {
+      SemanticAnalyize(block.get(), dependencies, &library);
+    }
+    catch (SemanticException& e)
+    {
+      fprintf(stderr, "The benchmark program failed analysis: %s\n", e.what());
+      return false;
+    }
+
+    const std::vector<SemanticPassTime>& times = GetSemanticPassTimes();
+    for (size_t i = 0; i < times.size() && i < MaxPasses - 1; ++i)
+    {
+      measurement.mNames[i] = times[i].mName;
+      measurement.mSeconds[i] += times[i].mSeconds;
+    }
+
+    Clock::time_point printStart = Clock::now();
+    PrintTreeWithSymbols(block.get());
+    Clock::time_point printEnd = Clock::now();
+
+    size_t print = times.size() < MaxPasses - 1 ? times.size() : MaxPasses - 1;
+    measurement.mNames[print] = "Print";
+    measurement.mSeconds[print] += std::chrono::duration<double>(printEnd - printStart).count();
+    measurement.mPasses = print + 1;
+
+    ++measurement.mRuns;
+    elapsed += printEnd - start;
+  } while (elapsed < std::chrono::milliseconds(500));
+
+  return true;
+}
+
+// Times building a library from source (lexing, parsing and analysis), saving it as an image,
+// and rebuilding a library from that image
+static bool MeasureImage(const std::string& source, double& sourceSeconds, double& saveSeconds, double& loadSeconds, size_t& bytes)
+{
+  typedef std::chrono::steady_clock Clock;
+
+  std::vector<Library*> dependencies;
+  dependencies.push_back(InitializeCoreLibrary());
+
+  // The parse trace would be printing, so it is off like it is for CompileCached
+  bool tracing = IsParseTracing();
+  SetParseTracing(false);
+
+  size_t sourceRuns = 0;
+  Clock::duration fromSource = Clock::duration::zero();
+  std::unique_ptr<Library> library;
+  do
+  {
+    // The previous library is destroyed before the clock starts
+    library.reset(new Library());
+
+    Clock::time_point start = Clock::now();
+    std::vector<Token> tokens;
+    Lex(source, tokens);
+    AstPtr<BlockNode> block = TryParseBlock(tokens);
+    try
+    {
+      SemanticAnalyize(block.get(), dependencies, library.get());
+    }
+    catch (SemanticException& e)
+    {
+      fprintf(stderr, "The benchmark program failed analysis: %s\n", e.what());
+      SetParseTracing(tracing);
+      return false;
+    }
+
+    fromSource += Clock::now() - start;
+    ++sourceRuns;
+  } while (fromSource < std::chrono::milliseconds(500));
+
+  SetParseTracing(tracing);
+  sourceSeconds = std::chrono::duration<double>(fromSource).count() / sourceRuns;
+
+  size_t runs = 0;
+  Clock::duration save = Clock::duration::zero();
+  Clock::duration load = Clock::duration::zero();
+  std::vector<char> image;
+  do
+  {
+    Clock::time_point start = Clock::now();
+    bool written = WriteLibraryImage(library.get(), dependencies, image);
+    Clock::time_point saved = Clock::now();
+
+    Library loaded;
+    bool read = written && ReadLibraryImage(image.data(), image.size(), dependencies, &loaded);
+    Clock::time_point loadedTime = Clock::now();
+
+    if (!read)
+    {
+      fprintf(stderr, "The benchmark library did not survive being saved as an image\n");
+      return false;
+    }
+
+    save += saved - start;
+    load += loadedTime - saved;
+    ++runs;
+  } while (save + load < std::chrono::milliseconds(500));
+
+  saveSeconds = std::chrono::duration<double>(save).count() / runs;
+  loadSeconds = std::chrono::duration<double>(load).count() / runs;
+  bytes = image.size();
+  return true;
+}
+
+// Times compiling a source that the cache doesn't have yet, and then the same source again
+static bool MeasureCache(const std::string& source, double& missSeconds, double& hitSeconds)
+{
+  typedef std::chrono::steady_clock Clock;
+
+  std::vector<Library*> dependencies;
+  dependencies.push_back(InitializeCoreLibrary());
+
+  // Leftovers from earlier runs are evicted as the cache fills
+  CompilationCache cache("SemanticBenchmarkCache", 16 * 1024 * 1024);
+
+  // A comment with the time makes a source the cache can't have seen, without changing what is analyzed
+  std::string fresh = source + "// " + std::to_string(Clock::now().time_since_epoch().count()) + "\n";
+  std::string diagnostic;
+
+  Clock::time_point start = Clock::now();
+  {
+    Library library;
+    if (!CompileCached(cache, fresh, dependencies, &library, diagnostic))
+    {
+      fprintf(stderr, "The benchmark program failed analysis: %s\n", diagnostic.c_str());
+      return false;
+    }
+  }
+  missSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+  size_t runs = 0;
+  Clock::duration elapsed = Clock::duration::zero();
+  do
+  {
+    Clock::time_point hitStart = Clock::now();
+    Library library;
+    bool compiled = CompileCached(cache, fresh, dependencies, &library, diagnostic);
+    elapsed += Clock::now() - hitStart;
+
+    if (!compiled)
+    {
+      fprintf(stderr, "The cached benchmark program failed analysis: %s\n", diagnostic.c_str());
+      return false;
+    }
+    ++runs;
+  } while (elapsed < std::chrono::milliseconds(500));
+
+  hitSeconds = std::chrono::duration<double>(elapsed).count() / runs;
+  return true;
+}
+
+// How many times MeasureEdit replaces the body
+static const size_t EditRuns = 2000;
+
+// Times analyzing one edited function body again, against analyzing the whole program
+
+static bool MeasureEdit(std::vector<Token>& tokens, std::vector<Token>& editTokens, double& editSeconds)
+{
+  typedef std::chrono::steady_clock Clock;
+
+  std::vector<Library*> dependencies;
+  dependencies.push_back(InitializeCoreLibrary());
+
+  IncrementalAnalyzer analyzer;
+  Library library;
+  try
+  {
+    analyzer.Analyze(TryParseBlock(tokens), dependencies, &library);
+  }
+  catch (SemanticException& e)
+  {
+    fprintf(stderr, "The benchmark program failed analysis: %s\n", e.what());
+    return false;
+  }
+
+  FunctionNode* function = static_cast<FunctionNode*>(analyzer.GetTree()->mGlobals[1].get());
+
+  // Parsing the edit is the editor's cost, not the analyzer's, so only ReplaceBody is timed (a fixed number of times,
+  // since parsing takes far longer than analyzing)
+  size_t runs = 0;
+  size_t settledBytes = 0;
+  Clock::duration elapsed = Clock::duration::zero();
+  do
+  {
+    // Replaced bodies are only removed once there are enough of them (hundreds of edits, on the large program),
+    // so by half way their memory is what later edits use
+    if (runs == EditRuns / 2)
+      settledBytes = library.GetSlabBytes();
+
+    AstPtr<BlockNode> edit = TryParseBlock(editTokens);
+    Clock::time_point start = Clock::now();
+    bool replaced = false;
+    try
+    {
+      replaced = analyzer.ReplaceBody(function, std::move(edit));
+    }
+    catch (SemanticException& e)
+    {
+      fprintf(stderr, "The edited function failed analysis: %s\n", e.what());
+      return false;
+    }
+    elapsed += Clock::now() - start;
+
+    if (!replaced)
+    {
+      fprintf(stderr, "The edited function was not accepted as the same function\n");
+      return false;
+    }
+    ++runs;
+  } while (runs < EditRuns);
+
+  if (library.GetSlabBytes() > settledBytes)
+  {
+    fprintf(stderr, "The library grew by %d bytes over %d edits\n", (int)(library.GetSlabBytes() - settledBytes), (int)(EditRuns / 2));
+    return false;
+  }
+
+  editSeconds = std::chrono::duration<double>(elapsed).count() / runs;
+  return true;
+}
+
+int main(int argc, char* argv[])
+{
+  struct BenchmarkProgram
+  {
+    const char* mName;
+    size_t mFunctions;
+    size_t mLocals;
+  };
+
+  // Either 'mFunctions' functions (see MakeProgram) or one function with 'mLocals' locals (see MakeLocalsProgram)
+  const BenchmarkProgram programs[] =
+  {
+    { "tiny",   1,    0     },
+    { "small",  10,   0     },
+    { "medium", 100,  0     },
+    { "large",  1000, 0     },
+    { "locals", 0,    10000 }
+  };
+
+  fprintf(stderr, "%-8s %9s %-7s %-8s %12s\n", "Program", "Tokens", "Passes", "Pass", "us/run");
+
+  std::vector<Token> editTokens;
+  Lex(MakeEditedFunction(), editTokens);
+
+  for (size_t i = 0; i < DriverArraySize(programs); ++i)
+  {
+    const BenchmarkProgram& program = programs[i];
+    std::string source = program.mLocals ? MakeLocalsProgram(program.mLocals) : MakeProgram(program.mFunctions);
+    std::vector<Token> tokens;
+    Lex(source, tokens);
+
+    for (int mode = 0; mode < 3; ++mode)
+    {
+      // Classic, fused on one thread, fused on every core
+      AnalysisMeasurement measurement;
+      if (!Measure(tokens, mode != 0, mode == 1 ? 1 : 0, measurement))
+        return 1;
+
+      const char* passes = mode == 0 ? "classic" : mode == 1 ? "fused" : "threads";
+      double total = 0.0;
+      for (size_t pass = 0; pass < measurement.mPasses; ++pass)
+      {
+        double microseconds = measurement.mSeconds[pass] * 1000000.0 / measurement.mRuns;
+        total += microseconds;
+        fprintf(stderr, "%-8s %9d %-7s %-8s %12.1f\n", program.mName, (int)tokens.size(), passes, measurement.mNames[pass], microseconds);
+      }
+
+      fprintf(stderr, "%-8s %9d %-7s %-8s %12.1f\n", program.mName, (int)tokens.size(), passes, "Total", total);
+    }
+
+    double fromSource = 0.0;
+    double save = 0.0;
+    double load = 0.0;
+    size_t bytes = 0;
+    if (!MeasureImage(source, fromSource, save, load, bytes))
+      return 1;
+
+    fprintf(stderr, "%-8s %9d %-7s %-8s %12.1f\n", program.mName, (int)tokens.size(), "image", "Source", fromSource * 1000000.0);
+    fprintf(stderr, "%-8s %9d %-7s %-8s %12.1f\n", program.mName, (int)tokens.size(), "image", "Save", save * 1000000.0);
+    fprintf(stderr, "%-8s %9d %-7s %-8s %12.1f  (%d bytes)\n", program.mName, (int)tokens.size(), "image", "Load", load * 1000000.0, (int)bytes);
+
+    double miss = 0.0;
+    double hit = 0.0;
+    if (!MeasureCache(source, miss, hit))
+      return 1;
+
+    fprintf(stderr, "%-8s %9d %-7s %-8s %12.1f\n", program.mName, (int)tokens.size(), "cache", "Miss", miss * 1000000.0);
+    fprintf(stderr, "%-8s %9d %-7s %-8s %12.1f\n", program.mName, (int)tokens.size(), "cache", "Hit", hit * 1000000.0);
+
+    // The locals program has no Update0 to edit
+    if (program.mFunctions == 0)
+      continue;
+
+    double edit = 0.0;
+    if (!MeasureEdit(tokens, editTokens, edit))
+      return 1;
+
+    fprintf(stderr, "%-8s %9d %-7s %-8s %12.1f\n", program.mName, (int)tokens.size(), "edit", "Recheck", edit * 1000000.0);
+  }
+
+  SetFusedSemanticPasses(true);
+  SetSemanticThreads(0);
+  return 0;
+}
+#endif
@@ -133,6 +133,7 @@ void DeleteStateAndChildren(DfaState* root)
 void ReadLanguageToken(DfaState* startingState, const char* stream, Token& outToken)
 {
   ReadToken(startingState, stream, outToken);
+  outToken.mAtom = EmptyAtom;
 
   int result;
 
@@ -163,6 +164,14 @@ void ReadLanguageToken(DfaState* startingState, const char* stream, Token& outTo
 	*/
   }
 #pragma endregion;
+
+  // Every copy of a name shares the interned text instead of the copy ReadToken made
+  if (outToken.mEnumTokenType == TokenType::Identifier)
+  {
+    outToken.mAtom = InternString(outToken.mText, outToken.mLength);
+    delete[] outToken.mText;
+    outToken.mText = GetAtomString(outToken.mAtom).c_str();
+  }
 }
 
 //#include <regex>
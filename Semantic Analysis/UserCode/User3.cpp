@@ -3,72 +3,270 @@
  * Copyright 2015, DigiPen Institute of Technology
 \******************************************************************/
 #include "../Drivers/Driver3.hpp"
+#include "../Drivers/AstArena.hpp"
+#include "../Drivers/FlatAst.hpp"
+#include "../Drivers/SymbolTable.hpp"
 
+#include <algorithm>
 #include <iostream>
 #include <cassert>
+#include <climits>
 #include <typeinfo> //typeid for classname printing
 
-using std::unique_ptr;
-using std::make_unique;
+// Every rule that may end up nested inside of itself
+// These run as frames on the parser's own heap allocated stack instead of recursing on the native stack
+namespace ParseRule
+{
+  enum Enum
+  {
+    Block,
+    Class,
+    Var,
+    Function,
+    Scope,
+    Statement,
+    DelimitedStatement,
+    FreeStatement,
+    Return,
+    If,
+    Else,
+    While,
+    For,
+    GroupedExpression,
+    Expression,
+    Expression1,
+    Expression2,
+    Expression3,
+    Expression4,
+    Expression5,
+    Expression6,
+    Expression7,
+    Value,
+    Call,
+    Index
+  };
+
+  const char* Names[] =
+  {
+    "Block",
+    "Class",
+    "Var",
+    "Function",
+    "Scope",
+    "Statement",
+    "DelimitedStatement",
+    "FreeStatement",
+    "Return",
+    "If",
+    "Else",
+    "While",
+    "For",
+    "GroupedExpression",
+    "Expression",
+    "Expression1",
+    "Expression2",
+    "Expression3",
+    "Expression4",
+    "Expression5",
+    "Expression6",
+    "Expression7",
+    "Value",
+    "Call",
+    "Index"
+  };
+}
+
+// The most rules the parser may be inside of at once (each level of parentheses costs about ten)
+const size_t DefaultMaxParseDepth = 100000;
+static size_t MaxParseDepth = DefaultMaxParseDepth;
+
+void SetParseDepthLimit(size_t maxDepth)
+{
+  MaxParseDepth = maxDepth ? maxDepth : DefaultMaxParseDepth;
+}
+
+static bool ParseTracing = true;
+
+void SetParseTracing(bool tracing)
+{
+  ParseTracing = tracing;
+}
+
+bool IsParseTracing()
+{
+  return ParseTracing;
+}
+
+// A PrintRule that is only created when the parser is tracing (used by the rules that run on the native stack)
+class RuleTrace
+{
+public:
+  RuleTrace(bool tracing, const char* rule) :
+    mRule(tracing ? new PrintRule(rule) : nullptr)
+  {
+  }
 
-class Parser 
+  ~RuleTrace()
+  {
+    delete mRule;
+  }
+
+  template <typename T>
+  T Accept(T result)
+  {
+    if (mRule)
+      mRule->Accept(result != nullptr);
+    return result;
+  }
+
+private:
+  PrintRule* mRule;
+};
+
+// A rule that the parser is currently inside of
+// mState is where the rule resumes once the rule it called has produced a result
+struct ParseFrame
+{
+  ParseRule::Enum mRule;
+  unsigned mState;
+  // Null when the parser is not tracing
+  PrintRule* mTrace;
+
+  // The node this rule is building (for the operator rules, the chain built so far)
+  AstPtr<AbstractNode> mNode;
+
+  // The innermost operator of an Expression6 prefix chain
+  UnaryOperatorNode* mTail;
+
+  // Whether a comma was accepted before the current Call argument
+  bool fComma;
+};
+
+// Owns the frames (and their PrintRules) of every rule the parser is inside of
+// Frames are always destroyed newest first (even while an exception unwinds) so the printed tree stays nested
+class ParseStack
+{
+public:
+  ~ParseStack()
+  {
+    Clear();
+  }
+
+  void Push(ParseRule::Enum rule, bool tracing)
+  {
+    mFrames.emplace_back();
+    ParseFrame& frame = mFrames.back();
+    frame.mRule = rule;
+    frame.mState = 0;
+    frame.mTrace = tracing ? new PrintRule(ParseRule::Names[rule]) : nullptr;
+    frame.mTail = nullptr;
+    frame.fComma = false;
+  }
+
+  void Pop()
+  {
+    delete mFrames.back().mTrace;
+    mFrames.pop_back();
+  }
+
+  void Clear()
+  {
+    while (!mFrames.empty())
+      Pop();
+  }
+
+  ParseFrame& Top()   { return mFrames.back();   }
+  size_t Size() const { return mFrames.size();   }
+  bool Empty() const  { return mFrames.empty();  }
+
+private:
+  std::vector<ParseFrame> mFrames;
+};
+
+// Tokens that can begin an expression (any other token makes the Expression rule fail without consuming anything)
+static bool StartsExpression(TokenType::Enum type)
+{
+  switch (type)
+  {
+    case TokenType::Asterisk:
+    case TokenType::BitwiseAndAddressOf:
+    case TokenType::Plus:
+    case TokenType::Minus:
+    case TokenType::LogicalNot:
+    case TokenType::Increment:
+    case TokenType::Decrement:
+    case TokenType::True:
+    case TokenType::False:
+    case TokenType::Null:
+    case TokenType::IntegerLiteral:
+    case TokenType::FloatLiteral:
+    case TokenType::StringLiteral:
+    case TokenType::CharacterLiteral:
+    case TokenType::Identifier:
+    case TokenType::OpenParentheses:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Tokens that can begin a DelimitedStatement
+static bool StartsDelimitedStatement(TokenType::Enum type)
+{
+  switch (type)
+  {
+    case TokenType::Label:
+    case TokenType::Goto:
+    case TokenType::Return:
+    case TokenType::Break:
+    case TokenType::Continue:
+    case TokenType::Var:
+      return true;
+    default:
+      return StartsExpression(type);
+  }
+}
+
+class Parser
 {
 public:
 #define RETURN_NODE(rule, node) return rule.Accept(std::move(node));
 
-	Parser(std::vector<Token>& tokens)
+	// When diagnostics are given, syntax errors are recorded there and skipped over instead of thrown
+	Parser(std::vector<Token>& tokens, std::vector<ParseDiagnostic>* diagnostics = nullptr)
 	{
 		m_tokenPos = 0;
 		m_tokenStream = &tokens;
+		m_maxDepth = MaxParseDepth;
+		m_tracing = ParseTracing;
+		m_diagnostics = diagnostics;
+		m_lastErrorPos = UINT_MAX;
+		m_failed = false;
+		m_arena.reset(new AstArena());
 		GetCurrentToken();
 	}
 
 	~Parser() {}
 
-    unique_ptr<BlockNode> Block()//  
+    // Whether the parse stopped on an error (Error describes it)
+    bool Failed() const
     {
-      PrintRule rule("Block");
-      unique_ptr<BlockNode> node = make_unique<BlockNode>();
-      
-      //TODO Implement root body
-      if (m_tokenStream->size())
-      {
-        bool fNewArg = true;
-        while( node->mGlobals.push_back(Class()) 
-            || node->mGlobals.push_back(Function()) 
-            || node->mGlobals.push_back(Var()) && this->Expect(TokenType::Semicolon));
-      }
-      if (m_tokenPos > m_tokenStream->size())
-        throw ParsingException("Too few tokens. Check syntax.");
-
-      RETURN_NODE(rule, node)
+      return m_failed;
     }
 
-    unique_ptr<ExpressionNode> Expression()
+    const std::string& Error() const
     {
-      PrintRule rule("Expression");
-      unique_ptr<ExpressionNode> node = Expression1();
-      if (node == nullptr)
-        return false;
-
-      unique_ptr<BinaryOperatorNode> opNode = make_unique<BinaryOperatorNode>();
-      if(  this->Accept(TokenType::Assignment, &opNode->mOperator)
-        || this->Accept(TokenType::AssignmentPlus, &opNode->mOperator)
-        || this->Accept(TokenType::AssignmentMinus, &opNode->mOperator)
-        || this->Accept(TokenType::AssignmentMultiply, &opNode->mOperator)
-        || this->Accept(TokenType::AssignmentDivide, &opNode->mOperator)
-        || this->Accept(TokenType::AssignmentModulo, &opNode->mOperator))
-      {
-        opNode->mLeft = Expression();
-        if (opNode->mLeft == nullptr)
-          throw ParsingException();
-
-        opNode->mRight = std::move(node);
+      return lastError;
+    }
 
-        RETURN_NODE(rule, opNode)
-      }
+    AstPtr<BlockNode> Block()
+    {
+      return Finish(Take<BlockNode>(Run(ParseRule::Block)));
+    }
 
-      RETURN_NODE(rule, node)
+    AstPtr<ExpressionNode> Expression()
+    {
+      return Finish(Take<ExpressionNode>(Run(ParseRule::Expression)));
     }
 
 private:
@@ -78,60 +276,74 @@ private:
 	Token m_lastDesiredToken;
 	std::string lastError;
 	PrintRule* m_lastRule;
-	/*
-	bool ParseTokenStream(std::vector<Token>& tokens)
-	{
-		m_tokenStream = tokens;
-		bool fSuccess = false;
-		try
-		{
-			switch (m_tokenStream[m_tokenPos].mTokenType)
-			{
-				case TokenType::Class:
-					fSuccess = Class();
-					break;
-
-				case TokenType::Function:
-					fSuccess = Function();
-					break;
-			}
-		}
-		catch (ParsingException exception)
-		{
-			std::cout << exception.what() << std::tempOpl;
-		}
-	}
-	*/
 
-    void ThrowError(const TokenType::Enum& desiredType)
+	// Every node is created here; declared first so that it outlives the nodes still held below
+	std::unique_ptr<AstArena> m_arena;
+	ParseStack m_frames;
+	// What the most recently finished rule returned
+	AstPtr<AbstractNode> m_result;
+	size_t m_maxDepth;
+	bool m_tracing;
+	std::vector<ParseDiagnostic>* m_diagnostics;
+	unsigned m_lastErrorPos;
+	bool m_failed;
+
+    // Errors are not thrown: the failing rule returns right away, every rule above it sees m_failed
+    // and returns too, and PrintRule prints them as failed while Run pops their frames
+    void Fail(const std::string& error = std::string())
+    {
+      if (m_failed)
+        return;
+
+      m_failed = true;
+      lastError = error;
+      if (m_tracing)
+        PrintRule::SetFailing(true);
+    }
+
+    // The name and text of the token we are at, such as: Semicolon ';'
+    std::string DescribeCurrentToken() const
     {
-        char cstr[64];
-        sprintf_s(cstr, sizeof(cstr), "Couldn't accept token of type: %d", (int)desiredType);
-        lastError = cstr;
-        throw ParsingException(cstr);
+      if (m_tokenPos >= m_tokenStream->size())
+        return "end of input";
+
+      std::string description = TokenNames[m_currentToken.mTokenType];
+      description.append(" '");
+      description.append(m_currentToken.str());
+      description.append("'");
+      return description;
+    }
+
+    void ExpectError(const TokenType::Enum& desiredType)
+    {
+      std::string error = "Expected ";
+      error.append(TokenNames[desiredType]);
+      error.append(" but found ");
+      error.append(DescribeCurrentToken());
+      Fail(error);
     }
 
 	//Helper Functions
 
-    bool Expect(const TokenType::Enum& desiredType, Token* token = nullptr) // 
+    bool Expect(const TokenType::Enum& desiredType, Token* token = nullptr) //
     {
       bool result = this->Accept(desiredType, token);
       if (!result)
-        ThrowError(desiredType);
+        ExpectError(desiredType);
 
       return result;
     }
 
-    bool Expect(const Token* desiredType, Token* token = nullptr) // 
+    bool Expect(const Token* desiredType, Token* token = nullptr) //
 	{
 		bool result = this->Accept(desiredType->mEnumTokenType, token);
 		if (!result)
-          ThrowError(desiredType->mEnumTokenType);
+          ExpectError(desiredType->mEnumTokenType);
 
 		return result;
 	}
 
-    bool Accept(const TokenType::Enum& desiredType, Token* token = nullptr) // 
+    bool Accept(const TokenType::Enum& desiredType, Token* token = nullptr) //
     {
         bool result = m_currentToken.mEnumTokenType == desiredType;
         if (result)
@@ -139,7 +351,8 @@ private:
           if(token)
             *token = m_currentToken;
 
-          PrintRule::AcceptedToken(desiredType);
+          if (m_tracing)
+            PrintRule::AcceptedToken(desiredType);
 
           ++m_tokenPos;
           GetCurrentToken();
@@ -152,664 +365,960 @@ private:
 	{
 		if (m_tokenStream && m_tokenPos < m_tokenStream->size())
 			m_currentToken = (*m_tokenStream)[m_tokenPos];
+		// Past the end the current token is Invalid, so truncated input fails instead of
+		// accepting the last token over and over (and recovery's skipping comes to an end)
+		else
+			m_currentToken = Token();
 	}
 
-    #pragma region ParserRules
-    //Rule Functions
+    bool Peek(TokenType::Enum type) const
+    {
+      return m_currentToken.mEnumTokenType == type;
+    }
 
+    template <typename T>
+    AstPtr<T> Create()
+    {
+      return m_arena->Create<T>();
+    }
 
-    unique_ptr<StatementNode> Statement()  
+    // Hands the arena over to the finished tree, which deletes it along with itself
+    // A failed parse leaves the arena with the parser, which frees whatever was built
+    template <typename T>
+    AstPtr<T> Finish(AstPtr<T> root)
     {
-	    PrintRule rule("Statement");
+      if (root)
+      {
+        m_arena->SetRoot(root.get());
+        m_arena.release();
+      }
 
-        unique_ptr<StatementNode> node = FreeStatement();
-        if (node == nullptr)
-        {
-          node = DelimitedStatement();
-          if(node)
-            this->Expect(TokenType::Semicolon);
-        }
+      return root;
+    }
 
-        RETURN_NODE(rule, node);
+    template <typename T>
+    static AstPtr<T> Take(AstPtr<AbstractNode> node)
+    {
+      return AstPtr<T>(static_cast<T*>(node.release()));
     }
 
-    unique_ptr<ClassNode> Class()//  
+    template <typename T>
+    static T* Get(ParseFrame& frame)
     {
-	    PrintRule rule("Class");
-	    if (!this->Accept(TokenType::Class))
-		    return false;
+      return static_cast<T*>(frame.mNode.get());
+    }
 
-        unique_ptr<ClassNode> node = make_unique<ClassNode>();
+    #pragma region ParseMachine
+    // Runs rules off of m_frames until the starting rule returns
+    AstPtr<AbstractNode> Run(ParseRule::Enum start)
+    {
+      Enter(start);
+      while (!m_failed && !m_frames.Empty())
+      {
+        Step(m_frames.Top());
 
-	    this->Expect(TokenType::Identifier, &node->mName);
-	    this->Expect(TokenType::OpenCurley);
+        if (m_failed && m_diagnostics)
+          Recover();
+      }
 
-        for (unsigned i = 0; i == node->mMembers.size(); ++i)
-        {
-          if (node->mMembers.push_back(Var()))
-            this->Expect(TokenType::Semicolon);
-          else
-            node->mMembers.push_back(Function());
-        }
+      if (m_failed)
+      {
+        // Popped while PrintRule is still failing, so the trace ends the same way an exception would end it
+        m_frames.Clear();
+        m_result = nullptr;
+        if (m_tracing)
+          PrintRule::SetFailing(false);
+      }
 
-        this->Expect(TokenType::CloseCurley);
-	    RETURN_NODE(rule, node)
+      return std::move(m_result);
     }
 
-    unique_ptr<VariableNode> Var()
+    void Enter(ParseRule::Enum rule)
     {
-	    PrintRule rule("Var");
-	    if (!this->Accept(TokenType::Var))
-		    return false;
+      if (m_frames.Size() >= m_maxDepth)
+        return Fail("Input is nested too deeply to parse.");
 
-        unique_ptr<VariableNode> node = make_unique<VariableNode>();
-	
-	    this->Expect(TokenType::Identifier, &node->mName);
-	
-        node->mType = SpecifiedType();
+      m_frames.Push(rule, m_tracing);
+    }
 
-        if (node->mType == nullptr)
-          throw ParsingException();
+    // Suspends the frame until 'rule' returns, then resumes it at 'state' with the result in m_result
+    // When 'enter' is false the rule is known to fail without accepting anything, so it is skipped
+    // The frame reference is not valid after this call
+    void Call(ParseFrame& frame, unsigned state, ParseRule::Enum rule, bool enter = true)
+    {
+      if (m_failed)
+        return;
 
-        if (this->Accept(TokenType::Assignment))
-        {
-          node->mInitialValue = Expression();
-          
-          if (node->mInitialValue == nullptr)
-            throw ParsingException();
-        }
+      frame.mState = state;
+      m_result = nullptr;
+      if (enter)
+        Enter(rule);
+    }
 
-        RETURN_NODE(rule, node)
+    // Finishes the rule on top of the stack (accepting it when the node is valid)
+    // After an error the frame is left for Run to pop
+    template <typename T>
+    void Return(AstPtr<T> node)
+    {
+      if (m_failed)
+        return;
+
+      PrintRule* trace = m_frames.Top().mTrace;
+      if (trace)
+        trace->Accept(node != nullptr);
+      m_result = std::move(node);
+      m_frames.Pop();
     }
 
-    unique_ptr<FunctionNode> Function()  
+    template <typename T>
+    AstPtr<T> Result()
     {
-	    PrintRule rule("Function");
-	    if (!this->Accept(TokenType::Function))
-		    return false;
-
-        unique_ptr<FunctionNode> node = make_unique<FunctionNode>();
-
-        this->Expect(TokenType::Identifier, &node->mName);
-	    this->Expect(TokenType::OpenParentheses);
-		
-	    if (node->mParameters.push_back(Parameter()))
-	    {
-            unsigned i = 1; 
-		    while (this->Accept(TokenType::Comma) && node->mParameters.size() == i)
-		    {
-                ++i;
-                node->mParameters.push_back(Parameter());
-		    }
-			
-            if (node->mParameters.size() != i)
-			    throw ParsingException("Missing a parameter in function.");
-	    }
-
-	    this->Expect(TokenType::CloseParentheses);
-
-	    node->mReturnType = SpecifiedType(); //return type
-
-        node->mScope = Scope();
-	    return rule.Accept(std::move(node));
+      return Take<T>(std::move(m_result));
     }
 
-    unique_ptr<ParameterNode> Parameter()
+    void Step(ParseFrame& frame)
     {
-	    PrintRule rule("Parameter");
-        unique_ptr<ParameterNode> node = make_unique<ParameterNode>();
+      switch (frame.mRule)
+      {
+        case ParseRule::Block:              return Block(frame);
+        case ParseRule::Class:              return Class(frame);
+        case ParseRule::Var:                return Var(frame);
+        case ParseRule::Function:           return Function(frame);
+        case ParseRule::Scope:              return Scope(frame);
+        case ParseRule::Statement:          return Statement(frame);
+        case ParseRule::DelimitedStatement: return DelimitedStatement(frame);
+        case ParseRule::FreeStatement:      return FreeStatement(frame);
+        case ParseRule::Return:             return Return(frame);
+        case ParseRule::If:                 return If(frame);
+        case ParseRule::Else:               return Else(frame);
+        case ParseRule::While:              return While(frame);
+        case ParseRule::For:                return For(frame);
+        case ParseRule::GroupedExpression:  return GroupedExpression(frame);
+        case ParseRule::Expression:         return Expression(frame);
+        case ParseRule::Expression6:        return Expression6(frame);
+        case ParseRule::Expression7:        return Expression7(frame);
+        case ParseRule::Value:              return Value(frame);
+        case ParseRule::Call:               return Call(frame);
+        case ParseRule::Index:              return Index(frame);
+        default:                            return BinaryExpression(frame);
+      }
+    }
+    #pragma endregion
 
-        if (this->Accept(TokenType::Identifier, &node->mName))
-        {
-          node->mType = SpecifiedType();
-        }
-        else
+    #pragma region ErrorRecovery
+    // Panic mode: skip to a token that a Scope, Class or Block can carry on from and leave an ErrorNode in its place
+    void Recover()
+    {
+      m_failed = false;
+      if (m_tracing)
+        PrintRule::SetFailing(false);
+
+      // Most rules fail without a message, so describe the token we stopped at
+      std::string message = lastError;
+      if (message.empty())
+        message = "Unexpected " + DescribeCurrentToken();
+
+      // An error at the same token as the last one is fallout from the same mistake
+      if (m_tokenPos != m_lastErrorPos)
+      {
+        ParseDiagnostic diagnostic;
+        diagnostic.mMessage = message;
+        diagnostic.mTokenIndex = m_tokenPos;
+        m_diagnostics->push_back(diagnostic);
+        m_lastErrorPos = m_tokenPos;
+      }
+
+      SkipToSynchronizingToken();
+
+      AstPtr<ErrorNode> errorNode = Create<ErrorNode>();
+      errorNode->mMessage = message;
+
+      for (;;)
+      {
+        ParseFrame& frame = m_frames.Top();
+        bool atEnd = m_tokenPos >= m_tokenStream->size();
+        switch (frame.mRule)
         {
-          node = nullptr;
-        }
+          case ParseRule::Block:
+            // A closing curley means nothing at the global level, so keep skipping
+            while (m_tokenPos < m_tokenStream->size() && Peek(TokenType::CloseCurley))
+            {
+              Skip();
+              SkipToSynchronizingToken();
+            }
 
-        RETURN_NODE(rule, node);
-    }
+            frame.mState = 1;
+            m_result = std::move(errorNode);
+            return;
 
-    unique_ptr<TypeNode> SpecifiedType()
-    {
-	    PrintRule rule("SpecifiedType");
-	    if (!this->Accept(TokenType::Colon))
-		    return nullptr;
+          case ParseRule::Class:
+            if (!atEnd && !Peek(TokenType::Class))
+            {
+              frame.mState = 2;
+              m_result = std::move(errorNode);
+              return;
+            }
 
-        unique_ptr<TypeNode> node = Type();
+            // The class was never closed, so keep what we have of it and let the Block continue
+            Get<ClassNode>(frame)->mMembers.push_back(std::move(errorNode));
+            return Return(std::move(frame.mNode));
 
-        if (node == nullptr)
-          throw ParsingException();
+          case ParseRule::Scope:
+            if (!atEnd && !Peek(TokenType::Class) && !Peek(TokenType::Function))
+            {
+              frame.mState = 1;
+              m_result = std::move(errorNode);
+              return;
+            }
 
-        RETURN_NODE(rule, node);
+            Get<ScopeNode>(frame)->mStatements.push_back(std::move(errorNode));
+            return Return(std::move(frame.mNode));
+
+          default:
+            // The partially parsed statement or expression is dropped
+            m_frames.Pop();
+            break;
+        }
+      }
     }
 
-    unique_ptr<ScopeNode> Scope()  
+    // Skips until just past a ';' or a balanced '{ }', or until a '}', 'class' or 'function' that an enclosing rule can use
+    void SkipToSynchronizingToken()
     {
-	    PrintRule rule("Scope");
-	    if (!this->Accept(TokenType::OpenCurley))
-		    return nullptr;
+      int depth = 0;
+      while (m_tokenPos < m_tokenStream->size())
+      {
+        TokenType::Enum type = m_currentToken.mEnumTokenType;
+        if (depth == 0)
+        {
+          if (type == TokenType::CloseCurley || type == TokenType::Class || type == TokenType::Function)
+            return;
 
-        unique_ptr<ScopeNode> node = make_unique<ScopeNode>();
+          if (type == TokenType::Semicolon)
+          {
+            Skip();
+            return;
+          }
+        }
 
-	    while(node->mStatements.push_back(Statement()));
+        Skip();
 
-        this->Expect(TokenType::CloseCurley);
-        RETURN_NODE(rule, node);
+        if (type == TokenType::OpenCurley)
+          ++depth;
+        else if (type == TokenType::CloseCurley && --depth == 0)
+          return;
+      }
     }
 
-    unique_ptr<StatementNode> DelimitedStatement()  
+    // Moves past a token without accepting it into the trace
+    void Skip()
     {
-	    PrintRule rule("DelimitedStatement");
-        unique_ptr<StatementNode> node = Label();
-
-        if (node == nullptr)
-          node = Goto();
+      ++m_tokenPos;
+      GetCurrentToken();
+    }
+    #pragma endregion
 
-        if (node == nullptr)
-          node = Return();
+    #pragma region ParserRules
+    //Rule Functions
 
-        if (node == nullptr && this->Accept(TokenType::Break))
-          node = make_unique<BreakNode>();
+    void Block(ParseFrame& frame)
+    {
+      BlockNode* node = Get<BlockNode>(frame);
+      switch (frame.mState)
+      {
+        case 0:
+          frame.mNode = Create<BlockNode>();
+          if (m_tokenStream->size())
+            return Call(frame, 1, ParseRule::Class, Peek(TokenType::Class));
+          break;
+
+        case 1:
+          if (node->mGlobals.push_back(Result<AbstractNode>()))
+            return Call(frame, 1, ParseRule::Class, Peek(TokenType::Class));
+          return Call(frame, 2, ParseRule::Function, Peek(TokenType::Function));
+
+        case 2:
+          if (node->mGlobals.push_back(Result<AbstractNode>()))
+            return Call(frame, 1, ParseRule::Class, Peek(TokenType::Class));
+          return Call(frame, 3, ParseRule::Var, Peek(TokenType::Var));
+
+        case 3:
+          if (node->mGlobals.push_back(Result<AbstractNode>()) && this->Expect(TokenType::Semicolon))
+            return Call(frame, 1, ParseRule::Class, Peek(TokenType::Class));
+          if (m_failed)
+            return;
+          break;
+      }
 
-        if (node == nullptr && this->Accept(TokenType::Continue))
-          node = make_unique<ContinueNode>();
+      if (m_tokenPos > m_tokenStream->size())
+        return Fail("Too few tokens. Check syntax.");
 
-        if (node == nullptr)
-          node = Var();
+      // Without recovery trailing tokens have always been ignored
+      if (m_diagnostics && m_tokenPos < m_tokenStream->size())
+        return Fail("Expected a class, function or var.");
 
-        if (node == nullptr)
-          node = Expression();
+      Return(std::move(frame.mNode));
+    }
 
-        RETURN_NODE(rule, node);
+    void Statement(ParseFrame& frame)
+    {
+      switch (frame.mState)
+      {
+        case 0:
+          return Call(frame, 1, ParseRule::FreeStatement,
+            Peek(TokenType::If) || Peek(TokenType::While) || Peek(TokenType::For));
+
+        case 1:
+          if (m_result)
+            return Return(std::move(m_result));
+          return Call(frame, 2, ParseRule::DelimitedStatement, StartsDelimitedStatement(m_currentToken.mEnumTokenType));
+
+        default:
+          if (m_result && !this->Expect(TokenType::Semicolon))
+            return;
+          return Return(std::move(m_result));
+      }
     }
 
-    unique_ptr<StatementNode> FreeStatement()  
+    void Class(ParseFrame& frame)
     {
-	    PrintRule rule("FreeStatement");
+      ClassNode* node = Get<ClassNode>(frame);
+      switch (frame.mState)
+      {
+        case 0:
+          this->Accept(TokenType::Class);
+          frame.mNode = Create<ClassNode>();
+          node = Get<ClassNode>(frame);
 
-        unique_ptr<StatementNode> node = If();
-        if(node == nullptr)
-          node = While();
-        
-        if(node == nullptr)
-          node = For();
+          if (!this->Expect(TokenType::Identifier, &node->mName) || !this->Expect(TokenType::OpenCurley))
+            return;
+          return Call(frame, 1, ParseRule::Var, Peek(TokenType::Var));
 
-        RETURN_NODE(rule, node)
-    }
+        case 1:
+          if (node->mMembers.push_back(Result<AbstractNode>()))
+          {
+            if (!this->Expect(TokenType::Semicolon))
+              return;
+            return Call(frame, 1, ParseRule::Var, Peek(TokenType::Var));
+          }
+          return Call(frame, 2, ParseRule::Function, Peek(TokenType::Function));
 
-    unique_ptr<LabelNode> Label()  
-    {
-	    PrintRule rule("Label");
-	    if (!this->Accept(TokenType::Label))
-		    return nullptr;
+        default:
+          if (node->mMembers.push_back(Result<AbstractNode>()))
+            return Call(frame, 1, ParseRule::Var, Peek(TokenType::Var));
 
-        unique_ptr<LabelNode> node = make_unique<LabelNode>();
-        this->Expect(TokenType::Identifier, &node->mName);
-        RETURN_NODE(rule, node)
+          if (!this->Expect(TokenType::CloseCurley))
+            return;
+          return Return(std::move(frame.mNode));
+      }
     }
 
-    unique_ptr<GotoNode> Goto()  
+    void Var(ParseFrame& frame)
     {
-	    PrintRule rule("Goto");
-	    if (!this->Accept(TokenType::Goto))
-		    return false;
+      VariableNode* node = Get<VariableNode>(frame);
+      switch (frame.mState)
+      {
+        case 0:
+          this->Accept(TokenType::Var);
+          frame.mNode = Create<VariableNode>();
+          node = Get<VariableNode>(frame);
 
-        unique_ptr<GotoNode> node = make_unique<GotoNode>();
-        this->Expect(TokenType::Identifier, &node->mName);
-        RETURN_NODE(rule, node)
-    }
+          if (!this->Expect(TokenType::Identifier, &node->mName))
+            return;
 
-    unique_ptr<ReturnNode> Return()
-    {
-	    PrintRule rule("Return");
-	    if (!this->Accept(TokenType::Return))
-		    return nullptr;
+          node->mType = SpecifiedType();
 
-        unique_ptr<ReturnNode> node = make_unique<ReturnNode>();
-	    node->mReturnValue = Expression();
+          if (node->mType == nullptr)
+            return Fail();
 
-        RETURN_NODE(rule, node)
+          if (this->Accept(TokenType::Assignment))
+            return Call(frame, 1, ParseRule::Expression, StartsExpression(m_currentToken.mEnumTokenType));
+
+          return Return(std::move(frame.mNode));
+
+        default:
+          node->mInitialValue = Result<ExpressionNode>();
+
+          if (node->mInitialValue == nullptr)
+            return Fail();
+
+          return Return(std::move(frame.mNode));
+      }
     }
 
-    unique_ptr<IfNode> If() 
+    void Function(ParseFrame& frame)
     {
-	    PrintRule rule("If");
-        unique_ptr<IfNode> node = nullptr;
-        if (this->Accept(TokenType::If))
-        {
-          node = make_unique<IfNode>();
+      FunctionNode* node = Get<FunctionNode>(frame);
+      if (frame.mState == 0)
+      {
+        this->Accept(TokenType::Function);
+        frame.mNode = Create<FunctionNode>();
+        node = Get<FunctionNode>(frame);
 
-          node->mCondition = GroupedExpression();
-          node->mScope = Scope();
+        if (!this->Expect(TokenType::Identifier, &node->mName) || !this->Expect(TokenType::OpenParentheses))
+          return;
 
-          if (node->mScope == nullptr)
-            throw ParsingException();
-          
-          node->mElse = Else();
+        bool fParameters = node->mParameters.push_back(Parameter());
+        if (m_failed)
+          return;
+
+        if (fParameters)
+        {
+          unsigned i = 1;
+          while (this->Accept(TokenType::Comma) && node->mParameters.size() == i)
+          {
+            ++i;
+            node->mParameters.push_back(Parameter());
+            if (m_failed)
+              return;
+          }
+
+          if (node->mParameters.size() != i)
+            return Fail("Missing a parameter in function.");
         }
-        RETURN_NODE(rule, node)
+
+        if (!this->Expect(TokenType::CloseParentheses))
+          return;
+
+        node->mReturnType = SpecifiedType(); //return type
+        if (m_failed)
+          return;
+
+        return Call(frame, 1, ParseRule::Scope, Peek(TokenType::OpenCurley));
+      }
+
+      node->mScope = Result<ScopeNode>();
+      Return(std::move(frame.mNode));
     }
 
-    unique_ptr<IfNode> Else() 
+    AstPtr<ParameterNode> Parameter()
     {
-	    PrintRule rule("Else");
-        unique_ptr<IfNode> node = nullptr;
-        if (this->Accept(TokenType::Else))
+	    RuleTrace rule(m_tracing, "Parameter");
+        AstPtr<ParameterNode> node = Create<ParameterNode>();
+
+        if (this->Accept(TokenType::Identifier, &node->mName))
         {
-          node = If();
-          if (node == nullptr)
-          {
-            node = make_unique<IfNode>();
-            node->mScope = Scope();
-            if (node->mScope == nullptr)
-              throw ParsingException();
-          }
+          node->mType = SpecifiedType();
+          if (m_failed)
+            return nullptr;
+        }
+        else
+        {
+          node = nullptr;
         }
 
         RETURN_NODE(rule, node);
     }
 
-    unique_ptr<WhileNode> While() 
+    AstPtr<TypeNode> SpecifiedType()
     {
-	    PrintRule rule("While");
-	    if (!this->Accept(TokenType::While))
+	    RuleTrace rule(m_tracing, "SpecifiedType");
+	    if (!this->Accept(TokenType::Colon))
 		    return nullptr;
 
-        unique_ptr<WhileNode> node = make_unique<WhileNode>();
-        
-        node->mCondition = GroupedExpression();
-        node->mScope = Scope();
+        AstPtr<TypeNode> node = Type();
 
-        if (node->mCondition && node->mScope)
-          RETURN_NODE(rule, node)
-        else
-          throw ParsingException();
+        if (node == nullptr)
+        {
+          Fail();
+          return nullptr;
+        }
+
+        RETURN_NODE(rule, node);
     }
 
-    unique_ptr<ForNode> For()  
+    void Scope(ParseFrame& frame)
     {
-	    PrintRule rule("For");
-	    if (!this->Accept(TokenType::For))
-		    return nullptr;
+      ScopeNode* node = Get<ScopeNode>(frame);
+      if (frame.mState == 0)
+      {
+        this->Accept(TokenType::OpenCurley);
+        frame.mNode = Create<ScopeNode>();
+      }
+      else if (!node->mStatements.push_back(Result<StatementNode>()))
+      {
+        if (!this->Expect(TokenType::CloseCurley))
+          return;
+        return Return(std::move(frame.mNode));
+      }
+
+      // A statement never starts with the closing curley, so don't bother entering one
+      Call(frame, 1, ParseRule::Statement, !Peek(TokenType::CloseCurley));
+    }
+
+    void DelimitedStatement(ParseFrame& frame)
+    {
+      if (frame.mState != 0)
+        return Return(std::move(m_result));
+
+      switch (m_currentToken.mEnumTokenType)
+      {
+        case TokenType::Label:
+          return Return(Label());
+
+        case TokenType::Goto:
+          return Return(Goto());
+
+        case TokenType::Return:
+          return Call(frame, 1, ParseRule::Return);
+
+        case TokenType::Break:
+          this->Accept(TokenType::Break);
+          return Return(Create<BreakNode>());
+
+        case TokenType::Continue:
+          this->Accept(TokenType::Continue);
+          return Return(Create<ContinueNode>());
 
-        unique_ptr<ForNode> node = make_unique<ForNode>();
+        case TokenType::Var:
+          return Call(frame, 1, ParseRule::Var);
 
-	    this->Expect(TokenType::OpenParentheses);
+        default:
+          return Call(frame, 1, ParseRule::Expression, StartsExpression(m_currentToken.mEnumTokenType));
+      }
+    }
 
-        node->mInitialVariable = Var();
-	    if (node->mInitialVariable == nullptr)
-		    node->mInitialExpression = Expression();
+    void FreeStatement(ParseFrame& frame)
+    {
+      if (frame.mState != 0)
+        return Return(std::move(m_result));
 
-	    this->Expect(TokenType::Semicolon); //first
-        node->mCondition = Expression();
+      if (Peek(TokenType::If))
+        return Call(frame, 1, ParseRule::If);
 
-	    this->Expect(TokenType::Semicolon); //second
-	    node->mIterator = Expression();
+      if (Peek(TokenType::While))
+        return Call(frame, 1, ParseRule::While);
 
-        this->Expect(TokenType::CloseParentheses);
+      Call(frame, 1, ParseRule::For, Peek(TokenType::For));
+    }
 
-        node->mScope = Scope();
+    AstPtr<LabelNode> Label()
+    {
+	    RuleTrace rule(m_tracing, "Label");
+	    if (!this->Accept(TokenType::Label))
+		    return nullptr;
+
+        AstPtr<LabelNode> node = Create<LabelNode>();
+        if (!this->Expect(TokenType::Identifier, &node->mName))
+          return nullptr;
         RETURN_NODE(rule, node)
     }
 
-    unique_ptr<ExpressionNode> GroupedExpression()  
+    AstPtr<GotoNode> Goto()
     {
-	    PrintRule rule("GroupedExpression");
-	    if (!this->Accept(TokenType::OpenParentheses))
+	    RuleTrace rule(m_tracing, "Goto");
+	    if (!this->Accept(TokenType::Goto))
 		    return nullptr;
 
-        unique_ptr<ExpressionNode> node = Expression();
-        this->Expect(TokenType::CloseParentheses);
-	    RETURN_NODE(rule, node)
+        AstPtr<GotoNode> node = Create<GotoNode>();
+        if (!this->Expect(TokenType::Identifier, &node->mName))
+          return nullptr;
+        RETURN_NODE(rule, node)
     }
 
-    #pragma region expressions
+    void Return(ParseFrame& frame)
+    {
+      if (frame.mState == 0)
+      {
+        this->Accept(TokenType::Return);
+        frame.mNode = Create<ReturnNode>();
+        return Call(frame, 1, ParseRule::Expression, StartsExpression(m_currentToken.mEnumTokenType));
+      }
 
-    unique_ptr<ExpressionNode> Expression1()
+      Get<ReturnNode>(frame)->mReturnValue = Result<ExpressionNode>();
+      Return(std::move(frame.mNode));
+    }
+
+    void If(ParseFrame& frame)
     {
-      PrintRule rule("Expression1");
-      unique_ptr<ExpressionNode> node = Expression2();
-      if (node != nullptr)
+      IfNode* node = Get<IfNode>(frame);
+      switch (frame.mState)
       {
-        bool fOp = false;
-        unique_ptr<BinaryOperatorNode> binaryOp, tempOp;
-        do
-        {
-          if (fOp)
-          {
-            tempOp->mLeft = Expression2();
+        case 0:
+          this->Accept(TokenType::If);
+          frame.mNode = Create<IfNode>();
+          return Call(frame, 1, ParseRule::GroupedExpression, Peek(TokenType::OpenParentheses));
 
-            if (tempOp->mLeft == nullptr)
-              throw ParsingException();
+        case 1:
+          node->mCondition = Result<ExpressionNode>();
+          return Call(frame, 2, ParseRule::Scope, Peek(TokenType::OpenCurley));
 
-            if (binaryOp)
-              tempOp->mRight = std::move(binaryOp);
-            else
-              tempOp->mRight = std::move(node);
+        case 2:
+          node->mScope = Result<ScopeNode>();
 
-            binaryOp = std::move(tempOp);
-          }
+          if (node->mScope == nullptr)
+            return Fail();
 
-          tempOp = make_unique<BinaryOperatorNode>();
-          fOp = Accept(TokenType::LogicalOr, &tempOp->mOperator);
-        } while (fOp);
+          return Call(frame, 3, ParseRule::Else, Peek(TokenType::Else));
 
-        if (binaryOp)
-        {
-          RETURN_NODE(rule, binaryOp)
-        }
+        default:
+          node->mElse = Result<IfNode>();
+          return Return(std::move(frame.mNode));
       }
-      RETURN_NODE(rule, node)
     }
 
-    unique_ptr<ExpressionNode> Expression2()
+    void Else(ParseFrame& frame)
     {
-	    PrintRule rule("Expression2");
-        unique_ptr<ExpressionNode> node = Expression3();
+      switch (frame.mState)
+      {
+        case 0:
+          this->Accept(TokenType::Else);
+          return Call(frame, 1, ParseRule::If, Peek(TokenType::If));
 
-        if (node != nullptr)
-        {
-          bool fOp = false;
-          unique_ptr<BinaryOperatorNode> binaryOp, tempOp;
-          do
-          {
-            if (fOp)
-            {
-              tempOp->mLeft = Expression3();
+        case 1:
+          if (m_result)
+            return Return(std::move(m_result));
 
-              if (tempOp->mLeft == nullptr)
-                throw ParsingException();
+          frame.mNode = Create<IfNode>();
+          return Call(frame, 2, ParseRule::Scope, Peek(TokenType::OpenCurley));
 
-              if (binaryOp)
-                tempOp->mRight = std::move(binaryOp);
-              else
-                tempOp->mRight = std::move(node);
+        default:
+          Get<IfNode>(frame)->mScope = Result<ScopeNode>();
+          if (Get<IfNode>(frame)->mScope == nullptr)
+            return Fail();
 
-              binaryOp = std::move(tempOp);
-            }
+          return Return(std::move(frame.mNode));
+      }
+    }
 
-            tempOp = make_unique<BinaryOperatorNode>();
-            fOp = Accept(TokenType::LogicalAnd, &tempOp->mOperator);
-          } while (fOp);
+    void While(ParseFrame& frame)
+    {
+      WhileNode* node = Get<WhileNode>(frame);
+      switch (frame.mState)
+      {
+        case 0:
+          this->Accept(TokenType::While);
+          frame.mNode = Create<WhileNode>();
+          return Call(frame, 1, ParseRule::GroupedExpression, Peek(TokenType::OpenParentheses));
 
-          if (binaryOp)
-          {
-            RETURN_NODE(rule, binaryOp)
-          }
-        }
+        case 1:
+          node->mCondition = Result<ExpressionNode>();
+          return Call(frame, 2, ParseRule::Scope, Peek(TokenType::OpenCurley));
 
-        RETURN_NODE(rule, node)
+        default:
+          node->mScope = Result<ScopeNode>();
+
+          if (node->mCondition && node->mScope)
+            return Return(std::move(frame.mNode));
+          else
+            return Fail();
+      }
     }
 
-    unique_ptr<ExpressionNode> Expression3()
+    void For(ParseFrame& frame)
     {
-	    PrintRule rule("Expression3");
-        unique_ptr<ExpressionNode> node = Expression4();
-        if (node != nullptr)
-        {
-          bool fOp = false;
-          unique_ptr<BinaryOperatorNode> binaryOp, tempOp;
-          do
-          {
-            if (fOp)
-            {
-              tempOp->mLeft = Expression4();
+      ForNode* node = Get<ForNode>(frame);
+      switch (frame.mState)
+      {
+        case 0:
+          this->Accept(TokenType::For);
+          frame.mNode = Create<ForNode>();
 
-              if (tempOp->mLeft == nullptr)
-                throw ParsingException();
+          if (!this->Expect(TokenType::OpenParentheses))
+            return;
+          return Call(frame, 1, ParseRule::Var, Peek(TokenType::Var));
 
-              if (binaryOp)
-                tempOp->mRight = std::move(binaryOp);
-              else
-                tempOp->mRight = std::move(node);
+        case 1:
+          node->mInitialVariable = Result<VariableNode>();
+          return Call(frame, 2, ParseRule::Expression,
+            node->mInitialVariable == nullptr && StartsExpression(m_currentToken.mEnumTokenType));
 
-              binaryOp = std::move(tempOp);
-            }
+        case 2:
+          node->mInitialExpression = Result<ExpressionNode>();
 
-            tempOp = make_unique<BinaryOperatorNode>();
+          if (!this->Expect(TokenType::Semicolon)) //first
+            return;
+          return Call(frame, 3, ParseRule::Expression, StartsExpression(m_currentToken.mEnumTokenType));
 
-            fOp = this->Accept(TokenType::LessThan, &tempOp->mOperator)
-               || this->Accept(TokenType::GreaterThan, &tempOp->mOperator)
-               || this->Accept(TokenType::LessThanOrEqualTo, &tempOp->mOperator)
-               || this->Accept(TokenType::GreaterThanOrEqualTo, &tempOp->mOperator)
-               || this->Accept(TokenType::Equality, &tempOp->mOperator)
-               || this->Accept(TokenType::Inequality, &tempOp->mOperator);
-          } while (fOp);
+        case 3:
+          node->mCondition = Result<ExpressionNode>();
 
-          if (binaryOp)
-          {
-            RETURN_NODE(rule, binaryOp)
-          }
-        }
+          if (!this->Expect(TokenType::Semicolon)) //second
+            return;
+          return Call(frame, 4, ParseRule::Expression, StartsExpression(m_currentToken.mEnumTokenType));
 
-        RETURN_NODE(rule, node)
+        case 4:
+          node->mIterator = Result<ExpressionNode>();
+
+          if (!this->Expect(TokenType::CloseParentheses))
+            return;
+          return Call(frame, 5, ParseRule::Scope, Peek(TokenType::OpenCurley));
+
+        default:
+          node->mScope = Result<ScopeNode>();
+          return Return(std::move(frame.mNode));
+      }
     }
 
-    unique_ptr<ExpressionNode> Expression4()
+    void GroupedExpression(ParseFrame& frame)
     {
-	    PrintRule rule("Expression4");
-        unique_ptr<ExpressionNode> node = Expression5();
-        if (node != nullptr)
-        {
+      if (frame.mState == 0)
+      {
+        this->Accept(TokenType::OpenParentheses);
+        return Call(frame, 1, ParseRule::Expression, StartsExpression(m_currentToken.mEnumTokenType));
+      }
 
-          bool fOp = false;
-          unique_ptr<BinaryOperatorNode> binaryOp, tempOp;
-          do
-          {
-            if (fOp)
-            {
-              tempOp->mLeft = Expression5();
+      if (this->Expect(TokenType::CloseParentheses))
+        Return(std::move(m_result));
+    }
+
+    #pragma region expressions
 
-              if (tempOp->mLeft == nullptr)
-                throw ParsingException();
+    // Right to left: the left hand side is parsed first and then becomes mRight of the assignment
+    void Expression(ParseFrame& frame)
+    {
+      if (frame.mState == 0)
+        return Call(frame, 1, ParseRule::Expression1);
+
+      if (frame.mState == 2)
+      {
+        BinaryOperatorNode* opNode = Get<BinaryOperatorNode>(frame);
+        opNode->mLeft = Result<ExpressionNode>();
+        if (opNode->mLeft == nullptr)
+          return Fail();
 
-              if (binaryOp)
-                tempOp->mRight = std::move(binaryOp);
-              else
-                tempOp->mRight = std::move(node);
+        return Return(std::move(frame.mNode));
+      }
 
-              binaryOp = std::move(tempOp);
-            }
+      if (m_result == nullptr)
+        return Return(std::move(m_result));
 
-            tempOp = make_unique<BinaryOperatorNode>();
-            fOp = this->Accept(TokenType::Plus, &tempOp->mOperator) || this->Accept(TokenType::Minus, &tempOp->mOperator);
-          } while (fOp);
+      Token op;
+      if(  this->Accept(TokenType::Assignment, &op)
+        || this->Accept(TokenType::AssignmentPlus, &op)
+        || this->Accept(TokenType::AssignmentMinus, &op)
+        || this->Accept(TokenType::AssignmentMultiply, &op)
+        || this->Accept(TokenType::AssignmentDivide, &op)
+        || this->Accept(TokenType::AssignmentModulo, &op))
+      {
+        AstPtr<BinaryOperatorNode> opNode = Create<BinaryOperatorNode>();
+        opNode->mOperator = op;
+        opNode->mRight = Result<ExpressionNode>();
+        frame.mNode = std::move(opNode);
 
-          if (binaryOp)
-          {
-            RETURN_NODE(rule, binaryOp)
-          }
-        }
+        return Call(frame, 2, ParseRule::Expression, StartsExpression(m_currentToken.mEnumTokenType));
+      }
 
-        RETURN_NODE(rule, node)
+      Return(std::move(m_result));
     }
 
-    unique_ptr<ExpressionNode> Expression5()
+    // Accepts an operator belonging to one of the left associative binary precedence levels
+    bool AcceptBinaryOperator(ParseRule::Enum rule, Token* op)
     {
-	    PrintRule rule("Expression5");
-        unique_ptr<ExpressionNode> node = Expression6();
-        if (node != nullptr)
-        {
-          bool fOp = false;
-          unique_ptr<BinaryOperatorNode> binaryOp, tempOp;
-          do
-          {
-            if (fOp)
-            {
-              tempOp->mLeft = Expression6();
+      switch (rule)
+      {
+        case ParseRule::Expression1:
+          return this->Accept(TokenType::LogicalOr, op);
+
+        case ParseRule::Expression2:
+          return this->Accept(TokenType::LogicalAnd, op);
+
+        case ParseRule::Expression3:
+          return this->Accept(TokenType::LessThan, op)
+              || this->Accept(TokenType::GreaterThan, op)
+              || this->Accept(TokenType::LessThanOrEqualTo, op)
+              || this->Accept(TokenType::GreaterThanOrEqualTo, op)
+              || this->Accept(TokenType::Equality, op)
+              || this->Accept(TokenType::Inequality, op);
+
+        case ParseRule::Expression4:
+          return this->Accept(TokenType::Plus, op)
+              || this->Accept(TokenType::Minus, op);
+
+        default:
+          return this->Accept(TokenType::Asterisk, op)
+              || this->Accept(TokenType::Divide, op)
+              || this->Accept(TokenType::Modulo, op);
+      }
+    }
 
-              if (tempOp->mLeft == nullptr)
-                throw ParsingException();
+    // Expression1 through Expression5 (left to right)
+    // Each new operator takes the chain built so far as mRight and the next operand as mLeft
+    void BinaryExpression(ParseFrame& frame)
+    {
+      ParseRule::Enum operand = static_cast<ParseRule::Enum>(frame.mRule + 1);
+      switch (frame.mState)
+      {
+        case 0:
+          return Call(frame, 1, operand);
 
-              if (binaryOp)
-                tempOp->mRight = std::move(binaryOp);
-              else
-                tempOp->mRight = std::move(node);
+        case 1:
+          if (m_result == nullptr)
+            return Return(std::move(m_result));
 
-              binaryOp = std::move(tempOp);
-            }
+          frame.mNode = std::move(m_result);
+          break;
 
-            tempOp = make_unique<BinaryOperatorNode>();
-            fOp = this->Accept(TokenType::Asterisk, &tempOp->mOperator)
-              || this->Accept(TokenType::Divide, &tempOp->mOperator)
-              || this->Accept(TokenType::Modulo, &tempOp->mOperator);
-          } while (fOp);
+        default:
+        {
+          BinaryOperatorNode* tempOp = Get<BinaryOperatorNode>(frame);
+          tempOp->mLeft = Result<ExpressionNode>();
 
-          if (binaryOp)
-          {
-            RETURN_NODE(rule, binaryOp)
-          }
+          if (tempOp->mLeft == nullptr)
+            return Fail();
+          break;
         }
+      }
 
-        RETURN_NODE(rule, node)
+      Token op;
+      if (!AcceptBinaryOperator(frame.mRule, &op))
+        return Return(std::move(frame.mNode));
+
+      AstPtr<BinaryOperatorNode> tempOp = Create<BinaryOperatorNode>();
+      tempOp->mOperator = op;
+      tempOp->mRight = Take<ExpressionNode>(std::move(frame.mNode));
+      frame.mNode = std::move(tempOp);
+      Call(frame, 2, operand);
     }
 
-    unique_ptr<ExpressionNode> Expression6()
+    // Prefix operators are collected into a chain hanging off of mNode, and the operand goes on the innermost one
+    void Expression6(ParseFrame& frame)
     {
-	    PrintRule rule("Expression6");
-        
-        bool fOp = false;
-        unique_ptr<UnaryOperatorNode> unaryOp = make_unique<UnaryOperatorNode>();
-
-        UnaryOperatorNode* tempOp = unaryOp.get();
-        UnaryOperatorNode* end = tempOp;
-        do
+      if (frame.mState == 0)
+      {
+        Token op;
+        while (this->Accept(TokenType::Asterisk, &op)
+            || this->Accept(TokenType::BitwiseAndAddressOf, &op)
+            || this->Accept(TokenType::Plus, &op)
+            || this->Accept(TokenType::Minus, &op)
+            || this->Accept(TokenType::LogicalNot, &op)
+            || this->Accept(TokenType::Increment, &op)
+            || this->Accept(TokenType::Decrement, &op))
         {
-          fOp = this->Accept(TokenType::Asterisk, &tempOp->mOperator)
-             || this->Accept(TokenType::BitwiseAndAddressOf, &tempOp->mOperator)
-             || this->Accept(TokenType::Plus, &tempOp->mOperator)
-             || this->Accept(TokenType::Minus, &tempOp->mOperator)
-             || this->Accept(TokenType::LogicalNot, &tempOp->mOperator)
-             || this->Accept(TokenType::Increment, &tempOp->mOperator)
-             || this->Accept(TokenType::Decrement, &tempOp->mOperator);
-        
-          if (fOp && tempOp->mOperator)
-          {
-            end = tempOp;
-            tempOp->mRight = make_unique<UnaryOperatorNode>();
-            tempOp = dynamic_cast<UnaryOperatorNode*>(tempOp->mRight.get());
-          }
-        } while (fOp);
+          AstPtr<UnaryOperatorNode> unaryOp = Create<UnaryOperatorNode>();
+          unaryOp->mOperator = op;
+          UnaryOperatorNode* tail = unaryOp.get();
 
-        end->mRight = Expression7();
-        
-        if (end->mRight == nullptr)
-          RETURN_NODE(rule, end->mRight)
-        else
-        {
-          if (unaryOp->mOperator)
-            RETURN_NODE(rule, unaryOp)
+          if (frame.mTail)
+            frame.mTail->mRight = std::move(unaryOp);
           else
-            RETURN_NODE(rule, tempOp->mRight)
+            frame.mNode = std::move(unaryOp);
+
+          frame.mTail = tail;
         }
+
+        return Call(frame, 1, ParseRule::Expression7);
+      }
+
+      if (m_result == nullptr || frame.mTail == nullptr)
+        return Return(std::move(m_result));
+
+      frame.mTail->mRight = Result<ExpressionNode>();
+      Return(std::move(frame.mNode));
     }
 
-    unique_ptr<ExpressionNode> Expression7()
+    void Expression7(ParseFrame& frame)
     {
-	    PrintRule rule("Expression7");
-        unique_ptr<ExpressionNode> node = Value();
-        
-        if (node != nullptr)
+      switch (frame.mState)
+      {
+        case 0:
+          return Call(frame, 1, ParseRule::Value);
+
+        case 1:
+          if (m_result == nullptr)
+            return Return(std::move(m_result));
+
+          frame.mNode = std::move(m_result);
+          break;
+
+        default:
         {
-          unique_ptr<PostExpressionNode> postExpr, tempPE;
-          do
-          {
-            if (tempPE)
-            {
-              if (postExpr)
-                tempPE->mLeft = std::move(postExpr);
-              else
-                tempPE->mLeft = std::move(node);
+          AstPtr<PostExpressionNode> tempPE = Result<PostExpressionNode>();
+          tempPE->mLeft = Take<ExpressionNode>(std::move(frame.mNode));
+          frame.mNode = std::move(tempPE);
+          break;
+        }
+      }
 
-              postExpr = std::move(tempPE);
-            }
+      // Member accesses and casts never nest, so they are parsed in place
+      for (;;)
+      {
+        AstPtr<PostExpressionNode> tempPE = MemberAccess();
+        if (tempPE == nullptr && Peek(TokenType::As))
+          tempPE = Cast();
 
-            tempPE = MemberAccess();
-            if (tempPE)
-              continue;
+        if (m_failed)
+          return;
 
-            tempPE = Call();
-            if (tempPE)
-              continue;
+        if (tempPE == nullptr)
+          break;
 
-            tempPE = Cast();
-            if (tempPE)
-              continue;
+        tempPE->mLeft = Take<ExpressionNode>(std::move(frame.mNode));
+        frame.mNode = std::move(tempPE);
+      }
 
-            tempPE = Index();
-          } while (tempPE);
+      if (Peek(TokenType::OpenParentheses))
+        return Call(frame, 2, ParseRule::Call);
 
-          if (postExpr)
-            RETURN_NODE(rule, postExpr)
-        }
+      if (Peek(TokenType::OpenBracket))
+        return Call(frame, 2, ParseRule::Index);
 
-        RETURN_NODE(rule, node)
+      Return(std::move(frame.mNode));
     }
 
-    unique_ptr<ExpressionNode> Value()  
+    void Value(ParseFrame& frame)
     {
-	    PrintRule rule("Value"); 
-        unique_ptr<ValueNode> node = make_unique<ValueNode>();
-
-	    bool fIsValue = this->Accept(TokenType::True, &node->mToken)
-		    || this->Accept(TokenType::False, &node->mToken)
-		    || this->Accept(TokenType::Null, &node->mToken)
-		    || this->Accept(TokenType::IntegerLiteral, &node->mToken)
-		    || this->Accept(TokenType::FloatLiteral, &node->mToken)
-		    || this->Accept(TokenType::StringLiteral, &node->mToken)
-            || this->Accept(TokenType::CharacterLiteral, &node->mToken)
-            || this->Accept(TokenType::Identifier, &node->mToken);
-       
-        //Talk to trevor about
-        if (!fIsValue)
-        {
-          unique_ptr<ExpressionNode> expr = GroupedExpression();
-          RETURN_NODE(rule, expr)
-        }
-        
-        RETURN_NODE(rule, node);
+      if (frame.mState != 0)
+        return Return(std::move(m_result));
+
+      Token value;
+	  bool fIsValue = this->Accept(TokenType::True, &value)
+		    || this->Accept(TokenType::False, &value)
+		    || this->Accept(TokenType::Null, &value)
+		    || this->Accept(TokenType::IntegerLiteral, &value)
+		    || this->Accept(TokenType::FloatLiteral, &value)
+		    || this->Accept(TokenType::StringLiteral, &value)
+            || this->Accept(TokenType::CharacterLiteral, &value)
+            || this->Accept(TokenType::Identifier, &value);
+
+      if (!fIsValue)
+        return Call(frame, 1, ParseRule::GroupedExpression, Peek(TokenType::OpenParentheses));
+
+      AstPtr<ValueNode> node = Create<ValueNode>();
+      node->mToken = value;
+      Return(std::move(node));
     }
 
-    unique_ptr<MemberAccessNode> MemberAccess()
+    AstPtr<MemberAccessNode> MemberAccess()
     {
-	    PrintRule rule("MemberAccess");
-        unique_ptr<MemberAccessNode> node = make_unique<MemberAccessNode>();
+      if (!Peek(TokenType::Dot) && !Peek(TokenType::Arrow))
+        return nullptr;
+
+	    RuleTrace rule(m_tracing, "MemberAccess");
+        AstPtr<MemberAccessNode> node = Create<MemberAccessNode>();
         if (!(this->Accept(TokenType::Dot, &node->mOperator) || this->Accept(TokenType::Arrow, &node->mOperator)))
           node = nullptr;
-        else
-          this->Expect(TokenType::Identifier, &node->mName);
+        else if (!this->Expect(TokenType::Identifier, &node->mName))
+          return nullptr;
 
         RETURN_NODE(rule, node)
     }
 
-    unique_ptr<CallNode> Call()  
+    void Call(ParseFrame& frame)
     {
-	    PrintRule rule("Call");
-        unique_ptr<CallNode> node = nullptr;
-        if (this->Accept(TokenType::OpenParentheses))
-        {
-          node = make_unique<CallNode>();
+      CallNode* node = Get<CallNode>(frame);
+      if (frame.mState == 0)
+      {
+        this->Accept(TokenType::OpenParentheses);
+        frame.mNode = Create<CallNode>();
+        return Call(frame, 1, ParseRule::Expression, StartsExpression(m_currentToken.mEnumTokenType));
+      }
 
-          bool fComma = false;
-	      do
-		  {
-            if (node->mArguments.push_back(Expression()) == false && fComma)
-              throw ParsingException("Missing a parameter in function.");
+      if (node->mArguments.push_back(Result<ExpressionNode>()) == false && frame.fComma)
+        return Fail("Missing a parameter in function.");
 
-            fComma = this->Accept(TokenType::Comma);
-          } while (fComma);
+      frame.fComma = this->Accept(TokenType::Comma);
+      if (frame.fComma)
+        return Call(frame, 1, ParseRule::Expression, StartsExpression(m_currentToken.mEnumTokenType));
 
-          this->Expect(TokenType::CloseParentheses);
-        }
-        RETURN_NODE(rule, node)
+      if (this->Expect(TokenType::CloseParentheses))
+        Return(std::move(frame.mNode));
     }
 
-    unique_ptr<TypeNode> Type()
+    AstPtr<TypeNode> Type()
     {
-      PrintRule rule("Type");
-      unique_ptr<TypeNode> node = make_unique<TypeNode>();
+      RuleTrace rule(m_tracing, "Type");
+      AstPtr<TypeNode> node = Create<TypeNode>();
       if (this->Accept(TokenType::Identifier, &node->mName))
       {
         node->mPointerCount = 0;
@@ -825,35 +1334,39 @@ private:
       RETURN_NODE(rule, node)
     }
 
-    unique_ptr<CastNode> Cast()
+    AstPtr<CastNode> Cast()
     {
-	    PrintRule rule("Cast");
-        unique_ptr<CastNode> node = nullptr;
+	    RuleTrace rule(m_tracing, "Cast");
+        AstPtr<CastNode> node = nullptr;
         if (this->Accept(TokenType::As))
         {
-          node = make_unique<CastNode>();
+          node = Create<CastNode>();
           node->mType = Type();
           if (node->mType == nullptr)
-            throw ParsingException();
+          {
+            Fail();
+            return nullptr;
+          }
         }
         RETURN_NODE(rule, node)
     }
 
-    unique_ptr<IndexNode> Index()
+    void Index(ParseFrame& frame)
     {
-	    PrintRule rule("Index");
-        unique_ptr<IndexNode> node = nullptr;
-        if (this->Accept(TokenType::OpenBracket))
-        {
-          node = make_unique<IndexNode>();
-          node->mIndex = Expression();
-          if (node->mIndex == nullptr)
-            throw ParsingException();
+      if (frame.mState == 0)
+      {
+        this->Accept(TokenType::OpenBracket);
+        frame.mNode = Create<IndexNode>();
+        return Call(frame, 1, ParseRule::Expression, StartsExpression(m_currentToken.mEnumTokenType));
+      }
 
-          this->Expect(TokenType::CloseBracket);
-        }
+      IndexNode* node = Get<IndexNode>(frame);
+      node->mIndex = Result<ExpressionNode>();
+      if (node->mIndex == nullptr)
+        return Fail();
 
-        RETURN_NODE(rule, node)
+      if (this->Expect(TokenType::CloseBracket))
+        Return(std::move(frame.mNode));
     }
 };
 
@@ -897,6 +1410,7 @@ public:
   virtual VisitResult Visit(BreakNode* node)          { return this->Visit((StatementNode*)node);      }
   virtual VisitResult Visit(ContinueNode* node)       { return this->Visit((StatementNode*)node);      }
   virtual VisitResult Visit(ReturnNode* node)         { return this->Visit((StatementNode*)node);      }
+  virtual VisitResult Visit(ErrorNode* node)          { return this->Visit((StatementNode*)node);      }
 };
 #pragma endregion
 
@@ -954,6 +1468,8 @@ public:
   VisitResult Visit(ContinueNode* node) override;
 
   VisitResult Visit(ReturnNode* node) override;
+
+  VisitResult Visit(ErrorNode* node) override;
   /*
   VisitResult Visit(PostExpressionNode* node) override;
   VisitResult Visit(CallNode* node) override;
@@ -1041,7 +1557,8 @@ VisitResult PrintVisitor::Visit(VariableNode* node)
 {
   PRINT_NODE("VariableNode(" << node->mName << ")")
   node->mType->Walk(this);
-  node->mInitialValue->Walk(this);
+  if (node->mInitialValue)
+    node->mInitialValue->Walk(this);
   return Stop;
 }
 
@@ -1190,6 +1707,12 @@ VisitResult PrintVisitor::Visit(ReturnNode* node)
 
   return Stop;
 }
+
+VisitResult PrintVisitor::Visit(ErrorNode* node)
+{
+  PRINT_NODE("ErrorNode(" << node->mMessage << ")")
+  return Stop;
+}
 #pragma endregion
 
 #pragma region walk
@@ -1316,6 +1839,13 @@ void ContinueNode::Walk(Visitor* visitor, bool visit)
     StatementNode::Walk(visitor, false);
 }
 
+void ErrorNode::Walk(Visitor* visitor, bool visit)
+{
+    WALK_INIT
+
+    StatementNode::Walk(visitor, false);
+}
+
 void ExpressionNode::Walk(Visitor* visitor, bool visit)
 {
     WALK_INIT
@@ -1447,42 +1977,503 @@ void PrintTree(AbstractNode* node)
   node->Walk(&printer);
 }
 
-unique_ptr<ExpressionNode> ParseExpression(std::vector<Token>& tokens)
+#pragma region FlattenVisitor
+// Appends nodes to a FlatAst
+// Every Visit returns Stop so that Walk never recurses; children are queued on a worklist instead
+class FlattenVisitor : public Visitor
+{
+public:
+  FlattenVisitor(FlatAst& flat) :
+    mFlat(flat)
+  {
+  }
+
+  void Run(AbstractNode* root)
+  {
+    mPending.push_back(PendingNode { root, FlatAst::None, FlatAst::None });
+    while (!mPending.empty())
+    {
+      mCurrent = mPending.back();
+      mPending.pop_back();
+      mCurrent.mNode->Walk(this);
+    }
+  }
+
+  VisitResult Visit(BlockNode* node) override
+  {
+    AddAll(node->mGlobals);
+    Add(NodeKind::Block);
+    return Stop;
+  }
+
+  VisitResult Visit(ClassNode* node) override
+  {
+    AddAll(node->mMembers);
+    Add(NodeKind::Class, &node->mName, node->mSymbol);
+    return Stop;
+  }
+
+  VisitResult Visit(VariableNode* node) override
+  {
+    mSlots = { node->mType.get(), node->mInitialValue.get() };
+    Add(NodeKind::Variable, &node->mName, node->mSymbol);
+    return Stop;
+  }
+
+  VisitResult Visit(ParameterNode* node) override
+  {
+    mSlots = { node->mType.get(), node->mInitialValue.get() };
+    Add(NodeKind::Parameter, &node->mName, node->mSymbol);
+    return Stop;
+  }
+
+  VisitResult Visit(ScopeNode* node) override
+  {
+    AddAll(node->mStatements);
+    Add(NodeKind::Scope);
+    return Stop;
+  }
+
+  VisitResult Visit(FunctionNode* node) override
+  {
+    AddAll(node->mParameters);
+    mSlots.push_back(node->mReturnType.get());
+    mSlots.push_back(node->mScope.get());
+    Add(NodeKind::Function, &node->mName, node->mSymbol, node->mSignatureType);
+    return Stop;
+  }
+
+  VisitResult Visit(TypeNode* node) override
+  {
+    Add(NodeKind::Type, &node->mName, node->mSymbol);
+    mFlat.mNodes.back().mExtra = (uint32_t)node->mPointerCount;
+    return Stop;
+  }
+
+  VisitResult Visit(LabelNode* node) override
+  {
+    Add(NodeKind::Label, &node->mName, node->mSymbol);
+    return Stop;
+  }
+
+  VisitResult Visit(GotoNode* node) override
+  {
+    Add(NodeKind::Goto, &node->mName, node->mResolvedLabel);
+    return Stop;
+  }
+
+  VisitResult Visit(ReturnNode* node) override
+  {
+    mSlots = { node->mReturnValue.get() };
+    Add(NodeKind::Return);
+    return Stop;
+  }
+
+  VisitResult Visit(BreakNode* node) override
+  {
+    Add(NodeKind::Break);
+    return Stop;
+  }
+
+  VisitResult Visit(ContinueNode* node) override
+  {
+    Add(NodeKind::Continue);
+    return Stop;
+  }
+
+  VisitResult Visit(ErrorNode* node) override
+  {
+    Add(NodeKind::Error);
+    mFlat.mNodes.back().mExtra = (uint32_t)mFlat.mMessages.size();
+    mFlat.mMessages.push_back(node->mMessage);
+    return Stop;
+  }
+
+  VisitResult Visit(IfNode* node) override
+  {
+    mSlots = { node->mCondition.get(), node->mScope.get(), node->mElse.get() };
+    Add(NodeKind::If);
+    return Stop;
+  }
+
+  VisitResult Visit(WhileNode* node) override
+  {
+    mSlots = { node->mCondition.get(), node->mScope.get() };
+    Add(NodeKind::While);
+    return Stop;
+  }
+
+  VisitResult Visit(ForNode* node) override
+  {
+    mSlots = { node->mInitialVariable.get(), node->mInitialExpression.get(), node->mCondition.get(), node->mIterator.get(), node->mScope.get() };
+    Add(NodeKind::For);
+    return Stop;
+  }
+
+  VisitResult Visit(ValueNode* node) override
+  {
+    Add(NodeKind::Value, &node->mToken, node->mResolvedSymbol, node->mResolvedType);
+    return Stop;
+  }
+
+  VisitResult Visit(BinaryOperatorNode* node) override
+  {
+    mSlots = { node->mLeft.get(), node->mRight.get() };
+    Add(NodeKind::BinaryOperator, &node->mOperator, nullptr, node->mResolvedType);
+    return Stop;
+  }
+
+  VisitResult Visit(UnaryOperatorNode* node) override
+  {
+    mSlots = { node->mRight.get() };
+    Add(NodeKind::UnaryOperator, &node->mOperator, nullptr, node->mResolvedType);
+    return Stop;
+  }
+
+  VisitResult Visit(MemberAccessNode* node) override
+  {
+    mSlots = { node->mLeft.get() };
+    Add(NodeKind::MemberAccess, &node->mOperator, node->mResolvedMember, node->mResolvedType);
+    mFlat.mTokens.push_back(node->mName);
+    return Stop;
+  }
+
+  VisitResult Visit(CallNode* node) override
+  {
+    mSlots.push_back(node->mLeft.get());
+    AddAll(node->mArguments);
+    Add(NodeKind::Call, nullptr, nullptr, node->mResolvedType);
+    return Stop;
+  }
+
+  VisitResult Visit(CastNode* node) override
+  {
+    mSlots = { node->mLeft.get(), node->mType.get() };
+    Add(NodeKind::Cast, nullptr, nullptr, node->mResolvedType);
+    return Stop;
+  }
+
+  VisitResult Visit(IndexNode* node) override
+  {
+    mSlots = { node->mLeft.get(), node->mIndex.get() };
+    Add(NodeKind::Index, nullptr, nullptr, node->mResolvedType);
+    return Stop;
+  }
+
+private:
+  // A node waiting to be flattened, and the child slot of its parent that should point at it
+  struct PendingNode
+  {
+    AbstractNode* mNode;
+    uint32_t mParent;
+    uint32_t mSlot;
+  };
+
+  template <typename T>
+  void AddAll(const AstVector<T>& children)
+  {
+    for (size_t i = 0; i < children.size(); ++i)
+      mSlots.push_back(children[i].get());
+  }
+
+  // Appends the current node with the children gathered in mSlots, and queues those children
+  void Add(NodeKind::Enum kind, const Token* token = nullptr, Symbol* symbol = nullptr, Type* type = nullptr)
+  {
+    uint32_t index = (uint32_t)mFlat.mNodes.size();
+    if (mCurrent.mSlot != FlatAst::None)
+      mFlat.mChildren[mCurrent.mSlot] = index;
+
+    FlatNode node;
+    node.mKind = (uint8_t)kind;
+    node.mParent = mCurrent.mParent;
+    node.mFirstChild = (uint32_t)mFlat.mChildren.size();
+    node.mChildCount = (uint32_t)mSlots.size();
+    node.mToken = token ? (uint32_t)mFlat.mTokens.size() : FlatAst::None;
+    node.mExtra = 0;
+    mFlat.mNodes.push_back(node);
+    mFlat.mSymbols.push_back(symbol);
+    mFlat.mTypes.push_back(type);
+    if (token)
+      mFlat.mTokens.push_back(*token);
+
+    // Queued last child first, so the first child comes off next and the nodes end up in Walk order
+    mFlat.mChildren.resize(mFlat.mChildren.size() + mSlots.size(), FlatAst::None);
+    for (size_t i = mSlots.size(); i-- > 0;)
+    {
+      if (mSlots[i])
+        mPending.push_back(PendingNode { mSlots[i], index, node.mFirstChild + (uint32_t)i });
+    }
+
+    mSlots.clear();
+  }
+
+  FlatAst& mFlat;
+  std::vector<PendingNode> mPending;
+  PendingNode mCurrent;
+  // Children of the node being visited, in slot order (null for an empty slot)
+  std::vector<AbstractNode*> mSlots;
+};
+#pragma endregion
+
+void Flatten(AbstractNode* root, FlatAst& flat)
+{
+  flat = FlatAst();
+  if (root == nullptr)
+    return;
+
+  FlattenVisitor flattener(flat);
+  flattener.Run(root);
+}
+
+#pragma region FlatPrinting
+// Writes the line PrintVisitor writes for a node (without the depth bars)
+static void PrintFlatNode(const FlatAst& flat, uint32_t index, std::ostream& out)
+{
+  const FlatNode& node = flat.mNodes[index];
+  const Token* tokens = node.mToken == FlatAst::None ? nullptr : &flat.mTokens[node.mToken];
+
+  switch (node.mKind)
+  {
+    case NodeKind::Block:          out << "BlockNode"; break;
+    case NodeKind::Class:          out << "ClassNode(" << tokens[0] << ")"; break;
+    case NodeKind::Variable:       out << "VariableNode(" << tokens[0] << ")"; break;
+    case NodeKind::Parameter:      out << "ParameterNode(" << tokens[0] << ")"; break;
+    case NodeKind::Scope:          out << "ScopeNode"; break;
+    case NodeKind::Function:       out << "FunctionNode(" << tokens[0] << ")"; break;
+    case NodeKind::Type:           out << "TypeNode(" << tokens[0] << "," << node.mExtra << ")"; break;
+    case NodeKind::Label:          out << "LabelNode(" << tokens[0] << ")"; break;
+    case NodeKind::Goto:           out << "GotoNode(" << tokens[0] << ")"; break;
+    case NodeKind::Return:         out << "ReturnNode"; break;
+    case NodeKind::Break:          out << "BreakNode"; break;
+    case NodeKind::Continue:       out << "ContinueNode"; break;
+    case NodeKind::Error:          out << "ErrorNode(" << flat.mMessages[node.mExtra] << ")"; break;
+    case NodeKind::If:             out << "IfNode"; break;
+    case NodeKind::While:          out << "WhileNode"; break;
+    case NodeKind::For:            out << "ForNode"; break;
+    case NodeKind::Value:          out << "ValueNode(" << tokens[0] << ")"; break;
+    case NodeKind::BinaryOperator: out << "BinaryOperatorNode(" << tokens[0] << ")"; break;
+    case NodeKind::UnaryOperator:  out << "UnaryOperatorNode(" << tokens[0] << ")"; break;
+    case NodeKind::MemberAccess:   out << "MemberAccessNode(" << tokens[0] << "," << tokens[1] << ")"; break;
+    case NodeKind::Call:           out << "CallNode"; break;
+    case NodeKind::Cast:           out << "CastNode"; break;
+    case NodeKind::Index:          out << "IndexNode"; break;
+  }
+}
+
+void PrintTree(const FlatAst& flat)
+{
+  if (flat.mNodes.empty())
+    return;
+
+  struct PendingNode
+  {
+    uint32_t mIndex;
+    uint32_t mDepth;
+  };
+
+  std::stringstream out;
+  std::vector<PendingNode> pending(1, PendingNode { 0, 0 });
+  std::vector<uint32_t> order;
+  while (!pending.empty())
+  {
+    PendingNode current = pending.back();
+    pending.pop_back();
+
+    for (uint32_t i = 0; i < current.mDepth; ++i)
+      out << "| ";
+    PrintFlatNode(flat, current.mIndex, out);
+    out << "\n";
+
+    // Children go out in the order PrintVisitor prints them, which is slot order except for these two
+    const FlatNode& node = flat.mNodes[current.mIndex];
+    order.clear();
+    if (node.mKind == NodeKind::BinaryOperator)
+      order = { 1, 0 };
+    else if (node.mKind == NodeKind::For)
+      order = { 0, 1, 2, 4, 3 };
+    else
+      for (uint32_t slot = 0; slot < node.mChildCount; ++slot)
+        order.push_back(slot);
+
+    // Pushed last to first so that the first child is printed next
+    for (size_t i = order.size(); i-- > 0;)
+    {
+      uint32_t child = flat.GetChild(current.mIndex, order[i]);
+      if (child != FlatAst::None)
+        pending.push_back(PendingNode { child, current.mDepth + 1 });
+    }
+  }
+
+  printf("%s", out.str().c_str());
+}
+#pragma endregion
+
+AstPtr<ExpressionNode> ParseExpression(std::vector<Token>& tokens)
 {
   Parser myParser(tokens);
 
-  return myParser.Expression();
+  AstPtr<ExpressionNode> node = myParser.Expression();
+  if (myParser.Failed())
+    throw ParsingException(myParser.Error());
+
+  return node;
 }
 
-unique_ptr<BlockNode> ParseBlock(std::vector<Token>& tokens)
+AstPtr<BlockNode> ParseBlock(std::vector<Token>& tokens)
 {
   Parser myParser(tokens);
   
+  AstPtr<BlockNode> node = myParser.Block();
+  if (myParser.Failed())
+    throw ParsingException(myParser.Error());
+
+  return node;
+}
+
+AstPtr<ExpressionNode> TryParseExpression(std::vector<Token>& tokens, std::string* error)
+{
+  Parser myParser(tokens);
+
+  AstPtr<ExpressionNode> node = myParser.Expression();
+  if (myParser.Failed() && error)
+    *error = myParser.Error();
+
+  return node;
+}
+
+AstPtr<BlockNode> TryParseBlock(std::vector<Token>& tokens, std::string* error)
+{
+  Parser myParser(tokens);
+
+  AstPtr<BlockNode> node = myParser.Block();
+  if (myParser.Failed() && error)
+    *error = myParser.Error();
+
+  return node;
+}
+
+AstPtr<BlockNode> ParseBlockWithRecovery(std::vector<Token>& tokens, std::vector<ParseDiagnostic>& diagnostics)
+{
+  Parser myParser(tokens, &diagnostics);
+
   return myParser.Block();
 }
 
 void RemoveWhitespaceAndComments( std::vector<Token>& tokens)
 {
-	TokenType::Enum type;
-	unsigned i = 0;
-	while(i < tokens.size())
+	// One compacting pass; erasing each token in place made this quadratic in the size of the file
+	auto end = std::remove_if(tokens.begin(), tokens.end(), [](const Token& token)
 	{
-		type = static_cast<TokenType::Enum>(tokens[i].mTokenType);
-		if (type == TokenType::Whitespace
+		TokenType::Enum type = static_cast<TokenType::Enum>(token.mTokenType);
+		return type == TokenType::Whitespace
 			|| type == TokenType::SingleLineComment
-			|| type == TokenType::MultiLineComment)
-		{
-			tokens.erase(tokens.begin() + i);
-		}
-		else
-		{
-			++i;
-		}
-	}
+			|| type == TokenType::MultiLineComment;
+	});
+	tokens.erase(end, tokens.end());
 }
 
+#pragma region Recognizer
+#include "RecognizerTable.inl"
+
+// Owns the PrintRule of every named rule the recognizer is currently inside of
+// Rules are always destroyed newest first (even while an exception unwinds) so the printed tree stays nested
+class RecognizerTrace
+{
+public:
+  ~RecognizerTrace()
+  {
+    while (!mRules.empty())
+      Pop();
+  }
+
+  void Enter(const char* rule)
+  {
+    mRules.push_back(new PrintRule(rule));
+  }
+
+  void Accept()
+  {
+    mRules.back()->Accept();
+    Pop();
+  }
+
+private:
+  void Pop()
+  {
+    delete mRules.back();
+    mRules.pop_back();
+  }
+
+  std::vector<PrintRule*> mRules;
+};
+
+// Predictive recognizer driven by the LL(1) table generated from Grammar.txt (see ParserGenerator.cpp)
+// Rules are expanded onto an explicit symbol stack, so deeply nested input never recurses
+// It accepts the same input as ParseBlock and prints the same trace, failing or not (only the messages differ)
+// For that, a rule with no table entry for the next token matches nothing if it can (EmptyProductions), the way the
+// parser skips a '*' or '?' part that the token can't start, so tokens after the last global are left unread
 void Recognize(std::vector<Token>& tokens)
 {
-	bool fSuccess = false;
-	Parser parser(tokens);
+  using namespace RecognizerTable;
+
+  // Pushed underneath the symbols of a named rule so we know when to accept it
+  const int EndOfRule = INT_MIN;
+
+  RecognizerTrace trace;
+  std::vector<int> symbols;
+  symbols.reserve(64);
+  symbols.push_back(~StartRule);
+
+  size_t position = 0;
+  while (!symbols.empty())
+  {
+    int symbol = symbols.back();
+    symbols.pop_back();
+
+    if (symbol == EndOfRule)
+    {
+      trace.Accept();
+      continue;
+    }
+
+    bool atEnd = position == tokens.size();
+    int type = atEnd ? TokenType::Invalid : tokens[position].mTokenType;
+
+    if (symbol >= 0)
+    {
+      if (atEnd || type != symbol)
+      {
+        std::string error = "Expected token ";
+        error.append(TokenNames[symbol]);
+        throw ParsingException(error);
+      }
+
+      PrintRule::AcceptedToken(static_cast<TokenType::Enum>(type));
+      ++position;
+      continue;
+    }
+
+    int rule = ~symbol;
+    int column = atEnd ? EndOfInputColumn : GetColumn(type);
+    int production = column < 0 ? -1 : Table[rule][column];
+    if (production < 0)
+      production = EmptyProductions[rule];
+    if (production < 0)
+    {
+      std::string error = "Unexpected ";
+      error.append(atEnd ? "end of input" : TokenNames[type]);
+      throw ParsingException(error);
+    }
+
+    if (RuleNames[rule])
+    {
+      trace.Enter(RuleNames[rule]);
+      symbols.push_back(EndOfRule);
+    }
+
+    const Production& expansion = Productions[production];
+    for (int i = expansion.mSymbolCount - 1; i >= 0; --i)
+      symbols.push_back(ProductionSymbols[expansion.mFirstSymbol + i]);
+  }
 }
+#pragma endregion
@@ -3,11 +3,25 @@
  * Copyright 2015, DigiPen Institute of Technology
 \******************************************************************/
 #include "../Drivers/Driver4.hpp"
+#include "../Drivers/StaticVisitor.hpp"
 \
 #include <stack>
-typedef std::unordered_map<std::string, Symbol*> SymbolMap;
-typedef std::pair<std::string, Symbol*> SymbolPair;
-SymbolMap g_GlobalSymbols;
+#include <chrono>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <algorithm>
+typedef std::unordered_map<Atom, Symbol*> SymbolMap;
+typedef std::pair<Atom, Symbol*> SymbolPair;
+
+// Names the passes look up over and over
+static const Atom VoidName = InternString("Void");
+static const Atom IntegerName = InternString("Integer");
+static const Atom FloatName = InternString("Float");
+static const Atom BooleanName = InternString("Boolean");
+static const Atom ByteName = InternString("Byte");
+static const Atom BytePointerName = InternString("Byte*");
+static const Atom NullPointerName = InternString("Null*");
 
 enum ScopeType {
     ST_SCOPE, //Used for if/else and loops
@@ -23,38 +37,141 @@ public:
     {
         mNode = node;
         mType = type;
-		mLocals.clear();
+        mFirstShadowed = 0;
+        mBoundary = 0;
     }
     ScopeType mType;
     AbstractNode* mNode;
-	std::vector<Symbol*> mLocals;
+
+    // Where the locals this scope declared start in AnalysisContext::mShadowed
+    size_t mFirstShadowed;
+
+    // The index of the innermost class or function scope, which locals are not looked up past
+    size_t mBoundary;
 };
 
 typedef std::vector<ScopeEntry> ScopeStack;
-ScopeStack scopeStack;
+
+class AnalysisContext
+{
+public:
+    void PushScope(AbstractNode* node, ScopeType type);
+
+    // Also forgets every local the scope declared, bringing back any it hid
+    void PopScope();
+
+    // Makes a local (or member) visible to the innermost scope until it is popped
+    void DeclareLocal(Symbol* symbol);
+
+    // The innermost local with this name, not looking past the innermost class or function (null if there isn't one)
+    Symbol* FindLocal(Atom name) const;
+
+    // Every global symbol by name, from the dependencies and the library being built
+    SymbolMap mGlobals;
+
+    // The class, function and scopes around the node being analyzed
+    ScopeStack mScopes;
+
+    // Held while the library creates types for a parallel Bodies pass
+    std::mutex mTypeMutex;
+
+private:
+    class VisibleLocal
+    {
+    public:
+        Symbol* mSymbol;
+        size_t mScope;
+    };
+
+    // What a declaration replaced in mLocals (a null symbol when it was the first with its name)
+    class ShadowedLocal
+    {
+    public:
+        Atom mName;
+        VisibleLocal mPrevious;
+    };
+
+    // The innermost local declared with each name, and the scope that declared it
+    std::unordered_map<Atom, VisibleLocal> mLocals;
+
+    // Undo log for mLocals, in the order the locals were declared
+    std::vector<ShadowedLocal> mShadowed;
+};
+
+void AnalysisContext::PushScope(AbstractNode* node, ScopeType type)
+{
+    ScopeEntry entry(node, type);
+    entry.mFirstShadowed = mShadowed.size();
+    if (type == ST_CLASS || type == ST_FUNCTION)
+        entry.mBoundary = mScopes.size();
+    else if (!mScopes.empty())
+        entry.mBoundary = mScopes.back().mBoundary;
+
+    mScopes.push_back(entry);
+}
+
+void AnalysisContext::PopScope()
+{
+    size_t first = mScopes.back().mFirstShadowed;
+    while (mShadowed.size() > first)
+    {
+        ShadowedLocal& shadowed = mShadowed.back();
+        if (shadowed.mPrevious.mSymbol)
+            mLocals[shadowed.mName] = shadowed.mPrevious;
+        else
+            mLocals.erase(shadowed.mName);
+        mShadowed.pop_back();
+    }
+
+    mScopes.pop_back();
+}
+
+void AnalysisContext::DeclareLocal(Symbol* symbol)
+{
+    VisibleLocal& visible = mLocals[symbol->mAtom];
+
+    ShadowedLocal shadowed;
+    shadowed.mName = symbol->mAtom;
+    shadowed.mPrevious = visible;
+    mShadowed.push_back(shadowed);
+
+    visible.mSymbol = symbol;
+    visible.mScope = mScopes.size() - 1;
+}
+
+Symbol* AnalysisContext::FindLocal(Atom name) const
+{
+    if (mScopes.empty())
+        return nullptr;
+
+    std::unordered_map<Atom, VisibleLocal>::const_iterator it = mLocals.find(name);
+    if (it == mLocals.end() || it->second.mScope < mScopes.back().mBoundary)
+        return nullptr;
+    return it->second.mSymbol;
+}
 
 template<typename T>
-void AddSymbolToLibrary(Library* lib, T* sym, const bool& isGlobal)
+void AddSymbolToLibrary(AnalysisContext* context, Library* lib, T* sym, const bool& isGlobal)
 {
 	if (isGlobal)
 	{
-		if (g_GlobalSymbols.find(sym->mName) != g_GlobalSymbols.end())
+		if (context->mGlobals.find(sym->mAtom) != context->mGlobals.end())
 		{
 			ErrorSameName(sym->mName);
 		}
 		else
 		{
-			lib->mGlobalsByName[sym->mName] = sym;
+			lib->mGlobalsByName[sym->mAtom] = sym;
 			lib->mGlobals.push_back(sym);
-			g_GlobalSymbols[sym->mName] = sym;
+			context->mGlobals[sym->mAtom] = sym;
 		}
 	}
 	else
 	{
-		ScopeStack::reverse_iterator top = scopeStack.rbegin();
-		top->mLocals.push_back(sym);
+		ScopeStack::reverse_iterator top = context->mScopes.rbegin();
+		context->DeclareLocal(sym);
 
-		while(top->mType == ST_SCOPE)
+		while(top->mType == ST_SCOPE || top->mType == ST_LOOP)
 		{
 			++top;
 		}
@@ -62,102 +179,58 @@ void AddSymbolToLibrary(Library* lib, T* sym, const bool& isGlobal)
 		if (top->mType == ST_FUNCTION)
 		{
 			Function* pFunc = static_cast<FunctionNode*>(top->mNode)->mSymbol;
-			for (auto local : pFunc->mLocals)
-			{
-				if (local->mName.compare(sym->mName) == 0)
-					ErrorSameName(sym->mName);
-			}
+			if (pFunc->mLocalsByName.find(sym->mAtom) != pFunc->mLocalsByName.end())
+				ErrorSameName(sym->mName);
 
 			pFunc->mLocals.push_back(sym);
+			pFunc->mLocalsByName.insert(SymbolPair(sym->mAtom, sym));
 			sym->mParentFunction = pFunc;
 		}
 		else if (top->mType == ST_CLASS)
 		{
 			Type* pClass = static_cast<ClassNode*>(top->mNode)->mSymbol;
 
-			for (auto member : pClass->mMembers)
-			{
-				if (member->mName.compare(sym->mName) == 0)
-					ErrorSameName(sym->mName);
-			}
+			if (pClass->mClass->mMembersByName.find(sym->mAtom) != pClass->mClass->mMembersByName.end())
+				ErrorSameName(sym->mName);
 
-			pClass->mMembersByName[sym->mName] = sym;
-			pClass->mMembers.push_back(sym);
+			pClass->mClass->mMembersByName[sym->mAtom] = sym;
+			pClass->mClass->mMembers.push_back(sym);
 			sym->mParentType = pClass;
 		}
 	}
-	lib->mAllSymbols.push_back(std::make_unique<T>(*sym));
 }
 
-#pragma region VisitorBase
-// All of our node types inherit from this node and implement the Walk function
-enum VisitResult
-{
-    Continue,
-    Stop
-};
-
-class Visitor
-{
-public:
-    virtual VisitResult Visit(AbstractNode*   node) { return Continue; }
-    virtual VisitResult Visit(BlockNode* node) { return this->Visit((AbstractNode*)node); }
-    virtual VisitResult Visit(StatementNode*  node) { return this->Visit((AbstractNode*)node); }
-    virtual VisitResult Visit(ExpressionNode* node) { return this->Visit((StatementNode*)node); }
-    //virtual VisitResult Visit(LiteralNode*    node)   { return this->Visit((ExpressionNode*)node);     }
-    virtual VisitResult Visit(UnaryOperatorNode* node) { return this->Visit((ExpressionNode*)node); }
-    virtual VisitResult Visit(BinaryOperatorNode* node) { return this->Visit((ExpressionNode*)node); }
-    virtual VisitResult Visit(PostExpressionNode* node) { return this->Visit((ExpressionNode*)node); }
-    virtual VisitResult Visit(MemberAccessNode*   node) { return this->Visit((PostExpressionNode*)node); }
-    virtual VisitResult Visit(ClassNode*      node) { return this->Visit((AbstractNode*)node); }
-    //virtual VisitResult Visit(MemberNode*     node)   { return this->Visit((AbstractNode*)node);       }
-    virtual VisitResult Visit(VariableNode*   node) { return this->Visit((StatementNode*)node); }
-    virtual VisitResult Visit(TypeNode*       node) { return this->Visit((AbstractNode*)node); }
-    //virtual VisitResult Visit(NamedReference* node)   { return this->Visit((ExpressionNode*)node);     }
-    virtual VisitResult Visit(ValueNode* node) { return this->Visit((ExpressionNode*)node); }
-    virtual VisitResult Visit(FunctionNode*   node) { return this->Visit((AbstractNode*)node); }
-    virtual VisitResult Visit(ParameterNode*  node) { return this->Visit((VariableNode*)node); }
-    virtual VisitResult Visit(LabelNode* node) { return this->Visit((StatementNode*)node); }
-    virtual VisitResult Visit(GotoNode* node) { return this->Visit((StatementNode*)node); }
-    virtual VisitResult Visit(CallNode* node) { return this->Visit((PostExpressionNode*)node); }
-    virtual VisitResult Visit(CastNode* node) { return this->Visit((PostExpressionNode*)node); }
-    virtual VisitResult Visit(IndexNode* node) { return this->Visit((PostExpressionNode*)node); }
-    virtual VisitResult Visit(ForNode* node) { return this->Visit((StatementNode*)node); }
-    virtual VisitResult Visit(WhileNode* node) { return this->Visit((StatementNode*)node); }
-    virtual VisitResult Visit(ScopeNode* node) { return this->Visit((StatementNode*)node); }
-    virtual VisitResult Visit(IfNode* node) { return this->Visit((StatementNode*)node); }
-    virtual VisitResult Visit(BreakNode* node) { return this->Visit((StatementNode*)node); }
-    virtual VisitResult Visit(ContinueNode* node) { return this->Visit((StatementNode*)node); }
-    virtual VisitResult Visit(ReturnNode* node) { return this->Visit((StatementNode*)node); }
-};
-
-#pragma endregion 
-
 #pragma region Phase1Visitor
-class Phase1Visitor : public Visitor
+class Phase1Visitor : public StaticVisitor<Phase1Visitor>
 {
 public:
-    Phase1Visitor(Library* lib = nullptr) { mLib = lib;}
-
-    VisitResult Visit(AbstractNode* node) override;
-    VisitResult Visit(ClassNode* node) override;
-    VisitResult Visit(BlockNode* node) override;
-    VisitResult Visit(UnaryOperatorNode* node) override;
-    VisitResult Visit(BinaryOperatorNode* node) override;
-    VisitResult Visit(PostExpressionNode* node) override;
-    VisitResult Visit(MemberAccessNode*   node) override;
-    VisitResult Visit(VariableNode*   node) override;
-    VisitResult Visit(FunctionNode*   node) override;
-    VisitResult Visit(CallNode* node) override;
-    VisitResult Visit(CastNode* node) override;
-    VisitResult Visit(IndexNode* node) override;
-    VisitResult Visit(ForNode* node) override;
-    VisitResult Visit(WhileNode* node) override;
-    VisitResult Visit(ScopeNode* node) override;
-    VisitResult Visit(IfNode* node) override;
-    VisitResult Visit(ReturnNode* node) override;
+    using StaticVisitor<Phase1Visitor>::Visit;
+
+    Phase1Visitor(Library* lib, AnalysisContext* context) { mLib = lib; mContext = context; mGlobalsOnly = false; }
+
+    VisitResult Visit(AbstractNode* node);
+    VisitResult Visit(ClassNode* node);
+    VisitResult Visit(BlockNode* node);
+    VisitResult Visit(UnaryOperatorNode* node);
+    VisitResult Visit(BinaryOperatorNode* node);
+    VisitResult Visit(PostExpressionNode* node);
+    VisitResult Visit(MemberAccessNode*   node);
+    VisitResult Visit(VariableNode*   node);
+    VisitResult Visit(FunctionNode*   node);
+    VisitResult Visit(CallNode* node);
+    VisitResult Visit(CastNode* node);
+    VisitResult Visit(IndexNode* node);
+    VisitResult Visit(ForNode* node);
+    VisitResult Visit(WhileNode* node);
+    VisitResult Visit(ScopeNode* node);
+    VisitResult Visit(IfNode* node);
+    VisitResult Visit(ReturnNode* node);
 
     Library* mLib;
+    AnalysisContext* mContext;
+
+    // Only create the types of the global classes and stop there
+    bool mGlobalsOnly;
 };
 VisitResult Phase1Visitor::Visit(AbstractNode* node)
 {
@@ -168,13 +241,11 @@ VisitResult Phase1Visitor::Visit(ClassNode* node)
 {
     if (node->mSymbol == nullptr)
     {
-       for (SymbolMap::iterator it = g_GlobalSymbols.begin(); it != g_GlobalSymbols.end(); ++it)
-       {
-      	  if (it->first.compare(node->mName.mText) == 0 && node->mSymbol != it->second)
-      		  ErrorSameName(it->first);
-       }
+       SymbolMap::iterator it = mContext->mGlobals.find(node->mName.mAtom);
+       if (it != mContext->mGlobals.end() && node->mSymbol != it->second)
+           ErrorSameName(GetAtomString(it->first));
     
-       node->mSymbol = mLib->CreateType(node->mName.mText, true);
+       node->mSymbol = mLib->CreateType(node->mName.mAtom, true, mContext);
 
        for (unsigned i = 0; i < node->mMembers.size(); ++i)
        {
@@ -191,6 +262,16 @@ VisitResult Phase1Visitor::Visit(BlockNode* node)
     {
         node->mGlobals[i]->mParent = node;
     }
+
+    if (mGlobalsOnly)
+    {
+        for (unsigned i = 0; i < node->mGlobals.size(); ++i)
+        {
+            if (node->mGlobals[i]->mKind == NodeKind::Class)
+                Visit(static_cast<ClassNode*>(node->mGlobals[i].get()));
+        }
+        return Stop;
+    }
     return Continue;
 }
 
@@ -320,31 +401,69 @@ VisitResult Phase1Visitor::Visit(ReturnNode* node)
 #pragma endregion
 
 #pragma region Phase2Visitor
-class Phase2Visitor : public Visitor
+class Phase2Visitor : public StaticVisitor<Phase2Visitor>
 {
 public:
-    Phase2Visitor(Library* lib = nullptr) { mLib = lib; }
-    VisitResult Visit(FunctionNode* node) override;
+    using StaticVisitor<Phase2Visitor>::Visit;
+
+    Phase2Visitor(Library* lib, AnalysisContext* context) { mLib = lib; mContext = context; mLinker = nullptr; }
+    VisitResult Visit(FunctionNode* node);
     
-    VisitResult Visit(TypeNode* node) override;
+    VisitResult Visit(TypeNode* node);
+
+    // Lets Phase1 link the parents of every node we walk over
+    VisitResult Visit(BlockNode* node)          { return Link(node); }
+    VisitResult Visit(ClassNode* node)          { return Link(node); }
+    VisitResult Visit(VariableNode* node)       { return Link(node); }
+    VisitResult Visit(ScopeNode* node)          { return Link(node); }
+    VisitResult Visit(ReturnNode* node)         { return Link(node); }
+    VisitResult Visit(IfNode* node)             { return Link(node); }
+    VisitResult Visit(WhileNode* node)          { return Link(node); }
+    VisitResult Visit(ForNode* node)            { return Link(node); }
+    VisitResult Visit(UnaryOperatorNode* node)  { return Link(node); }
+    VisitResult Visit(BinaryOperatorNode* node) { return Link(node); }
+    VisitResult Visit(PostExpressionNode* node) { return Link(node); }
+    VisitResult Visit(MemberAccessNode* node)   { return Link(node); }
+    VisitResult Visit(CallNode* node)           { return Link(node); }
+    VisitResult Visit(CastNode* node)           { return Link(node); }
+    VisitResult Visit(IndexNode* node)          { return Link(node); }
+
+    template <typename T>
+    VisitResult Link(T* node)
+    {
+        if (mLinker)
+            mLinker->Visit(node);
+        return Continue;
+    }
     
     Library* mLib;
+    AnalysisContext* mContext;
+
+    // When set, Phase1 runs in the same walk (the class types must already exist)
+    Phase1Visitor* mLinker;
 };
 
 VisitResult Phase2Visitor::Visit(TypeNode* node)
 {
-    std::string name = node->mName.mText;
-    Type* givenType = static_cast<Type*>(g_GlobalSymbols[name]);
+    Atom name = node->mName.mAtom;
+    Type* givenType = static_cast<Type*>(mContext->mGlobals[name]);
     if(givenType)
-        node->mSymbol = mLib->GetPointerType(givenType, node->mPointerCount);
+        node->mSymbol = mLib->GetPointerType(givenType, node->mPointerCount, mContext);
     else
-        ErrorSymbolNotFound(name);
+        ErrorSymbolNotFound(GetAtomString(name));
 
     return Continue;
 }
 
 VisitResult Phase2Visitor::Visit(FunctionNode* node)
 {
+    Link(node);
+    if (mLinker)
+    {
+        for (unsigned i = 0; i < node->mParameters.size(); ++i)
+            mLinker->Visit((VariableNode*)node->mParameters[i].get());
+    }
+
     std::vector<Type*> parameterTypes;
 
     TypeNode* paramNode;
@@ -353,57 +472,67 @@ VisitResult Phase2Visitor::Visit(FunctionNode* node)
     {
         paramNode = node->mParameters[i]->mType.get();
         
-        paramNode->Walk(this);
+        Walk(paramNode);
 
         if(paramNode->mSymbol == nullptr)
-            paramNode->mSymbol = mLib->CreateType(paramNode->mName.mText, paramNode->mParent == nullptr);
+            paramNode->mSymbol = mLib->CreateType(paramNode->mName.mAtom, paramNode->mParent == nullptr, mContext);
         
-        baseType = static_cast<Type*>(g_GlobalSymbols[paramNode->mName.mText]);
-        parameterTypes.push_back(mLib->GetPointerType(baseType, paramNode->mPointerCount));
+        baseType = static_cast<Type*>(mContext->mGlobals[paramNode->mName.mAtom]);
+        parameterTypes.push_back(mLib->GetPointerType(baseType, paramNode->mPointerCount, mContext));
     }
 
-    node->mScope->Walk(this);
+    Walk(node->mScope);
     
     Type* returnType;
     if (node->mReturnType)
     {
-        node->mReturnType->Walk(this);
+        Walk(node->mReturnType);
         returnType = node->mReturnType->mSymbol;
     }
     else
     {
-        returnType = static_cast<Type*>(g_GlobalSymbols["Void"]);
+        returnType = static_cast<Type*>(mContext->mGlobals[VoidName]);
     }
 
-    node->mSignatureType = mLib->GetFunctionType(parameterTypes, returnType);
+    node->mSignatureType = mLib->GetFunctionType(parameterTypes, returnType, mContext);
     return Stop;
 }
 
 #pragma endregion
 
 #pragma region Phase3Visitor
-class Phase3Visitor : public Visitor
+class Phase3Visitor : public StaticVisitor<Phase3Visitor>
 {
 public:
-    Phase3Visitor(Library* lib = nullptr) { mLib = lib; }
+    using StaticVisitor<Phase3Visitor>::Visit;
+
+    Phase3Visitor(Library* lib, AnalysisContext* context) { mLib = lib; mContext = context; mSkipBodies = false; mSymbols = &lib->mAllSymbols; }
 
-    VisitResult Visit(LabelNode* node) override;
+    VisitResult Visit(LabelNode* node);
 
-    VisitResult Visit(VariableNode* node) override;
+    VisitResult Visit(VariableNode* node);
 
     //Get added to scope stack
-    VisitResult Visit(ClassNode* node) override;
-    VisitResult Visit(FunctionNode* node) override;
-	VisitResult Visit(ScopeNode* node) override;
+    VisitResult Visit(ClassNode* node);
+    VisitResult Visit(FunctionNode* node);
+	VisitResult Visit(ScopeNode* node);
 
     Library* mLib;
+    AnalysisContext* mContext;
+
+    // Only declare globals, members and parameters
+    // The locals and labels in function bodies are then declared by Phase4 (see Phase4Visitor::mDeclare)
+    bool mSkipBodies;
+
+    // Where the symbols we declare are owned (the library's mAllSymbols unless a parallel task collects them)
+    SymbolVector* mSymbols;
 };
 
 VisitResult Phase3Visitor::Visit(LabelNode* node)
 {
-    bool isGlobal = scopeStack.size() == 0;
-	std::string name = node->mName.mText;
-    node->mSymbol = mLib->CreateLabel(name, isGlobal);    
+    bool isGlobal = mContext->mScopes.size() == 0;
+	Atom name = node->mName.mAtom;
+    node->mSymbol = mLib->CreateLabel(name, isGlobal, mSymbols);
 	bool error = false;
 
 	if (isGlobal)
@@ -416,13 +545,13 @@ VisitResult Phase3Visitor::Visit(LabelNode* node)
 		{
 			mLib->mGlobalsByName[name] = node->mSymbol;
 			mLib->mGlobals.push_back(node->mSymbol);
-			g_GlobalSymbols[name] = node->mSymbol;
+			mContext->mGlobals[name] = node->mSymbol;
 		}
 	}
 	else
 	{
 		ScopeStack::reverse_iterator topFunc;
-		for (topFunc = scopeStack.rbegin(); topFunc->mType != ST_FUNCTION && topFunc != scopeStack.rend(); ++topFunc);
+		for (topFunc = mContext->mScopes.rbegin(); topFunc->mType != ST_FUNCTION && topFunc != mContext->mScopes.rend(); ++topFunc);
 
 		Function* pFunc = static_cast<FunctionNode*>(topFunc->mNode)->mSymbol;
 		if (pFunc->mLabelsByName.find(name) == pFunc->mLabelsByName.end())
@@ -430,229 +559,264 @@ VisitResult Phase3Visitor::Visit(LabelNode* node)
 			node->mSymbol->mParentFunction = pFunc;
 			pFunc->mLabelsByName[name] = node->mSymbol;
 			pFunc->mLocals.push_back(node->mSymbol);
+			pFunc->mLocalsByName.insert(SymbolPair(name, node->mSymbol));
 		}
 		else
 			error = true;
 	}
-	mLib->mAllSymbols.push_back(std::make_unique<Label>(*node->mSymbol));
-
 	if (error)
-		ErrorSameName(name);
+		ErrorSameName(GetAtomString(name));
 
     return Stop;
 }
 
 VisitResult Phase3Visitor::Visit(VariableNode* node)
 {
-    bool isGlobal = scopeStack.size() == 0;
-	node->mSymbol = mLib->CreateVariable(node->mName.mText, isGlobal);
+    bool isGlobal = mContext->mScopes.size() == 0;
+	node->mSymbol = mLib->CreateVariable(node->mName.mAtom, isGlobal, mSymbols);
 
-    node->mType->Walk(this);
+    Walk(node->mType);
     node->mSymbol->mType = node->mType->mSymbol;
     
     if (node->mInitialValue)
     {
-        node->mInitialValue->Walk(this);
+        Walk(node->mInitialValue);
         node->mInitialValue->mResolvedType = node->mType->mSymbol;
     }
     
-    AddSymbolToLibrary(mLib, node->mSymbol, isGlobal);
+    AddSymbolToLibrary(mContext, mLib, node->mSymbol, isGlobal);
 
 	return Stop;
 }
 
 VisitResult Phase3Visitor::Visit(ClassNode* node)
 {
-	scopeStack.push_back(ScopeEntry(node, ST_CLASS));
+	mContext->PushScope(node, ST_CLASS);
 	for (unsigned i = 0; i < node->mMembers.size(); ++i)
 	{
-		node->mMembers[i]->Walk(this);
+		Walk(node->mMembers[i]);
 	}
-    scopeStack.pop_back();
+    mContext->PopScope();
 	return Stop;
 }
 
 VisitResult Phase3Visitor::Visit(FunctionNode* node)
 {
-	bool isGlobal = scopeStack.size() == 0;
-	node->mSymbol = mLib->CreateFunction(node->mName.mText, isGlobal);
+	bool isGlobal = mContext->mScopes.size() == 0;
+	node->mSymbol = mLib->CreateFunction(node->mName.mAtom, isGlobal, mSymbols);
     node->mSymbol->mType = node->mSignatureType;
     node->mSymbol->mExecutableFunction = node;
 
-	scopeStack.push_back(ScopeEntry(node, ST_FUNCTION));
+	mContext->PushScope(node, ST_FUNCTION);
     for (unsigned i = 0; i < node->mParameters.size(); ++i)
 	{
-        node->mParameters[i]->Walk(this);
+        Walk(node->mParameters[i]);
         node->mParameters[i]->mSymbol->mIsParameter = true;
     }
     
     if (node->mReturnType)
     {
-        node->mReturnType->Walk(this);
+        Walk(node->mReturnType);
     }
 
-    node->mScope->Walk(this);
-    scopeStack.pop_back();
+    if (!mSkipBodies)
+        Walk(node->mScope);
+    mContext->PopScope();
 
-    AddSymbolToLibrary(mLib, node->mSymbol, isGlobal);
+    AddSymbolToLibrary(mContext, mLib, node->mSymbol, isGlobal);
 
 	return Stop;
 }
 
 VisitResult Phase3Visitor::Visit(ScopeNode* node)
 {
-	scopeStack.push_back(ScopeEntry(node, ST_SCOPE));
+	mContext->PushScope(node, ST_SCOPE);
 	for (unsigned i = 0; i < node->mStatements.size(); ++i)
 	{
-		node->mStatements[i]->Walk(this);
+		Walk(node->mStatements[i]);
 	}
-	scopeStack.pop_back();
+	mContext->PopScope();
 
 	return Stop;
 }
 #pragma endregion
 
 #pragma region Phase4Visitor
-class Phase4Visitor : public Visitor
+class BodyTask;
+
+class Phase4Visitor : public StaticVisitor<Phase4Visitor>
 {
 public:
-	Phase4Visitor(Library* lib = nullptr) { mLib = lib; }
-	VisitResult Visit(ValueNode* node) override;
+    using StaticVisitor<Phase4Visitor>::Visit;
+
+	Phase4Visitor(Library* lib, AnalysisContext* context) : mDeclarations(lib, context) { mLib = lib; mContext = context; mDeclare = false; mGlobals = &context->mGlobals; mTask = nullptr; }
+	VisitResult Visit(ValueNode* node);
 
-	VisitResult Visit(IndexNode* node) override;
+	VisitResult Visit(IndexNode* node);
 
-	VisitResult Visit(MemberAccessNode* node) override;
+	VisitResult Visit(MemberAccessNode* node);
 
-    VisitResult Visit(BinaryOperatorNode* node) override;
+    VisitResult Visit(BinaryOperatorNode* node);
     
-    VisitResult Visit(UnaryOperatorNode* node) override;
+    VisitResult Visit(UnaryOperatorNode* node);
     
-    VisitResult Visit(CallNode* node) override;
+    VisitResult Visit(CallNode* node);
     
-    VisitResult Visit(CastNode* node) override;
+    VisitResult Visit(CastNode* node);
     
-    VisitResult Visit(IfNode* node) override;
+    VisitResult Visit(IfNode* node);
     
-    VisitResult Visit(ForNode* node) override;
+    VisitResult Visit(ForNode* node);
     
-    VisitResult Visit(WhileNode* node) override;
+    VisitResult Visit(WhileNode* node);
     
-    VisitResult Visit(GotoNode* node) override;
+    VisitResult Visit(GotoNode* node);
     
-    VisitResult Visit(ReturnNode* node) override;
+    VisitResult Visit(ReturnNode* node);
 
-    VisitResult Visit(VariableNode* node) override;
+    VisitResult Visit(VariableNode* node);
 
-    VisitResult Visit(BreakNode* node) override;
+    VisitResult Visit(BreakNode* node);
 
-    VisitResult Visit(ContinueNode* node) override;
+    VisitResult Visit(ContinueNode* node);
+
+    VisitResult Visit(LabelNode* node);
 
     //Get added to scope stack
-    VisitResult Visit(ClassNode* node) override;
-    VisitResult Visit(FunctionNode* node) override;
-	VisitResult Visit(ScopeNode* node) override;
+    VisitResult Visit(ClassNode* node);
+    VisitResult Visit(FunctionNode* node);
+	VisitResult Visit(ScopeNode* node);
     
     Library* mLib;
+    AnalysisContext* mContext;
+
+    // Also declare the locals and labels of function bodies, which lets Phase3 skip them
+    bool mDeclare;
+    Phase3Visitor mDeclarations;
+    // Gotos seen before their label in the current function
+    std::vector<GotoNode*> mPendingGotos;
+
+    // The globals that names resolve to (a copy that nobody writes to while bodies are analyzed in parallel)
+    const SymbolMap* mGlobals;
+    Symbol* FindGlobal(Atom name);
+
+    // Set when this visitor analyzes one part of a parallel Bodies pass (see BodyTask)
+    BodyTask* mTask;
+    // The library calls that may create a type
+    Type* CreateType(Atom name);
+    Type* GetPointerType(Type* type);
 };
 
 //Get added to scope stack
 VisitResult Phase4Visitor::Visit(ClassNode* node)
 {
-    scopeStack.push_back(ScopeEntry(node, ST_CLASS));
+    mContext->PushScope(node, ST_CLASS);
     for (unsigned i = 0; i < node->mMembers.size(); ++i)
     {
-        node->mMembers[i]->Walk(this);
+        Walk(node->mMembers[i]);
     }
-    scopeStack.pop_back();
+    mContext->PopScope();
     return Stop;
 }
 
 
 VisitResult Phase4Visitor::Visit(FunctionNode* node)
 {
-    scopeStack.push_back(ScopeEntry(node, ST_FUNCTION));
+    mContext->PushScope(node, ST_FUNCTION);
     for (unsigned i = 0; i < node->mParameters.size(); ++i)
     {
-        node->mParameters[i]->Walk(this);
+        Walk(node->mParameters[i]);
     }
 
     if (node->mReturnType)
     {
-        node->mReturnType->Walk(this);
+        Walk(node->mReturnType);
     }
 
-    node->mScope->Walk(this);
-    scopeStack.pop_back();
+    Walk(node->mScope);
+    mContext->PopScope();
+
+    for (unsigned i = 0; i < mPendingGotos.size(); ++i)
+    {
+        GotoNode* gotoNode = mPendingGotos[i];
+        if (node->mSymbol->mLabelsByName.find(gotoNode->mName.mAtom) != node->mSymbol->mLabelsByName.end())
+            gotoNode->mResolvedLabel = node->mSymbol->mLabelsByName[gotoNode->mName.mAtom];
+    }
+    mPendingGotos.clear();
 
     return Stop;
 }
 VisitResult Phase4Visitor::Visit(ScopeNode* node)
 {
-	scopeStack.push_back(ScopeEntry(node, ST_SCOPE));
+	mContext->PushScope(node, ST_SCOPE);
 	for (unsigned i = 0; i < node->mStatements.size(); ++i)
 	{
-		node->mStatements[i]->Walk(this);
+		Walk(node->mStatements[i]);
 	}
-	scopeStack.pop_back();
+	mContext->PopScope();
 	return Stop;
 }
 VisitResult Phase4Visitor::Visit(ValueNode* node)
 {
+    // An initial value already has its declared type, but whatever runs the code still needs to know what its name is
+    // (a missing name is not an error here, which the declared type has always let through)
+    if (node->mResolvedType != nullptr && node->mResolvedSymbol == nullptr && node->mToken.mEnumTokenType == TokenType::Identifier)
+    {
+        Symbol* local = mContext->FindLocal(node->mToken.mAtom);
+        node->mResolvedSymbol = local != nullptr && local->mType != nullptr ? local : FindGlobal(node->mToken.mAtom);
+    }
+
     if (node->mResolvedType == nullptr)
     {
         switch (node->mToken.mEnumTokenType)
         {
         case TokenType::IntegerLiteral:
-            node->mResolvedType = static_cast<Type*>(g_GlobalSymbols["Integer"]);
+            node->mResolvedType = static_cast<Type*>(FindGlobal(IntegerName));
             break;
 
         case TokenType::FloatLiteral:
-			node->mResolvedType = static_cast<Type*>(g_GlobalSymbols["Float"]);
+			node->mResolvedType = static_cast<Type*>(FindGlobal(FloatName));
             break;
 
         case TokenType::StringLiteral:
-			if (g_GlobalSymbols.find("Byte*") == g_GlobalSymbols.end())
-				node->mResolvedType = mLib->CreateType("Byte*", true);
+			if (FindGlobal(BytePointerName) == nullptr)
+				node->mResolvedType = CreateType(BytePointerName);
 			else
-				node->mResolvedType = static_cast<Type*>(g_GlobalSymbols["Byte*"]);
+				node->mResolvedType = static_cast<Type*>(FindGlobal(BytePointerName));
             break;
 
         case TokenType::CharacterLiteral:
-			node->mResolvedType = static_cast<Type*>(g_GlobalSymbols["Byte"]);
+			node->mResolvedType = static_cast<Type*>(FindGlobal(ByteName));
             break;
 
         case TokenType::True:
         case TokenType::False:
-			node->mResolvedType = static_cast<Type*>(g_GlobalSymbols["Boolean"]);
+			node->mResolvedType = static_cast<Type*>(FindGlobal(BooleanName));
             break;
 
         case TokenType::Null:
-			node->mResolvedType = static_cast<Type*>(g_GlobalSymbols["Null*"]);
+			node->mResolvedType = static_cast<Type*>(FindGlobal(NullPointerName));
             break;
 
         case TokenType::Identifier:
-            std::string name = node->mToken.mText;
-            ScopeStack::reverse_iterator top;
-            bool fStop = false;
-            for ( top = scopeStack.rbegin(); top != scopeStack.rend() && !fStop ; ++top)
+            Atom name = node->mToken.mAtom;
+            Symbol* local = mContext->FindLocal(name);
+            if (local != nullptr)
             {
-                for (unsigned i = 0; i < top->mLocals.size() && node->mResolvedType == nullptr; ++i)
-                {
-                    if (top->mLocals[i]->mName.compare(name) == 0)
-                        node->mResolvedType = top->mLocals[i]->mType;
-                }
-
-                fStop = node->mResolvedType != nullptr
-                        || (top->mType == ST_FUNCTION || top->mType == ST_CLASS);
+                node->mResolvedType = local->mType;
+                node->mResolvedSymbol = local;
             }
 
             if (node->mResolvedType == nullptr)
             {
-                SymbolMap::iterator it = g_GlobalSymbols.find(name);
-                if (it != g_GlobalSymbols.end())
-					node->mResolvedType = it->second->mType;
+                Symbol* global = FindGlobal(name);
+                if (global != nullptr)
+                {
+					node->mResolvedType = global->mType;
+                    node->mResolvedSymbol = global;
+                }
                 else
-                    ErrorSymbolNotFound(name);
+                    ErrorSymbolNotFound(GetAtomString(name));
             }
             break;
         }
@@ -664,11 +828,11 @@ VisitResult Phase4Visitor::Visit(ValueNode* node)
 //TODO
 VisitResult Phase4Visitor::Visit(IndexNode* node)
 {
-    node->mLeft->Walk(this);
-    node->mIndex->Walk(this);
+    Walk(node->mLeft);
+    Walk(node->mIndex);
 
     if (node->mLeft->mResolvedType->mMode == TypeMode::Pointer
-     && node->mIndex->mResolvedType == g_GlobalSymbols["Integer"])
+     && node->mIndex->mResolvedType == FindGlobal(IntegerName))
 	{
 		node->mResolvedType = node->mLeft->mResolvedType->mPointerToType;
 	}
@@ -680,7 +844,7 @@ VisitResult Phase4Visitor::Visit(IndexNode* node)
 
 VisitResult Phase4Visitor::Visit(MemberAccessNode* node)
 {
-    node->mLeft->Walk(this);
+    Walk(node->mLeft);
 
 	Type* pClass = nullptr;
 	if (node->mOperator.mEnumTokenType == TokenType::Arrow && node->mLeft->mResolvedType->mMode == TypeMode::Pointer
@@ -691,13 +855,14 @@ VisitResult Phase4Visitor::Visit(MemberAccessNode* node)
 
 	if(pClass)
 	{
-		if (pClass->mMembersByName.find(node->mName.mText) != pClass->mMembersByName.end())
+		std::unordered_map<Atom, Symbol*>::const_iterator member = pClass->mClass->mMembersByName.find(node->mName.mAtom);
+		if (member != pClass->mClass->mMembersByName.end())
 		{
-			node->mResolvedMember = pClass->mMembersByName[node->mName.mText];
+			node->mResolvedMember = member->second;
 			node->mResolvedType = node->mResolvedMember->mType;
 		}
 		else
-			ErrorSymbolNotFound(node->mName.mText);
+			ErrorSymbolNotFound(GetAtomString(node->mName.mAtom));
 	}
 	else
 		ErrorInvalidMemberAccess(node);
@@ -707,8 +872,8 @@ VisitResult Phase4Visitor::Visit(MemberAccessNode* node)
 
 VisitResult Phase4Visitor::Visit(BinaryOperatorNode* node)
 {
-	node->mRight->Walk(this);
-	node->mLeft->Walk(this);
+	Walk(node->mRight);
+	Walk(node->mLeft);
 
     switch (node->mOperator.mEnumTokenType)
     {
@@ -716,17 +881,17 @@ VisitResult Phase4Visitor::Visit(BinaryOperatorNode* node)
             if (node->mLeft->mResolvedType->mMode == TypeMode::Pointer
             && node->mRight->mResolvedType->mMode == TypeMode::Pointer)
             {
-                node->mResolvedType = static_cast<Type*>(g_GlobalSymbols["Integer"]);
+                node->mResolvedType = static_cast<Type*>(FindGlobal(IntegerName));
                 break;
             }
 
         case TokenType::Plus:
-            if (node->mLeft->mResolvedType == g_GlobalSymbols["Integer"] && node->mRight->mResolvedType->mMode == TypeMode::Pointer)
+            if (node->mLeft->mResolvedType == FindGlobal(IntegerName) && node->mRight->mResolvedType->mMode == TypeMode::Pointer)
             {
                 node->mResolvedType = node->mRight->mResolvedType;
                 break;
             }
-            else if (node->mLeft->mResolvedType->mMode == TypeMode::Pointer && node->mRight->mResolvedType == g_GlobalSymbols["Integer"])
+            else if (node->mLeft->mResolvedType->mMode == TypeMode::Pointer && node->mRight->mResolvedType == FindGlobal(IntegerName))
             {
                 node->mResolvedType = node->mLeft->mResolvedType;
                 break;
@@ -736,9 +901,9 @@ VisitResult Phase4Visitor::Visit(BinaryOperatorNode* node)
         case TokenType::Divide:
         case TokenType::Modulo:
             if (node->mLeft->mResolvedType == node->mRight->mResolvedType
-            && (node->mLeft->mResolvedType == g_GlobalSymbols["Byte"]
-             || node->mLeft->mResolvedType == g_GlobalSymbols["Integer"]
-             || node->mLeft->mResolvedType == g_GlobalSymbols["Float"]))
+            && (node->mLeft->mResolvedType == FindGlobal(ByteName)
+             || node->mLeft->mResolvedType == FindGlobal(IntegerName)
+             || node->mLeft->mResolvedType == FindGlobal(FloatName)))
             {
                 node->mResolvedType = node->mLeft->mResolvedType;
             }
@@ -750,16 +915,16 @@ VisitResult Phase4Visitor::Visit(BinaryOperatorNode* node)
         case TokenType::GreaterThanOrEqualTo:
         case TokenType::Equality:
         case TokenType::Inequality:
-           node->mResolvedType = static_cast<Type*>(g_GlobalSymbols["Boolean"]);
+           node->mResolvedType = static_cast<Type*>(FindGlobal(BooleanName));
            break;
 
         case TokenType::LogicalOr:
         case TokenType::LogicalAnd:
-            if( (node->mLeft->mResolvedType == g_GlobalSymbols["Boolean"] 
+            if( (node->mLeft->mResolvedType == FindGlobal(BooleanName) 
 		      || node->mLeft->mResolvedType->mMode == TypeMode::Pointer)
-             && (node->mRight->mResolvedType == g_GlobalSymbols["Boolean"]
+             && (node->mRight->mResolvedType == FindGlobal(BooleanName)
 			  || node->mRight->mResolvedType->mMode == TypeMode::Pointer))
-                node->mResolvedType = static_cast<Type*>(g_GlobalSymbols["Boolean"]);
+                node->mResolvedType = static_cast<Type*>(FindGlobal(BooleanName));
             break;
 
         case TokenType::Assignment:
@@ -779,7 +944,7 @@ VisitResult Phase4Visitor::Visit(BinaryOperatorNode* node)
 
 VisitResult Phase4Visitor::Visit(UnaryOperatorNode* node) 
 {
-	node->mRight->Walk(this);
+	Walk(node->mRight);
     Type* rightType = node->mRight->mResolvedType;
 
     switch (node->mOperator.mEnumTokenType)
@@ -791,29 +956,29 @@ VisitResult Phase4Visitor::Visit(UnaryOperatorNode* node)
 
         case TokenType::Plus                   :
         case TokenType::Minus                  :
-            if (rightType == g_GlobalSymbols["Byte"]
-             || rightType == g_GlobalSymbols["Integer"]
-             || rightType == g_GlobalSymbols["Float"])
+            if (rightType == FindGlobal(ByteName)
+             || rightType == FindGlobal(IntegerName)
+             || rightType == FindGlobal(FloatName))
                 node->mResolvedType = rightType;
             break;
 
         case TokenType::Increment              :
         case TokenType::Decrement              :
-            if (rightType == g_GlobalSymbols["Byte"]
-             || rightType == g_GlobalSymbols["Integer"]
-             || rightType == g_GlobalSymbols["Float"]
+            if (rightType == FindGlobal(ByteName)
+             || rightType == FindGlobal(IntegerName)
+             || rightType == FindGlobal(FloatName)
              || rightType->mMode == TypeMode::Pointer)
                 node->mResolvedType = rightType;
             break;
 
         case TokenType::LogicalNot             :
             if (rightType->mMode == TypeMode::Pointer
-             || rightType == g_GlobalSymbols["Boolean"])
-                node->mResolvedType = static_cast<Type*>(g_GlobalSymbols["Boolean"]);
+             || rightType == FindGlobal(BooleanName))
+                node->mResolvedType = static_cast<Type*>(FindGlobal(BooleanName));
             break;
 
         case TokenType::BitwiseAndAddressOf    :
-            node->mResolvedType = mLib->GetPointerType(rightType);
+            node->mResolvedType = GetPointerType(rightType);
             break;
     }
 
@@ -825,16 +990,16 @@ VisitResult Phase4Visitor::Visit(UnaryOperatorNode* node)
 
 VisitResult Phase4Visitor::Visit(CallNode* node) 
 {
-    node->mLeft->Walk(this);
+    Walk(node->mLeft);
     
     if (node->mLeft->mResolvedType->mMode != TypeMode::Function)
         ErrorNonCallableType(node->mLeft->mResolvedType);
 
-    const std::vector<Type*>& params = node->mLeft->mResolvedType->mParameterTypes;
+    const std::vector<Type*>& params = node->mLeft->mResolvedType->mFunction->mParameterTypes;
     bool fError = node->mArguments.size() != params.size();
     for (unsigned i = 0; i < node->mArguments.size(); ++i)
     {
-        node->mArguments[i]->Walk(this);
+        Walk(node->mArguments[i]);
         if (node->mArguments[i]->mResolvedType != params[i])
             fError = true;
     }
@@ -842,18 +1007,18 @@ VisitResult Phase4Visitor::Visit(CallNode* node)
     if (fError)
         ErrorInvalidCall(node);
     else
-		node->mResolvedType = node->mLeft->mResolvedType->mReturnType;
+		node->mResolvedType = node->mLeft->mResolvedType->mFunction->mReturnType;
 
 //    if (node->mArguments.size() == 0)
-//        node->mResolvedType->mParameterTypes.push_back(static_cast<Type*>(g_GlobalSymbols["Void"]));
+//        node->mResolvedType->mParameterTypes.push_back(static_cast<Type*>(FindGlobal(VoidName)));
 
     return Stop;
 }
 
 VisitResult Phase4Visitor::Visit(CastNode* node) 
 {
-	node->mLeft->Walk(this);
-	node->mType->Walk(this);
+	Walk(node->mLeft);
+	Walk(node->mType);
 
     node->mResolvedType = node->mType->mSymbol;
 
@@ -861,11 +1026,11 @@ VisitResult Phase4Visitor::Visit(CastNode* node)
 	  || node->mType->mSymbol->mMode == TypeMode::Function
 	  || node->mLeft->mResolvedType->mMode == TypeMode::Pointer
       && node->mType->mSymbol->mMode == TypeMode::Class
-      && node->mType->mSymbol != g_GlobalSymbols["Boolean"]
-      && node->mType->mSymbol != g_GlobalSymbols["Integer"]
+      && node->mType->mSymbol != FindGlobal(BooleanName)
+      && node->mType->mSymbol != FindGlobal(IntegerName)
       || node->mType->mSymbol->mMode == TypeMode::Pointer
       && node->mLeft->mResolvedType->mMode == TypeMode::Class
-      && node->mLeft->mResolvedType != g_GlobalSymbols["Integer"])
+      && node->mLeft->mResolvedType != FindGlobal(IntegerName))
 		ErrorInvalidCast(node->mLeft->mResolvedType, node->mType->mSymbol);
 		
 	return Stop;
@@ -876,18 +1041,18 @@ VisitResult Phase4Visitor::Visit(IfNode* node)
 	bool error = false;
     if (node->mCondition)
     {
-        node->mCondition->Walk(this);
+        Walk(node->mCondition);
 
 		if (node->mCondition == nullptr
 			|| !(node->mCondition->mResolvedType->mMode == TypeMode::Pointer
-				|| node->mCondition->mResolvedType == g_GlobalSymbols["Boolean"]))
+				|| node->mCondition->mResolvedType == FindGlobal(BooleanName)))
 			error = true;
     }
 
-	node->mScope->Walk(this);
+	Walk(node->mScope);
 
 	if (node->mElse)
-		node->mElse->Walk(this);
+		Walk(node->mElse);
 
 	if(error)
 		ErrorConditionExpectedBooleanOrPointer(node->mCondition->mResolvedType);
@@ -897,47 +1062,47 @@ VisitResult Phase4Visitor::Visit(IfNode* node)
 
 VisitResult Phase4Visitor::Visit(ForNode* node) 
 {
-    scopeStack.push_back(ScopeEntry(node, ST_LOOP));
+    mContext->PushScope(node, ST_LOOP);
     if (node->mInitialExpression)
-        node->mInitialExpression->Walk(this);
+        Walk(node->mInitialExpression);
 
     if (node->mInitialVariable)
-        node->mInitialVariable->Walk(this);
+        Walk(node->mInitialVariable);
 
     if (node->mCondition)
     {
-        node->mCondition->Walk(this);
+        Walk(node->mCondition);
 
         if (node->mCondition == nullptr
             || !(node->mCondition->mResolvedType->mMode == TypeMode::Pointer
-                || node->mCondition->mResolvedType == g_GlobalSymbols["Boolean"]))
+                || node->mCondition->mResolvedType == FindGlobal(BooleanName)))
             ErrorConditionExpectedBooleanOrPointer(node->mCondition->mResolvedType);
     }
 
     if (node->mIterator)
-        node->mIterator->Walk(this);
+        Walk(node->mIterator);
 
-    node->mScope->Walk(this);
-    scopeStack.pop_back();
+    Walk(node->mScope);
+    mContext->PopScope();
 
     return Stop;
 }
 
 VisitResult Phase4Visitor::Visit(WhileNode* node) 
 {
-    scopeStack.push_back(ScopeEntry(node, ST_LOOP));
+    mContext->PushScope(node, ST_LOOP);
     if (node->mCondition)
     {
-        node->mCondition->Walk(this);
+        Walk(node->mCondition);
 
         if (node->mCondition == nullptr
             || !(node->mCondition->mResolvedType->mMode == TypeMode::Pointer
-                || node->mCondition->mResolvedType == g_GlobalSymbols["Boolean"]))
+                || node->mCondition->mResolvedType == FindGlobal(BooleanName)))
             ErrorConditionExpectedBooleanOrPointer(node->mCondition->mResolvedType);
     }
 
-    node->mScope->Walk(this);
-    scopeStack.pop_back();
+    Walk(node->mScope);
+    mContext->PopScope();
 
     return Stop;
 }
@@ -946,7 +1111,7 @@ VisitResult Phase4Visitor::Visit(GotoNode* node)
 {
 	bool found = false;
 	FunctionNode* topFunc = nullptr;
-	for (ScopeStack::reverse_iterator it = scopeStack.rbegin(); !found && it != scopeStack.rend(); ++it)
+	for (ScopeStack::reverse_iterator it = mContext->mScopes.rbegin(); !found && it != mContext->mScopes.rend(); ++it)
 	{
 		if (it->mType == ST_FUNCTION)
 		{
@@ -954,32 +1119,39 @@ VisitResult Phase4Visitor::Visit(GotoNode* node)
 				topFunc = static_cast<FunctionNode*>(it->mNode);
 
 			Function* pFunc = static_cast<FunctionNode*>(it->mNode)->mSymbol;
-			if (pFunc->mLabelsByName.find(node->mName.mText) != pFunc->mLabelsByName.end())
-				node->mResolvedLabel = pFunc->mLabelsByName[node->mName.mText];
+			if (pFunc->mLabelsByName.find(node->mName.mAtom) != pFunc->mLabelsByName.end())
+				node->mResolvedLabel = pFunc->mLabelsByName[node->mName.mAtom];
 		}
 	}
 
+	if (mDeclare && node->mResolvedLabel == nullptr)
+		mPendingGotos.push_back(node);
+
 	return Stop;
 }
 
 VisitResult Phase4Visitor::Visit(ReturnNode* node) 
 {
-    FunctionNode* parentFunc = static_cast<FunctionNode*>(node->mParent->mParent);
+    // The return may be nested in any number of scopes, loops and ifs
+    AbstractNode* parent = node->mParent;
+    while (parent->mKind != NodeKind::Function)
+        parent = parent->mParent;
+    FunctionNode* parentFunc = static_cast<FunctionNode*>(parent);
     Type* got;
     Type* expected;
     got = expected = nullptr;
     if (node->mReturnValue)
     {
-        node->mReturnValue->Walk(this);
+        Walk(node->mReturnValue);
         got = node->mReturnValue->mResolvedType;
     }
     
     if (parentFunc->mReturnType)
         expected = parentFunc->mReturnType->mSymbol;
     else
-        expected = static_cast<Type*>(g_GlobalSymbols["Void"]);
+        expected = static_cast<Type*>(FindGlobal(VoidName));
 
-    if(( !got && expected != g_GlobalSymbols["Void"])
+    if(( !got && expected != FindGlobal(VoidName))
     || (got != expected))
     {
         ErrorTypeMismatch(expected, got);
@@ -989,24 +1161,33 @@ VisitResult Phase4Visitor::Visit(ReturnNode* node)
 
 VisitResult Phase4Visitor::Visit(VariableNode* node)
 {	
-	node->mType->Walk(this);
+	// Phase3 would have given the initial value the declared type before we walk it
+	bool declare = mDeclare && node->mSymbol == nullptr;
+	if (declare && node->mInitialValue)
+		node->mInitialValue->mResolvedType = node->mType->mSymbol;
+
+	Walk(node->mType);
 
 	if (node->mInitialValue)
 	{
-		node->mInitialValue->Walk(this);
+		Walk(node->mInitialValue);
 		node->mInitialValue->mResolvedType = node->mType->mSymbol;
 	}
 
-	bool isGlobal = scopeStack.size() == 0;
+	// Declared after the initial value, so it only sees the names that were in scope before this variable
+	if (declare)
+		return mDeclarations.Visit(node);
+
+	bool isGlobal = mContext->mScopes.size() == 0;
 	if (node->mSymbol == nullptr)
 	{
-		node->mSymbol = mLib->CreateVariable(node->mName.mText, isGlobal);
+		node->mSymbol = mLib->CreateVariable(node->mName.mAtom, isGlobal);
 		node->mSymbol->mType = node->mType->mSymbol;
-		AddSymbolToLibrary(mLib, node->mSymbol, isGlobal);
+		AddSymbolToLibrary(mContext, mLib, node->mSymbol, isGlobal);
 	}
 	else if(!isGlobal)
 	{
-		scopeStack.back().mLocals.push_back(node->mSymbol);
+		mContext->DeclareLocal(node->mSymbol);
 	}
 	return Stop;
 }
@@ -1014,7 +1195,7 @@ VisitResult Phase4Visitor::Visit(VariableNode* node)
 
 VisitResult Phase4Visitor::Visit(BreakNode* node)
 {   
-    for (ScopeStack::reverse_iterator top = scopeStack.rbegin(); top != scopeStack.rend(); ++top)
+    for (ScopeStack::reverse_iterator top = mContext->mScopes.rbegin(); top != mContext->mScopes.rend(); ++top)
     {
         if (top->mType == ST_LOOP)
             return Stop;
@@ -1026,7 +1207,7 @@ VisitResult Phase4Visitor::Visit(BreakNode* node)
 
 VisitResult Phase4Visitor::Visit(ContinueNode* node)
 {
-    for (ScopeStack::reverse_iterator top = scopeStack.rbegin(); top != scopeStack.rend(); ++top)
+    for (ScopeStack::reverse_iterator top = mContext->mScopes.rbegin(); top != mContext->mScopes.rend(); ++top)
     {
         if (top->mType == ST_LOOP)
             return Stop;
@@ -1035,42 +1216,266 @@ VisitResult Phase4Visitor::Visit(ContinueNode* node)
     ErrorBreakContinueMustBeInsideLoop();
     return Stop;
 }
+
+VisitResult Phase4Visitor::Visit(LabelNode* node)
+{
+    if (mDeclare)
+        return mDeclarations.Visit(node);
+    return Continue;
+}
+
+Symbol* Phase4Visitor::FindGlobal(Atom name)
+{
+    SymbolMap::const_iterator it = mGlobals->find(name);
+    if (it == mGlobals->end())
+        return nullptr;
+    return it->second;
+}
 #pragma endregion
 
+#pragma region ParallelBodies
+// One global (or class member) whose function body or initial value is analyzed on its own thread
+// Once Phase3 has declared every global and member, the only things tasks share are the
+// global symbols (which they only read) and the types the library creates (which are locked)
+class BodyTask
+{
+public:
+    BodyTask(AnalysisContext* shared, AbstractNode* node, ClassNode* parentClass, size_t memberIndex) :
+        mShared(shared),
+        mNode(node),
+        mParentClass(parentClass),
+        mMemberIndex(memberIndex),
+        mFailed(false)
+    {
+    }
+
+    // The context of the whole analysis, which the library may only use under its lock
+    // Each task gets a context of its own for its scopes
+    AnalysisContext* mShared;
+
+    AbstractNode* mNode;
+
+    // The class that mNode is a member of (if any), and where it is in mMembers
+    ClassNode* mParentClass;
+    size_t mMemberIndex;
+
+    // The locals and labels we declared, handed to the library once every task is done
+    SymbolVector mSymbols;
+
+    // Every type we got from the library that it may have had to create, in the order we asked
+    std::vector<Type*> mTypes;
+
+    bool mFailed;
+    SemanticException mError;
+};
 
-Type* Library::CreateType(const std::string& name, bool isGlobal)
+// Fewer bodies than this are analyzed on the calling thread
+static const size_t ParallelBodyThreshold = 32;
+
+size_t g_SemanticThreads = 0;
+
+Type* Phase4Visitor::CreateType(Atom name)
 {
-    unsigned pos = name.find("*");
+    if (mTask == nullptr)
+        return mLib->CreateType(name, true, mContext);
+
+    std::lock_guard<std::mutex> lock(mTask->mShared->mTypeMutex);
+    Type* type = mLib->CreateType(name, true, mTask->mShared);
+    mTask->mTypes.push_back(type);
+    return type;
+}
+
+Type* Phase4Visitor::GetPointerType(Type* type)
+{
+    if (mTask == nullptr)
+        return mLib->GetPointerType(type, mContext);
+
+    std::lock_guard<std::mutex> lock(mTask->mShared->mTypeMutex);
+    Type* pointer = mLib->GetPointerType(type, mTask->mShared);
+    mTask->mTypes.push_back(pointer);
+    return pointer;
+}
+
+// Pushes the scope of the class a member is in, for analyzing just that member
+// Phase4 has only seen the members before this one by the time it reaches it, so only those are declared
+void PushMemberScope(AnalysisContext& context, ClassNode* parentClass, size_t memberIndex)
+{
+    context.PushScope(parentClass, ST_CLASS);
+    for (size_t i = 0; i < memberIndex; ++i)
+    {
+        AbstractNode* member = parentClass->mMembers[i].get();
+        if (member->mKind == NodeKind::Variable)
+            context.DeclareLocal(static_cast<VariableNode*>(member)->mSymbol);
+    }
+}
+
+void RunBodyTask(BodyTask& task, Library* library, const SymbolMap* globals)
+{
+    AnalysisContext context;
+    if (task.mParentClass)
+        PushMemberScope(context, task.mParentClass, task.mMemberIndex);
+
+    Phase4Visitor visitor(library, &context);
+    visitor.mDeclare = true;
+    visitor.mDeclarations.mSymbols = &task.mSymbols;
+    visitor.mGlobals = globals;
+    visitor.mTask = &task;
+
+    try
+    {
+        visitor.Walk(task.mNode);
+    }
+    catch (SemanticException& e)
+    {
+        task.mFailed = true;
+        task.mError = e;
+    }
+}
+
+// Runs the Bodies pass with one task per global and class member, spread over a pool of threads
+// Returns false (having done nothing) when the tree is too small to be worth it
+bool RunParallelBodies(AbstractNode* node, Library* library, AnalysisContext* context)
+{
+    size_t threads = g_SemanticThreads ? g_SemanticThreads : std::thread::hardware_concurrency();
+    if (threads < 2 || node->mKind != NodeKind::Block)
+        return false;
+
+    std::vector<std::unique_ptr<BodyTask>> tasks;
+    size_t functions = 0;
+    BlockNode* block = static_cast<BlockNode*>(node);
+    for (size_t i = 0; i < block->mGlobals.size(); ++i)
+    {
+        AbstractNode* global = block->mGlobals[i].get();
+        if (global->mKind == NodeKind::Class)
+        {
+            ClassNode* classNode = static_cast<ClassNode*>(global);
+            for (size_t j = 0; j < classNode->mMembers.size(); ++j)
+            {
+                AbstractNode* member = classNode->mMembers[j].get();
+                functions += member->mKind == NodeKind::Function;
+                tasks.push_back(std::make_unique<BodyTask>(context, member, classNode, j));
+            }
+        }
+        else
+        {
+            functions += global->mKind == NodeKind::Function;
+            tasks.push_back(std::make_unique<BodyTask>(context, global, nullptr, 0));
+        }
+    }
+
+    if (functions < ParallelBodyThreshold)
+        return false;
+
+    // Nobody inserts into the copy, so it can be read from every thread while the library adds types to the original
+    SymbolMap globals = context->mGlobals;
+    size_t globalCount = library->mGlobals.size();
+    size_t symbolCount = library->mAllSymbols.size();
+
+    std::atomic<size_t> next(0);
+    auto work = [&]()
+    {
+        for (size_t i = next++; i < tasks.size(); i = next++)
+            RunBodyTask(*tasks[i], library, &globals);
+    };
+
+    std::vector<std::thread> pool;
+    threads = std::min(threads, tasks.size());
+    for (size_t i = 1; i < threads; ++i)
+        pool.push_back(std::thread(work));
+    work();
+    for (size_t i = 0; i < pool.size(); ++i)
+        pool[i].join();
+
+    // The error a serial walk would have stopped at
+    for (size_t i = 0; i < tasks.size(); ++i)
+    {
+        if (tasks[i]->mFailed)
+            throw tasks[i]->mError;
+    }
+
+    // Walking serially, each new type is created by the first task (in source order) that asks for it
+    // Put the types that were created in that order instead of the order the threads happened to run in
+    std::unordered_map<Symbol*, size_t> firstRequest;
+    size_t request = 0;
+    for (size_t i = 0; i < tasks.size(); ++i)
+    {
+        for (size_t j = 0; j < tasks[i]->mTypes.size(); ++j)
+            firstRequest.insert(std::make_pair(tasks[i]->mTypes[j], request++));
+    }
+
+    std::stable_sort(library->mGlobals.begin() + globalCount, library->mGlobals.end(),
+        [&](Symbol* a, Symbol* b) { return firstRequest[a] < firstRequest[b]; });
+    std::stable_sort(library->mAllSymbols.begin() + symbolCount, library->mAllSymbols.end(),
+        [&](const SymbolVector::value_type& a, const SymbolVector::value_type& b) { return firstRequest[a.get()] < firstRequest[b.get()]; });
+
+    for (size_t i = 0; i < tasks.size(); ++i)
+    {
+        for (size_t j = 0; j < tasks[i]->mSymbols.size(); ++j)
+            library->mAllSymbols.push_back(std::move(tasks[i]->mSymbols[j]));
+    }
+
+    return true;
+}
+#pragma endregion
+
+
+Type* Library::CreateType(const std::string& name, bool isGlobal, AnalysisContext* context)
+{
+    return CreateType(InternString(name), isGlobal, context);
+}
+
+Variable* Library::CreateVariable(const std::string& name, bool isGlobal, SymbolVector* owner)
+{
+    return CreateVariable(InternString(name), isGlobal, owner);
+}
+
+Function* Library::CreateFunction(const std::string& name, bool isGlobal, SymbolVector* owner)
+{
+    return CreateFunction(InternString(name), isGlobal, owner);
+}
+
+Label* Library::CreateLabel(const std::string& name, bool isGlobal, SymbolVector* owner)
+{
+    return CreateLabel(InternString(name), isGlobal, owner);
+}
+
+Type* Library::CreateType(Atom atom, bool isGlobal, AnalysisContext* context)
+{
+    const std::string& name = GetAtomString(atom);
+    size_t pos = name.find("*");
     Type* newSymbol;
     if (pos != name.npos)
     {
         size_t numPtrs = name.size() - pos;
-		std::string givenname = name.substr(0, pos);
+		Atom givenname = InternString(name.substr(0, pos));
         Type* givenType = nullptr;
 
-		if (g_GlobalSymbols.find(givenname) != g_GlobalSymbols.end())
+		SymbolMap& globals = context ? context->mGlobals : mGlobalsByName;
+		if (globals.find(givenname) != globals.end())
 		{
-			givenType = static_cast<Type*>(g_GlobalSymbols[givenname]);
+			givenType = static_cast<Type*>(globals[givenname]);
 		}
 		else
 		{
 			for (unsigned i = 0; i < mAllSymbols.size(); ++i)
 			{
-				if (mAllSymbols[i]->mName.compare(givenname) == 0)
+				if (mAllSymbols[i]->mAtom == givenname)
 				{
 					givenType = static_cast<Type*>(mAllSymbols[i].get());
 				}
 			}
 		}
         
-        newSymbol = GetPointerType(givenType, numPtrs);
+        newSymbol = GetPointerType(givenType, numPtrs, context);
         newSymbol->mName = name;
+        newSymbol->mAtom = atom;
     }
     else
     {
-        newSymbol = new Type();
-        newSymbol->mLibrary = this;
+        newSymbol = Allocate<Type>();
+        newSymbol->mClass = Construct<ClassTypeRecord>();
         newSymbol->mName = name;
+        newSymbol->mAtom = atom;
 
         //Items to fill
         newSymbol->mParentFunction = nullptr;
@@ -1079,119 +1484,121 @@ Type* Library::CreateType(const std::string& name, bool isGlobal)
     
         if (isGlobal)
         {
-            if (mGlobalsByName.find(name) != mGlobalsByName.end())
+            if (mGlobalsByName.find(atom) != mGlobalsByName.end())
             {
                 ErrorSameName(name);
             }
             else
             {
-                mGlobalsByName[name] = newSymbol;
+                mGlobalsByName[atom] = newSymbol;
                 mGlobals.push_back(newSymbol);
             }
         }
 
-        mAllSymbols.push_back(std::make_unique<Type>(*newSymbol));
-        g_GlobalSymbols[name] = newSymbol;
+        if (context)
+            context->mGlobals[atom] = newSymbol;
 
     }
     return newSymbol;
 }
 
-Variable* Library::CreateVariable(const std::string& name, bool isGlobal)
+Variable* Library::CreateVariable(Atom name, bool isGlobal, SymbolVector* owner)
 {
-    Variable* newSymbol = new Variable();
-    newSymbol->mLibrary = this;
-    newSymbol->mName = name;
+    Variable* newSymbol = Allocate<Variable>(owner);
+    newSymbol->mName = GetAtomString(name);
+    newSymbol->mAtom = name;
 
     return newSymbol;
 }
 
-Function* Library::CreateFunction(const std::string& name, bool isGlobal)
+Function* Library::CreateFunction(Atom name, bool isGlobal, SymbolVector* owner)
 {
-    Function* newSymbol = new Function();
-    newSymbol->mLibrary = this;
-    newSymbol->mName = name;
+    Function* newSymbol = Allocate<Function>(owner);
+    newSymbol->mName = GetAtomString(name);
+    newSymbol->mAtom = name;
     
     return newSymbol;
 }
 
-Label* Library::CreateLabel(const std::string& name, bool isGlobal)
+Label* Library::CreateLabel(Atom name, bool isGlobal, SymbolVector* owner)
 {
-    Label* newSymbol = new Label();
-    newSymbol->mLibrary = this;
-    newSymbol->mName = name;
+    Label* newSymbol = Allocate<Label>(owner);
+    newSymbol->mName = GetAtomString(name);
+    newSymbol->mAtom = name;
     newSymbol->mType = nullptr;
     newSymbol->mParentFunction = nullptr;
 	newSymbol->mParentType = nullptr;
     return newSymbol;
 }
 
-Type* Library::GetPointerType(Type* givenType)
+Type* Library::GetPointerType(Type* givenType, AnalysisContext* context)
 {
+    std::unordered_map<Type*, Type*>::iterator cached = mPointerTypes.find(givenType);
+    if (cached != mPointerTypes.end())
+        return cached->second;
+
     std::string name = givenType->mName;
     name.append("*");
-    
-    Symbol* symbol;
-    for (unique_vector<Symbol>::iterator it = mAllSymbols.begin(); it != mAllSymbols.end(); ++it)
+    Atom atom = InternString(name);
+
+    // Every pointer type this library made is one of its globals
+    std::unordered_map<Atom, Symbol*>::iterator existing = mGlobalsByName.find(atom);
+    if (existing != mGlobalsByName.end())
     {
-        symbol = it->get();
-        if (name.compare(symbol->mName) == 0)
-        {
-            return static_cast<Type*>(symbol);
-        }
+        mPointerTypes[givenType] = static_cast<Type*>(existing->second);
+        return static_cast<Type*>(existing->second);
     }
     
-    std::unique_ptr<Type> uptrType = std::make_unique<Type>();
-    Type* type = uptrType.get();
-    type->mLibrary = this;
+    Type* type = Allocate<Type>();
     type->mType = nullptr;
     type->mName = name;
+    type->mAtom = atom;
     type->mParentFunction = nullptr;
     type->mParentType = nullptr;
     type->mMode = TypeMode::Pointer;
     type->mPointerToType = givenType;
 
-    mGlobalsByName[name] = type;
+    mGlobalsByName[atom] = type;
     mGlobals.push_back(type);
-    mAllSymbols.push_back(std::move(uptrType));
-    g_GlobalSymbols.insert(SymbolPair(name, type));
+    mPointerTypes[givenType] = type;
+    if (context)
+        context->mGlobals.insert(SymbolPair(atom, type));
     return type;
 }
 
-Type* Library::GetPointerType(Type* pointerToType, size_t pointerCount)
+Type* Library::GetPointerType(Type* pointerToType, size_t pointerCount, AnalysisContext* context)
 {
     Type* current = pointerToType;
     for (unsigned i = 0; i < pointerCount; ++i)
     {
-        current = GetPointerType(current);
+        current = GetPointerType(current, context);
     }
     
     return current;
 }
 
-Type* Library::GetFunctionType(std::vector<Type*> parameterTypes, Type* returnType)
+Type* Library::GetFunctionType(std::vector<Type*> parameterTypes, Type* returnType, AnalysisContext* context)
 {
-    Type* symbol;
-    for (unique_vector<Symbol>::iterator it = mAllSymbols.begin(); it != mAllSymbols.end(); ++it)
-    {
-        symbol = static_cast<Type*>(it->get());
-        if ( symbol->mMode == TypeMode::Function
-          && symbol->mParameterTypes == parameterTypes 
-          && symbol->mReturnType == returnType)
-        {
-            return symbol;
-        }
-    }
+    Type* symbol = mFunctionTypes.Find(parameterTypes, returnType);
+    if (symbol)
+        return symbol;
 
-    symbol = new Type();
-    symbol->mLibrary = this;
-    symbol->mMode = TypeMode::Function;    
-    symbol->mParameterTypes = parameterTypes;
+    symbol = Allocate<Type>();
+    symbol->mMode = TypeMode::Function;
+    symbol->mFunction = Construct<FunctionTypeRecord>();
+    symbol->mFunction->mParameterTypes = parameterTypes;
     symbol->mType = nullptr;
     symbol->mParentFunction = nullptr;
     symbol->mParentType = nullptr;
 
-    std::string funcSigStr("function(");
+    // Sized up front so the appends below never reallocate
+    size_t length = sizeof("function() : ") + returnType->mName.size();
+    for (unsigned i = 0; i < parameterTypes.size(); ++i)
+        length += parameterTypes[i]->mName.size() + 2;
+
+    std::string funcSigStr;
+    funcSigStr.reserve(length);
+    funcSigStr.append("function(");
     Type* paramType;
     for (unsigned i = 0; i < parameterTypes.size(); ++i)
     {
@@ -1205,18 +1612,127 @@ Type* Library::GetFunctionType(std::vector<Type*> parameterTypes, Type* returnTy
     funcSigStr.append(") : ");
 
     funcSigStr.append(returnType->mName);
-    symbol->mReturnType = returnType;
+    symbol->mFunction->mReturnType = returnType;
 
     symbol->mName = funcSigStr;
+    symbol->mAtom = InternString(funcSigStr);
 
-    mGlobalsByName[funcSigStr] = symbol; //Do we need to do this?
+    mGlobalsByName[symbol->mAtom] = symbol; //Do we need to do this?
     mGlobals.push_back(symbol);
-    g_GlobalSymbols[funcSigStr] = symbol;
-    mAllSymbols.push_back(std::make_unique<Type>(*symbol));
+    mFunctionTypes.Add(symbol);
+    if (context)
+        context->mGlobals[symbol->mAtom] = symbol;
     
     return symbol;
 }
 
+#pragma region ResetVisitor
+// Clears everything semantic analysis stored on the tree, so it can be analyzed again from scratch
+class ResetVisitor : public StaticVisitor<ResetVisitor>
+{
+public:
+    using StaticVisitor<ResetVisitor>::Visit;
+
+    VisitResult Visit(AbstractNode* node)     { node->mParent = nullptr; return Continue; }
+    VisitResult Visit(ClassNode* node)        { node->mSymbol = nullptr; return Visit((AbstractNode*)node); }
+    VisitResult Visit(TypeNode* node)         { node->mSymbol = nullptr; return Visit((AbstractNode*)node); }
+    VisitResult Visit(VariableNode* node)     { node->mSymbol = nullptr; return Visit((AbstractNode*)node); }
+    VisitResult Visit(LabelNode* node)        { node->mSymbol = nullptr; return Visit((AbstractNode*)node); }
+    VisitResult Visit(GotoNode* node)         { node->mResolvedLabel = nullptr; return Visit((AbstractNode*)node); }
+    VisitResult Visit(ExpressionNode* node)   { node->mResolvedType = nullptr; return Visit((AbstractNode*)node); }
+    VisitResult Visit(MemberAccessNode* node) { node->mResolvedMember = nullptr; return Visit((ExpressionNode*)node); }
+    VisitResult Visit(ValueNode* node)        { node->mResolvedSymbol = nullptr; return Visit((ExpressionNode*)node); }
+
+    VisitResult Visit(FunctionNode* node)
+    {
+        node->mSymbol = nullptr;
+        node->mSignatureType = nullptr;
+        return Visit((AbstractNode*)node);
+    }
+};
+#pragma endregion
+
+// Each thread keeps the times of the last analysis it ran
+thread_local std::vector<SemanticPassTime> g_PassTimes;
+bool g_FuseSemanticPasses = true;
+
+// Walks the tree with one pass and records how long it took
+template <typename Pass>
+void RunPass(const char* name, Pass& pass, AbstractNode* node)
+{
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point start = Clock::now();
+
+    pass.Walk(node);
+
+    SemanticPassTime time;
+    time.mName = name;
+    time.mSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+    g_PassTimes.push_back(time);
+}
+
+void LoadDependencies(AnalysisContext* context, std::vector<Library*>& dependencies)
+{
+    for (auto lib : dependencies)
+    {
+        for (SymbolMap::iterator it = lib->mGlobalsByName.begin(); it != lib->mGlobalsByName.end(); ++it)
+        {
+            context->mGlobals[it->first] = it->second;
+        }
+    }
+}
+
+// Each phase walks the whole tree
+void RunClassicPasses(AbstractNode* node, Library* library, AnalysisContext* context)
+{
+    Phase1Visitor phase1(library, context);
+    RunPass("Phase1", phase1, node);
+    Phase2Visitor phase2(library, context);
+    RunPass("Phase2", phase2, node);
+    Phase3Visitor phase3(library, context);
+    RunPass("Phase3", phase3, node);
+    Phase4Visitor phase4(library, context);
+    RunPass("Phase4", phase4, node);
+}
+
+// The same work as the classic passes in two walks of the tree, plus two walks of just the globals:
+//   Classes: the class types, which any type name may refer to
+//   Types:   Phase1 and Phase2 (parents, resolved types, function signatures)
+//   Globals: Phase3 for everything outside of function bodies, so that bodies can refer to any global or member
+//   Bodies:  Phase3 for the locals and labels of function bodies along with Phase4
+//            Large trees split this up by global, and analyze the globals on several threads
+// Types are still resolved in their own walk so the library receives its symbols in the same order
+void RunFusedPasses(AbstractNode* node, Library* library, AnalysisContext* context)
+{
+    Phase1Visitor classes(library, context);
+    classes.mGlobalsOnly = true;
+    RunPass("Classes", classes, node);
+
+    Phase1Visitor linker(library, context);
+    Phase2Visitor types(library, context);
+    types.mLinker = &linker;
+    RunPass("Types", types, node);
+
+    Phase3Visitor globals(library, context);
+    globals.mSkipBodies = true;
+    RunPass("Globals", globals, node);
+
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point start = Clock::now();
+    if (RunParallelBodies(node, library, context))
+    {
+        SemanticPassTime time;
+        time.mName = "Bodies";
+        time.mSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+        g_PassTimes.push_back(time);
+        return;
+    }
+
+    Phase4Visitor bodies(library, context);
+    bodies.mDeclare = true;
+    RunPass("Bodies", bodies, node);
+}
+
 // Run semantic analysis over the tree
 // You should initialize your symbol table with the libraries that you depend upon given here
 // This will run multiple passes to collect symbols (module based compilation)
@@ -1226,88 +1742,312 @@ Type* Library::GetFunctionType(std::vector<Type*> parameterTypes, Type* returnTy
 // A partial library may be used to print out a tree after an error occurs (for your own debugging)
 void SemanticAnalyize(AbstractNode* node, std::vector<Library*>& dependencies, Library* library)
 {
-    scopeStack.clear();
-    g_GlobalSymbols.clear();
-    for (auto lib : dependencies)
+    g_PassTimes.clear();
+
+    if (g_FuseSemanticPasses)
     {
-        for (SymbolMap::iterator it = lib->mGlobalsByName.begin(); it != lib->mGlobalsByName.end(); ++it)
+        size_t globalCount = library->mGlobals.size();
+        size_t symbolCount = library->mAllSymbols.size();
+        std::unordered_map<Atom, Symbol*> globalsByName = library->mGlobalsByName;
+        std::unordered_map<Type*, Type*> pointerTypes = library->mPointerTypes;
+
+        try
         {
-            g_GlobalSymbols[it->first] = it->second;
+            AnalysisContext context;
+            LoadDependencies(&context, dependencies);
+            RunFusedPasses(node, library, &context);
+            return;
+        }
+        catch (SemanticException&)
+        {
+            // The fused passes find errors in a different order, so start over with the classic
+            // passes to report the same error they always have
+            for (size_t i = globalCount; i < library->mGlobals.size(); ++i)
+            {
+                Type* type = dynamic_cast<Type*>(library->mGlobals[i]);
+                if (type && type->mMode == TypeMode::Function)
+                    library->mFunctionTypes.Remove(type);
+            }
+
+            library->mGlobals.resize(globalCount);
+            library->mAllSymbols.resize(symbolCount);
+            library->mGlobalsByName = globalsByName;
+            library->mPointerTypes = pointerTypes;
+
+            ResetVisitor reset;
+            reset.Walk(node);
         }
     }
 
-    std::vector<Visitor*> passes;
-    
-    passes.push_back(new Phase1Visitor(library));
-    passes.push_back(new Phase2Visitor(library));
-    passes.push_back(new Phase3Visitor(library));
-    passes.push_back(new Phase4Visitor(library));
-    
-    for (auto pass : passes)
-        node->Walk(pass);
-    
+    AnalysisContext context;
+    LoadDependencies(&context, dependencies);
+    RunClassicPasses(node, library, &context);
+}
+
+void SetFusedSemanticPasses(bool fused)
+{
+    g_FuseSemanticPasses = fused;
+}
+
+void SetSemanticThreads(size_t threads)
+{
+    g_SemanticThreads = threads;
+}
+
+const std::vector<SemanticPassTime>& GetSemanticPassTimes()
+{
+    return g_PassTimes;
+}
+
+#pragma region IncrementalAnalyzer
+// Stale symbols are removed once they are this fraction of the library's symbols
+static const size_t StaleSymbolDivisor = 4;
+
+static bool SameType(TypeNode* a, TypeNode* b)
+{
+    if (a == nullptr || b == nullptr)
+        return a == b;
+    return a->mName.mAtom == b->mName.mAtom && a->mPointerCount == b->mPointerCount;
+}
+
+// Whether two functions declare the same name, parameters (names and types) and return type
+static bool SameSignature(FunctionNode* a, FunctionNode* b)
+{
+    if (a->mName.mAtom != b->mName.mAtom || a->mParameters.size() != b->mParameters.size())
+        return false;
+
+    for (size_t i = 0; i < a->mParameters.size(); ++i)
+    {
+        ParameterNode* left = a->mParameters[i].get();
+        ParameterNode* right = b->mParameters[i].get();
+        if (left->mName.mAtom != right->mName.mAtom || !SameType(left->mType.get(), right->mType.get()))
+            return false;
+    }
+
+    return SameType(a->mReturnType.get(), b->mReturnType.get());
+}
+
+IncrementalAnalyzer::IncrementalAnalyzer()
+{
+    mLibrary = nullptr;
+}
+
+IncrementalAnalyzer::~IncrementalAnalyzer()
+{
+    RestoreBodies();
+}
+
+void IncrementalAnalyzer::Analyze(AstPtr<BlockNode> block, std::vector<Library*>& dependencies, Library* library)
+{
+    RestoreBodies();
+    mContext = nullptr;
+    mFailedLocals.clear();
+    mStaleSymbols.clear();
+    mLibrary = library;
+    mTree = std::move(block);
+
+    SemanticAnalyize(mTree.get(), dependencies, library);
+
+    // The same globals the passes saw: the dependencies, then the library's own
+    mContext.reset(new AnalysisContext());
+    LoadDependencies(mContext.get(), dependencies);
+    for (SymbolMap::iterator it = library->mGlobalsByName.begin(); it != library->mGlobalsByName.end(); ++it)
+        mContext->mGlobals[it->first] = it->second;
+}
+
+BlockNode* IncrementalAnalyzer::GetTree() const
+{
+    return mTree.get();
 }
 
+bool IncrementalAnalyzer::ReplaceBody(FunctionNode* function, AstPtr<BlockNode> edit)
+{
+    if (mContext == nullptr || function->mSymbol == nullptr || edit == nullptr)
+        return false;
+    if (edit->mGlobals.size() != 1 || edit->mGlobals[0]->mKind != NodeKind::Function)
+        return false;
+
+    FunctionNode* edited = static_cast<FunctionNode*>(edit->mGlobals[0].get());
+    if (!SameSignature(function, edited))
+        return false;
+
+    // A previous edit gets its own body back before it is let go, so that every tree only ever frees its own nodes
+    ForgetLocals(function);
+    std::unordered_map<FunctionNode*, AstPtr<BlockNode>>::iterator previous = mEdits.find(function);
+    if (previous != mEdits.end())
+    {
+        std::swap(function->mScope, static_cast<FunctionNode*>(previous->second->mGlobals[0].get())->mScope);
+        mEdits.erase(previous);
+    }
+
+    std::swap(function->mScope, edited->mScope);
+    function->mScope->mParent = function;
+    mEdits[function] = std::move(edit);
+
+    size_t symbolCount = mLibrary->mAllSymbols.size();
+    try
+    {
+        CheckBody(function);
+    }
+    catch (SemanticException&)
+    {
+        // The failed body is still in the tree, so what it declared is only forgotten once it is replaced
+        // (any new types are globals, and stay)
+        std::vector<Symbol*>& failed = mFailedLocals[function];
+        for (size_t i = symbolCount; i < mLibrary->mAllSymbols.size(); ++i)
+        {
+            Symbol* declared = mLibrary->mAllSymbols[i].get();
+            if (dynamic_cast<Type*>(declared) == nullptr)
+                failed.push_back(declared);
+        }
+        throw;
+    }
+
+    if (mStaleSymbols.size() * StaleSymbolDivisor > mLibrary->mAllSymbols.size())
+        RemoveStaleSymbols();
+    return true;
+}
+
+void IncrementalAnalyzer::CheckBody(FunctionNode* function)
+{
+    // The new body's parents and type names
+    Phase1Visitor linker(mLibrary, mContext.get());
+    Phase2Visitor types(mLibrary, mContext.get());
+    types.mLinker = &linker;
+    types.Walk(function->mScope);
+
+    if (function->mParent && function->mParent->mKind == NodeKind::Class)
+    {
+        ClassNode* parentClass = static_cast<ClassNode*>(function->mParent);
+        size_t index = 0;
+        while (parentClass->mMembers[index].get() != function)
+            ++index;
+        PushMemberScope(*mContext, parentClass, index);
+    }
+
+    Phase4Visitor bodies(mLibrary, mContext.get());
+    bodies.mDeclare = true;
+    try
+    {
+        bodies.Walk(function);
+    }
+    catch (SemanticException&)
+    {
+        while (!mContext->mScopes.empty())
+            mContext->PopScope();
+        throw;
+    }
+
+    while (!mContext->mScopes.empty())
+        mContext->PopScope();
+}
+
+void IncrementalAnalyzer::ForgetLocals(FunctionNode* function)
+{
+    // The parameters come first, and stay
+    Function* symbol = function->mSymbol;
+    size_t parameters = function->mParameters.size();
+    for (size_t i = parameters; i < symbol->mLocals.size(); ++i)
+        mStaleSymbols.insert(symbol->mLocals[i]);
+
+    symbol->mLocals.resize(parameters);
+    symbol->mLocalsByName.clear();
+    symbol->mLabelsByName.clear();
+    for (size_t i = 0; i < parameters; ++i)
+        symbol->mLocalsByName.insert(SymbolPair(symbol->mLocals[i]->mAtom, symbol->mLocals[i]));
+
+    std::unordered_map<FunctionNode*, std::vector<Symbol*>>::iterator failed = mFailedLocals.find(function);
+    if (failed != mFailedLocals.end())
+    {
+        mStaleSymbols.insert(failed->second.begin(), failed->second.end());
+        mFailedLocals.erase(failed);
+    }
+}
+
+void IncrementalAnalyzer::RestoreBodies()
+{
+    for (std::unordered_map<FunctionNode*, AstPtr<BlockNode>>::iterator it = mEdits.begin(); it != mEdits.end(); ++it)
+        std::swap(it->first->mScope, static_cast<FunctionNode*>(it->second->mGlobals[0].get())->mScope);
+    mEdits.clear();
+}
+
+void IncrementalAnalyzer::RemoveStaleSymbols()
+{
+    // The library takes their memory back, so the slabs don't grow with every edit
+    SymbolVector& symbols = mLibrary->mAllSymbols;
+    for (size_t i = 0; i < symbols.size(); ++i)
+    {
+        if (mStaleSymbols.count(symbols[i].get()) != 0)
+            mLibrary->Destroy(symbols[i].release());
+    }
+
+    symbols.erase(std::remove(symbols.begin(), symbols.end(), nullptr), symbols.end());
+    mStaleSymbols.clear();
+}
+#pragma endregion
+
 #pragma region PrintSymbolVisitor
 
 #define PRINT_NODE(outputStr)                            \
 NodePrinter printer;\
 printer << outputStr; 
 
-class PrintSymbolVisitor : public Visitor
+class PrintSymbolVisitor : public StaticVisitor<PrintSymbolVisitor>
 {
 public:
+    using StaticVisitor<PrintSymbolVisitor>::Visit;
+
     /*Specials*/
-    VisitResult Visit(ClassNode* node) override;
+    VisitResult Visit(ClassNode* node);
     
-    VisitResult Visit(VariableNode* node) override;
+    VisitResult Visit(VariableNode* node);
     
-    VisitResult Visit(ParameterNode* node) override;
+    VisitResult Visit(ParameterNode* node);
     
-    VisitResult Visit(FunctionNode* node) override;
+    VisitResult Visit(FunctionNode* node);
     
-    VisitResult Visit(TypeNode* node) override;
+    VisitResult Visit(TypeNode* node);
     
-    VisitResult Visit(LabelNode* node) override;
+    VisitResult Visit(LabelNode* node);
     
-    VisitResult Visit(GotoNode* node) override;
+    VisitResult Visit(GotoNode* node);
     
-    VisitResult Visit(ExpressionNode* node) override;
+    VisitResult Visit(ExpressionNode* node);
     
-    VisitResult Visit(ValueNode* node) override;
+    VisitResult Visit(ValueNode* node);
     
-    VisitResult Visit(BinaryOperatorNode* node) override;
+    VisitResult Visit(BinaryOperatorNode* node);
     
-    VisitResult Visit(UnaryOperatorNode* node) override;
+    VisitResult Visit(UnaryOperatorNode* node);
     
-    VisitResult Visit(PostExpressionNode* node) override;
+    VisitResult Visit(PostExpressionNode* node);
     
-    VisitResult Visit(MemberAccessNode* node) override;
+    VisitResult Visit(MemberAccessNode* node);
     
-    VisitResult Visit(CallNode* node) override;
+    VisitResult Visit(CallNode* node);
     
-    VisitResult Visit(CastNode* node) override;
+    VisitResult Visit(CastNode* node);
     
-    VisitResult Visit(IndexNode* node) override;
+    VisitResult Visit(IndexNode* node);
     
     /*Normals*/
-    VisitResult Visit(AbstractNode* node) override;
+    VisitResult Visit(AbstractNode* node);
     
-    VisitResult Visit(BlockNode* node) override;
+    VisitResult Visit(BlockNode* node);
     
-    VisitResult Visit(IfNode* node) override;
+    VisitResult Visit(IfNode* node);
     
-    VisitResult Visit(WhileNode* node) override;
+    VisitResult Visit(WhileNode* node);
     
-    VisitResult Visit(ForNode* node) override;
+    VisitResult Visit(ForNode* node);
     
-    VisitResult Visit(ScopeNode* node) override;
+    VisitResult Visit(ScopeNode* node);
     
-    VisitResult Visit(BreakNode* node) override;
+    VisitResult Visit(BreakNode* node);
     
-    VisitResult Visit(ContinueNode* node) override;
+    VisitResult Visit(ContinueNode* node);
     
-    VisitResult Visit(ReturnNode* node) override;
+    VisitResult Visit(ReturnNode* node);
 };
 
 VisitResult PrintSymbolVisitor::Visit(ClassNode* node)
@@ -1316,7 +2056,7 @@ VisitResult PrintSymbolVisitor::Visit(ClassNode* node)
     
     for (unsigned i = 0; i < node->mMembers.size(); ++i)
     {
-      node->mMembers[i]->Walk(this);
+      Walk(node->mMembers[i]);
     }
     
     return Stop;
@@ -1326,10 +2066,10 @@ VisitResult PrintSymbolVisitor::Visit(VariableNode* node)
 {
 	PRINT_NODE("VariableNode(" << node->mSymbol << ")")
 
-	node->mType->Walk(this);
+	Walk(node->mType);
 	
 	if(node->mInitialValue)
-		node->mInitialValue->Walk(this);
+		Walk(node->mInitialValue);
 
 	return Stop;
 }
@@ -1338,10 +2078,10 @@ VisitResult PrintSymbolVisitor::Visit(ParameterNode* node)
 {
 	PRINT_NODE("ParameterNode(" << node->mSymbol << ")")
 
-	node->mType->Walk(this);
+	Walk(node->mType);
 
 	if (node->mInitialValue)
-		node->mInitialValue->Walk(this);
+		Walk(node->mInitialValue);
 
 	return Stop;
 }
@@ -1352,13 +2092,13 @@ VisitResult PrintSymbolVisitor::Visit(FunctionNode* node)
 
 	for (unsigned i = 0; i < node->mParameters.size(); ++i)
 	{
-		node->mParameters[i]->Walk(this);
+		Walk(node->mParameters[i]);
 	}
 
 	if (node->mReturnType)
-		node->mReturnType->Walk(this);
+		Walk(node->mReturnType);
 
-	node->mScope->Walk(this);
+	Walk(node->mScope);
 
 	return Stop;
 }
@@ -1397,8 +2137,8 @@ VisitResult PrintSymbolVisitor::Visit(BinaryOperatorNode* node)
 {
 	PRINT_NODE("BinaryOperatorNode(" << node->mOperator << ", " << node->mResolvedType << ")")
 
-	node->mRight->Walk(this);
-	node->mLeft->Walk(this);
+	Walk(node->mRight);
+	Walk(node->mLeft);
 	return Stop;
 }
 
@@ -1406,7 +2146,7 @@ VisitResult PrintSymbolVisitor::Visit(BinaryOperatorNode* node)
 VisitResult PrintSymbolVisitor::Visit(UnaryOperatorNode* node)
 {
 	PRINT_NODE("UnaryOperatorNode(" << node->mOperator << ", " << node->mResolvedType << ")")
-	node->mRight->Walk(this);
+	Walk(node->mRight);
 	return Stop;
 }
 
@@ -1414,7 +2154,7 @@ VisitResult PrintSymbolVisitor::Visit(PostExpressionNode* node)
 {
 	PRINT_NODE("PostExpressionNode(" << node->mResolvedType << ")")
 
-	node->mLeft->Walk(this);
+	Walk(node->mLeft);
 	return Stop;
 }
 
@@ -1422,17 +2162,17 @@ VisitResult PrintSymbolVisitor::Visit(MemberAccessNode* node)
 {
 	//TODO print correctly
 	PRINT_NODE("MemberAccessNode(" << node->mOperator << ", " << node->mResolvedMember << ", " << node->mResolvedType << ")")
-	node->mLeft->Walk(this);
+	Walk(node->mLeft);
 	return Stop;
 }
 
 VisitResult PrintSymbolVisitor::Visit(CallNode* node)
 {
 	PRINT_NODE("CallNode(" << node->mResolvedType << ")")
-	node->mLeft->Walk(this);
+	Walk(node->mLeft);
     for (unsigned i = 0; i < node->mArguments.size(); ++i)
 	{
-		node->mArguments[i]->Walk(this);
+		Walk(node->mArguments[i]);
     }
 
     return Stop;
@@ -1442,8 +2182,8 @@ VisitResult PrintSymbolVisitor::Visit(CastNode* node)
 {
 	PRINT_NODE("CastNode(" << node->mResolvedType << ")")
 
-	node->mLeft->Walk(this);
-	node->mType->Walk(this);
+	Walk(node->mLeft);
+	Walk(node->mType);
 	return Stop;
 }
 
@@ -1451,8 +2191,8 @@ VisitResult PrintSymbolVisitor::Visit(IndexNode* node)
 {
 	PRINT_NODE("IndexNode(" << node->mResolvedType << ")")
 
-	node->mLeft->Walk(this);
-	node->mIndex->Walk(this);
+	Walk(node->mLeft);
+	Walk(node->mIndex);
 	return Stop;
 }
 
@@ -1467,7 +2207,7 @@ VisitResult PrintSymbolVisitor::Visit(BlockNode* node)
 	
 	for (unsigned i = 0; i < node->mGlobals.size(); ++i)
 	{
-		node->mGlobals[i]->Walk(this);
+		Walk(node->mGlobals[i]);
 	}
 	return Stop;
 }
@@ -1476,12 +2216,12 @@ VisitResult PrintSymbolVisitor::Visit(IfNode* node)
 {
     PRINT_NODE("IfNode")
     if (node->mCondition)
-        node->mCondition->Walk(this);
+        Walk(node->mCondition);
     
-    node->mScope->Walk(this);
+    Walk(node->mScope);
     
     if (node->mElse)
-        node->mElse->Walk(this);
+        Walk(node->mElse);
     
     return Stop;
 }
@@ -1489,8 +2229,8 @@ VisitResult PrintSymbolVisitor::Visit(IfNode* node)
 VisitResult PrintSymbolVisitor::Visit(WhileNode* node)
 {
     PRINT_NODE("WhileNode")
-    node->mCondition->Walk(this);
-    node->mScope->Walk(this);
+    Walk(node->mCondition);
+    Walk(node->mScope);
     return Stop;
 }
 
@@ -1498,18 +2238,18 @@ VisitResult PrintSymbolVisitor::Visit(ForNode* node)
 {
     PRINT_NODE("ForNode")
     if (node->mInitialVariable)
-        node->mInitialVariable->Walk(this);
+        Walk(node->mInitialVariable);
     
     if (node->mInitialExpression)
-        node->mInitialExpression->Walk(this);
+        Walk(node->mInitialExpression);
     
     if (node->mCondition)
-        node->mCondition->Walk(this);
+        Walk(node->mCondition);
     
-    node->mScope->Walk(this);
+    Walk(node->mScope);
     
     if (node->mIterator)
-        node->mIterator->Walk(this);
+        Walk(node->mIterator);
     
     return Stop;
 }
@@ -1519,7 +2259,7 @@ VisitResult PrintSymbolVisitor::Visit(ScopeNode* node)
     PRINT_NODE("ScopeNode")
     for (unsigned i = 0; i < node->mStatements.size(); ++i)
     {
-        node->mStatements[i]->Walk(this);
+        Walk(node->mStatements[i]);
     }
     return Stop;
 }
@@ -1540,7 +2280,7 @@ VisitResult PrintSymbolVisitor::Visit(ReturnNode* node)
 {
   PRINT_NODE("ReturnNode")
   if (node->mReturnValue)
-        node->mReturnValue->Walk(this);
+        Walk(node->mReturnValue);
 
   return Stop;
 }
@@ -1549,5 +2289,5 @@ VisitResult PrintSymbolVisitor::Visit(ReturnNode* node)
 void PrintTreeWithSymbols(AbstractNode* node)
 {
     PrintSymbolVisitor printSymbols;
-    node->Walk(&printSymbols);
+    printSymbols.Walk(node);
 }